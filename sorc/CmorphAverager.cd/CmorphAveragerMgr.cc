@@ -34,7 +34,9 @@ using std::vector;
 
 CmorphAveragerMgr::CmorphAveragerMgr(const ParmsCmorphAverager &params, 
 				     void cleanExit(int)):
-  pParams(params)
+  pParams(params),
+  pAccum(params.checkpointFile),
+  pRestored(false)
 {   
   time_t t = time(0);
 
@@ -46,6 +48,36 @@ CmorphAveragerMgr::CmorphAveragerMgr(const ParmsCmorphAverager &params,
     cleanExit(1);
   }
 
+  // if center averaging, look to do an average of older data
+  // at hour 1, 4, 7, etc, with output time set to 0, 3, 6, etc.
+  // the average will be at 7:  7, 6.5, 6, 5.5, 5, 4.5  output time = 6
+
+  // for end time averaging, look to do an average of older data
+  // at hour 0, 3, 6, etc. with output time same (0, 3, 6, etc).
+  // the average at 6:  3.5, 4, 4.5, 5, 5.5, 6
+  // if (pParams.centerAveraging)
+  // {
+  //   pHoursForProcessing.push_back(1);
+  //   pHoursForProcessing.push_back(4);
+  //   pHoursForProcessing.push_back(7);
+  //   pHoursForProcessing.push_back(10);
+  //   pHoursForProcessing.push_back(13);
+  //   pHoursForProcessing.push_back(16);
+  //   pHoursForProcessing.push_back(19);
+  //   pHoursForProcessing.push_back(22);
+  // }
+  // else
+  // {
+    pHoursForProcessing.push_back(0);
+    pHoursForProcessing.push_back(3);
+    pHoursForProcessing.push_back(6);
+    pHoursForProcessing.push_back(9);
+    pHoursForProcessing.push_back(12);
+    pHoursForProcessing.push_back(15);
+    pHoursForProcessing.push_back(18);
+    pHoursForProcessing.push_back(21);
+  // }
+
   ILOGF(WARNING, "Restarted at %s", ConvWxTime::stime(t).c_str());
 }
 
@@ -56,62 +88,22 @@ CmorphAveragerMgr::~CmorphAveragerMgr()
   
 }
 
-bool CmorphAveragerMgr::run() const
+bool CmorphAveragerMgr::run()
 { 
+  if (pParams.rolling && pParams.backfill && !pParams.main.isRealtime())
+  {
+    return pBackfill();
+  }
+
   //
   // Observation data time. 
   //
   time_t obsTime;
     
-  int lastYear = -1;
-  int lastMonth = -1;
-  int lastDay = -1;
-  int lastHour = -1;
-  
-  vector<time_t> hoursForProcessing;
-    
-  // if center averaging, look to do an average of older data
-  // at hour 1, 4, 7, etc, with output time set to 0, 3, 6, etc.
-  // the average will be at 7:  7, 6.5, 6, 5.5, 5, 4.5  output time = 6
-
-  // for end time averaging, look to do an average of older data
-  // at hour 0, 3, 6, etc. with output time same (0, 3, 6, etc).
-  // the average at 6:  3.5, 4, 4.5, 5, 5.5, 6
-  // if (pParams.centerAveraging)
-  // {
-  //   hoursForProcessing.push_back(1);
-  //   hoursForProcessing.push_back(4);
-  //   hoursForProcessing.push_back(7);
-  //   hoursForProcessing.push_back(10);
-  //   hoursForProcessing.push_back(13);
-  //   hoursForProcessing.push_back(16);
-  //   hoursForProcessing.push_back(19);
-  //   hoursForProcessing.push_back(22);
-  // }
-  // else
-  // {
-    hoursForProcessing.push_back(0);
-    hoursForProcessing.push_back(3);
-    hoursForProcessing.push_back(6);
-    hoursForProcessing.push_back(9);
-    hoursForProcessing.push_back(12);
-    hoursForProcessing.push_back(15);
-    hoursForProcessing.push_back(18);
-    hoursForProcessing.push_back(21);
-  // }
-
   while (Trigger::sequenceTrigger(pParams.main, obsTime))
   {
     InterfaceLL::doRegister("Processing observation data");
-    bool doWrite = false;
-    int y, m, d, h, min, s;
-    ConvWxTime::expandTime(obsTime, y, m, d, h, min, s);
-    if (find(hoursForProcessing.begin(), hoursForProcessing.end(), h) == hoursForProcessing.end())
-    {
-      InterfaceLL::doRegister("Skipping observation data");
-      continue;
-    }
-    if (min != 0)
+    if (!pIsOutputTime(obsTime))
     {
       InterfaceLL::doRegister("Skipping observation data");
       continue;
@@ -130,56 +122,154 @@ bool CmorphAveragerMgr::run() const
       outTime = obsTime;
     // }
 
-    Grid data;
     Grid out;
-    Grid counts;
-    vector<time_t> times = InterfaceIO::availableObsTimesInARange(pParams.obs.pUrl, t0, t1);
-    bool first = true;
-    for (size_t i=0; i<times.size(); ++i)
+    if (pParams.rolling)
     {
-      if (pLoadObs(times[i], data))
+      vector<time_t> times =
+	InterfaceIO::availableObsTimesInARange(pParams.obs.pUrl, t0, t1);
+      if (!pRollingAverage(times, t0, t1, out))
       {
-	if (first)
-	{
-	  first = false;
-	  out = data;
-	  out.setAllMissing();
-	  counts = data;
-	  counts.setAllToValue(0.0);
-	}
-	for (int i=0; i<data.getNdata(); ++i)
+	ILOGF(WARNING, "No observations for %s",
+	      ConvWxTime::stime(outTime).c_str());
+	continue;
+      }
+      if (!pAccum.checkpoint())
+      {
+	ILOGF(WARNING, "Checkpoint not written at %s, a restart will re-read "
+	      "the whole window", ConvWxTime::stime(outTime).c_str());
+      }
+    }
+    else
+    {
+      pAverage(t0, t1, out);
+    }
+    pFinishAndWrite(outTime, out);
+  }  
+  return true;
+}
+
+bool CmorphAveragerMgr::pIsOutputTime(const time_t &obsTime) const
+{
+  int y, m, d, h, min, s;
+  ConvWxTime::expandTime(obsTime, y, m, d, h, min, s);
+  if (find(pHoursForProcessing.begin(), pHoursForProcessing.end(), h) ==
+      pHoursForProcessing.end())
+  {
+    return false;
+  }
+  return min == 0;
+}
+
+void CmorphAveragerMgr::pAverage(const time_t &t0, const time_t &t1,
+				 Grid &out) const
+{
+  Grid data;
+  Grid counts;
+  vector<time_t> times = InterfaceIO::availableObsTimesInARange(pParams.obs.pUrl, t0, t1);
+  bool first = true;
+  for (size_t i=0; i<times.size(); ++i)
+  {
+    if (pLoadObs(times[i], data))
+    {
+      if (first)
+      {
+	first = false;
+	out = data;
+	out.setAllMissing();
+	counts = data;
+	counts.setAllToValue(0.0);
+      }
+      for (int i=0; i<data.getNdata(); ++i)
+      {
+	double v;
+	if (data.getValue(i, v))
 	{
-	  double v;
-	  if (data.getValue(i, v))
+	  counts.incrementValueAtPoint(i, 1.0);
+	  if (out.isMissingAt(i))
+	  {
+	    out.setv(i, v);
+	  }
+	  else
 	  {
-	    counts.incrementValueAtPoint(i, 1.0);
-	    if (out.isMissingAt(i))
-	    {
-	      out.setv(i, v);
-	    }
-	    else
-	    {
-	      out.incrementValueAtPoint(i, v);
-	    }
+	    out.incrementValueAtPoint(i, v);
 	  }
 	}
       }
     }
-    // normalize
-    out.divide(counts);
+  }
+  // normalize
+  out.divide(counts);
+}
 
-    if (pParams.unitsConvert)
+bool CmorphAveragerMgr::pRollingAverage(const vector<time_t> &times,
+					const time_t &t0, const time_t &t1,
+					Grid &out)
+{
+  Grid data;
+  for (size_t i=0; i<times.size(); ++i)
+  {
+    if (times[i] < t0 || times[i] > t1 || pAccum.has(times[i]))
     {
-      // multiply by 3 to change units from mm/hour to mm/3hr
-      out.multiply(3.0);
-      out.changeUnits("mm/3hr");
+      continue;
     }
-    pWriteObs(outTime, out);
-    InterfaceLL::doRegister("Wrote observation data");
-  }  
+    if (!pLoadObs(times[i], data))
+    {
+      continue;
+    }
+    if (!pRestored)
+    {
+      // the first observation read gives everything but the values
+      pRestored = true;
+      pAccum.restore(data);
+    }
+    pAccum.add(times[i], data);
+  }
+  pAccum.retire(t0, t1);
+  return pAccum.average(out);
+}
+
+bool CmorphAveragerMgr::pBackfill(void)
+{
+  time_t t0 = pParams.main.pArchiveT0;
+  time_t t1 = pParams.main.pArchiveT1;
+  vector<time_t> times =
+    InterfaceIO::availableObsTimesInARange(pParams.obs.pUrl, t0 - 3.5*3600,
+					   t1);
+  ILOGF(DEBUG, "Backfill %s to %s, %d observations",
+	ConvWxTime::stime(t0).c_str(), ConvWxTime::stime(t1).c_str(),
+	static_cast<int>(times.size()));
+
+  // no checkpoint in this mode, so nothing to restore
+  pRestored = true;
+  for (size_t i=0; i<times.size(); ++i)
+  {
+    if (times[i] < t0 || !pIsOutputTime(times[i]))
+    {
+      continue;
+    }
+    InterfaceLL::doRegister("Processing observation data");
+    time_t outTime = times[i];
+    Grid out;
+    if (pRollingAverage(times, outTime - 3.5*3600, outTime, out))
+    {
+      pFinishAndWrite(outTime, out);
+    }
+  }
   return true;
 }
 
+void CmorphAveragerMgr::pFinishAndWrite(const time_t &outTime, Grid &out) const
+{
+  if (pParams.unitsConvert)
+  {
+    // multiply by 3 to change units from mm/hour to mm/3hr
+    out.multiply(3.0);
+    out.changeUnits("mm/3hr");
+  }
+  pWriteObs(outTime, out);
+  InterfaceLL::doRegister("Wrote observation data");
+}
+
 bool 
 CmorphAveragerMgr::pLoadObs(const time_t obsTime, Grid &data) const
 {
@@ -26,6 +26,8 @@
 #define CmorphAveragerMgr_HH
 
 #include "ParmsCmorphAverager.hh"
+#include "ObsAccumulator.hh"
+#include <vector>
 
 class CmorphAveragerMgr
 {
@@ -54,7 +56,7 @@ public:
    * Run the application.
    * @return true or false
    */ 
-  bool run(void) const;
+  bool run(void);
   
 protected:
   
@@ -65,6 +67,60 @@ private:
    */
   ParmsCmorphAverager  pParams;
 
+  /**
+   * Rolling sums, when pParams.rolling
+   */
+  ObsAccumulator pAccum;
+
+  /**
+   * True once pAccum has been restored from its checkpoint, or tried to be
+   */
+  bool pRestored;
+
+  /**
+   * Hours of the day at which output is produced
+   */
+  std::vector<int> pHoursForProcessing;
+
+  /**
+   * @return true if an observation time is one at which output is produced
+   * @param[in] obsTime
+   */
+  bool pIsOutputTime(const time_t &obsTime) const;
+
+  /**
+   * Average all observations in a window by reading them all
+   * @param[in] t0  Earliest observation time
+   * @param[in] t1  Latest observation time
+   * @param[out] out  The average
+   */
+  void pAverage(const time_t &t0, const time_t &t1, Grid &out) const;
+
+  /**
+   * Average all observations in a window using pAccum, reading only the
+   * observations that are not in it yet
+   * @param[in] times  The observation times in the window
+   * @param[in] t0  Earliest observation time
+   * @param[in] t1  Latest observation time
+   * @param[out] out  The average
+   * @return false if there were no observations
+   */
+  bool pRollingAverage(const std::vector<time_t> &times, const time_t &t0,
+		       const time_t &t1, Grid &out);
+
+  /**
+   * Produce all archive mode outputs in one sweep using pAccum
+   * @return true or false
+   */
+  bool pBackfill(void);
+
+  /**
+   * Convert units if configured, and write
+   * @param[in] outTime  Output time
+   * @param[in] out  The average
+   */
+  void pFinishAndWrite(const time_t &outTime, Grid &out) const;
+
   /**
    *  Load observations at this time. Static calibration may be applied.
    *  @param[in] obsTime  Observation time
@@ -0,0 +1,279 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/** 
+ * @file ObsAccumulator.cc
+ * @brief Source for ObsAccumulator class 
+ */
+
+#include "ObsAccumulator.hh"
+#include <ConvWx/InterfaceLL.hh>
+#include <ConvWx/ConvWxTime.hh>
+#include <ConvWxIO/ILogMsg.hh>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+using std::map;
+using std::string;
+using std::vector;
+
+/**
+ * Identifies a checkpoint file, and its layout version
+ */
+static const char checkpointMagic[16] = "ObsAccumulator2";
+
+/**
+ * Missing data value in checkpoint files
+ */
+static const double checkpointMissing = -9999.0;
+
+ObsAccumulator::ObsAccumulator(const string &checkpointFile) :
+  pCheckpointFile(checkpointFile)
+{
+}
+
+ObsAccumulator::~ObsAccumulator()
+{
+}
+
+bool ObsAccumulator::has(const time_t &t) const
+{
+  return pRing.find(t) != pRing.end();
+}
+
+void ObsAccumulator::add(const time_t &t, const Grid &data)
+{
+  if (has(t))
+  {
+    return;
+  }
+  if (!pRing.empty() && !pSum.sizeEqual(data))
+  {
+    ILOGF(WARNING, "Grid size changed at %s, starting over",
+	  ConvWxTime::stime(t).c_str());
+    pRing.clear();
+  }
+  bool inOrder = pRing.empty() || t > pRing.rbegin()->first;
+  pRing[t] = data;
+  if (inOrder)
+  {
+    if (pRing.size() == 1)
+    {
+      pReset(data);
+    }
+    pAdd(data);
+  }
+  else
+  {
+    // keep the sums in time order
+    pRebuild();
+  }
+  ILOGF(DEBUG_VERBOSE, "Added %s, %d in ring", ConvWxTime::stime(t).c_str(),
+	static_cast<int>(pRing.size()));
+}
+
+void ObsAccumulator::retire(const time_t &t0, const time_t &t1)
+{
+  bool retired = false;
+  map<time_t, Grid>::iterator i;
+  for (i=pRing.begin(); i!=pRing.end(); )
+  {
+    if (i->first >= t0 && i->first <= t1)
+    {
+      ++i;
+    }
+    else
+    {
+      ILOGF(DEBUG_VERBOSE, "Retired %s", ConvWxTime::stime(i->first).c_str());
+      pRing.erase(i++);
+      retired = true;
+    }
+  }
+  if (retired)
+  {
+    // subtracting would leave rounding behind, so sum what is left again
+    pRebuild();
+  }
+}
+
+vector<time_t> ObsAccumulator::times(void) const
+{
+  vector<time_t> ret;
+  map<time_t, Grid>::const_iterator i;
+  for (i=pRing.begin(); i!=pRing.end(); ++i)
+  {
+    ret.push_back(i->first);
+  }
+  return ret;
+}
+
+bool ObsAccumulator::average(Grid &out) const
+{
+  if (pRing.empty())
+  {
+    return false;
+  }
+  out = pSum;
+  out.divide(pCount);
+  return true;
+}
+
+bool ObsAccumulator::checkpoint(void) const
+{
+  if (pCheckpointFile.empty())
+  {
+    return true;
+  }
+  if (!InterfaceLL::makeDirRecurse(pCheckpointFile))
+  {
+    ILOGF(ERROR, "Making path to %s", pCheckpointFile.c_str());
+    return false;
+  }
+  string tmp = pCheckpointFile + ".tmp";
+  FILE *fp = fopen(tmp.c_str(), "w");
+  if (fp == NULL)
+  {
+    ILOGF(ERROR, "Opening %s", tmp.c_str());
+    return false;
+  }
+  int n = pRing.empty() ? 0 : pSum.getNdata();
+  int nring = static_cast<int>(pRing.size());
+  bool ok = (fwrite(checkpointMagic, sizeof(checkpointMagic), 1, fp) == 1 &&
+	     fwrite(&n, sizeof(int), 1, fp) == 1 &&
+	     fwrite(&nring, sizeof(int), 1, fp) == 1);
+  vector<double> values(n);
+  map<time_t, Grid>::const_iterator i;
+  for (i=pRing.begin(); ok && i!=pRing.end(); ++i)
+  {
+    for (int k=0; k<n; ++k)
+    {
+      double v;
+      values[k] = i->second.getValue(k, v) ? v : checkpointMissing;
+    }
+    ok = (fwrite(&i->first, sizeof(time_t), 1, fp) == 1 &&
+	  (n == 0 || fwrite(&values[0], sizeof(double), n, fp) ==
+	   static_cast<size_t>(n)));
+  }
+  if (fclose(fp) != 0)
+  {
+    ok = false;
+  }
+  if (!ok || rename(tmp.c_str(), pCheckpointFile.c_str()) != 0)
+  {
+    ILOGF(ERROR, "Writing %s", pCheckpointFile.c_str());
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ObsAccumulator::restore(const Grid &tmpl)
+{
+  if (pCheckpointFile.empty())
+  {
+    return false;
+  }
+  FILE *fp = fopen(pCheckpointFile.c_str(), "r");
+  if (fp == NULL)
+  {
+    ILOGF(DEBUG, "No checkpoint %s", pCheckpointFile.c_str());
+    return false;
+  }
+  char magic[sizeof(checkpointMagic)];
+  int n, nring;
+  bool ok = (fread(magic, sizeof(magic), 1, fp) == 1 &&
+	     memcmp(magic, checkpointMagic, sizeof(magic)) == 0 &&
+	     fread(&n, sizeof(int), 1, fp) == 1 &&
+	     fread(&nring, sizeof(int), 1, fp) == 1 &&
+	     (nring == 0 || n == tmpl.getNdata()));
+  pRing.clear();
+  vector<double> values(ok ? n : 0);
+  for (int r=0; ok && r<nring; ++r)
+  {
+    time_t t;
+    ok = (fread(&t, sizeof(time_t), 1, fp) == 1 &&
+	  (n == 0 || fread(&values[0], sizeof(double), n, fp) ==
+	   static_cast<size_t>(n)));
+    if (ok)
+    {
+      Grid g(tmpl);
+      for (int k=0; k<n; ++k)
+      {
+	if (values[k] == checkpointMissing)
+	{
+	  g.setToMissing(k);
+	}
+	else
+	{
+	  g.setv(k, values[k]);
+	}
+      }
+      add(t, g);
+    }
+  }
+  fclose(fp);
+  if (!ok)
+  {
+    ILOGF(WARNING, "Checkpoint %s bad or wrong size, ignored",
+	  pCheckpointFile.c_str());
+    pRing.clear();
+    return false;
+  }
+  ILOGF(DEBUG, "Restored %d observations from %s", nring,
+	pCheckpointFile.c_str());
+  return nring > 0;
+}
+
+void ObsAccumulator::pReset(const Grid &data)
+{
+  pSum = data;
+  pSum.setAllMissing();
+  pCount = data;
+  pCount.setAllToValue(0.0);
+}
+
+void ObsAccumulator::pAdd(const Grid &data)
+{
+  for (int i=0; i<data.getNdata(); ++i)
+  {
+    double v;
+    if (data.getValue(i, v))
+    {
+      pCount.incrementValueAtPoint(i, 1.0);
+      if (pSum.isMissingAt(i))
+      {
+	pSum.setv(i, v);
+      }
+      else
+      {
+	pSum.incrementValueAtPoint(i, v);
+      }
+    }
+  }
+}
+
+void ObsAccumulator::pRebuild(void)
+{
+  map<time_t, Grid>::const_iterator i;
+  for (i=pRing.begin(); i!=pRing.end(); ++i)
+  {
+    if (i == pRing.begin())
+    {
+      pReset(i->second);
+    }
+    pAdd(i->second);
+  }
+}
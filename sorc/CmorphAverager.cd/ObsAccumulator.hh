@@ -0,0 +1,124 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file ObsAccumulator.hh
+ * @brief Rolling sum and count of observations over a time window
+ * @class ObsAccumulator
+ * @brief Rolling sum and count of observations over a time window
+ *
+ * Each observation grid is read and added once, and kept in a ring for as
+ * long as it is in the window. When observations leave the window, or one
+ * arrives out of time order, the sums are rebuilt from the ring in time
+ * order rather than subtracted, so the average is exactly what summing
+ * every observation in the window from scratch gives.
+ *
+ * The checkpoint holds the ring, each observation time with its values as
+ * doubles. restore() rebuilds the ring from it using a freshly loaded
+ * observation for everything but the values, so a restart only needs to
+ * read observations that are newer than the checkpoint.
+ */
+
+#ifndef ObsAccumulator_HH
+#define ObsAccumulator_HH
+
+#include <ConvWx/Grid.hh>
+#include <map>
+#include <string>
+#include <vector>
+#include <ctime>
+
+class ObsAccumulator
+{
+public:
+
+  /**
+   * Constructor, empty
+   * @param[in] checkpointFile  File for the list of times in the ring,
+   *                            empty for no checkpointing
+   */
+  ObsAccumulator(const std::string &checkpointFile);
+
+  /**
+   * Destructor
+   */
+  ~ObsAccumulator(void);
+
+  /**
+   * @return true if an observation time is in the ring
+   * @param[in] t
+   */
+  bool has(const time_t &t) const;
+
+  /**
+   * Add an observation to the sums, unless it is already there
+   * @param[in] t  Observation time
+   * @param[in] data  Observation grid
+   *
+   * If data is not the same size as what is in the ring, the ring is
+   * emptied first.
+   */
+  void add(const time_t &t, const Grid &data);
+
+  /**
+   * Drop all observations not in a time range, and rebuild the sums if
+   * any were dropped
+   * @param[in] t0  Earliest time to keep
+   * @param[in] t1  Latest time to keep
+   */
+  void retire(const time_t &t0, const time_t &t1);
+
+  /**
+   * @return the observation times in the ring, ascending
+   */
+  std::vector<time_t> times(void) const;
+
+  /**
+   * Compute the average at each point
+   * @param[out] out  The average, missing where there were no observations
+   * @return false if the ring is empty
+   */
+  bool average(Grid &out) const;
+
+  /**
+   * Write the ring to the checkpoint file, replacing it atomically
+   * @return true for success, or no checkpoint file
+   */
+  bool checkpoint(void) const;
+
+  /**
+   * Replace the ring with what is in the checkpoint file
+   * @param[in] tmpl  An observation grid, which gives everything but the
+   *                  values
+   * @return true if something was restored, false if there is no
+   *         checkpoint or it is bad or a different size than tmpl
+   */
+  bool restore(const Grid &tmpl);
+
+protected:
+private:
+
+  std::string pCheckpointFile;       /**< File with the ring */
+  std::map<time_t, Grid> pRing;      /**< Each observation in the sums */
+  Grid pSum;                         /**< Sum at each point, or missing */
+  Grid pCount;                       /**< Count at each point */
+
+  void pReset(const Grid &data);
+  void pAdd(const Grid &data);
+  void pRebuild(void);
+};
+
+#endif
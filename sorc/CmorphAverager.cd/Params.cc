@@ -584,6 +584,51 @@
     tt->single_val.b = pTRUE;
     tt++;
     
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("Rolling accumulation");
+    tt->comment_text = tdrpStrDup("Options to read each observation only once");
+    tt++;
+    
+    // Parameter 'rolling'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("rolling");
+    tt->descr = tdrpStrDup("Keep a rolling sum instead of re-reading the whole window");
+    tt->help = tdrpStrDup("TRUE to keep a running sum and count at each point, plus the observations in the window. Each observation is read once and kept while it is in the window; the sums are rebuilt from those kept observations when any leave it, so the output matches re-reading the whole window.");
+    tt->val_offset = (char *) &rolling - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'checkpointFile'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("checkpointFile");
+    tt->descr = tdrpStrDup("Checkpoint file for the rolling accumulation");
+    tt->help = tdrpStrDup("When rolling = TRUE, the observations in the window are saved here after each output, and restored from here at startup, so a restart only reads newer observations. Empty for no checkpointing.");
+    tt->val_offset = (char *) &checkpointFile - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'backfill'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("backfill");
+    tt->descr = tdrpStrDup("Produce all archive outputs in one sweep");
+    tt->help = tdrpStrDup("When rolling = TRUE and in archive mode, list the observations for the whole archive time range once and produce every output in one sweep, instead of triggering on each observation. There is no checkpointing in this mode.");
+    tt->val_offset = (char *) &backfill - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
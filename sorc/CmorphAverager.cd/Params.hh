@@ -362,6 +362,12 @@ public:
 
   tdrp_bool_t unitsConvert;
 
+  tdrp_bool_t rolling;
+
+  char* checkpointFile;
+
+  tdrp_bool_t backfill;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -369,7 +375,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[4];
+  mutable TDRPtable _table[8];
 
   const char *_className;
 
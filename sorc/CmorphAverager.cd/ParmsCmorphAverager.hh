@@ -62,6 +62,21 @@ public:
    */
   bool unitsConvert;
 
+  /**
+   * If true, read each observation once and keep a rolling sum
+   */
+  bool rolling;
+
+  /**
+   * File for saving the rolling sum, empty for none
+   */
+  std::string checkpointFile;
+
+  /**
+   * If true and rolling, produce all archive mode outputs in one sweep
+   */
+  bool backfill;
+
 protected:
 private:
  
@@ -61,6 +61,9 @@ ParmsCmorphAveragerIO::ParmsCmorphAveragerIO(int argc, char **argv)
   obsOut = ParmFcstIO(obsOutput[0]);
 
   unitsConvert = params.unitsConvert;
+  rolling = params.rolling;
+  checkpointFile = params.checkpointFile;
+  backfill = params.backfill;
 
 }
 
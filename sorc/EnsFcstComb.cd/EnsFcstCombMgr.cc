@@ -458,27 +458,15 @@ bool EnsFcstCombMgr::pProcessInputField(const std::vector<Grid> &inputGrids,
   Grid sumWgtsDenom(combProbGrid);
   for (size_t i=0; i<inputGrids.size(); ++i)
   {    
-    for (int j = 0; j< inputGrids[i].getNdata(); j++)
+    //
+    // running sums of the weighted values and of the weights, at points
+    // where the input is not missing
+    //
+    if (!combProbGrid.addWeighted(inputGrids[i], pParams.weights[i],
+				  sumWgtsDenom))
     {
-      double val; 
-      if (  inputGrids[i].getValue(j, val) )
-      {
-	//
-	// calculate running sum of the weighted values
-	//
-	double runningSumNumerator;
-
-	combProbGrid.getValue(j, runningSumNumerator);
-	combProbGrid.setv(j, runningSumNumerator + val * pParams.weights[i]);
-
-	//
-	// calculate running sum of the weights
-	//
-	double runningSumDenominator;
-
-	sumWgtsDenom.getValue(j,runningSumDenominator);
-	sumWgtsDenom.setv(j, runningSumDenominator +  pParams.weights[i]);
-      }
+      LOG(ERROR) << "Input grid " << i << " size differs";
+      return false;
     }
   } 
   // normalize the results
@@ -4,60 +4,22 @@
 
 #include "EnsLookupGenMgr.hh"
 #include "Info.hh"
-#include "GriddedThresh.hh"
 #include <ConvWxIO/InterfaceIO.hh>
 #include <ConvWx/InterfaceLL.hh>
 #include <ConvWx/MultiFcstGrid.hh>
 #include <ConvWx/FcstGrid.hh>
 #include <ConvWx/ConvWxTime.hh>
+#include <ConvWx/ConvWxConstants.hh>
+#include <ConvWx/PhaseTimer.hh>
 #include <dsdata/DsEnsembleLeadTrigger.hh>
 #include <toolsa/TaThreadSimple.hh>
 #include <toolsa/LogStream.hh>
+#include <algorithm>
 
 using std::vector;
 using std::pair;
 using std::string;
-
-//----------------------------------------------------------------------
-static bool _setValueVec(const vector<const Grid *> &grids, int k, 
-			 vector<double> &values, bool debug, int ensIndex)
-{
-  bool status = true;
-  if (debug)
-  {
-    printf("Retrieving values for ensemble member %d ", ensIndex);
-  }
-
-  for (size_t n=0; n<grids.size(); ++n)
-  {
-    double v;
-    if (!grids[n]->getValue(k, v))
-    {
-      if (debug)
-      {
-	printf(" %s = missing ", grids[n]->getName().c_str());
-      }
-      status = false;
-    }
-    else
-    {
-      values[n] = v;
-      if (debug)
-      {
-	printf(" %s = %lf", grids[n]->getName().c_str(), v);
-      }
-    }
-  }
-  if (debug)
-  {
-    printf("\n");
-  }
-  if (debug && status == false)
-  {
-    printf(" Ignore this point, need data for all fields\n");
-  }
-  return status;
-}
+using std::find;
 
 //----------------------------------------------------------------------
 TaThread *EnsLookupGenMgr::EnsLookupThreads::clone(int index)
@@ -69,9 +31,11 @@ TaThread *EnsLookupGenMgr::EnsLookupThreads::clone(int index)
 }
 
 //----------------------------------------------------------------------
-EnsLookupGenMgr::EnsLookupGenMgr(const ParmsEnsLookupGenIO &params,
-				 void cleanExit(int)):
-  _params(params),  _trigger(NULL),  _genTime(0),  _multiThreshInfo(params)
+EnsLookupGenMgr::
+EnsLookupGenMgr(const ParmsEnsLookupGenIO &params,
+		const vector<ParmsEnsLookupGenIO> &instances,
+		void cleanExit(int)):
+  _params(params),  _trigger(NULL),  _genTime(0)
 {
   time_t t = time(0);
   LOG(DEBUG) << "Restarted at " << ConvWxTime::stime(t);
@@ -79,10 +43,29 @@ EnsLookupGenMgr::EnsLookupGenMgr(const ParmsEnsLookupGenIO &params,
   // to make things thread safe
   InterfaceIO::disallowStoringVerticalLevels();
 
+  // the instances share member reads, so must agree on what gets read
+  _addInstance(params);
+  for (size_t i=0; i<instances.size(); ++i)
+  {
+    string why;
+    _addInstance(instances[i]);
+    if (!_instances.back()->canShareInputs(params, why))
+    {
+      LOG(ERROR) << "Instance " << _params._instanceParamFiles[i]
+		 << " cannot share inputs, " << why;
+      cleanExit(convWx::BAD_EXIT);
+    }
+  }
+  if (_instances.size() > 1)
+  {
+    LOG(DEBUG) << _instances.size() << " instances, reading "
+	       << _inputs.size() << " member inputs per lead";
+  }
+
   // set up triggering one of two ways
   if (params._main.isRealtime())
   {
-    _trigger = new DsEnsembleLeadTrigger(params._modelUrls,
+    _trigger = new DsEnsembleLeadTrigger(_triggerUrls,
 					 params._leadSeconds);
     if (params._main.pDebugTrigger)
     {
@@ -97,21 +80,46 @@ EnsLookupGenMgr::EnsLookupGenMgr(const ParmsEnsLookupGenIO &params,
   {
     _trigger = new DsEnsembleLeadTrigger(params._main.pArchiveT0,
                                          params._main.pArchiveT1,
-                                         params._modelUrls,
+                                         _triggerUrls,
 					 params._leadSeconds);
   }
   _thread.init(params._numThreads, false);
+  if (params._gridHandoff)
+  {
+    // by default, every member and lead of two generation times
+    int maxEntries = params._gridHandoffMaxEntries;
+    if (maxEntries <= 0)
+    {
+      maxEntries = 2*static_cast<int>(_triggerUrls.size()*
+				       params._leadSeconds.size());
+    }
+    if (!InterfaceIO::setGridHandoffSubscriber(params._gridHandoffUrl,
+					       params._gridHandoffNumSlots,
+					       params._gridHandoffBufSize,
+					       maxEntries))
+    {
+      LOG(WARNING) << "No grid handoff, reading all input from files";
+    }
+  }
+  Instrumentation::setMode(params._instrumentation,
+			   params._instrumentationJsonDir);
 }
 
 //----------------------------------------------------------------------
 EnsLookupGenMgr::~EnsLookupGenMgr()
 {
   _thread.waitForThreads();
+  _instrumentationReport();
   if (_trigger != NULL)
   {
     delete _trigger;
     _trigger = NULL;
   }
+  for (size_t i=0; i<_instances.size(); ++i)
+  {
+    delete _instances[i];
+  }
+  _instances.clear();
 
   time_t t = time(0);
   LOG(DEBUG) << "Terminated at ", ConvWxTime::stime(t);
@@ -150,9 +158,14 @@ void EnsLookupGenMgr::_process(const time_t &genTime, int leadTime,
   if (_genTime != genTime)
   {
     _thread.waitForThreads();
+    _instrumentationReport();
     LOG(DEBUG) << "New gen time, look for new thresholds";
     _genTime = genTime;
-    _multiThreshInfo.newGenTime(genTime);
+    PhaseTimer t("spdbRead");
+    for (size_t i=0; i<_instances.size(); ++i)
+    {
+      _instances[i]->newGenTime(genTime);
+    }
     index = 0;
   }
   else
@@ -170,173 +183,162 @@ void EnsLookupGenMgr::compute(void *ti)
   Info *algInfo = static_cast<Info *>(ti);
   EnsLookupGenMgr *alg = algInfo->_alg;
 
-  Grid ensembleCount = Grid("counts", "none", alg->_params._projExtended.pNx,
-			    alg->_params._projExtended.pNy,-99.99);
-  ensembleCount.setAllToValue(0.0);
-
-  GriddedThresh gthresh(alg->_params);
-  gthresh.newLeadTime(algInfo->_genTime, algInfo->_lt, alg->_multiThreshInfo);
-
-  InterfaceLL::doRegister("Processing forecast data");
-
-  // Loop through ensemble members and load data, check data thresholds
-  // at each point, increment output grid elements satisfying 
-  // threshold criteria as appropriate
-  for (size_t i=0; i <alg->_params._modelInput.size(); i++)
+  vector<EnsLookupInstance::LeadState *> state;
+  for (size_t i=0; i<alg->_instances.size(); ++i)
   {
-    alg->_processEnsembleMember(i, algInfo->_genTime, algInfo->_lt,
-				ensembleCount, gthresh);
+    EnsLookupInstance::LeadState *s =
+      new EnsLookupInstance::LeadState(alg->_instances[i]->params());
+    alg->_instances[i]->newLeadTime(algInfo->_genTime, algInfo->_lt, *s);
+    state.push_back(s);
   }
 
-  // normalize the results using counts
-  alg->_normalize(ensembleCount, gthresh);
-
-  // Output data
-  alg->_outputData(algInfo->_genTime, algInfo->_lt, gthresh);
-  delete algInfo;
-}
+  InterfaceLL::doRegister("Processing forecast data");
 
-//----------------------------------------------------------------------
-void EnsLookupGenMgr::_processEnsembleMember(int ensIndex,
-					     const time_t &genTime,
-					     int leadTime,
-					     Grid &ensembleCount,
-					     GriddedThresh &gthresh)
-{
-  MultiFcstGrid mInGrid;
-  vector<const Grid *> grids;
-  if (!_loadAllInputFieldsForEnsemble(ensIndex, genTime, leadTime,
-				      mInGrid, grids))
+  // Loop through the member inputs, loading each once, and have every
+  // instance that uses it check data thresholds at each point, incrementing
+  // its output grid elements satisfying threshold criteria as appropriate
+  for (size_t i=0; i<alg->_inputs.size(); i++)
   {
-    LOG(WARNING) << "Did not get all inputs";
-    return;
-  }
-
-  vector<double> values;
-  values.resize(static_cast<int>(grids.size()), 0.0);
+    const SharedInput &input = alg->_inputs[i];
+    MultiFcstGrid mInGrid;
+    if (alg->_loadInputData(i, algInfo->_genTime, algInfo->_lt,
+			    input._fieldNames, mInGrid))
+    {
+      Instrumentation::addCount("membersLoaded");
+      for (size_t j=0; j<input._users.size(); ++j)
+      {
+	int k = input._users[j].first;
+	alg->_instances[k]->update(input._users[j].second, mInGrid,
+				   *state[k]);
+      }
+      continue;
+    }
 
-  int k=0;
-  for (int y = 0; y <_params._projExtended.pNy; ++y)
-  {
-    for (int x=0; x<_params._projExtended.pNx; ++x)
+    // The union of the fields did not load. A field only some instances
+    // need may be missing from this member, so load each instance's own
+    // fields, and let every instance that gets all of them use the member
+    bool anyLoaded = false;
+    for (size_t j=0; j<input._users.size(); ++j)
     {
-      if (_setValueVec(grids, k, values, _params.isDebugPoint(x,y), ensIndex))
+      int k = input._users[j].first;
+      const vector<string> &fields = alg->_instances[k]->params()._fieldNames;
+      if (fields.size() == input._fieldNames.size())
+      {
+	// same fields as the union, which failed
+	continue;
+      }
+      MultiFcstGrid instanceGrid;
+      if (alg->_loadInputData(i, algInfo->_genTime, algInfo->_lt,
+			      fields, instanceGrid))
       {
-	// all values were present, if not all present, don't increment anything
-	ensembleCount.incrementValueAtPoint(k, 1.0);
-	gthresh.updateCount(values, k, x, y);
+	anyLoaded = true;
+	alg->_instances[k]->update(input._users[j].second, instanceGrid,
+				   *state[k]);
       }
-      k++;
+    }
+    if (anyLoaded)
+    {
+      LOG(WARNING) << "Did not get all inputs for every instance";
+      Instrumentation::addCount("membersLoaded");
+    }
+    else
+    {
+      LOG(WARNING) << "Did not get all inputs";
+      Instrumentation::addCount("membersMissing");
     }
   }
-}
 
-//----------------------------------------------------------------------
-bool
-EnsLookupGenMgr::
-_loadAllInputFieldsForEnsemble(int i, const time_t &genTime, int leadTime, 
-			       MultiFcstGrid &mInGrid,
-			       std::vector<const Grid *> &grids) const
-{
-  LOG(DEBUG) << "Loading data for gen " << ConvWxTime::stime(genTime) 
-	     << " lead " << leadTime << " at url "
-	     << _params._modelInput[i].pUrl;
-  if (!_loadInputData(i, genTime, leadTime, mInGrid))
+  // normalize and write, per instance
+  for (size_t i=0; i<alg->_instances.size(); ++i)
   {
-    return false;
+    alg->_instances[i]->finish(algInfo->_genTime, algInfo->_lt, *state[i],
+			       alg->_thread);
+    delete state[i];
   }
+  delete algInfo;
+}
 
-  LOG(DEBUG_VERBOSE) << "Data loaded";
-  for (size_t i=0; i<_params._fieldNames.size(); ++i)
+//----------------------------------------------------------------------
+void EnsLookupGenMgr::_addInstance(const ParmsEnsLookupGenIO &params)
+{
+  int k = static_cast<int>(_instances.size());
+  _instances.push_back(new EnsLookupInstance(params));
+  for (size_t i=0; i<params._modelInput.size(); ++i)
   {
-    const Grid *g = mInGrid.constGridPtr(_params._fieldNames[i]);
-    if (g == NULL)
+    // inputs are shared by instances reading the same URL with the
+    // same remapping
+    const string &url = params._modelInput[i].pUrl;
+    bool remap = params._modelInput[i].pRemap;
+    size_t j;
+    for (j=0; j<_inputs.size(); ++j)
     {
-      return false;
+      if (_inputs[j]._input.pUrl == url && _inputs[j]._input.pRemap == remap)
+      {
+	break;
+      }
     }
-    grids.push_back(g);
+    if (j == _inputs.size())
+    {
+      SharedInput s;
+      s._input = params._modelInput[i];
+      _inputs.push_back(s);
+      if (find(_triggerUrls.begin(), _triggerUrls.end(), url) ==
+	  _triggerUrls.end())
+      {
+	_triggerUrls.push_back(url);
+      }
+    }
+    SharedInput &s = _inputs[j];
+    for (size_t f=0; f<params._fieldNames.size(); ++f)
+    {
+      if (find(s._fieldNames.begin(), s._fieldNames.end(),
+	       params._fieldNames[f]) == s._fieldNames.end())
+      {
+	s._fieldNames.push_back(params._fieldNames[f]);
+      }
+    }
+    s._users.push_back(pair<int,int>(k, static_cast<int>(i)));
   }
-  return true;
 }
 
 //----------------------------------------------------------------------
 bool
-EnsLookupGenMgr::_loadInputData(int ensembleMember,
+EnsLookupGenMgr::_loadInputData(int inputIndex,
 				const time_t &genTime, int leadTime,
+				const vector<string> &fieldNames,
 				MultiFcstGrid &mInGrid) const
 
 {
   InterfaceLL::doRegister("Loading data");
 
+  const SharedInput &input = _inputs[inputIndex];
+  LOG(DEBUG) << "Loading data for gen " << ConvWxTime::stime(genTime) 
+	     << " lead " << leadTime << " at url " << input._input.pUrl;
+
   // NOTE: read the larger domain
   if (!InterfaceIO::loadMultiFcst(genTime, leadTime, _params._projExtended,
-                                  _params._modelInput[ensembleMember].pUrl,
-                                  _params._fieldNames,
-                                  _params._modelInput[ensembleMember].pRemap,
-                                  mInGrid))
+                                  input._input.pUrl, fieldNames,
+                                  input._input.pRemap, mInGrid))
   {
     LOG(ERROR) << "Failure to load fcst data for gen "
 	       << ConvWxTime::stime(genTime) << " lead " << leadTime 
-	       << " at url " << _params._modelInput[ensembleMember].pUrl;
+	       << " at url " << input._input.pUrl;
     return false;
   }
+  LOG(DEBUG_VERBOSE) << "Data loaded";
   return true;
 }
 
 //----------------------------------------------------------------------
-void EnsLookupGenMgr::_outputData(const time_t &genTime, int leadTime,
-				  GriddedThresh &gthresh)
+void EnsLookupGenMgr::_instrumentationReport(void) const
 {
-  InterfaceLL::doRegister("Writing data");
-
-  LOG(DEBUG) << "Writing data to " << _params._modelOut.pUrl << " for gen time "
-	     << ConvWxTime::stime(genTime) << " lead time " << leadTime;
-  
-  MultiGrid mOutGrid;
-  string xml;
-  _multiThreshInfo.prepareOutput(//mOutGrid,
-				 xml);
-  gthresh.prepareOutput(mOutGrid);
-  
-  MetaData md;
-  md.xmlAddFreeform(xml);
-
-  ParmFcstIO parm(_params._modelOut);
-  mOutGrid.setEncoding(_params._encodingType);
-  
-  _thread.lockForIO();
-  parm.write(genTime, leadTime, _params._projExtended, mOutGrid, md);
-  _thread.unlockAfterIO();
-}
-
-//----------------------------------------------------------------------
-void EnsLookupGenMgr::_normalize(const Grid &ensembleCount,
-				 GriddedThresh &gthresh) const
-{
-  for (int k = 0; k < ensembleCount.getNdata(); ++k)
-  { 
-    int x = ensembleCount.xAtIndex(k);
-    int y = ensembleCount.yAtIndex(k);
-    bool debug = _params.isDebugPoint(x,y);
-    double v=0.0;
-    bool hasCount = ensembleCount.getValue(k, v);
-    if (hasCount && v <= 0)
-    {
-      if (debug) printf("The denom N=%lf\n", v);
-      hasCount = false;
-    }
-    if (!hasCount)
-    {
-      if (debug) printf("Setting output to missing, no count\n");
-      gthresh.setEnsembleSumMissing(k);
-    }
-    else
-    {
-      gthresh.normalizeEnsembleSum(k, v, debug);
-    } 
+  if (_genTime == 0)
+  {
+    return;
+  }
+  string s = Instrumentation::report("EnsLookupGen", _genTime);
+  if (!s.empty())
+  {
+    LOG(PRINT) << s;
   }
 }
-
-
-
-
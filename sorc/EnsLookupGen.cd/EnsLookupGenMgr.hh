@@ -11,13 +11,15 @@
 #define  EnsLookupGenMgr_hh
 
 #include "ParmsEnsLookupGenIO.hh"
-#include "MultiThreshInfo.hh"
+#include "EnsLookupInstance.hh"
 #include <toolsa/TaThreadDoubleQue.hh>
+#include <string>
+#include <vector>
+#include <utility>
 
 class MultiFcstGrid;
 class DsEnsembleLeadTrigger;
 class Grid2d;
-class GriddedThresh;
 
 class EnsLookupGenMgr
 {
@@ -26,9 +28,12 @@ public:
   /**
    * Constructor
    * @param[in] params  The algorithm parameters
+   * @param[in] instances  Parameters for more instances to serve from
+   *                       the same member inputs, possibly empty
    * @param[in] cleanExit  Cleanup function to call at exit
    */
   EnsLookupGenMgr(const ParmsEnsLookupGenIO &params,
+		  const std::vector<ParmsEnsLookupGenIO> &instances,
 		  void cleanExit(int));
 
   /**
@@ -63,6 +68,18 @@ private:
     TaThread *clone(int index);
   };
 
+  /**
+   * @class SharedInput
+   * @brief One member URL and remapping, read once per gen/lead for every
+   *        instance that uses it
+   */
+  class SharedInput
+  {
+  public:
+    ParmFcstIO _input;                    /**< URL and remap parameters */
+    std::vector<std::string> _fieldNames; /**< Union of the fields needed */
+    std::vector<std::pair<int,int> > _users; /**< (instance, member index) */
+  };
 
   /**
    *  User defined parameters
@@ -77,9 +94,19 @@ private:
   time_t _genTime;  /**< Current gen time */
 
   /**
-   * Multi thresholds object, one per data field
+   * The instances, the one from _params first
+   */
+  std::vector<EnsLookupInstance *> _instances;
+
+  /**
+   * The distinct member inputs across all instances
+   */
+  std::vector<SharedInput> _inputs;
+
+  /**
+   * The URLs in _inputs, which are triggered on
    */
-  MultiThreshInfo _multiThreshInfo;
+  std::vector<std::string> _triggerUrls;
 
   /**
    * Threading
@@ -96,56 +123,31 @@ private:
   void _process(const time_t &genTime, int leadTime, size_t num, bool complete, int &index);
 
   /**
-   * Process individual ensemble member
-   * @param[in] ensIndex  Index into ensembles 0,1,...
-   * @param[in] genTime  Forecast generation time  
-   * @param[in] leadTime  Forecast lead time in seconds
+   * Add an instance, and its member inputs to _inputs
+   * @param[in] params  The instance parameters
    */
-  void _processEnsembleMember(int ensIndex, const time_t &genTime, int leadTime,
-			      Grid &ensembleCount,
-			      GriddedThresh &gthresh);
+  void _addInstance(const ParmsEnsLookupGenIO &params);
 
   /**
-   * Load in the fields for one ensemble member
-   * @param[in] ensIndex  Index into ensembles 0,1,...
-   * @param[in] genTime  Forecast generation time  
-   * @param[in] leadTime  Forecast lead time in seconds
-   * @param[out] mInGrid  The data grids, one per field
-   * @param[out] grid  Pointers to each data grid within mInGrid,
-   *                   done for efficienty
-   *
-   * @return true for success
-   */
-  bool _loadAllInputFieldsForEnsemble(int ensIndex, const time_t &genTime,
-				      int leadTime,  MultiFcstGrid &mInGrid,
-				      std::vector<const Grid *> &grid) const;
-  /**
-   * Load in the fields for one ensemble member,, normal forecast data
+   * Load in the fields for one shared input
    *
-   * @param[in] ensIndex  Index into ensembles 0,1,...
+   * @param[in] inputIndex  Index into _inputs
    * @param[in] genTime  Forecast generation time  
    * @param[in] leadTime  Forecast lead time in seconds
+   * @param[in] fieldNames  The fields to load
    * @param[out] inputMultGrid  The data grids, one per field
    *
    * @return true for success
    */ 
-  bool _loadInputData(int ensIndex, const time_t &genTime, 
-		      int leadTime, MultiFcstGrid &inputMultGrid) const;
-
-  
-  /**
-   * Output the results
-   *
-   * @param[in] genTime  Forecast generation time   
-   * @param[in] leadTime  Forecast lead time in seconds
-   */ 
-  void _outputData(const time_t &genTime, int leadTime, GriddedThresh &gthresh);
+  bool _loadInputData(int inputIndex, const time_t &genTime, 
+		      int leadTime, const std::vector<std::string> &fieldNames,
+		      MultiFcstGrid &inputMultGrid) const;
 
   /**
-   * Normalize the ensemble sum by dividing by counts
+   * Log (and optionally write) the instrumentation for the gen time just
+   * finished, if any
    */
-  void _normalize(const Grid &ensembleCount,
-		  GriddedThresh &gthresh) const;
+  void _instrumentationReport(void) const;
 
 };
 
@@ -0,0 +1,258 @@
+/**
+ * @file EnsLookupInstance.cc
+ */
+
+#include "EnsLookupInstance.hh"
+#include <ConvWxIO/InterfaceIO.hh>
+#include <ConvWx/InterfaceLL.hh>
+#include <ConvWx/MultiFcstGrid.hh>
+#include <ConvWx/ConvWxTime.hh>
+#include <ConvWx/PhaseTimer.hh>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/LogStream.hh>
+
+using std::vector;
+using std::string;
+
+//----------------------------------------------------------------------
+static bool _setValueVec(const vector<const Grid *> &grids, int k,
+			 vector<double> &values, bool debug, int ensIndex)
+{
+  bool status = true;
+  if (debug)
+  {
+    printf("Retrieving values for ensemble member %d ", ensIndex);
+  }
+
+  for (size_t n=0; n<grids.size(); ++n)
+  {
+    double v;
+    if (!grids[n]->getValue(k, v))
+    {
+      if (debug)
+      {
+	printf(" %s = missing ", grids[n]->getName().c_str());
+      }
+      status = false;
+    }
+    else
+    {
+      values[n] = v;
+      if (debug)
+      {
+	printf(" %s = %lf", grids[n]->getName().c_str(), v);
+      }
+    }
+  }
+  if (debug)
+  {
+    printf("\n");
+  }
+  if (debug && status == false)
+  {
+    printf(" Ignore this point, need data for all fields\n");
+  }
+  return status;
+}
+
+//----------------------------------------------------------------------
+static bool _allValid(const vector<const Grid *> &grids,
+		      vector<unsigned long long> &valid)
+{
+  for (size_t n=0; n<grids.size(); ++n)
+  {
+    if (!grids[n]->hasValidMask())
+    {
+      return false;
+    }
+  }
+  if (grids.empty())
+  {
+    return false;
+  }
+  valid = grids[0]->validMask();
+  for (size_t n=1; n<grids.size(); ++n)
+  {
+    const vector<unsigned long long> &m = grids[n]->validMask();
+    if (m.size() != valid.size())
+    {
+      return false;
+    }
+    for (size_t w=0; w<valid.size(); ++w)
+    {
+      valid[w] &= m[w];
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+EnsLookupInstance::LeadState::LeadState(const ParmsEnsLookupGen &parms) :
+  _ensembleCount("counts", "none", parms._projExtended.pNx,
+		 parms._projExtended.pNy, -99.99),
+  _gthresh(parms)
+{
+  _ensembleCount.setAllToValue(0.0);
+}
+
+//----------------------------------------------------------------------
+EnsLookupInstance::EnsLookupInstance(const ParmsEnsLookupGenIO &params) :
+  _params(params), _multiThreshInfo(params)
+{
+}
+
+//----------------------------------------------------------------------
+EnsLookupInstance::~EnsLookupInstance()
+{
+}
+
+//----------------------------------------------------------------------
+bool EnsLookupInstance::canShareInputs(const ParmsEnsLookupGen &primary,
+				       string &why) const
+{
+  if (!(_params._projExtended == primary._projExtended))
+  {
+    why = "extended projection differs";
+    return false;
+  }
+  if (_params._leadSeconds != primary._leadSeconds)
+  {
+    why = "lead times differ";
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------
+void EnsLookupInstance::newGenTime(const time_t &genTime)
+{
+  _multiThreshInfo.newGenTime(genTime);
+}
+
+//----------------------------------------------------------------------
+void EnsLookupInstance::newLeadTime(const time_t &genTime, int leadTime,
+				    LeadState &state) const
+{
+  state._gthresh.newLeadTime(genTime, leadTime, _multiThreshInfo);
+}
+
+//----------------------------------------------------------------------
+void EnsLookupInstance::update(int ensIndex, const MultiFcstGrid &mInGrid,
+			       LeadState &state) const
+{
+  // pointers to this instance's fields, in the order of its thresholds
+  vector<const Grid *> grids;
+  for (size_t i=0; i<_params._fieldNames.size(); ++i)
+  {
+    const Grid *g = mInGrid.constGridPtr(_params._fieldNames[i]);
+    if (g == NULL)
+    {
+      LOG(WARNING) << "Did not get all inputs for "
+		   << _params._modelInput[ensIndex].pUrl
+		   << ", missing " << _params._fieldNames[i];
+      Instrumentation::addCount("membersMissing");
+      return;
+    }
+    grids.push_back(g);
+  }
+  PhaseTimer t("count");
+
+  vector<double> values;
+  values.resize(static_cast<int>(grids.size()), 0.0);
+
+  // where every field has a validity mask, points missing in any field
+  // can be skipped 64 at a time
+  vector<unsigned long long> valid;
+  bool useMask = _allValid(grids, valid);
+
+  int k=0;
+  for (int y = 0; y <_params._projExtended.pNy; ++y)
+  {
+    for (int x=0; x<_params._projExtended.pNx; ++x)
+    {
+      if (useMask && ((valid[k >> 6] >> (k & 63)) & 1ULL) == 0ULL &&
+	  !_params.isDebugPoint(x,y))
+      {
+	k++;
+	continue;
+      }
+      if (_setValueVec(grids, k, values, _params.isDebugPoint(x,y), ensIndex))
+      {
+	// all values were present, if not all present, don't increment anything
+	state._ensembleCount.incrementValueAtPoint(k, 1.0);
+	state._gthresh.updateCount(values, k, x, y);
+      }
+      k++;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+void EnsLookupInstance::finish(const time_t &genTime, int leadTime,
+			       LeadState &state,
+			       TaThreadDoubleQue &thread) const
+{
+  // normalize the results using counts
+  {
+    PhaseTimer t("count");
+    _normalize(state);
+  }
+
+  // Output data
+  _outputData(genTime, leadTime, state, thread);
+}
+
+//----------------------------------------------------------------------
+void EnsLookupInstance::_normalize(LeadState &state) const
+{
+  const Grid &ensembleCount = state._ensembleCount;
+  for (int k = 0; k < ensembleCount.getNdata(); ++k)
+  {
+    int x = ensembleCount.xAtIndex(k);
+    int y = ensembleCount.yAtIndex(k);
+    bool debug = _params.isDebugPoint(x,y);
+    double v=0.0;
+    bool hasCount = ensembleCount.getValue(k, v);
+    if (hasCount && v <= 0)
+    {
+      if (debug) printf("The denom N=%lf\n", v);
+      hasCount = false;
+    }
+    if (!hasCount)
+    {
+      if (debug) printf("Setting output to missing, no count\n");
+      state._gthresh.setEnsembleSumMissing(k);
+    }
+    else
+    {
+      state._gthresh.normalizeEnsembleSum(k, v, debug);
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+void EnsLookupInstance::_outputData(const time_t &genTime, int leadTime,
+				    LeadState &state,
+				    TaThreadDoubleQue &thread) const
+{
+  InterfaceLL::doRegister("Writing data");
+
+  LOG(DEBUG) << "Writing data to " << _params._modelOut.pUrl << " for gen time "
+	     << ConvWxTime::stime(genTime) << " lead time " << leadTime;
+
+  MultiGrid mOutGrid;
+  string xml;
+  _multiThreshInfo.prepareOutput(//mOutGrid,
+				 xml);
+  state._gthresh.prepareOutput(mOutGrid);
+
+  MetaData md;
+  md.xmlAddFreeform(xml);
+
+  ParmFcstIO parm(_params._modelOut);
+  mOutGrid.setEncoding(_params._encodingType);
+
+  thread.lockForIO();
+  parm.write(genTime, leadTime, _params._projExtended, mOutGrid, md);
+  thread.unlockAfterIO();
+}
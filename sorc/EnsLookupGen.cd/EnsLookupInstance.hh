@@ -0,0 +1,128 @@
+/**
+ * @file EnsLookupInstance.hh
+ * @brief One EnsLookupGen configuration: its parameters, threshold
+ *        information, counting and output
+ * @class EnsLookupInstance
+ * @brief One EnsLookupGen configuration: its parameters, threshold
+ *        information, counting and output
+ *
+ * The member forecasts are loaded by EnsLookupGenMgr, which can hand the
+ * same in-memory grids to several instances (for example the main and
+ * cloud top configurations of a model), so each instance only does the
+ * threshold tests and writes its own output.
+ */
+
+#ifndef  EnsLookupInstance_hh
+#define  EnsLookupInstance_hh
+
+#include "ParmsEnsLookupGenIO.hh"
+#include "MultiThreshInfo.hh"
+#include "GriddedThresh.hh"
+#include <ConvWx/Grid.hh>
+#include <string>
+#include <vector>
+
+class MultiFcstGrid;
+class TaThreadDoubleQue;
+
+class EnsLookupInstance
+{
+public:
+
+  /**
+   * @class LeadState
+   * @brief The counts for one instance at one gen/lead, built up one
+   *        member at a time
+   */
+  class LeadState
+  {
+  public:
+    /**
+     * @param[in] parms  The instance parameters
+     */
+    LeadState(const ParmsEnsLookupGen &parms);
+    inline ~LeadState(void) {}
+
+    Grid _ensembleCount;      /**< Number of members with data at each point*/
+    GriddedThresh _gthresh;   /**< Ensemble sums */
+  };
+
+  /**
+   * Constructor
+   * @param[in] params  The instance parameters
+   */
+  EnsLookupInstance(const ParmsEnsLookupGenIO &params);
+
+  /**
+   *  Destructor
+   */
+  ~EnsLookupInstance(void);
+
+  /**
+   * @return the parameters
+   */
+  inline const ParmsEnsLookupGenIO &params(void) const {return _params;}
+
+  /**
+   * Check that this instance can share member inputs with another
+   * @param[in] primary  The parameters of the instance that triggers
+   * @param[out] why  Reason when not
+   * @return true if the extended projection and lead times agree
+   */
+  bool canShareInputs(const ParmsEnsLookupGen &primary,
+		      std::string &why) const;
+
+  /**
+   * Get the thresholds for a new gen time
+   * @param[in] genTime
+   */
+  void newGenTime(const time_t &genTime);
+
+  /**
+   * Initialize the state for a gen/lead
+   * @param[in] genTime
+   * @param[in] leadTime  Lead seconds
+   * @param[out] state
+   */
+  void newLeadTime(const time_t &genTime, int leadTime,
+		   LeadState &state) const;
+
+  /**
+   * Add one ensemble member to the counts
+   * @param[in] ensIndex  Index into this instance's ensemble members
+   * @param[in] mInGrid  Loaded data, which can have more fields than
+   *                     this instance uses
+   * @param[in,out] state
+   */
+  void update(int ensIndex, const MultiFcstGrid &mInGrid,
+	      LeadState &state) const;
+
+  /**
+   * Normalize the counts and write the output
+   * @param[in] genTime
+   * @param[in] leadTime  Lead seconds
+   * @param[in,out] state
+   * @param[in] thread  Threading object, used to lock the write
+   */
+  void finish(const time_t &genTime, int leadTime, LeadState &state,
+	      TaThreadDoubleQue &thread) const;
+
+protected:
+private:
+
+  ParmsEnsLookupGenIO _params;        /**< Parameters */
+  MultiThreshInfo _multiThreshInfo;   /**< Thresholds, one per data field */
+
+  /**
+   * Normalize the ensemble sum by dividing by counts
+   */
+  void _normalize(LeadState &state) const;
+
+  /**
+   * Output the results
+   */
+  void _outputData(const time_t &genTime, int leadTime, LeadState &state,
+		   TaThreadDoubleQue &thread) const;
+};
+
+#endif
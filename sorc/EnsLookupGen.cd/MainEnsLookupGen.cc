@@ -19,6 +19,9 @@
 #include <ConvWxIO/InterfaceIO.hh>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
+
+using std::vector;
 
 /**
  * Return value of program to indicate success
@@ -57,6 +60,40 @@ static void _checkForSpecialArgs(int argc, char **argv)
   }
 }
 
+/**
+ * Load the parameters for each of the instanceParamFiles, using the
+ * command line with the -params path replaced
+ * @param[in] params  Primary parameters
+ * @param[in] argc
+ * @param[in] argv
+ * @return the instance parameters
+ */
+static vector<ParmsEnsLookupGenIO>
+_loadInstances(const ParmsEnsLookupGenIO &params, int argc, char **argv)
+{
+  vector<ParmsEnsLookupGenIO> ret;
+  for (size_t i=0; i<params._instanceParamFiles.size(); ++i)
+  {
+    vector<char *> args(argv, argv + argc);
+    for (int j=0; j<argc-1; ++j)
+    {
+      if (string(argv[j]) == "-params")
+      {
+	args[j+1] = const_cast<char *>(params._instanceParamFiles[i].c_str());
+      }
+    }
+    ParmsEnsLookupGenIO p(argc, &args[0]);
+    if (!p._instanceParamFiles.empty())
+    {
+      printf("WARNING instanceParamFiles ignored in %s\n",
+	     params._instanceParamFiles[i].c_str());
+      p._instanceParamFiles.clear();
+    }
+    ret.push_back(p);
+  }
+  return ret;
+}
+
 /**
  * Create algorithm manager and run algorithm 
  * @param[in] argc  Number of command line arguments is generally three for
@@ -79,9 +116,10 @@ int main(int argc, char **argv)
 
   // Read in parameters
   ParmsEnsLookupGenIO params(argc, argv);
+  vector<ParmsEnsLookupGenIO> instances = _loadInstances(params, argc, argv);
 
   // Create object that runs the algorithm               
-  _mgr = new EnsLookupGenMgr(params, cleanExit);
+  _mgr = new EnsLookupGenMgr(params, instances, cleanExit);
 
   // standard initialization
   InterfaceIO::startup(params._main.pProcessName, 
@@ -861,6 +861,145 @@
     tt->single_val.i = 0;
     tt++;
     
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("GRID HANDOFF");
+    tt->comment_text = tdrpStrDup("Optionally take forecast input from a shared memory queue published by the upstream app (PrecipAccumCalc), instead of reading the files.  Anything not found in the queue, or with a different projection, is read from the file as usual.");
+    tt++;
+    
+    // Parameter 'gridHandoff'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoff");
+    tt->descr = tdrpStrDup("Set TRUE to look for input in the grid handoff queue");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &gridHandoff - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'gridHandoffUrl'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffUrl");
+    tt->descr = tdrpStrDup("Grid handoff queue");
+    tt->help = tdrpStrDup("Must agree with the publisher.");
+    tt->val_offset = (char *) &gridHandoffUrl - &_start_;
+    tt->single_val.s = tdrpStrDup("/tmp/fmq/shmem_27000");
+    tt++;
+    
+    // Parameter 'gridHandoffNumSlots'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffNumSlots");
+    tt->descr = tdrpStrDup("Number of slots in the grid handoff queue");
+    tt->help = tdrpStrDup("Must agree with the publisher.");
+    tt->val_offset = (char *) &gridHandoffNumSlots - &_start_;
+    tt->single_val.i = 100;
+    tt++;
+    
+    // Parameter 'gridHandoffBufSize'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffBufSize");
+    tt->descr = tdrpStrDup("Size of the grid handoff queue buffer (bytes)");
+    tt->help = tdrpStrDup("Must agree with the publisher.");
+    tt->val_offset = (char *) &gridHandoffBufSize - &_start_;
+    tt->single_val.i = 500000000;
+    tt++;
+    
+    // Parameter 'gridHandoffMaxEntries'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffMaxEntries");
+    tt->descr = tdrpStrDup("Number of forecasts to keep in memory from the queue");
+    tt->help = tdrpStrDup("Zero or less to hold two generation times, members times lead times times two, so that every input of a trigger can come from memory.  Forecasts of the oldest generation time are dropped first.  Each one is all the fields for one member and lead time, as float32.");
+    tt->val_offset = (char *) &gridHandoffMaxEntries - &_start_;
+    tt->single_val.i = 0;
+    tt++;
+    
+    // Parameter 'Comment 3'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 3");
+    tt->comment_hdr = tdrpStrDup("INSTRUMENTATION");
+    tt->comment_text = tdrpStrDup("Per trigger timing of the processing phases (load, count, tile stats, SPDB read/write, MDV write), broken down by thread");
+    tt++;
+    
+    // Parameter 'instrumentation'
+    // ctype is 'Instrumentation_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = ENUM_TYPE;
+    tt->param_name = tdrpStrDup("instrumentation");
+    tt->descr = tdrpStrDup("Instrumentation output");
+    tt->help = tdrpStrDup("OFF for none. LOG to log summary lines after each trigger. JSON to also write a JSON file to instrumentationJsonDir after each trigger.");
+    tt->val_offset = (char *) &instrumentation - &_start_;
+    tt->enum_def.name = tdrpStrDup("Instrumentation_t");
+    tt->enum_def.nfields = 3;
+    tt->enum_def.fields = (enum_field_t *)
+        tdrpMalloc(tt->enum_def.nfields * sizeof(enum_field_t));
+      tt->enum_def.fields[0].name = tdrpStrDup("INSTRUMENTATION_OFF");
+      tt->enum_def.fields[0].val = INSTRUMENTATION_OFF;
+      tt->enum_def.fields[1].name = tdrpStrDup("INSTRUMENTATION_LOG");
+      tt->enum_def.fields[1].val = INSTRUMENTATION_LOG;
+      tt->enum_def.fields[2].name = tdrpStrDup("INSTRUMENTATION_JSON");
+      tt->enum_def.fields[2].val = INSTRUMENTATION_JSON;
+    tt->single_val.e = INSTRUMENTATION_OFF;
+    tt++;
+    
+    // Parameter 'instrumentationJsonDir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("instrumentationJsonDir");
+    tt->descr = tdrpStrDup("Directory for JSON instrumentation output");
+    tt->help = tdrpStrDup("Used when instrumentation = INSTRUMENTATION_JSON, one file per trigger named yyyymmdd_hhmmss_<trigger>.json");
+    tt->val_offset = (char *) &instrumentationJsonDir - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'Comment 4'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 4");
+    tt->comment_hdr = tdrpStrDup("MULTIPLE INSTANCES");
+    tt->comment_text = tdrpStrDup("Optionally serve more than one configuration from this process, sharing the member reads");
+    tt++;
+    
+    // Parameter 'instanceParamFiles'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("instanceParamFiles");
+    tt->descr = tdrpStrDup("Param files for more instances served by this process");
+    tt->help = tdrpStrDup("Each file is a complete EnsLookupGen param file, normally the main or -cloudtop params for the same or another model. Every (member, lead) input is read once and shared by all instances that use it, and each instance writes its own output. All instances must use the same extended projection and lead times. Triggering is on the union of the ensemble member URLs; process name, logging and threading come from this file. instanceParamFiles is ignored within the listed files. Empty to run just this one instance.");
+    tt->array_offset = (char *) &_instanceParamFiles - &_start_;
+    tt->array_n_offset = (char *) &instanceParamFiles_n - &_start_;
+    tt->is_array = TRUE;
+    tt->array_len_fixed = FALSE;
+    tt->array_elem_size = sizeof(char*);
+    tt->array_n = 0;
+    tt->array_vals = (tdrpVal_t *)
+        tdrpMalloc(tt->array_n * sizeof(tdrpVal_t));
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
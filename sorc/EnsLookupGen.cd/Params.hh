@@ -79,6 +79,12 @@ public:
     ENCODING_FLOAT32 = 5
   } encodingType_t;
 
+  typedef enum {
+    INSTRUMENTATION_OFF = 0,
+    INSTRUMENTATION_LOG = 1,
+    INSTRUMENTATION_JSON = 2
+  } Instrumentation_t;
+
   ///////////////////////////
   // Member functions
   //
@@ -408,6 +414,23 @@ public:
 
   int num_threads;
 
+  tdrp_bool_t gridHandoff;
+
+  char* gridHandoffUrl;
+
+  int gridHandoffNumSlots;
+
+  int gridHandoffBufSize;
+
+  int gridHandoffMaxEntries;
+
+  Instrumentation_t instrumentation;
+
+  char* instrumentationJsonDir;
+
+  char* *_instanceParamFiles;
+  int instanceParamFiles_n;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -415,7 +438,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[22];
+  mutable TDRPtable _table[33];
 
   const char *_className;
 
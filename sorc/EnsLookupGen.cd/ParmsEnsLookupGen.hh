@@ -18,6 +18,7 @@
 #include <ConvWxIO/ParmFcstIO.hh>
 #include <ConvWx/ParmMain.hh>
 #include <ConvWx/Grid.hh>
+#include <ConvWx/Instrumentation.hh>
 
 #include <string>
 #include <vector>
@@ -166,6 +167,18 @@ public:
 		       * the weights are set to be 100% the actual ones */
   int _numThreads;  /**< Number of threads */
 
+  bool _gridHandoff;              /**< True to use grid handoff queue input */
+  std::string _gridHandoffUrl;    /**< Grid handoff queue location */
+  int _gridHandoffNumSlots;       /**< Grid handoff queue slots */
+  int _gridHandoffBufSize;        /**< Grid handoff queue buffer size */
+  int _gridHandoffMaxEntries;     /**< Handoff forecasts to keep in memory */
+
+  Instrumentation::Mode_t _instrumentation; /**< Per gen time timing output */
+  std::string _instrumentationJsonDir;      /**< Where JSON timing goes */
+
+  std::vector<std::string> _instanceParamFiles; /**< More instances to serve,
+						  empty for none */
+
 protected:
 private:
 
@@ -166,6 +166,32 @@ ParmsEnsLookupGenIO::ParmsEnsLookupGenIO(int argc,
   }    
   _maxNptInside = params.maximumNptInside;
   _numThreads = params.num_threads;
+
+  _gridHandoff = params.gridHandoff;
+  _gridHandoffUrl = params.gridHandoffUrl;
+  _gridHandoffNumSlots = params.gridHandoffNumSlots;
+  _gridHandoffBufSize = params.gridHandoffBufSize;
+  _gridHandoffMaxEntries = params.gridHandoffMaxEntries;
+
+  switch (params.instrumentation)
+  {
+  case Params::INSTRUMENTATION_LOG:
+    _instrumentation = Instrumentation::MODE_LOG;
+    break;
+  case Params::INSTRUMENTATION_JSON:
+    _instrumentation = Instrumentation::MODE_JSON;
+    break;
+  case Params::INSTRUMENTATION_OFF:
+  default:
+    _instrumentation = Instrumentation::MODE_OFF;
+    break;
+  }
+  _instrumentationJsonDir = params.instrumentationJsonDir;
+
+  for (int i=0; i<params.instanceParamFiles_n; ++i)
+  {
+    _instanceParamFiles.push_back(params._instanceParamFiles[i]);
+  }
 }
 
 //-----------------------------------------------------------------
@@ -0,0 +1,107 @@
+/**
+ * @file BenchTimer.cc
+ */
+
+#include "BenchTimer.hh"
+#include <toolsa/TaXml.hh>
+#include <toolsa/LogStream.hh>
+#include <cstdio>
+
+//----------------------------------------------------------------------
+BenchTimer::BenchTimer(const std::string &name, double items) :
+  _name(name),
+  _items(items),
+  _n(0),
+  _total(0.0),
+  _min(0.0),
+  _max(0.0),
+  _ok(true),
+  _error("")
+{
+  _t0.tv_sec = 0;
+  _t0.tv_usec = 0;
+}
+
+//----------------------------------------------------------------------
+BenchTimer::~BenchTimer(void)
+{
+}
+
+//----------------------------------------------------------------------
+void BenchTimer::start(void)
+{
+  gettimeofday(&_t0, NULL);
+}
+
+//----------------------------------------------------------------------
+void BenchTimer::stop(void)
+{
+  struct timeval t1;
+  gettimeofday(&t1, NULL);
+  double dt = (double)(t1.tv_sec - _t0.tv_sec) +
+    (double)(t1.tv_usec - _t0.tv_usec)*1.0e-6;
+  if (_n == 0 || dt < _min)
+  {
+    _min = dt;
+  }
+  if (_n == 0 || dt > _max)
+  {
+    _max = dt;
+  }
+  _total += dt;
+  ++_n;
+}
+
+//----------------------------------------------------------------------
+void BenchTimer::fail(const std::string &why)
+{
+  _ok = false;
+  _error = why;
+  LOG(ERROR) << _name << ": " << why;
+}
+
+//----------------------------------------------------------------------
+std::string BenchTimer::toXml(int level) const
+{
+  std::string s = TaXml::writeStartTag("kernel", level);
+  s += TaXml::writeString("name", level+1, _name);
+  s += TaXml::writeBoolean("ok", level+1, _ok);
+  if (!_ok)
+  {
+    s += TaXml::writeString("error", level+1, _error);
+  }
+  s += TaXml::writeInt("iterations", level+1, _n);
+  s += TaXml::writeDouble("totalSeconds", level+1, _total, "%.6f");
+  if (_n > 0)
+  {
+    double mean = _total/(double)_n;
+    s += TaXml::writeDouble("meanSeconds", level+1, mean, "%.6f");
+    s += TaXml::writeDouble("minSeconds", level+1, _min, "%.6f");
+    s += TaXml::writeDouble("maxSeconds", level+1, _max, "%.6f");
+    if (_items > 0.0)
+    {
+      s += TaXml::writeDouble("itemsPerIteration", level+1, _items, "%.0f");
+      if (mean > 0.0)
+      {
+	s += TaXml::writeDouble("itemsPerSecond", level+1, _items/mean,
+				"%.1f");
+      }
+    }
+  }
+  s += TaXml::writeEndTag("kernel", level);
+  return s;
+}
+
+//----------------------------------------------------------------------
+void BenchTimer::log(void) const
+{
+  if (_n == 0)
+  {
+    LOG(DEBUG) << _name << ": not run";
+    return;
+  }
+  char buf[1000];
+  sprintf(buf, "%-40s n=%3d mean=%10.6f min=%10.6f max=%10.6f",
+	  _name.c_str(), _n, _total/(double)_n, _min, _max);
+  LOG(PRINT) << buf;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file BenchTimer.hh
+ * @brief Timing of one benchmark kernel over a number of iterations
+ * @class BenchTimer
+ * @brief Timing of one benchmark kernel over a number of iterations
+ *
+ * Call start() and stop() around each iteration. The XML written by
+ * toXml() has the kernel name, iteration count, and total, mean, min and
+ * max wall clock seconds, plus an optional count of items processed per
+ * iteration (grid points, chunks, records) for throughput comparisons.
+ */
+
+#ifndef BENCH_TIMER_HH
+#define BENCH_TIMER_HH
+
+#include <string>
+#include <sys/time.h>
+
+class BenchTimer
+{
+public:
+
+  /**
+   * @param[in] name  Kernel name, as it will appear in the report
+   * @param[in] items  Items processed per iteration, 0 if not meaningful
+   */
+  BenchTimer(const std::string &name, double items=0.0);
+
+  /**
+   * Destructor
+   */
+  ~BenchTimer(void);
+
+  /**
+   * Start an iteration
+   */
+  void start(void);
+
+  /**
+   * Stop an iteration and accumulate its time
+   */
+  void stop(void);
+
+  /**
+   * Record a failure, the kernel is reported as not ok
+   * @param[in] why  Reason, goes into the report
+   */
+  void fail(const std::string &why);
+
+  /**
+   * @return true if no failure was recorded
+   */
+  inline bool isOk(void) const {return _ok;}
+
+  /**
+   * @return total seconds over all iterations
+   */
+  inline double total(void) const {return _total;}
+
+  /**
+   * @return XML for the report
+   * @param[in] level  Indentation level
+   */
+  std::string toXml(int level) const;
+
+  /**
+   * Log a one line summary
+   */
+  void log(void) const;
+
+protected:
+private:
+
+  std::string _name;  /**< Kernel name */
+  double _items;      /**< Items per iteration */
+  int _n;             /**< Number of iterations timed */
+  double _total;      /**< Total seconds */
+  double _min;        /**< Fastest iteration seconds */
+  double _max;        /**< Slowest iteration seconds */
+  bool _ok;           /**< False if a failure was recorded */
+  std::string _error; /**< Failure reason */
+  struct timeval _t0; /**< Start of the current iteration */
+};
+
+#endif
@@ -0,0 +1,736 @@
+/**
+ * @file EpochBenchMgr.cc
+ */
+
+#include "EpochBenchMgr.hh"
+#include <Epoch/TileInfo.hh>
+#include <Epoch/TileRange.hh>
+#include <ConvWxIO/InterfaceIO.hh>
+#include <ConvWx/MultiFcstGrid.hh>
+#include <ConvWx/MetaData.hh>
+#include <ConvWx/Grid.hh>
+#include <ConvWx/ConvWxTime.hh>
+#include <Mdv/Mdvx.hh>
+#include <Mdv/MdvxField.hh>
+#include <Spdb/DsSpdb.hh>
+#include <grib2/Grib2File.hh>
+#include <grib2/Grib2Record.hh>
+#include <grib2/DS.hh>
+#include <toolsa/TaXml.hh>
+#include <toolsa/DateTime.hh>
+#include <toolsa/LogStream.hh>
+#include <toolsa/file_io.h>
+#include <toolsa/Path.hh>
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <list>
+
+using std::string;
+using std::vector;
+using std::list;
+
+/**
+ * Number of gaussian blobs in each synthetic field
+ */
+static const int NUM_BLOBS = 40;
+
+/**
+ * The apps timed end to end, in the order they run operationally
+ */
+static const char *APPS[] = {"ObarCompute", "PbarCompute",
+			     "ThreshFromObarPbar", "EnsLookupGen"};
+
+/**
+ * The environment variables the production GEFS param files take their
+ * SPDB and output locations from, each set to work_dir/spdb/<name> for
+ * the end to end runs
+ */
+static const char *APP_ENV[] = {"OBAR_CMORPH", "OBAR_CTH", "PBAR_GEFS",
+				"THRESH_APCP_GEFS", "THRESH_ULWRF_GEFS",
+				"THRESH_HIST_APCP_GEFS",
+				"THRESH_HIST_ULWRF_GEFS",
+				"EPOCH_GEFS_PROB_OPT"};
+
+//----------------------------------------------------------------------
+/**
+ * Small deterministic random number generator (64 bit LCG), so the
+ * synthetic data does not depend on the system rand()
+ */
+class BenchRandom
+{
+public:
+  inline BenchRandom(unsigned long long seed) :
+    _state(seed*2862933555777941757ULL + 3037000493ULL) {}
+  /**
+   * @return uniform value in [0,1)
+   */
+  inline double next(void)
+  {
+    _state = _state*6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(_state >> 11)/9007199254740992.0;
+  }
+  /**
+   * @return uniform value in [v0,v1)
+   */
+  inline double next(double v0, double v1)
+  {
+    return v0 + (v1-v0)*next();
+  }
+private:
+  unsigned long long _state;
+};
+
+//----------------------------------------------------------------------
+EpochBenchMgr::EpochBenchMgr(const Params &params) :
+  _params(params)
+{
+  _proj = ParmProjection(ParmProjection::LATLON, _params.nx, _params.ny,
+			 _params.minx, _params.miny, _params.dx, _params.dy,
+			 -90.0, 0.0, -90.0, 0.0, 0.0, 0.0, 0.0, 6371.229);
+  _genTime = DateTime::parseDateTime(_params.gen_time);
+  if (_genTime == DateTime::NEVER)
+  {
+    LOG(ERROR) << "Bad gen_time " << _params.gen_time << ", using 0";
+    _genTime = 0;
+  }
+  for (int i=0; i<_params.num_leads; ++i)
+  {
+    _leadSeconds.push_back((_params.first_lead_hours +
+			    i*_params.lead_delta_hours)*3600);
+  }
+  char buf[100];
+  for (int i=0; i<_params.num_gefs_members; ++i)
+  {
+    sprintf(buf, "gefs/gep%02d", i+1);
+    _members.push_back(buf);
+  }
+  for (int i=0; i<_params.num_cmce_members; ++i)
+  {
+    sprintf(buf, "cmce/cmc%02d", i+1);
+    _members.push_back(buf);
+  }
+}
+
+//----------------------------------------------------------------------
+EpochBenchMgr::~EpochBenchMgr(void)
+{
+}
+
+//----------------------------------------------------------------------
+bool EpochBenchMgr::run(void)
+{
+  if (_members.empty() || _leadSeconds.empty())
+  {
+    LOG(ERROR) << "Need at least one member and one lead, have "
+	       << _members.size() << " members (num_gefs_members + "
+	       << "num_cmce_members) and " << _leadSeconds.size() << " leads";
+    return false;
+  }
+  if (ta_makedir_recurse(_params.work_dir))
+  {
+    LOG(ERROR) << "Cannot create " << _params.work_dir;
+    return false;
+  }
+  LOG(DEBUG) << _members.size() << " members, " << _leadSeconds.size()
+	     << " leads, grid " << _params.nx << "x" << _params.ny;
+
+  if ((_params.run_xml_kernels || _params.run_spdb_kernels) &&
+      !_loadThresholds())
+  {
+    return false;
+  }
+  if (_params.generate_inputs)
+  {
+    _generateInputs();
+  }
+  if (_params.run_grid_kernels)
+  {
+    _gridKernels();
+  }
+  if (_params.run_xml_kernels)
+  {
+    _xmlKernels();
+  }
+  if (_params.run_mdv_kernels)
+  {
+    _mdvKernels();
+  }
+  if (_params.run_spdb_kernels)
+  {
+    _spdbKernels();
+  }
+  if (strlen(_params.grib2_file) > 0)
+  {
+    _grib2Kernels();
+  }
+  if (strlen(_params.app_param_dir) > 0)
+  {
+    _runApps();
+  }
+
+  bool ok = true;
+  for (size_t i=0; i<_timers.size(); ++i)
+  {
+    _timers[i].log();
+    ok = ok && _timers[i].isOk();
+  }
+  return _writeReport() && ok;
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_generateInputs(void)
+{
+  BenchTimer t("generateInputs",
+	       (double)((_members.size() + 1)*_leadSeconds.size()));
+  MetaData md;
+  md.setName("EpochBench");
+  md.setSource("synthetic");
+  string top = _params.work_dir;
+  top += "/mdv/";
+  t.start();
+  for (size_t i=0; i<_members.size(); ++i)
+  {
+    string url = top + _members[i];
+    for (size_t j=0; j<_leadSeconds.size(); ++j)
+    {
+      MultiGrid g = _synthetic(i, j);
+      InterfaceIO::write(_genTime, _leadSeconds[j], url, _proj, g, md);
+    }
+    LOG(DEBUG_VERBOSE) << "Wrote " << url;
+  }
+
+  // observations at each valid time, drawn as one more member
+  string url = top + "obs";
+  int obsIndex = static_cast<int>(_members.size());
+  for (size_t j=0; j<_leadSeconds.size(); ++j)
+  {
+    Grid obs(*_synthetic(obsIndex, j).ithConstGrid(0), _params.obs_field,
+	     "mm hr-1");
+    MultiGrid g;
+    g.append(obs);
+    InterfaceIO::write(_genTime + _leadSeconds[j], url, _proj, g, md);
+  }
+  LOG(DEBUG_VERBOSE) << "Wrote " << url;
+  t.stop();
+  _timers.push_back(t);
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_gridKernels(void)
+{
+  // one lead of the first ensemble, as PbarCompute sees it
+  int nmember = _params.num_gefs_members;
+  if (nmember <= 0)
+  {
+    nmember = static_cast<int>(_members.size());
+  }
+  vector<Grid> grids;
+  for (int i=0; i<nmember; ++i)
+  {
+    grids.push_back(*_synthetic(i, 0).ithConstGrid(0));
+  }
+
+  TileInfo tiles(_params.tile_npt, _params.tile_npt,
+		 _params.tile_overlap_npt, _params.tile_overlap_npt,
+		 false, 0, 0, 0, 0, _params.nx, _params.ny);
+  int ntiles = tiles.numTiles();
+
+  BenchTimer mean("GridData::meanSubset", (double)(ntiles*nmember));
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    double sum = 0.0;
+    mean.start();
+    for (int i=0; i<nmember; ++i)
+    {
+      for (int j=0; j<ntiles; ++j)
+      {
+	TileRange r = tiles.range(j);
+	double v;
+	bool outOfBounds;
+	if (grids[i].meanSubset(r.getX0(), r.getY0(), r.getNx(), r.getNy(),
+				true, false, v, outOfBounds))
+	{
+	  sum += v;
+	}
+      }
+    }
+    mean.stop();
+    LOG(DEBUG_VERBOSE) << "meanSubset sum " << sum;
+  }
+  _timers.push_back(mean);
+
+  BenchTimer smooth("GridData::smooth",
+		    (double)(_params.nx*_params.ny));
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    Grid g(grids[it % nmember]);
+    smooth.start();
+    g.smooth(_params.smooth_npt, _params.smooth_npt);
+    smooth.stop();
+  }
+  _timers.push_back(smooth);
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_xmlKernels(void)
+{
+  TileInfo tiles(_params.tile_npt, _params.tile_npt,
+		 _params.tile_overlap_npt, _params.tile_overlap_npt,
+		 false, 0, 0, 0, 0, _params.nx, _params.ny);
+  int ntiles = tiles.numTiles();
+
+  BenchTimer tw("TileInfo::toXml", (double)ntiles);
+  BenchTimer tr("TileInfo(xml)", (double)ntiles);
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    tw.start();
+    string xml = tiles.toXml();
+    tw.stop();
+    tr.start();
+    TileInfo t2(xml);
+    tr.stop();
+    if (!(t2 == tiles))
+    {
+      tr.fail("TileInfo does not survive the XML round trip");
+    }
+  }
+  _timers.push_back(tw);
+  _timers.push_back(tr);
+
+  // threshold database style content, one entry per tile and lead
+  const vector<double> &thresh1 = _thresh1;
+  const vector<double> &thresh2 = _thresh2;
+  int nentry = ntiles*static_cast<int>(_leadSeconds.size());
+  BenchTimer xw("TaXml write thresholds", (double)nentry);
+  BenchTimer xr("TaXml parse thresholds", (double)nentry);
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    xw.start();
+    string xml;
+    for (size_t j=0; j<_leadSeconds.size(); ++j)
+    {
+      for (int i=0; i<ntiles; ++i)
+      {
+	xml += TaXml::writeStartTag("Tile", 0);
+	xml += TaXml::writeInt("Index", 1, i);
+	xml += TaXml::writeInt("Lead", 1, _leadSeconds[j]);
+	xml += TaXml::writeDouble("Thresh1", 1,
+				  thresh1[(i+j) % thresh1.size()]);
+	xml += TaXml::writeDouble("Thresh2", 1,
+				  thresh2[(i+j) % thresh2.size()]);
+	xml += TaXml::writeEndTag("Tile", 0);
+      }
+    }
+    xw.stop();
+
+    xr.start();
+    vector<string> tags;
+    int nok = 0;
+    if (TaXml::readTagBufArray(xml, "Tile", tags) == 0)
+    {
+      for (size_t k=0; k<tags.size(); ++k)
+      {
+	int index, lead;
+	double t1, t2;
+	if (TaXml::readInt(tags[k], "Index", index) == 0 &&
+	    TaXml::readInt(tags[k], "Lead", lead) == 0 &&
+	    TaXml::readDouble(tags[k], "Thresh1", t1) == 0 &&
+	    TaXml::readDouble(tags[k], "Thresh2", t2) == 0)
+	{
+	  ++nok;
+	}
+      }
+    }
+    xr.stop();
+    if (nok != nentry)
+    {
+      xr.fail("Parsed the wrong number of threshold entries");
+    }
+  }
+  _timers.push_back(xw);
+  _timers.push_back(xr);
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_mdvKernels(void)
+{
+  MultiGrid g = _synthetic(0, 0);
+  const Grid *precip = g.ithConstGrid(0);
+  int npt = _params.nx*_params.ny;
+
+  Mdvx::field_header_t fhdr;
+  memset(&fhdr, 0, sizeof(fhdr));
+  fhdr.nx = _params.nx;
+  fhdr.ny = _params.ny;
+  fhdr.nz = 1;
+  fhdr.grid_dx = _params.dx;
+  fhdr.grid_dy = _params.dy;
+  fhdr.grid_minx = _params.minx;
+  fhdr.grid_miny = _params.miny;
+  fhdr.proj_type = Mdvx::PROJ_LATLON;
+  fhdr.encoding_type = Mdvx::ENCODING_FLOAT32;
+  fhdr.data_element_nbytes = 4;
+  fhdr.volume_size = npt*4;
+  fhdr.compression_type = Mdvx::COMPRESSION_NONE;
+  fhdr.scaling_type = Mdvx::SCALING_NONE;
+  fhdr.scale = 1.0;
+  fhdr.bias = 0.0;
+  fhdr.missing_data_value = precip->getMissing();
+  fhdr.bad_data_value = precip->getMissing();
+  Mdvx::vlevel_header_t vhdr;
+  memset(&vhdr, 0, sizeof(vhdr));
+  vector<fl32> data(npt);
+  precip->copyFloatFilterNans(&data[0], precip->getName(), npt);
+  MdvxField field(fhdr, vhdr, &data[0]);
+
+  BenchTimer enc("MdvxField::convertType INT8 gzip", (double)npt);
+  BenchTimer dec("MdvxField::convertType FLOAT32", (double)npt);
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    MdvxField f(field);
+    enc.start();
+    int stat = f.convertType(Mdvx::ENCODING_INT8, Mdvx::COMPRESSION_GZIP);
+    enc.stop();
+    if (stat)
+    {
+      enc.fail(f.getErrStr());
+      break;
+    }
+    dec.start();
+    stat = f.convertType(Mdvx::ENCODING_FLOAT32, Mdvx::COMPRESSION_NONE);
+    dec.stop();
+    if (stat)
+    {
+      dec.fail(f.getErrStr());
+      break;
+    }
+  }
+  _timers.push_back(enc);
+  _timers.push_back(dec);
+
+  // one forecast file, the way every app writes and reads them
+  string url = _params.work_dir;
+  url += "/mdv/kernel";
+  vector<string> names;
+  for (int i=0; i<g.num(); ++i)
+  {
+    names.push_back(g.ithConstGrid(i)->getName());
+  }
+  MetaData md;
+  BenchTimer w("InterfaceIO::write", (double)(npt*g.num()));
+  BenchTimer r("InterfaceIO::loadMultiFcst", (double)(npt*g.num()));
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    w.start();
+    InterfaceIO::write(_genTime, _leadSeconds[0], url, _proj, g, md);
+    w.stop();
+    MultiFcstGrid in;
+    r.start();
+    bool ok = InterfaceIO::loadMultiFcst(_genTime, _leadSeconds[0], _proj,
+					 url, names, false, in);
+    r.stop();
+    if (!ok)
+    {
+      r.fail("Cannot read back " + url);
+      break;
+    }
+  }
+  _timers.push_back(w);
+  _timers.push_back(r);
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_spdbKernels(void)
+{
+  TileInfo tiles(_params.tile_npt, _params.tile_npt,
+		 _params.tile_overlap_npt, _params.tile_overlap_npt,
+		 false, 0, 0, 0, 0, _params.nx, _params.ny);
+  int ntiles = tiles.numTiles();
+  const vector<double> &thresh1 = _thresh1;
+  string url = _params.work_dir;
+  url += "/spdb/kernel";
+  int nchunk = ntiles*static_cast<int>(_leadSeconds.size());
+
+  BenchTimer p("DsSpdb::put", (double)nchunk);
+  BenchTimer g("DsSpdb::getInterval", (double)nchunk);
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    DsSpdb s;
+    p.start();
+    for (size_t j=0; j<_leadSeconds.size(); ++j)
+    {
+      time_t vt = _genTime + _leadSeconds[j];
+      for (int i=0; i<ntiles; ++i)
+      {
+	string xml = TaXml::writeInt("Tile", 0, i);
+	for (size_t k=0; k<thresh1.size(); ++k)
+	{
+	  xml += TaXml::writeDouble("Thresh", 0, thresh1[k]);
+	}
+	if (s.put(url, SPDB_XML_ID, SPDB_XML_LABEL, i+1, vt, vt,
+		  static_cast<int>(xml.size())+1, xml.c_str()))
+	{
+	  p.fail(s.getErrStr());
+	  break;
+	}
+      }
+    }
+    p.stop();
+    if (!p.isOk())
+    {
+      break;
+    }
+
+    g.start();
+    int stat = s.getInterval(url, _genTime,
+			     _genTime + _leadSeconds[_leadSeconds.size()-1]);
+    g.stop();
+    if (stat || s.getNChunks() != nchunk)
+    {
+      g.fail("Did not get back what was put");
+      break;
+    }
+  }
+  _timers.push_back(p);
+  _timers.push_back(g);
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_grib2Kernels(void)
+{
+  BenchTimer r("Grib2File::read");
+  BenchTimer u("DS::getData");
+  for (int it=0; it<_params.num_iterations; ++it)
+  {
+    Grib2::Grib2File f;
+    r.start();
+    int stat = f.read(_params.grib2_file);
+    r.stop();
+    if (stat != Grib2::GRIB_SUCCESS)
+    {
+      r.fail(string("Cannot read ") + _params.grib2_file);
+      break;
+    }
+    int nrec = 0;
+    u.start();
+    list<string> fields = f.getFieldList();
+    for (list<string>::iterator i=fields.begin(); i!=fields.end(); ++i)
+    {
+      list<string> levels = f.getFieldLevels(*i);
+      for (list<string>::iterator j=levels.begin(); j!=levels.end(); ++j)
+      {
+	vector<Grib2::Grib2Record::Grib2Sections_t> recs = f.getRecords(*i, *j);
+	for (size_t k=0; k<recs.size(); ++k)
+	{
+	  if (recs[k].ds->getData() != NULL)
+	  {
+	    ++nrec;
+	  }
+	  recs[k].ds->freeData();
+	}
+      }
+    }
+    u.stop();
+    LOG(DEBUG_VERBOSE) << "Unpacked " << nrec << " records";
+  }
+  _timers.push_back(r);
+  _timers.push_back(u);
+}
+
+//----------------------------------------------------------------------
+void EpochBenchMgr::_runApps(void)
+{
+  // where the .bench param files find the synthetic data and write
+  string dir = _params.work_dir;
+  setenv("EPOCH_BENCH_DIR", dir.c_str(), 1);
+  int nenv = static_cast<int>(sizeof(APP_ENV)/sizeof(APP_ENV[0]));
+  for (int i=0; i<nenv; ++i)
+  {
+    string v = dir + "/spdb/" + APP_ENV[i];
+    setenv(APP_ENV[i], v.c_str(), 1);
+  }
+
+  // ARCHIVE mode over the generation time and all valid times
+  time_t t1 = _genTime;
+  if (!_leadSeconds.empty())
+  {
+    t1 += _leadSeconds[_leadSeconds.size()-1];
+  }
+  string interval = " -interval " + _yyyymmddhhmmss(_genTime) + " " +
+    _yyyymmddhhmmss(t1);
+
+  int napp = static_cast<int>(sizeof(APPS)/sizeof(APPS[0]));
+  for (int i=0; i<napp; ++i)
+  {
+    string path = _params.app_param_dir;
+    path += "/";
+    path += APPS[i];
+    path += ".bench";
+    struct stat sbuf;
+    if (stat(path.c_str(), &sbuf) != 0)
+    {
+      LOG(DEBUG) << "No " << path << ", not running " << APPS[i];
+      continue;
+    }
+    // relative param file names in the .bench files are in app_param_dir
+    string cmd = "cd ";
+    cmd += _params.app_param_dir;
+    cmd += " && ";
+    cmd += APPS[i];
+    cmd += " -params ";
+    cmd += APPS[i];
+    cmd += ".bench" + interval;
+    LOG(DEBUG) << "Running " << cmd;
+    BenchTimer t(APPS[i]);
+    t.start();
+    int stat = system(cmd.c_str());
+    t.stop();
+    if (stat != 0)
+    {
+      char buf[100];
+      sprintf(buf, "exit status %d", stat);
+      t.fail(buf);
+    }
+    _timers.push_back(t);
+  }
+}
+
+//----------------------------------------------------------------------
+bool EpochBenchMgr::_writeReport(void) const
+{
+  Path p(_params.report_path);
+  if (ta_makedir_recurse(p.getDirectory().c_str()))
+  {
+    LOG(ERROR) << "Cannot create directory for " << _params.report_path;
+    return false;
+  }
+  FILE *fp = fopen(_params.report_path, "w");
+  if (fp == NULL)
+  {
+    LOG(ERROR) << "Cannot write " << _params.report_path;
+    return false;
+  }
+  string s = TaXml::writeStartTag("EpochBench", 0);
+  s += TaXml::writeTime("runTime", 1, time(0));
+  s += TaXml::writeTime("genTime", 1, _genTime);
+  s += TaXml::writeInt("nx", 1, _params.nx);
+  s += TaXml::writeInt("ny", 1, _params.ny);
+  s += TaXml::writeInt("numMembers", 1, static_cast<int>(_members.size()));
+  s += TaXml::writeInt("numLeads", 1, static_cast<int>(_leadSeconds.size()));
+  s += TaXml::writeInt("iterations", 1, _params.num_iterations);
+  for (size_t i=0; i<_timers.size(); ++i)
+  {
+    s += _timers[i].toXml(1);
+  }
+  s += TaXml::writeEndTag("EpochBench", 0);
+  fputs(s.c_str(), fp);
+  fclose(fp);
+  LOG(DEBUG) << "Wrote " << _params.report_path;
+  return true;
+}
+
+//----------------------------------------------------------------------
+MultiGrid EpochBenchMgr::_synthetic(int memberIndex, int leadIndex) const
+{
+  int nx = _params.nx, ny = _params.ny;
+  vector<double> precip(nx*ny, 0.0);
+  BenchRandom rand(static_cast<unsigned long long>(memberIndex)*1000 +
+		   leadIndex + 1);
+  for (int b=0; b<NUM_BLOBS; ++b)
+  {
+    double cx = rand.next(0.0, (double)nx);
+    double cy = rand.next(0.0, (double)ny);
+    double r = rand.next(3.0, 15.0);
+    double amp = rand.next(2.0, 20.0);
+    int ir = static_cast<int>(3.0*r);
+    for (int y=static_cast<int>(cy)-ir; y<=static_cast<int>(cy)+ir; ++y)
+    {
+      if (y < 0 || y >= ny)
+      {
+	continue;
+      }
+      for (int xx=static_cast<int>(cx)-ir; xx<=static_cast<int>(cx)+ir; ++xx)
+      {
+	// longitude wraps
+	int x = (xx + nx) % nx;
+	double d2 = (xx-cx)*(xx-cx) + (y-cy)*(y-cy);
+	precip[y*nx + x] += amp*exp(-d2/(2.0*r*r));
+      }
+    }
+  }
+
+  double missing = -99.0;
+  Grid gp(_params.precip_field, "mm", nx, ny, missing);
+  Grid go(_params.olr_field, "W m-2", nx, ny, missing);
+  Grid gc(_params.cape_field, "J kg-1", nx, ny, missing);
+  for (int i=0; i<nx*ny; ++i)
+  {
+    double p = precip[i] < 0.01 ? 0.0 : precip[i];
+    double olr = 300.0 - 8.0*p;
+    if (olr < 150.0)
+    {
+      olr = 150.0;
+    }
+    gp.setv(i, p);
+    go.setv(i, olr);
+    gc.setv(i, 150.0*p);
+  }
+  gp.setEncoding(Grid::ENCODING_FLOAT32);
+  go.setEncoding(Grid::ENCODING_FLOAT32);
+  gc.setEncoding(Grid::ENCODING_FLOAT32);
+
+  MultiGrid ret;
+  ret.append(gp);
+  ret.append(go);
+  ret.append(gc);
+  return ret;
+}
+
+//----------------------------------------------------------------------
+bool EpochBenchMgr::_loadThresholds(void)
+{
+  // the threshold params are named as in PbarCompute, so its param file
+  // loads as one of ours, everything else in it being ignored
+  Params p;
+  TDRP_warn_if_extra_params(FALSE);
+  int stat = p.load(_params.thresh_param_file, NULL, FALSE, FALSE);
+  TDRP_warn_if_extra_params(TRUE);
+  if (stat)
+  {
+    LOG(ERROR) << "Cannot read thresholds from " << _params.thresh_param_file;
+    return false;
+  }
+  _thresh1 = _thresholdList(p.threshMin1, p.threshMax1, p.threshDelta1);
+  _thresh2 = _thresholdList(p.threshMin2, p.threshMax2, p.threshDelta2);
+  LOG(DEBUG) << _thresh1.size() << " precip and " << _thresh2.size()
+	     << " OLR thresholds from " << _params.thresh_param_file;
+  return true;
+}
+
+//----------------------------------------------------------------------
+vector<double> EpochBenchMgr::_thresholdList(double t0, double t1, double dt)
+{
+  vector<double> ret;
+  for (double t=t0; t<=t1 && dt > 0.0; t+=dt)
+  {
+    ret.push_back(t);
+  }
+  if (ret.empty())
+  {
+    ret.push_back(t0);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------------
+string EpochBenchMgr::_yyyymmddhhmmss(time_t t)
+{
+  DateTime d(t);
+  char buf[32];
+  sprintf(buf, "%.4d%.2d%.2d%.2d%.2d%.2d", d.getYear(), d.getMonth(),
+	  d.getDay(), d.getHour(), d.getMin(), d.getSec());
+  return buf;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file EpochBenchMgr.hh
+ * @brief Generates synthetic ensemble data and times EPOCH kernels and apps
+ * @class EpochBenchMgr
+ * @brief Generates synthetic ensemble data and times EPOCH kernels and apps
+ *
+ * The synthetic forecasts are precip, OLR and CAPE fields built from
+ * random gaussian blobs, seeded by member and lead so every run sees the
+ * same data. Each enabled kernel group is timed num_iterations times and
+ * all results go into one XML report.
+ */
+
+#ifndef EPOCH_BENCH_MGR_HH
+#define EPOCH_BENCH_MGR_HH
+
+#include "Params.hh"
+#include "BenchTimer.hh"
+#include <ConvWx/ParmProjection.hh>
+#include <ConvWx/MultiGrid.hh>
+#include <string>
+#include <vector>
+
+class EpochBenchMgr
+{
+public:
+
+  /**
+   * Constructor
+   * @param[in] params  The parameters
+   */
+  EpochBenchMgr(const Params &params);
+
+  /**
+   * Destructor
+   */
+  ~EpochBenchMgr(void);
+
+  /**
+   * Run everything that is enabled and write the report
+   * @return true if the report was written and nothing failed
+   */
+  bool run(void);
+
+protected:
+private:
+
+  Params _params;                 /**< Parameters */
+  ParmProjection _proj;           /**< Synthetic grid projection */
+  time_t _genTime;                /**< Synthetic generation time */
+  std::vector<int> _leadSeconds;  /**< Synthetic lead times */
+  std::vector<std::string> _members; /**< <ensemble>/<member> names */
+  std::vector<BenchTimer> _timers;   /**< Results, in the order run */
+  std::vector<double> _thresh1;   /**< Production precip thresholds */
+  std::vector<double> _thresh2;   /**< Production OLR thresholds */
+
+  /**
+   * Read the production threshold lists from thresh_param_file
+   * @return true for success
+   */
+  bool _loadThresholds(void);
+
+  /**
+   * Write all members and leads, and the observations at each valid time,
+   * as MDV under work_dir/mdv
+   */
+  void _generateInputs(void);
+
+  /**
+   * Time GridData::meanSubset over all tiles and GridData::smooth
+   */
+  void _gridKernels(void);
+
+  /**
+   * Time TaXml writing and parsing of tiling and threshold XML
+   */
+  void _xmlKernels(void);
+
+  /**
+   * Time MdvxField convertType and MDV write/read through InterfaceIO
+   */
+  void _mdvKernels(void);
+
+  /**
+   * Time SPDB put and get of per tile, per lead chunks
+   */
+  void _spdbKernels(void);
+
+  /**
+   * Time GRIB2 read and unpack of every record in grib2_file
+   */
+  void _grib2Kernels(void);
+
+  /**
+   * Run and time each app that has a param file in app_param_dir
+   */
+  void _runApps(void);
+
+  /**
+   * Write the XML report
+   * @return true for success
+   */
+  bool _writeReport(void) const;
+
+  /**
+   * @return the synthetic precip, OLR and CAPE grids for a member and lead
+   * @param[in] memberIndex  Index into _members
+   * @param[in] leadIndex  Index into _leadSeconds
+   */
+  MultiGrid _synthetic(int memberIndex, int leadIndex) const;
+
+  /**
+   * @return thresholds from t0 to t1 in steps of dt, as PbarCompute has them
+   * @param[in] t0  Minimum
+   * @param[in] t1  Maximum
+   * @param[in] dt  Spacing
+   */
+  static std::vector<double> _thresholdList(double t0, double t1, double dt);
+
+  /**
+   * @return a time as yyyymmddhhmmss, for the -interval command line arg
+   * @param[in] t  The time
+   */
+  static std::string _yyyymmddhhmmss(time_t t);
+};
+
+#endif
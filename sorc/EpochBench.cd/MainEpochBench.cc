@@ -0,0 +1,100 @@
+ 
+/**
+ * @mainpage EpochBench
+ *
+ * This application generates deterministic synthetic ensemble forecasts on
+ * the production grid and times the EPOCH kernels that dominate run time
+ * (tile means, smoothing, threshold XML, MDV encode/decode and I/O, SPDB
+ * put/get, optionally GRIB2 unpack and whole apps), writing an XML report
+ * that can be compared from one build to the next.
+ */
+
+/**
+ * @file MainEpochBench.cc
+ */
+
+#include "EpochBenchMgr.hh"
+#include "Params.hh"
+#include <toolsa/LogStream.hh>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * Return value of program to indicate success
+ */
+const static int success = 0;
+
+/**
+ *  Return value of program to indicate failure
+ */
+const static int failure = 1;
+
+/**
+ * Exit program, return signal to operating system
+ * @param[in] sig  Signal
+ */
+static void cleanExit (int sig);
+
+/**
+ * New handler function
+ */
+static void outOfStore(void);
+
+/**
+ * Mgr
+ */
+static EpochBenchMgr *_mgr = NULL;
+
+/**
+ * Create the manager and run the benchmarks
+ * @param[in] argc  Number of command line arguments
+ * @param[in] argv  Typical command line is 'EpochBench -params EpochBench.params'
+ *
+ * @return integer status
+ */
+
+int main(int argc, char **argv)
+{
+  // set new() memory failure handler function
+  std::set_new_handler(outOfStore);
+
+  // Read in parameters
+  Params params;
+  char *path;
+  if (params.loadFromArgs(argc, argv, NULL, &path))
+  {
+    std::cerr << "ERROR - EpochBench, problem with params" << std::endl;
+    exit(failure);
+  }
+  LOG_STREAM_INIT(params.debug, params.debug_verbose, true, true);
+
+  _mgr = new EpochBenchMgr(params);
+  int iret;
+  if (_mgr->run())
+  {
+    iret = success;
+  }
+  else
+  {
+    iret = failure;
+  }
+  cleanExit(iret);
+  return iret;
+}
+
+static void cleanExit (int sig)
+{
+  if (_mgr != NULL)
+  {
+    delete _mgr;
+    _mgr = NULL;
+  }
+  exit(sig);
+}
+
+static void outOfStore()
+{
+  std::cerr << "FATAL ERROR - program EpochBench " << std::endl;
+  std::cerr << "Operator new failed - out of store" << std::endl;
+  exit(failure);
+}
@@ -0,0 +1,1037 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1992 - 2019
+// ** University Corporation for Atmospheric Research(UCAR)
+// ** National Center for Atmospheric Research(NCAR)
+// ** Boulder, Colorado, USA
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+////////////////////////////////////////////
+// Params.cc
+//
+// TDRP C++ code file for class 'Params'.
+//
+// Code for program EpochBench
+//
+// This file has been automatically
+// generated by TDRP, do not modify.
+//
+/////////////////////////////////////////////
+
+/**
+ *
+ * @file Params.cc
+ *
+ * @class Params
+ *
+ * This class is automatically generated by the Table
+ * Driven Runtime Parameters (TDRP) system
+ *
+ * @note Source is automatically generated from
+ *       paramdef file at compile time, do not modify
+ *       since modifications will be overwritten.
+ *
+ *
+ * @author Automatically generated
+ *
+ */
+using namespace std;
+
+#include "Params.hh"
+#include <cstring>
+
+  ////////////////////////////////////////////
+  // Default constructor
+  //
+
+  Params::Params()
+
+  {
+
+    // zero out table
+
+    memset(_table, 0, sizeof(_table));
+
+    // zero out members
+
+    memset(&_start_, 0, &_end_ - &_start_);
+
+    // class name
+
+    _className = "Params";
+
+    // initialize table
+
+    _init();
+
+    // set members
+
+    tdrpTable2User(_table, &_start_);
+
+    _exitDeferred = false;
+
+  }
+
+  ////////////////////////////////////////////
+  // Copy constructor
+  //
+
+  Params::Params(const Params& source)
+
+  {
+
+    // sync the source object
+
+    source.sync();
+
+    // zero out table
+
+    memset(_table, 0, sizeof(_table));
+
+    // zero out members
+
+    memset(&_start_, 0, &_end_ - &_start_);
+
+    // class name
+
+    _className = "Params";
+
+    // copy table
+
+    tdrpCopyTable((TDRPtable *) source._table, _table);
+
+    // set members
+
+    tdrpTable2User(_table, &_start_);
+
+    _exitDeferred = false;
+
+  }
+
+  ////////////////////////////////////////////
+  // Destructor
+  //
+
+  Params::~Params()
+
+  {
+
+    // free up
+
+    freeAll();
+
+  }
+
+  ////////////////////////////////////////////
+  // Assignment
+  //
+
+  void Params::operator=(const Params& other)
+
+  {
+
+    // sync the other object
+
+    other.sync();
+
+    // free up any existing memory
+
+    freeAll();
+
+    // zero out table
+
+    memset(_table, 0, sizeof(_table));
+
+    // zero out members
+
+    memset(&_start_, 0, &_end_ - &_start_);
+
+    // copy table
+
+    tdrpCopyTable((TDRPtable *) other._table, _table);
+
+    // set members
+
+    tdrpTable2User(_table, &_start_);
+
+    _exitDeferred = other._exitDeferred;
+
+  }
+
+  ////////////////////////////////////////////
+  // loadFromArgs()
+  //
+  // Loads up TDRP using the command line args.
+  //
+  // Check usage() for command line actions associated with
+  // this function.
+  //
+  //   argc, argv: command line args
+  //
+  //   char **override_list: A null-terminated list of overrides
+  //     to the parameter file.
+  //     An override string has exactly the format of an entry
+  //     in the parameter file itself.
+  //
+  //   char **params_path_p:
+  //     If this is non-NULL, it is set to point to the path
+  //     of the params file used.
+  //
+  //   bool defer_exit: normally, if the command args contain a 
+  //      print or check request, this function will call exit().
+  //      If defer_exit is set, such an exit is deferred and the
+  //      private member _exitDeferred is set.
+  //      Use exidDeferred() to test this flag.
+  //
+  //  Returns 0 on success, -1 on failure.
+  //
+
+  int Params::loadFromArgs(int argc, char **argv,
+                           char **override_list,
+                           char **params_path_p,
+                           bool defer_exit)
+  {
+    int exit_deferred;
+    if (_tdrpLoadFromArgs(argc, argv,
+                          _table, &_start_,
+                          override_list, params_path_p,
+                          _className,
+                          defer_exit, &exit_deferred)) {
+      return (-1);
+    } else {
+      if (exit_deferred) {
+        _exitDeferred = true;
+      }
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // loadApplyArgs()
+  //
+  // Loads up TDRP using the params path passed in, and applies
+  // the command line args for printing and checking.
+  //
+  // Check usage() for command line actions associated with
+  // this function.
+  //
+  //   const char *param_file_path: the parameter file to be read in
+  //
+  //   argc, argv: command line args
+  //
+  //   char **override_list: A null-terminated list of overrides
+  //     to the parameter file.
+  //     An override string has exactly the format of an entry
+  //     in the parameter file itself.
+  //
+  //   bool defer_exit: normally, if the command args contain a 
+  //      print or check request, this function will call exit().
+  //      If defer_exit is set, such an exit is deferred and the
+  //      private member _exitDeferred is set.
+  //      Use exidDeferred() to test this flag.
+  //
+  //  Returns 0 on success, -1 on failure.
+  //
+
+  int Params::loadApplyArgs(const char *params_path,
+                            int argc, char **argv,
+                            char **override_list,
+                            bool defer_exit)
+  {
+    int exit_deferred;
+    if (tdrpLoadApplyArgs(params_path, argc, argv,
+                          _table, &_start_,
+                          override_list,
+                          _className,
+                          defer_exit, &exit_deferred)) {
+      return (-1);
+    } else {
+      if (exit_deferred) {
+        _exitDeferred = true;
+      }
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // isArgValid()
+  // 
+  // Check if a command line arg is a valid TDRP arg.
+  //
+
+  bool Params::isArgValid(const char *arg)
+  {
+    return (tdrpIsArgValid(arg));
+  }
+
+  ////////////////////////////////////////////
+  // load()
+  //
+  // Loads up TDRP for a given class.
+  //
+  // This version of load gives the programmer the option to load
+  // up more than one class for a single application. It is a
+  // lower-level routine than loadFromArgs, and hence more
+  // flexible, but the programmer must do more work.
+  //
+  //   const char *param_file_path: the parameter file to be read in.
+  //
+  //   char **override_list: A null-terminated list of overrides
+  //     to the parameter file.
+  //     An override string has exactly the format of an entry
+  //     in the parameter file itself.
+  //
+  //   expand_env: flag to control environment variable
+  //               expansion during tokenization.
+  //               If TRUE, environment expansion is set on.
+  //               If FALSE, environment expansion is set off.
+  //
+  //  Returns 0 on success, -1 on failure.
+  //
+
+  int Params::load(const char *param_file_path,
+                   char **override_list,
+                   int expand_env, int debug)
+  {
+    if (tdrpLoad(param_file_path,
+                 _table, &_start_,
+                 override_list,
+                 expand_env, debug)) {
+      return (-1);
+    } else {
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // loadFromBuf()
+  //
+  // Loads up TDRP for a given class.
+  //
+  // This version of load gives the programmer the option to
+  // load up more than one module for a single application,
+  // using buffers which have been read from a specified source.
+  //
+  //   const char *param_source_str: a string which describes the
+  //     source of the parameter information. It is used for
+  //     error reporting only.
+  //
+  //   char **override_list: A null-terminated list of overrides
+  //     to the parameter file.
+  //     An override string has exactly the format of an entry
+  //     in the parameter file itself.
+  //
+  //   const char *inbuf: the input buffer
+  //
+  //   int inlen: length of the input buffer
+  //
+  //   int start_line_num: the line number in the source which
+  //     corresponds to the start of the buffer.
+  //
+  //   expand_env: flag to control environment variable
+  //               expansion during tokenization.
+  //               If TRUE, environment expansion is set on.
+  //               If FALSE, environment expansion is set off.
+  //
+  //  Returns 0 on success, -1 on failure.
+  //
+
+  int Params::loadFromBuf(const char *param_source_str,
+                          char **override_list,
+                          const char *inbuf, int inlen,
+                          int start_line_num,
+                          int expand_env, int debug)
+  {
+    if (tdrpLoadFromBuf(param_source_str,
+                        _table, &_start_,
+                        override_list,
+                        inbuf, inlen, start_line_num,
+                        expand_env, debug)) {
+      return (-1);
+    } else {
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // loadDefaults()
+  //
+  // Loads up default params for a given class.
+  //
+  // See load() for more detailed info.
+  //
+  //  Returns 0 on success, -1 on failure.
+  //
+
+  int Params::loadDefaults(int expand_env)
+  {
+    if (tdrpLoad(NULL,
+                 _table, &_start_,
+                 NULL, expand_env, FALSE)) {
+      return (-1);
+    } else {
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // sync()
+  //
+  // Syncs the user struct data back into the parameter table,
+  // in preparation for printing.
+  //
+  // This function alters the table in a consistent manner.
+  // Therefore it can be regarded as const.
+  //
+
+  void Params::sync(void) const
+  {
+    tdrpUser2Table(_table, (char *) &_start_);
+  }
+
+  ////////////////////////////////////////////
+  // print()
+  // 
+  // Print params file
+  //
+  // The modes supported are:
+  //
+  //   PRINT_SHORT:   main comments only, no help or descriptions
+  //                  structs and arrays on a single line
+  //   PRINT_NORM:    short + descriptions and help
+  //   PRINT_LONG:    norm  + arrays and structs expanded
+  //   PRINT_VERBOSE: long  + private params included
+  //
+
+  void Params::print(FILE *out, tdrp_print_mode_t mode)
+  {
+    tdrpPrint(out, _table, _className, mode);
+  }
+
+  ////////////////////////////////////////////
+  // checkAllSet()
+  //
+  // Return TRUE if all set, FALSE if not.
+  //
+  // If out is non-NULL, prints out warning messages for those
+  // parameters which are not set.
+  //
+
+  int Params::checkAllSet(FILE *out)
+  {
+    return (tdrpCheckAllSet(out, _table, &_start_));
+  }
+
+  //////////////////////////////////////////////////////////////
+  // checkIsSet()
+  //
+  // Return TRUE if parameter is set, FALSE if not.
+  //
+  //
+
+  int Params::checkIsSet(const char *paramName)
+  {
+    return (tdrpCheckIsSet(paramName, _table, &_start_));
+  }
+
+  ////////////////////////////////////////////
+  // freeAll()
+  //
+  // Frees up all TDRP dynamic memory.
+  //
+
+  void Params::freeAll(void)
+  {
+    tdrpFreeAll(_table, &_start_);
+  }
+
+  ////////////////////////////////////////////
+  // usage()
+  //
+  // Prints out usage message for TDRP args as passed
+  // in to loadFromArgs().
+  //
+
+  void Params::usage(ostream &out)
+  {
+    out << "TDRP args: [options as below]\n"
+        << "   [ -params/--params path ] specify params file path\n"
+        << "   [ -check_params/--check_params] check which params are not set\n"
+        << "   [ -print_params/--print_params [mode]] print parameters\n"
+        << "     using following modes, default mode is 'norm'\n"
+        << "       short:   main comments only, no help or descr\n"
+        << "                structs and arrays on a single line\n"
+        << "       norm:    short + descriptions and help\n"
+        << "       long:    norm  + arrays and structs expanded\n"
+        << "       verbose: long  + private params included\n"
+        << "       short_expand:   short with env vars expanded\n"
+        << "       norm_expand:    norm with env vars expanded\n"
+        << "       long_expand:    long with env vars expanded\n"
+        << "       verbose_expand: verbose with env vars expanded\n"
+        << "   [ -tdrp_debug] debugging prints for tdrp\n"
+        << "   [ -tdrp_usage] print this usage\n";
+  }
+
+  ////////////////////////////////////////////
+  // arrayRealloc()
+  //
+  // Realloc 1D array.
+  //
+  // If size is increased, the values from the last array 
+  // entry is copied into the new space.
+  //
+  // Returns 0 on success, -1 on error.
+  //
+
+  int Params::arrayRealloc(const char *param_name, int new_array_n)
+  {
+    if (tdrpArrayRealloc(_table, &_start_,
+                         param_name, new_array_n)) {
+      return (-1);
+    } else {
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // array2DRealloc()
+  //
+  // Realloc 2D array.
+  //
+  // If size is increased, the values from the last array 
+  // entry is copied into the new space.
+  //
+  // Returns 0 on success, -1 on error.
+  //
+
+  int Params::array2DRealloc(const char *param_name,
+                             int new_array_n1,
+                             int new_array_n2)
+  {
+    if (tdrpArray2DRealloc(_table, &_start_, param_name,
+                           new_array_n1, new_array_n2)) {
+      return (-1);
+    } else {
+      return (0);
+    }
+  }
+
+  ////////////////////////////////////////////
+  // _init()
+  //
+  // Class table initialization function.
+  //
+  //
+
+  void Params::_init()
+
+  {
+
+    TDRPtable *tt = _table;
+
+    // Parameter 'Comment 0'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 0");
+    tt->comment_hdr = tdrpStrDup("EpochBench generates synthetic inputs at the scale of the GEFS/CMCE ensembles and times the kernels and apps that process them. Results go to an XML report so that runs can be compared.");
+    tt->comment_text = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'debug'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("debug");
+    tt->descr = tdrpStrDup("Debug logging");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &debug - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'debug_verbose'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("debug_verbose");
+    tt->descr = tdrpStrDup("Verbose debug logging");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &debug_verbose - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'work_dir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("work_dir");
+    tt->descr = tdrpStrDup("Scratch directory for synthetic MDV and SPDB data");
+    tt->help = tdrpStrDup("Everything written by EpochBench goes under this directory");
+    tt->val_offset = (char *) &work_dir - &_start_;
+    tt->single_val.s = tdrpStrDup("/tmp/EpochBench");
+    tt++;
+    
+    // Parameter 'report_path'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("report_path");
+    tt->descr = tdrpStrDup("Path of the XML report");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &report_path - &_start_;
+    tt->single_val.s = tdrpStrDup("/tmp/EpochBench/EpochBench.xml");
+    tt++;
+    
+    // Parameter 'num_iterations'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("num_iterations");
+    tt->descr = tdrpStrDup("Number of times each kernel is timed");
+    tt->help = tdrpStrDup("The report has total, mean, min and max seconds over the iterations");
+    tt->val_offset = (char *) &num_iterations - &_start_;
+    tt->single_val.i = 5;
+    tt++;
+    
+    // Parameter 'Comment 1'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 1");
+    tt->comment_hdr = tdrpStrDup("SYNTHETIC GRID");
+    tt->comment_text = tdrpStrDup("Defaults are the extended 0.5 degree EPOCH domain (projection_0.5deg_extend.params) and tiling (Tiling_20deg_10overlap_0.5deg.params)");
+    tt++;
+    
+    // Parameter 'nx'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("nx");
+    tt->descr = tdrpStrDup("Grid points in x");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &nx - &_start_;
+    tt->single_val.i = 720;
+    tt++;
+    
+    // Parameter 'ny'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("ny");
+    tt->descr = tdrpStrDup("Grid points in y");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &ny - &_start_;
+    tt->single_val.i = 281;
+    tt++;
+    
+    // Parameter 'dx'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("dx");
+    tt->descr = tdrpStrDup("Grid spacing x (degrees)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &dx - &_start_;
+    tt->single_val.d = 0.5;
+    tt++;
+    
+    // Parameter 'dy'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("dy");
+    tt->descr = tdrpStrDup("Grid spacing y (degrees)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &dy - &_start_;
+    tt->single_val.d = 0.5;
+    tt++;
+    
+    // Parameter 'minx'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("minx");
+    tt->descr = tdrpStrDup("Lower left longitude");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &minx - &_start_;
+    tt->single_val.d = 0;
+    tt++;
+    
+    // Parameter 'miny'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("miny");
+    tt->descr = tdrpStrDup("Lower left latitude");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &miny - &_start_;
+    tt->single_val.d = -60;
+    tt++;
+    
+    // Parameter 'tile_npt'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("tile_npt");
+    tt->descr = tdrpStrDup("Tile size (points, x and y)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &tile_npt - &_start_;
+    tt->single_val.i = 40;
+    tt++;
+    
+    // Parameter 'tile_overlap_npt'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("tile_overlap_npt");
+    tt->descr = tdrpStrDup("Tile overlap (points, x and y)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &tile_overlap_npt - &_start_;
+    tt->single_val.i = 20;
+    tt++;
+    
+    // Parameter 'smooth_npt'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("smooth_npt");
+    tt->descr = tdrpStrDup("Box size for the smoothing kernel (points, x and y)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &smooth_npt - &_start_;
+    tt->single_val.i = 5;
+    tt++;
+    
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("SYNTHETIC ENSEMBLE");
+    tt->comment_text = tdrpStrDup("Defaults are the production GEFS and CMCE settings (PbarCompute.GEFS, PbarCompute.CMCE)");
+    tt++;
+    
+    // Parameter 'num_gefs_members'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("num_gefs_members");
+    tt->descr = tdrpStrDup("Number of GEFS members (gep01, gep02, ...)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &num_gefs_members - &_start_;
+    tt->single_val.i = 30;
+    tt++;
+    
+    // Parameter 'num_cmce_members'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("num_cmce_members");
+    tt->descr = tdrpStrDup("Number of CMCE members (cmc01, cmc02, ...)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &num_cmce_members - &_start_;
+    tt->single_val.i = 20;
+    tt++;
+    
+    // Parameter 'first_lead_hours'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("first_lead_hours");
+    tt->descr = tdrpStrDup("First lead time (hours)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &first_lead_hours - &_start_;
+    tt->single_val.i = 3;
+    tt++;
+    
+    // Parameter 'lead_delta_hours'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("lead_delta_hours");
+    tt->descr = tdrpStrDup("Lead time spacing (hours)");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &lead_delta_hours - &_start_;
+    tt->single_val.i = 3;
+    tt++;
+    
+    // Parameter 'num_leads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("num_leads");
+    tt->descr = tdrpStrDup("Number of lead times");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &num_leads - &_start_;
+    tt->single_val.i = 18;
+    tt++;
+    
+    // Parameter 'gen_time'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("gen_time");
+    tt->descr = tdrpStrDup("Generation time given to the synthetic forecasts");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &gen_time - &_start_;
+    tt->single_val.s = tdrpStrDup("2023-03-16T00:00:00");
+    tt++;
+    
+    // Parameter 'precip_field'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("precip_field");
+    tt->descr = tdrpStrDup("Name of the synthetic 3 hour precip field");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &precip_field - &_start_;
+    tt->single_val.s = tdrpStrDup("APCP3Hr");
+    tt++;
+    
+    // Parameter 'olr_field'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("olr_field");
+    tt->descr = tdrpStrDup("Name of the synthetic outgoing long wave field");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &olr_field - &_start_;
+    tt->single_val.s = tdrpStrDup("ULWRF3Hr");
+    tt++;
+    
+    // Parameter 'cape_field'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("cape_field");
+    tt->descr = tdrpStrDup("Name of the synthetic CAPE field");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &cape_field - &_start_;
+    tt->single_val.s = tdrpStrDup("CAPE");
+    tt++;
+    
+    // Parameter 'obs_field'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("obs_field");
+    tt->descr = tdrpStrDup("Name of the synthetic observed precip field");
+    tt->help = tdrpStrDup("Written in mm hr-1 at each forecast valid time, as CMORPH is read by ObarCompute");
+    tt->val_offset = (char *) &obs_field - &_start_;
+    tt->single_val.s = tdrpStrDup("cmorph");
+    tt++;
+    
+    // Parameter 'Comment 3'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 3");
+    tt->comment_hdr = tdrpStrDup("PRODUCTION THRESHOLDS");
+    tt->comment_text = tdrpStrDup("The threshold lists used by the XML and SPDB kernels are the ones PbarCompute runs with, read from its production param file");
+    tt++;
+    
+    // Parameter 'thresh_param_file'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("thresh_param_file");
+    tt->descr = tdrpStrDup("PbarCompute param file to read the threshold lists from");
+    tt->help = tdrpStrDup("Only the parameters below are read from it. Each list goes from min to max in steps of delta, as in PbarCompute.");
+    tt->val_offset = (char *) &thresh_param_file - &_start_;
+    tt->single_val.s = tdrpStrDup("$(PARMepoch)/PbarCompute.GEFS");
+    tt++;
+    
+    // Parameter 'threshMin1'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("threshMin1");
+    tt->descr = tdrpStrDup("Precip thresholds minimum");
+    tt->help = tdrpStrDup("Replaced by the value in thresh_param_file, where it has the same name");
+    tt->val_offset = (char *) &threshMin1 - &_start_;
+    tt->single_val.d = 0.5;
+    tt++;
+    
+    // Parameter 'threshMax1'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("threshMax1");
+    tt->descr = tdrpStrDup("Precip thresholds maximum");
+    tt->help = tdrpStrDup("Replaced by the value in thresh_param_file, where it has the same name");
+    tt->val_offset = (char *) &threshMax1 - &_start_;
+    tt->single_val.d = 6;
+    tt++;
+    
+    // Parameter 'threshDelta1'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("threshDelta1");
+    tt->descr = tdrpStrDup("Precip thresholds spacing");
+    tt->help = tdrpStrDup("Replaced by the value in thresh_param_file, where it has the same name");
+    tt->val_offset = (char *) &threshDelta1 - &_start_;
+    tt->single_val.d = 0.25;
+    tt++;
+    
+    // Parameter 'threshMin2'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("threshMin2");
+    tt->descr = tdrpStrDup("OLR thresholds minimum");
+    tt->help = tdrpStrDup("Replaced by the value in thresh_param_file, where it has the same name");
+    tt->val_offset = (char *) &threshMin2 - &_start_;
+    tt->single_val.d = 170;
+    tt++;
+    
+    // Parameter 'threshMax2'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("threshMax2");
+    tt->descr = tdrpStrDup("OLR thresholds maximum");
+    tt->help = tdrpStrDup("Replaced by the value in thresh_param_file, where it has the same name");
+    tt->val_offset = (char *) &threshMax2 - &_start_;
+    tt->single_val.d = 350;
+    tt++;
+    
+    // Parameter 'threshDelta2'
+    // ctype is 'double'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = DOUBLE_TYPE;
+    tt->param_name = tdrpStrDup("threshDelta2");
+    tt->descr = tdrpStrDup("OLR thresholds spacing");
+    tt->help = tdrpStrDup("Replaced by the value in thresh_param_file, where it has the same name");
+    tt->val_offset = (char *) &threshDelta2 - &_start_;
+    tt->single_val.d = 10;
+    tt++;
+    
+    // Parameter 'Comment 4'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 4");
+    tt->comment_hdr = tdrpStrDup("WHAT TO RUN");
+    tt->comment_text = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'generate_inputs'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("generate_inputs");
+    tt->descr = tdrpStrDup("Write the synthetic ensemble as MDV under work_dir/mdv");
+    tt->help = tdrpStrDup("Layout is work_dir/mdv/<gefs|cmce>/<member>, as written by PrecipAccumCalc, plus the observations in work_dir/mdv/obs, so the end to end runs can point at it. The time taken is reported.");
+    tt->val_offset = (char *) &generate_inputs - &_start_;
+    tt->single_val.b = pTRUE;
+    tt++;
+    
+    // Parameter 'run_grid_kernels'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("run_grid_kernels");
+    tt->descr = tdrpStrDup("Time GridData::meanSubset over all tiles and GridData::smooth");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &run_grid_kernels - &_start_;
+    tt->single_val.b = pTRUE;
+    tt++;
+    
+    // Parameter 'run_xml_kernels'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("run_xml_kernels");
+    tt->descr = tdrpStrDup("Time TaXml writing and parsing of tiling and threshold XML");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &run_xml_kernels - &_start_;
+    tt->single_val.b = pTRUE;
+    tt++;
+    
+    // Parameter 'run_mdv_kernels'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("run_mdv_kernels");
+    tt->descr = tdrpStrDup("Time MdvxField convertType/compress and MDV write/read");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &run_mdv_kernels - &_start_;
+    tt->single_val.b = pTRUE;
+    tt++;
+    
+    // Parameter 'run_spdb_kernels'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("run_spdb_kernels");
+    tt->descr = tdrpStrDup("Time SPDB put and get of per tile threshold chunks");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &run_spdb_kernels - &_start_;
+    tt->single_val.b = pTRUE;
+    tt++;
+    
+    // Parameter 'grib2_file'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("grib2_file");
+    tt->descr = tdrpStrDup("GRIB2 file to unpack");
+    tt->help = tdrpStrDup("If set, every record in the file is unpacked (Grib2File::read, then DS::getData for each record). Empty to skip.");
+    tt->val_offset = (char *) &grib2_file - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'app_param_dir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("app_param_dir");
+    tt->descr = tdrpStrDup("Directory with param files for end to end runs");
+    tt->help = tdrpStrDup("For each of ObarCompute, PbarCompute, ThreshFromObarPbar and EnsLookupGen, if <app_param_dir>/<app>.bench exists the app is run in app_param_dir as '<app> -params <app>.bench -interval <gen_time> <last valid time>' and timed. EPOCH_BENCH_DIR is set to work_dir, and each SPDB or output location that the production param files take from the environment (OBAR_CMORPH, PBAR_GEFS, ...) is set to a directory under work_dir/spdb. The .bench files in the EPOCH parm directory are the GEFS production param files reading the synthetic data. Empty to skip.");
+    tt->val_offset = (char *) &app_param_dir - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
+    // trailing entry has param_name set to NULL
+    
+    tt->param_name = NULL;
+    
+    return;
+  
+  }
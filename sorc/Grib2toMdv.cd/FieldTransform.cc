@@ -0,0 +1,420 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1990 - 2016
+// ** University Corporation for Atmospheric Research (UCAR)
+// ** National Center for Atmospheric Research (NCAR)
+// ** Boulder, Colorado, USA
+// ** BSD licence applies - redistribution and use in source and binary
+// ** forms, with or without modification, are permitted provided that
+// ** the following conditions are met:
+// ** 1) If the software is modified to produce derivative works,
+// ** such modified software should be clearly marked, so as not
+// ** to confuse it with the version available from UCAR.
+// ** 2) Redistributions of source code must retain the above copyright
+// ** notice, this list of conditions and the following disclaimer.
+// ** 3) Redistributions in binary form must reproduce the above copyright
+// ** notice, this list of conditions and the following disclaimer in the
+// ** documentation and/or other materials provided with the distribution.
+// ** 4) Neither the name of UCAR nor the names of its contributors,
+// ** if any, may be used to endorse or promote products derived from
+// ** this software without specific prior written permission.
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+///////////////////////////////////////////////////
+// FieldTransform - post-processing of the GRIB
+// data for one output field, in as few passes
+// over the data as possible
+///////////////////////////////////////////////////
+
+#include <cmath>
+#include <limits>
+#include <toolsa/TaEncodeKernels.hh>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/TaThreadSimple.hh>
+
+#include "FieldTransform.hh"
+using namespace std;
+
+// points processed together by all of the volume operations,
+// small enough to stay in cache between them
+
+static const size_t CHUNK_NPTS = 4096;
+
+// fewest points worth handing to a thread
+
+static const size_t MIN_BAND_NPTS = 65536;
+
+///////////////////////////////////////////////////
+// threads on bands of rows or points
+
+class FieldTransformThreads : public TaThreadDoubleQue
+{
+public:
+  FieldTransformThreads() : TaThreadDoubleQue() {}
+  virtual ~FieldTransformThreads() {}
+  TaThread *clone(int index)
+  {
+    TaThreadSimple *t = new TaThreadSimple(index);
+    t->setThreadMethod(FieldTransform::compute);
+    t->setThreadContext(this);
+    return (TaThread *)t;
+  }
+};
+
+FieldTransform::FieldTransform() :
+        _nThreads(1),
+        _threads(NULL),
+        _flipNS(false),
+        _adjacentRows(false),
+        _useBad(false),
+        _useMissing(false),
+        _inBad(0.0),
+        _bad(0.0),
+        _inMissing(0.0),
+        _missing(0.0)
+{
+}
+
+FieldTransform::~FieldTransform()
+{
+  delete _threads;
+}
+
+//////////////////////////////////////////
+// number of threads
+
+void FieldTransform::setNThreads(int nThreads)
+{
+  if (nThreads < 1) {
+    nThreads = 1;
+  }
+  if (nThreads == _nThreads) {
+    return;
+  }
+  delete _threads;
+  _threads = NULL;
+  _nThreads = nThreads;
+  if (_nThreads > 1) {
+    _threads = new FieldTransformThreads();
+    _threads->init(_nThreads, false);
+  }
+}
+
+//////////////////////////////////////////
+// plane copy options
+
+void FieldTransform::setRowOrder(bool flipNS, bool adjacentRows)
+{
+  _flipNS = flipNS;
+  _adjacentRows = adjacentRows;
+}
+
+void FieldTransform::setReplace(bool useBad, fl32 inBad, fl32 bad,
+                                bool useMissing, fl32 inMissing, fl32 missing)
+{
+  _useBad = useBad;
+  _inBad = inBad;
+  _bad = bad;
+  _useMissing = useMissing;
+  _inMissing = inMissing;
+  _missing = missing;
+}
+
+void FieldTransform::clearReplace()
+{
+  _useBad = false;
+  _useMissing = false;
+}
+
+//////////////////////////////////////////
+// copy a plane, in bands of rows
+
+void FieldTransform::copyPlane(const fl32 *in, int nx, int ny, fl32 *out)
+{
+  if (nx <= 0 || ny <= 0) {
+    return;
+  }
+  size_t nBands = (size_t) nx * (size_t) ny / MIN_BAND_NPTS;
+  if (nBands > (size_t) _nThreads) {
+    nBands = _nThreads;
+  }
+  if (nBands > (size_t) ny) {
+    nBands = ny;
+  }
+  if (nBands < 1) {
+    nBands = 1;
+  }
+  vector<band_t> bands(nBands);
+  for (size_t i = 0; i < nBands; i++) {
+    band_t &band = bands[i];
+    band.transform = this;
+    band.isPlane = true;
+    band.in = in;
+    band.out = out;
+    band.nx = nx;
+    band.ny = ny;
+    band.start = (ny * i) / nBands;
+    band.end = (ny * (i + 1)) / nBands;
+  }
+  _run(bands);
+}
+
+//////////////////////////////////////////
+// volume operations
+
+void FieldTransform::clearOps()
+{
+  _ops.clear();
+}
+
+void FieldTransform::addLimit(fl32 lower, fl32 upper, fl32 replacement)
+{
+  op_t op;
+  op.type = OP_LIMIT;
+  op.a = lower;
+  op.b = upper;
+  op.c = replacement;
+  op.bad = 0.0;
+  op.missing = 0.0;
+  _ops.push_back(op);
+}
+
+void FieldTransform::addScale(fl32 scale, fl32 bad, fl32 missing)
+{
+  op_t op;
+  op.type = OP_SCALE;
+  op.a = scale;
+  op.b = 0.0;
+  op.c = 0.0;
+  op.bad = bad;
+  op.missing = missing;
+  _ops.push_back(op);
+}
+
+void FieldTransform::addOffset(fl32 offset, fl32 bad, fl32 missing)
+{
+  op_t op;
+  op.type = OP_OFFSET;
+  op.a = offset;
+  op.b = 0.0;
+  op.c = 0.0;
+  op.bad = bad;
+  op.missing = missing;
+  _ops.push_back(op);
+}
+
+fl32 FieldTransform::apply(fl32 val) const
+{
+  band_t band;
+  band.isPlane = false;
+  band.out = &val;
+  band.start = 0;
+  band.end = 1;
+  band.finish = false;
+  _applyPoints(band);
+  return val;
+}
+
+//////////////////////////////////////////
+// apply to a volume, in bands of points
+
+size_t FieldTransform::applyVol(fl32 *data, size_t npoints,
+                                bool finish, fl32 bad, fl32 missing,
+                                fl32 &minVal, fl32 &maxVal)
+{
+  if (npoints == 0 || (_ops.empty() && !finish)) {
+    return 0;
+  }
+
+  // the band min and max combine to the same result as one
+  // pass, unless NaN values are left in
+
+  size_t nBands = npoints / MIN_BAND_NPTS;
+  if (nBands > (size_t) _nThreads) {
+    nBands = _nThreads;
+  }
+  if (nBands < 1 || (finish && (std::isnan(bad) || std::isnan(missing)))) {
+    nBands = 1;
+  }
+
+  vector<band_t> bands(nBands);
+  for (size_t i = 0; i < nBands; i++) {
+    band_t &band = bands[i];
+    band.transform = this;
+    band.isPlane = false;
+    band.in = NULL;
+    band.out = data;
+    band.start = (npoints * i) / nBands;
+    band.end = (npoints * (i + 1)) / nBands;
+    band.finish = finish;
+    band.bad = bad;
+    band.missing = missing;
+    band.minVal = numeric_limits<float>::max();
+    band.maxVal = -1 * numeric_limits<float>::max();
+    band.nNonFinite = 0;
+  }
+  _run(bands);
+
+  if (!finish) {
+    return 0;
+  }
+
+  size_t nNonFinite = 0;
+  fl32 min_val = numeric_limits<float>::max();
+  fl32 max_val = -1 * numeric_limits<float>::max();
+  for (size_t i = 0; i < nBands; i++) {
+    nNonFinite += bands[i].nNonFinite;
+    min_val = (min_val < bands[i].minVal) ? min_val : bands[i].minVal;
+    max_val = (max_val > bands[i].maxVal) ? max_val : bands[i].maxVal;
+  }
+  if (min_val <= max_val) {
+    minVal = min_val;
+    maxVal = max_val;
+  }
+  return nNonFinite;
+}
+
+//////////////////////////////////////////
+// thread method
+
+void FieldTransform::compute(void *ti)
+{
+  band_t *band = (band_t *) ti;
+  if (band->isPlane) {
+    band->transform->_copyRows(*band);
+  } else {
+    band->transform->_applyPoints(*band);
+  }
+}
+
+//////////////////////////////////////////
+// run the bands, threaded if more than one
+
+void FieldTransform::_run(vector<band_t> &bands)
+{
+  if (bands.size() == 1 || _threads == NULL) {
+    for (size_t i = 0; i < bands.size(); i++) {
+      compute(&bands[i]);
+    }
+    return;
+  }
+  for (size_t i = 0; i < bands.size(); i++) {
+    _threads->thread((int) i, &bands[i]);
+  }
+  _threads->waitForThreads();
+}
+
+//////////////////////////////////////////
+// additional bad and missing values
+
+inline fl32 FieldTransform::_replace(fl32 val) const
+{
+  if (_useBad && val == _inBad)
+    return _bad;
+  else if (_useMissing && val == _inMissing)
+    return _missing;
+  return val;
+}
+
+//////////////////////////////////////////
+// copy rows of a plane
+//
+// Output row y is input row ny-1-y when flipping North to South.
+// Adjacent row reordering then moves the points within each odd
+// output row, as Grib2Mdv::_reOrderAdjacentRows() did:
+// point x goes to 2*halfX-2-x, except x = halfX, which stays.
+// For even nx, point 0 lands on point 0 of the following row.
+
+void FieldTransform::_copyRows(band_t &band) const
+{
+  int nx = band.nx;
+  int ny = band.ny;
+  bool replace = _useBad || _useMissing;
+  int halfX = (nx / 2) + 1;
+
+  for (int y = (int) band.start; y < (int) band.end; y++) {
+
+    const fl32 *src = band.in + (size_t) (_flipNS ? ny - 1 - y : y) * nx;
+    fl32 *dst = band.out + (size_t) y * nx;
+
+    if (replace) {
+      for (int x = 0; x < nx; x++) {
+        dst[x] = _replace(src[x]);
+      }
+    } else {
+      for (int x = 0; x < nx; x++) {
+        dst[x] = src[x];
+      }
+    }
+
+    if (!_adjacentRows) {
+      continue;
+    }
+
+    if (y % 2 == 1) {
+      for (int x = 0; x < nx; x++) {
+        int xx = 2 * halfX - 2 - x;
+        if (x != halfX && xx < nx) {
+          dst[xx] = replace ? _replace(src[x]) : src[x];
+        }
+      }
+    } else if (y > 0 && nx % 2 == 0) {
+      const fl32 *prev =
+        band.in + (size_t) (_flipNS ? ny - y : y - 1) * nx;
+      dst[0] = replace ? _replace(prev[0]) : prev[0];
+    }
+
+  }
+}
+
+//////////////////////////////////////////
+// apply the operations to points of a volume,
+// a chunk at a time
+
+void FieldTransform::_applyPoints(band_t &band) const
+{
+  for (size_t start = band.start; start < band.end; start += CHUNK_NPTS) {
+
+    size_t npts = band.end - start;
+    if (npts > CHUNK_NPTS) {
+      npts = CHUNK_NPTS;
+    }
+    fl32 *val = band.out + start;
+
+    for (size_t iop = 0; iop < _ops.size(); iop++) {
+      const op_t &op = _ops[iop];
+      switch (op.type) {
+        case OP_LIMIT:
+          for (size_t j = 0; j < npts; j++) {
+            if ((val[j] < op.a) || (val[j] > op.b)) {
+              val[j] = op.c;
+            }
+          }
+          break;
+        case OP_SCALE:
+          for (size_t j = 0; j < npts; j++) {
+            if ((val[j] != op.bad) && (val[j] != op.missing)) {
+              val[j] *= op.a;
+            }
+          }
+          break;
+        case OP_OFFSET:
+          for (size_t j = 0; j < npts; j++) {
+            if ((val[j] != op.bad) && (val[j] != op.missing)) {
+              val[j] += op.a;
+            }
+          }
+          break;
+      }
+    }
+
+    if (band.finish) {
+      band.nNonFinite +=
+        TaEncodeKernels::replaceNonFinite(val, npts, band.bad);
+      TaEncodeKernels::minMax(val, npts, band.missing, band.bad,
+                              band.minVal, band.maxVal);
+    }
+
+  }
+}
@@ -0,0 +1,179 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1990 - 2016
+// ** University Corporation for Atmospheric Research (UCAR)
+// ** National Center for Atmospheric Research (NCAR)
+// ** Boulder, Colorado, USA
+// ** BSD licence applies - redistribution and use in source and binary
+// ** forms, with or without modification, are permitted provided that
+// ** the following conditions are met:
+// ** 1) If the software is modified to produce derivative works,
+// ** such modified software should be clearly marked, so as not
+// ** to confuse it with the version available from UCAR.
+// ** 2) Redistributions of source code must retain the above copyright
+// ** notice, this list of conditions and the following disclaimer.
+// ** 3) Redistributions in binary form must reproduce the above copyright
+// ** notice, this list of conditions and the following disclaimer in the
+// ** documentation and/or other materials provided with the distribution.
+// ** 4) Neither the name of UCAR nor the names of its contributors,
+// ** if any, may be used to endorse or promote products derived from
+// ** this software without specific prior written permission.
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+///////////////////////////////////////////////////
+// FieldTransform - post-processing of the GRIB
+// data for one output field, in as few passes
+// over the data as possible
+//
+// Two stages:
+//
+//  copyPlane() - each GRIB record is copied into
+//    its level of the field volume, with the
+//    additional bad/missing value replacement,
+//    North to South row flip and adjacent row
+//    reordering done on the way.
+//
+//  applyVol() - the range limits and unit
+//    conversions configured for the field are
+//    applied together, a block of points at a
+//    time, optionally with the NaN replacement
+//    and min/max that MdvxField does when it is
+//    constructed.
+//
+// Both run in bands of rows or points on
+// several threads if set up to.
+// The results are the same as the separate
+// passes in Grib2Mdv they replace.
+///////////////////////////////////////////////////
+#ifndef _FIELD_TRANSFORM_
+#define _FIELD_TRANSFORM_
+
+#include <vector>
+#include <cstddef>
+#include <dataport/port_types.h>
+
+class FieldTransformThreads;
+
+class FieldTransform {
+
+public:
+
+  FieldTransform();
+  ~FieldTransform();
+
+  // number of threads, 1 for no threading
+
+  void setNThreads(int nThreads);
+
+  //////////////////////
+  // plane copy options
+
+  void setRowOrder(bool flipNS, bool adjacentRows);
+
+  // replace values equal to inBad with bad, and values
+  // equal to inMissing with missing, if the use flags are set
+
+  void setReplace(bool useBad, fl32 inBad, fl32 bad,
+                  bool useMissing, fl32 inMissing, fl32 missing);
+  void clearReplace();
+
+  // copy an nx by ny plane from in to out, which must not overlap
+
+  void copyPlane(const fl32 *in, int nx, int ny, fl32 *out);
+
+  ///////////////////////
+  // volume operations,
+  // applied in the order added
+
+  void clearOps();
+
+  // values below lower or above upper are set to replacement
+
+  void addLimit(fl32 lower, fl32 upper, fl32 replacement);
+
+  // values other than bad and missing are multiplied by scale
+
+  void addScale(fl32 scale, fl32 bad, fl32 missing);
+
+  // values other than bad and missing have offset added
+
+  void addOffset(fl32 offset, fl32 bad, fl32 missing);
+
+  bool hasOps() const { return !_ops.empty(); }
+
+  // the operations added so far, applied to a single value
+
+  fl32 apply(fl32 val) const;
+
+  // Apply the operations to a volume in place.
+  //
+  // If finish is true, NaN and infinite values are then set
+  // to bad, and minVal and maxVal are set to the min and max
+  // of the values which are not bad or missing, as MdvxField
+  // does on construction. minVal and maxVal are unchanged if
+  // there are no such values.
+  //
+  // Returns the number of NaN and infinite values replaced.
+
+  size_t applyVol(fl32 *data, size_t npoints,
+                  bool finish, fl32 bad, fl32 missing,
+                  fl32 &minVal, fl32 &maxVal);
+
+  // thread method
+
+  static void compute(void *ti);
+
+protected:
+private:
+
+  typedef enum {
+    OP_LIMIT,
+    OP_SCALE,
+    OP_OFFSET
+  } op_type_t;
+
+  typedef struct {
+    op_type_t type;
+    fl32 a;      // lower, scale or offset
+    fl32 b;      // upper
+    fl32 c;      // replacement
+    fl32 bad;
+    fl32 missing;
+  } op_t;
+
+  // work for one thread, rows [start, end) of a plane
+  // or points [start, end) of a volume
+
+  typedef struct {
+    FieldTransform *transform;
+    bool isPlane;
+    const fl32 *in;
+    fl32 *out;
+    int nx, ny;
+    size_t start, end;
+    bool finish;
+    fl32 bad, missing;
+    fl32 minVal, maxVal;
+    size_t nNonFinite;
+  } band_t;
+
+  int _nThreads;
+  FieldTransformThreads *_threads;
+
+  bool _flipNS;
+  bool _adjacentRows;
+
+  bool _useBad, _useMissing;
+  fl32 _inBad, _bad, _inMissing, _missing;
+
+  std::vector<op_t> _ops;
+
+  void _run(std::vector<band_t> &bands);
+  void _copyRows(band_t &band) const;
+  void _applyPoints(band_t &band) const;
+  inline fl32 _replace(fl32 val) const;
+
+};
+
+#endif
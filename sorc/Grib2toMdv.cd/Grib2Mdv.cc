@@ -36,7 +36,7 @@
 #include <toolsa/str.h>
 #include <toolsa/pmu.h>
 #include <toolsa/port.h>
-#include <toolsa/MemBuf.hh>
+#include <toolsa/TaEncodeKernels.hh>
 #include <toolsa/DateTime.hh>
 #include <toolsa/Path.hh>
 #include <dsdata/DsFileListTrigger.hh>
@@ -93,6 +93,8 @@ Grib2Mdv::Grib2Mdv (Params &params)
 
   memset( (void *) &_fieldHeader, (int) 0, sizeof(Mdvx::field_header_t) );
   memset( (void *) &_vlevelHeader, (int) 0, sizeof(Mdvx::vlevel_header_t) );
+
+  _transform.setNThreads(_paramsPtr->transform_n_threads);
 }
 
 Grib2Mdv::~Grib2Mdv()
@@ -197,6 +199,7 @@ int Grib2Mdv::init(int nFiles, char** fileList, bool printVarList,
    } // if( nFiles > 0 ) {
 
    _Grib2File   = new Grib2::Grib2File ();
+   _Grib2File->setNThreads(_paramsPtr->grib_unpack_n_threads);
    _printVarList = printVarList;
    _printSummary = printsummary;
    _printSections = printsections;
@@ -382,6 +385,10 @@ int Grib2Mdv::getData()
 	    _sortByLevel(GribRecords.begin(), GribRecords.end());
 	  
 	  //MemBuf fieldData;
+	  // The data goes straight into the volume of fieldPtr, or into
+	  // fieldDataPtr if it is too large for a FLOAT32 field and has
+	  // to be encoded first.
+	  MdvxField *fieldPtr = NULL;
 	  fl32 *fieldDataPtr = NULL;
 	  fl32 *currDataPtr = NULL;
 
@@ -412,6 +419,16 @@ int Grib2Mdv::getData()
 	  if( _field->vert_level_dz > 1)
 	    levelDz =  _field->vert_level_dz;
 
+	  //
+	  // Decode the requested levels together if threaded, any
+	  // that fail are caught again by getData() below
+	  if (_paramsPtr->grib_unpack_n_threads > 1) {
+	    vector<Grib2::Grib2Record::Grib2Sections_t> unpackRecords;
+	    for(int levelNum = levelMin; levelNum <= levelMax; levelNum+=levelDz)
+	      unpackRecords.push_back(GribRecords[levelNum]);
+	    _Grib2File->unpackData(unpackRecords);
+	  }
+
 	  //
 	  // Loop over requested vertical levels in each field
 	  for(int levelNum = levelMin; levelNum <= levelMax; levelNum+=levelDz) {
@@ -454,16 +471,25 @@ int Grib2Mdv::getData()
 		cerr << "Processing  " << _fieldHeader.nz << " records." << endl;
 	      }
 	  
-	      fieldDataPtr = new fl32[(size_t)_fieldHeader.nz*(size_t)_fieldHeader.nx*(size_t)_fieldHeader.ny];
-	      currDataPtr = fieldDataPtr;
+	      _fieldHeader.volume_size = (si32)_fieldHeader.nx * (si32)_fieldHeader.ny * 
+		(si32)_fieldHeader.nz * (si32)_fieldHeader.data_element_nbytes;
+	      if (_fieldHeader.volume_size > 0) {
+		fieldPtr = new MdvxField(_fieldHeader, _vlevelHeader, NULL, false, false);
+		currDataPtr = (fl32 *) fieldPtr->getVol();
+	      } else {
+		fieldDataPtr = new fl32[(size_t)_fieldHeader.nz*(size_t)_fieldHeader.nx*(size_t)_fieldHeader.ny];
+		currDataPtr = fieldDataPtr;
+	      }
 	    }
 
 	    //
 	    // Generation time changed. This shouldn't happen and we can't handle it correctly.
-	    if (currDataPtr != fieldDataPtr && _GribRecord->ids->getGenerateTime() != lastGenerateTime) {
+	    if (levelNum != levelMin && _GribRecord->ids->getGenerateTime() != lastGenerateTime) {
 	      
 	      cerr << "ERROR: File containes multiple gen times." << endl;
 	      cerr << "       currently unsupported." << endl;
+	      delete fieldPtr;
+	      delete [] fieldDataPtr;
 	      _outputFile->clear();
 	      _Grib2File->clearInventory();
 	      return( RI_FAILURE );
@@ -475,24 +501,36 @@ int Grib2Mdv::getData()
 	    if(data == NULL) {
 	      cerr << "ERROR: Failed to get field "
                    <<  _field->param << " level " << _field->level << endl;
+	      delete fieldPtr;
+	      delete [] fieldDataPtr;
 	      return( RI_FAILURE );
 	    }
 
-            if (_field->use_additional_bad_data_value || _field->use_additional_missing_data_value)
-              _replaceAdditionalBadMissing(data, _fieldHeader,
-                                           _field->use_additional_bad_data_value,
-                                           _field->additional_bad_data_value,
-                                           _field->use_additional_missing_data_value,
-                                           _field->additional_missing_data_value);
+	    // The additional bad/missing replacement and the row
+	    // reordering are done while copying into the volume,
+	    // except that remapped data is replaced before remapping.
+	    _transform.clearReplace();
+	    if (_field->use_additional_bad_data_value || _field->use_additional_missing_data_value) {
+	      if(_reMapField)
+		_replaceAdditionalBadMissing(data, _fieldHeader,
+					     _field->use_additional_bad_data_value,
+					     _field->additional_bad_data_value,
+					     _field->use_additional_missing_data_value,
+					     _field->additional_missing_data_value);
+	      else
+		_transform.setReplace(_field->use_additional_bad_data_value,
+				      _field->additional_bad_data_value,
+				      _fieldHeader.bad_data_value,
+				      _field->use_additional_missing_data_value,
+				      _field->additional_missing_data_value,
+				      _fieldHeader.missing_data_value);
+	    }
 	    if(_reMapField)
 	      data = _reMapReducedOrGaussian(data, _fieldHeader);
-	    if(_reOrderNS_2_SN)
-	      _reOrderNS2SN(data, _fieldHeader.nx, _fieldHeader.ny);
-	    if(_reOrderAdjacent_Rows)
-	      _reOrderAdjacentRows(data, _fieldHeader.nx, _fieldHeader.ny);
+	    _transform.setRowOrder(_reOrderNS_2_SN, _reOrderAdjacent_Rows);
 	    
 	    //fieldDataPtr = fieldData.add(data, sizeof(fl32)*_fieldHeader.nx*_fieldHeader.ny );
-	    memcpy ( currDataPtr, data, sizeof(fl32)*_fieldHeader.nx*_fieldHeader.ny );
+	    _transform.copyPlane(data, _fieldHeader.nx, _fieldHeader.ny, currDataPtr);
 	    currDataPtr += _fieldHeader.nx*_fieldHeader.ny;
 	    if(_reMapField)
 	      delete[] data;
@@ -522,9 +560,13 @@ int Grib2Mdv::getData()
                  << " not found in grib file." << endl;
 	  } else {
             
+	    // collect the range limits and unit conversions, then
+	    // apply them in one pass
+	    fl32 *volPtr = fieldPtr ? (fl32 *) fieldPtr->getVol() : fieldDataPtr;
+	    _transform.clearOps();
 	    if(_paramsPtr->process_everything) {
 	      _setFieldNames(-1);
-	      _convertUnits(-1,fieldDataPtr);
+	      _convertUnits(-1,volPtr);
 	      _convertVerticalUnits(-1);
 	    } else {
 	      for (int i = 0; i < _paramsPtr->output_fields_n; i++) {
@@ -533,46 +575,76 @@ int Grib2Mdv::getData()
 		    STRequal_exact(_paramsPtr->_output_fields[i].level,
                                    _GribRecord->summary->levelType.c_str()) ) {
 		  _setFieldNames(i);
-		  _limitDataRange(i,fieldDataPtr);
-		  _convertUnits(i,fieldDataPtr);
+		  _limitDataRange(i);
+		  _convertUnits(i,volPtr);
 		  _convertVerticalUnits(i);
 		}
 	      }
 	    }
 
-	    _fieldHeader.volume_size = (si32)_fieldHeader.nx * (si32)_fieldHeader.ny * 
-	      (si32)_fieldHeader.nz * (si32)_fieldHeader.data_element_nbytes;
+	    size_t npoints = (size_t)_fieldHeader.nz*(size_t)_fieldHeader.nx*(size_t)_fieldHeader.ny;
+
+	    if (fieldPtr != NULL) {
+
+	      // also the NaN check and min/max MdvxField does when
+	      // constructed with data
+	      size_t numNans =
+		_transform.applyVol(volPtr, npoints, true,
+				    _fieldHeader.bad_data_value,
+				    _fieldHeader.missing_data_value,
+				    _fieldHeader.min_value, _fieldHeader.max_value);
+	      if (numNans > 0) {
+		cerr << "WARNING - MdvxField::MdvxField" << endl;
+		cerr << "  " << numNans << " NaNs found in data volume for field ";
+		cerr << "  " << _fieldHeader.field_name << " (";
+		cerr << 100.0*double(numNans)/double(npoints);
+		cerr << " % NaNs) - replaced with bad_data_value" << endl;
+	      }
+	      fieldPtr->setFieldHeader(_fieldHeader);
+	      fieldPtr->setVlevelHeader(_vlevelHeader);
+
+	    } else {
 
-	    // Large data with volume_size larger than mdv can handle must be encoded
-	    // before being passed off to the mdv class.
-	    if(_fieldHeader.volume_size < 0) {
+	      fl32 min_val, max_val;
+	      _transform.applyVol(fieldDataPtr, npoints, false, 0.0, 0.0,
+				  min_val, max_val);
 
 	      _fieldHeader.volume_size = (si32)_fieldHeader.nx * (si32)_fieldHeader.ny * 
-		(si32)_fieldHeader.nz * 2;
+		(si32)_fieldHeader.nz * (si32)_fieldHeader.data_element_nbytes;
+
+	      // Large data with volume_size larger than mdv can handle must be encoded
+	      // before being passed off to the mdv class.
+	      if(_fieldHeader.volume_size < 0) {
 
-	      if(_fieldHeader.volume_size > 0) {
-		if (_paramsPtr->debug)
-		  cerr << "Forcing encoding to INT16 for field " <<  _field->param << " due to size." << endl;
-		fieldDataPtr = _encode(fieldDataPtr, Params::ENCODING_INT16);
-	      } else {
 		_fieldHeader.volume_size = (si32)_fieldHeader.nx * (si32)_fieldHeader.ny * 
-		  (si32)_fieldHeader.nz * 1;
+		  (si32)_fieldHeader.nz * 2;
+
 		if(_fieldHeader.volume_size > 0) {
 		  if (_paramsPtr->debug)
-		    cerr << "Forcing encoding to INT8 for field " <<  _field->param << " due to size." << endl;
-		  fieldDataPtr = _encode(fieldDataPtr, Params::ENCODING_INT8);
+		    cerr << "Forcing encoding to INT16 for field " <<  _field->param << " due to size." << endl;
+		  fieldDataPtr = _encode(fieldDataPtr, Params::ENCODING_INT16);
 		} else {
-		  cerr << "ERROR: Field " <<  _field->param << " " 
-		       << _fieldHeader.nz << " is larger than Mdv can handle." << endl;
-		  delete [] fieldDataPtr;
-		  return( RI_FAILURE );
+		  _fieldHeader.volume_size = (si32)_fieldHeader.nx * (si32)_fieldHeader.ny * 
+		    (si32)_fieldHeader.nz * 1;
+		  if(_fieldHeader.volume_size > 0) {
+		    if (_paramsPtr->debug)
+		      cerr << "Forcing encoding to INT8 for field " <<  _field->param << " due to size." << endl;
+		    fieldDataPtr = _encode(fieldDataPtr, Params::ENCODING_INT8);
+		  } else {
+		    cerr << "ERROR: Field " <<  _field->param << " " 
+			 << _fieldHeader.nz << " is larger than Mdv can handle." << endl;
+		    delete [] fieldDataPtr;
+		    return( RI_FAILURE );
+		  }
 		}
+
 	      }
 
+	      fieldPtr = new MdvxField(_fieldHeader, _vlevelHeader, fieldDataPtr );
+	      delete [] fieldDataPtr;
+
 	    }
 
-	    MdvxField *fieldPtr = new MdvxField(_fieldHeader, _vlevelHeader, fieldDataPtr );
-	    delete [] fieldDataPtr;
 	    _outputFile->addField(fieldPtr);
 
 	  }
@@ -981,54 +1053,6 @@ void Grib2Mdv::_sortByLevel(vector<Grib2::Grib2Record::Grib2Sections_t>::iterato
 
 }
 
-// reorders data from North to South to South to North
-// East/West increments remain the same
-// For GFS data this means  that the data starts in the 
-// lower left hand corner instead of the upper left hand 
-// corner. 
-void Grib2Mdv::_reOrderNS2SN (fl32 *data, int numX, int numY)
-{
-  int j = 0;
-  MemBuf *gribData = new MemBuf();
-
-  fl32 *bufPtr = (fl32 *) gribData->load 
-                     ((void *) data, numX * numY * sizeof (fl32));
-
-  for (int y = numY - 1; y >= 0; y--) {
-    for (int x = 0;  x < numX; x++) {
-      data[j] = bufPtr[(y * numX) + x];
-      j++;
-    }
-  }
-
-  delete gribData;
-
-}
-
-//
-// Reorders rows that scan in the opposite direction
-// to rows that scan in the same direction.
-// Grid size remains the same.
-void Grib2Mdv::_reOrderAdjacentRows (fl32 *data, int numX, int numY)
-{
-  MemBuf *gribData = new MemBuf();
-
-  fl32 *bufPtr = (fl32 *) gribData->load 
-                     ((void *) data, numX * numY * sizeof (fl32));
-  int halfX = (numX / 2)+1;
-  for (int y = 1; y < numY; y += 2) {
-    for (int x = 0;  x < halfX; x++) {
-      data[(y * numX) + x + ((halfX - x - 1)*2)] = bufPtr[(y * numX) + x];
-    }
-    for (int x = halfX+1;  x < numX; x++) {
-      data[(y * numX) + x - ((x - halfX + 1)*2)] = bufPtr[(y * numX) + x];
-    }
-  }
-
-  delete gribData;
-
-}
-
 //
 // Selects the Mdv field name. Uses the abbreviated name from the Grib2 product table along
 // with the abbreviated level name to form a unique name for this field.
@@ -1059,7 +1083,8 @@ void Grib2Mdv::_setFieldNames(int paramsIndex)
 //
 // Applies limits on range of values in _data, specified by the upper_range_limit 
 // and lower_range_limit values from the parameter file. 
-void Grib2Mdv::_limitDataRange(int paramsIndex, fl32 *dataPtr)
+// Adds the limits to _transform, applied later with the unit conversions.
+void Grib2Mdv::_limitDataRange(int paramsIndex)
 {
   if(paramsIndex < 0 || paramsIndex >= _paramsPtr->output_fields_n)
     return;
@@ -1088,14 +1113,7 @@ void Grib2Mdv::_limitDataRange(int paramsIndex, fl32 *dataPtr)
     return;
   }
   
-  fl32* flPtr = (fl32*) dataPtr;
-  size_t numPts = _fieldHeader.nx*_fieldHeader.ny*_fieldHeader.nz;
-  
-  for (size_t j = 0; j < numPts; j++,  flPtr++) {
-    if((*flPtr < lowerLimit) || (*flPtr > upperLimit)) {
-      *flPtr = replacementValue;
-    }
-  }
+  _transform.addLimit(lowerLimit, upperLimit, replacementValue);
   
 }
 
@@ -1136,8 +1154,10 @@ void Grib2Mdv::_convertVerticalUnits(int paramsIndex)
 
 //
 // Performs simple unit conversions, which are prescribed in the parameter file
+// Adds the conversion to _transform, after any range limits, so dataPtr
+// is the data before either is applied.
 //
-void Grib2Mdv::_convertUnits(int paramsIndex, fl32 *dataPtr)
+void Grib2Mdv::_convertUnits(int paramsIndex, const fl32 *dataPtr)
 {
 
   float scaleFactor = 1.0;
@@ -1150,7 +1170,7 @@ void Grib2Mdv::_convertUnits(int paramsIndex, fl32 *dataPtr)
   // Attempt to get missing data value correct.
   // Grib2 does not allow a missing value to be specified unless complex packing is used.
   if (  _paramsPtr->autoset_missing_value){
-     fl32 firstVal = ((fl32*)dataPtr)[0];
+     fl32 firstVal = _transform.apply(dataPtr[0]);
      if(_fieldHeader.missing_data_value == -9999.0 && 
        (firstVal == -1 || firstVal == -99 || firstVal == -999) ) {
         _fieldHeader.missing_data_value = firstVal;
@@ -1214,27 +1234,14 @@ void Grib2Mdv::_convertUnits(int paramsIndex, fl32 *dataPtr)
 	break;
     }
     
-    fl32* flPtr = (fl32*)dataPtr;
-    size_t numPts = _fieldHeader.nx*_fieldHeader.ny*_fieldHeader.nz;
-
     if (scaleFactor != 1.0) {
-      
-      for (size_t j = 0; j < numPts; j++,  flPtr++) {
-	if((*flPtr != _fieldHeader.bad_data_value) && (*flPtr != _fieldHeader.missing_data_value)) {
-	  *flPtr *= scaleFactor;
-	}
-      }
-    
+      _transform.addScale(scaleFactor, _fieldHeader.bad_data_value,
+                          _fieldHeader.missing_data_value);
     }
     
     if (offsetFactor != 0.0) {
-      
-      for (size_t j = 0; j < numPts; j++,  flPtr++) {
-	if((*flPtr != _fieldHeader.bad_data_value) && (*flPtr != _fieldHeader.missing_data_value)) {
-	  *flPtr += offsetFactor;
-	}
-      }
-      
+      _transform.addOffset(offsetFactor, _fieldHeader.bad_data_value,
+                           _fieldHeader.missing_data_value);
     }
     
     STRncopy(_fieldHeader.units, theUnits.c_str(), MDV_UNITS_LEN);
@@ -1426,15 +1433,8 @@ fl32 *Grib2Mdv::_encode(fl32 *dataPtr, Params::encoding_type_t output_encoding)
     fl32 missing = _fieldHeader.missing_data_value;
     fl32 bad = _fieldHeader.bad_data_value;
     size_t npoints = (size_t)_fieldHeader.nz*(size_t)_fieldHeader.nx*(size_t)_fieldHeader.ny;
-    fl32 *val = dataPtr;
-    
-    for (size_t i = 0; i < npoints; i++, val++) {
-      fl32 this_val = *val;
-      if (this_val != missing && this_val != bad) {
-	min_val = MIN(min_val, this_val);
-	max_val = MAX(max_val, this_val);
-      }
-    }
+
+    TaEncodeKernels::minMax(dataPtr, npoints, missing, bad, min_val, max_val);
     _fieldHeader.min_value = min_val;
     _fieldHeader.max_value = max_val;
     
@@ -1500,27 +1500,9 @@ void *Grib2Mdv::_float32_to_int8(fl32 *inDataPtr)
   
   fl32 *in = inDataPtr;
   ui08 *out = (ui08 *) outDataPtr;
-  size_t nBad = 0;
-
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    fl32 in_val = *in;
-    if (in_val == in_missing) {
-      *out = out_missing;
-    } else if (in_val == in_bad) {
-      *out = out_bad;
-    } else {
-      int out_val = (int) ((in_val - bias) / scale + 0.49999);
-      if (out_val > 255) {
-        nBad++;
- 	*out = 255;
-      } else if (out_val < 3) {
-        nBad++;
- 	*out = 3;
-      } else {
-	*out = (ui08) out_val;
-      }
-    }
-  } // i */
+  size_t nBad = TaEncodeKernels::encodeInt8(in, npoints, in_missing, in_bad,
+                                            scale, bias, 3, 255,
+                                            out_missing, out_bad, out);
 
   if (nBad > 0) {
     cerr << "ERROR - float32_to_int8" << endl;
@@ -1602,27 +1584,9 @@ void *Grib2Mdv::_float32_to_int16(fl32 *inDataPtr)
   
   fl32 *in = (fl32 *) inDataPtr;
   ui16 *out = (ui16 *) outDataPtr;
-  size_t nBad = 0;
-
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    fl32 in_val = *in;
-    if (in_val == in_missing) {
-      *out = out_missing;
-    } else if (in_val == in_bad) {
-      *out = out_bad;
-    } else {
-      int out_val = (int) ((in_val - bias) / scale + 0.49999);
-      if (out_val > 65535) {
-        nBad++;
- 	*out = 65535;
-      } else if (out_val < 20) {
-        nBad++;
- 	*out = 20;
-      } else {
-	*out = (ui16) out_val;
-      }
-    }
-  } // i */
+  size_t nBad = TaEncodeKernels::encodeInt16(in, npoints, in_missing, in_bad,
+                                             scale, bias, 20, 65535,
+                                             out_missing, out_bad, out);
 
   if (nBad > 0) {
     cerr << "ERROR - MdvxField::_float32_to_int16" << endl;
@@ -43,6 +43,7 @@
 
 #include "Params.hh"
 #include "OutputFile.hh"
+#include "FieldTransform.hh"
 using namespace std;
 
 //
@@ -123,6 +124,11 @@ private:
   vector<MdvxField*> _outputFields;
   OutputFile *_outputFile;
 
+  //
+  // per field post-processing
+  //
+  FieldTransform _transform;
+
   int _mdvInit();
   int _convertGribLevel2MDVLevel(const string &GribLevel);
   int _createFieldHdr(); 
@@ -130,16 +136,14 @@ private:
 
   void _sortByLevel(vector<Grib2::Grib2Record::Grib2Sections_t>::iterator begin, 
 		    vector<Grib2::Grib2Record::Grib2Sections_t>::iterator end);
-  void _reOrderNS2SN(fl32 *data, int numX, int numY);
-  void _reOrderAdjacentRows(fl32 *data, int numX, int numY);
   void _replaceAdditionalBadMissing(fl32 *data, Mdvx::field_header_t fhdr,
                                     bool use_bad_value, fl32 bad_value,
                                     bool use_missing_value, fl32 missing_value);
   fl32 *_reMapReducedOrGaussian(fl32 *data, Mdvx::field_header_t fhdr);
   void _setFieldNames(int paramsIndex);
-  void _limitDataRange(int paramsIndex,fl32 *dataPtr);
+  void _limitDataRange(int paramsIndex);
   void _convertVerticalUnits(int paramsIndex);
-  void _convertUnits(int paramsIndex,fl32 *dataPtr); 
+  void _convertUnits(int paramsIndex, const fl32 *dataPtr); 
 
   fl32 *_encode(fl32 *dataPtr, Params::encoding_type_t output_encoding);
   void *_float32_to_int8(fl32 *inDataPtr);
@@ -47,6 +47,18 @@ OutputFile::OutputFile(Params *params)
   _paramsPtr = params;
   _mdvObj = new DsMdvx;
   _htInterp = new HtInterp(params);
+  switch (params->remap_method) {
+  case Params::REMAP_BILINEAR:
+    _remapLut.setMethod(MdvxRemapLut::REMAP_BILINEAR);
+    break;
+  case Params::REMAP_CONSERVATIVE:
+    _remapLut.setMethod(MdvxRemapLut::REMAP_CONSERVATIVE);
+    break;
+  default:
+    _remapLut.setMethod(MdvxRemapLut::REMAP_NEAREST);
+  }
+  _remapLut.setNConservSamples(params->remap_conservative_samples);
+  _remapLut.setNThreads(params->remap_n_threads);
 }
 
 OutputFile::~OutputFile()
@@ -254,7 +266,7 @@ void
 OutputFile::_remap(MdvxField* field)
 {
 
-  MdvxRemapLut lut;
+  MdvxRemapLut &lut = _remapLut;
 
   switch( _paramsPtr->out_projection_info.type) {
   case Params::PROJ_FLAT:
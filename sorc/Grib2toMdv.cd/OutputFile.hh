@@ -33,6 +33,7 @@
 // Forward class declarations
 //
 #include "Params.hh"
+#include <Mdv/MdvxRemapLut.hh>
 class MdvxField;
 class DsMdvx;
 class HtInterp;
@@ -83,6 +84,11 @@ private:
 
   int _verticalType;
 
+  // remap lookup table, kept so the weights are computed once
+  // for each input/output grid pair rather than for every field
+
+  MdvxRemapLut _remapLut;
+
   void _remap(MdvxField* inputField);
 
   void _setMasterHdr( time_t genTime, long int leadSecs, bool isObs );
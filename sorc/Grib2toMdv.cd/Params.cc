@@ -1558,6 +1558,94 @@
     tt->single_val.d = 0;
     tt++;
     
+    // Parameter 'Comment 5'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 5");
+    tt->comment_hdr = tdrpStrDup("REMAPPING METHOD");
+    tt->comment_text = tdrpStrDup("Options for the remap_output remapping.");
+    tt++;
+    
+    // Parameter 'remap_method'
+    // ctype is 'remap_method_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = ENUM_TYPE;
+    tt->param_name = tdrpStrDup("remap_method");
+    tt->descr = tdrpStrDup("Method used when remap_output is TRUE.");
+    tt->help = tdrpStrDup("REMAP_NEAREST: value of the nearest input grid point.\nREMAP_BILINEAR: bilinear interpolation between the 4 surrounding input points, for smooth fields.\nREMAP_CONSERVATIVE: area weighted mean of the input cells overlapping each output cell, for going to a coarser grid.\nThe interpolation weights are computed once for each input/output grid pair and reused for every field. Missing input points are left out of the weighted means. Does not apply to Lambert to Lambert remapping.");
+    tt->val_offset = (char *) &remap_method - &_start_;
+    tt->enum_def.name = tdrpStrDup("remap_method_t");
+    tt->enum_def.nfields = 3;
+    tt->enum_def.fields = (enum_field_t *)
+        tdrpMalloc(tt->enum_def.nfields * sizeof(enum_field_t));
+      tt->enum_def.fields[0].name = tdrpStrDup("REMAP_NEAREST");
+      tt->enum_def.fields[0].val = REMAP_NEAREST;
+      tt->enum_def.fields[1].name = tdrpStrDup("REMAP_BILINEAR");
+      tt->enum_def.fields[1].val = REMAP_BILINEAR;
+      tt->enum_def.fields[2].name = tdrpStrDup("REMAP_CONSERVATIVE");
+      tt->enum_def.fields[2].val = REMAP_CONSERVATIVE;
+    tt->single_val.e = REMAP_NEAREST;
+    tt++;
+    
+    // Parameter 'remap_conservative_samples'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("remap_conservative_samples");
+    tt->descr = tdrpStrDup("Samples per output cell side, REMAP_CONSERVATIVE.");
+    tt->help = tdrpStrDup("The overlap of each output cell with the input cells is estimated from an n by n sampling of the output cell. Use at least the ratio of output to input grid spacing.");
+    tt->val_offset = (char *) &remap_conservative_samples - &_start_;
+    tt->single_val.i = 4;
+    tt++;
+    
+    // Parameter 'remap_n_threads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("remap_n_threads");
+    tt->descr = tdrpStrDup("Number of threads for remapping.");
+    tt->help = tdrpStrDup("Threads used to compute the remap weights and to apply them to each field, 1 for no threading.");
+    tt->val_offset = (char *) &remap_n_threads - &_start_;
+    tt->single_val.i = 1;
+    tt++;
+    
+    // Parameter 'Comment 6'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 6");
+    tt->comment_hdr = tdrpStrDup("FIELD PROCESSING");
+    tt->comment_text = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'transform_n_threads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("transform_n_threads");
+    tt->descr = tdrpStrDup("Number of threads for processing the field data.");
+    tt->help = tdrpStrDup("Threads used to copy each GRIB record into its field, and to apply the range limits and unit conversions, in bands of rows. 1 for no threading.");
+    tt->val_offset = (char *) &transform_n_threads - &_start_;
+    tt->single_val.i = 1;
+    tt++;
+    
+    // Parameter 'grib_unpack_n_threads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("grib_unpack_n_threads");
+    tt->descr = tdrpStrDup("Number of threads for unpacking the GRIB data.");
+    tt->help = tdrpStrDup("Threads used to decode the GRIB records of each output field together, before they are processed. 1 to decode each record as it is processed, which uses the least memory.");
+    tt->val_offset = (char *) &grib_unpack_n_threads - &_start_;
+    tt->single_val.i = 1;
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
@@ -162,6 +162,12 @@ public:
     double dy;
   } grid_info_t;
 
+  typedef enum {
+    REMAP_NEAREST = 0,
+    REMAP_BILINEAR = 1,
+    REMAP_CONSERVATIVE = 2
+  } remap_method_t;
+
   ///////////////////////////
   // Member functions
   //
@@ -561,6 +567,16 @@ public:
 
   double min_height_from_pressure_levels;
 
+  remap_method_t remap_method;
+
+  int remap_conservative_samples;
+
+  int remap_n_threads;
+
+  int transform_n_threads;
+
+  int grib_unpack_n_threads;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -568,7 +584,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[56];
+  mutable TDRPtable _table[63];
 
   const char *_className;
 
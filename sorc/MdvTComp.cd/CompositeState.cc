@@ -0,0 +1,417 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// CompositeState.cc
+//
+// Incremental time composite state for MdvTComp
+//
+///////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <toolsa/DateTime.hh>
+#include <Mdv/MdvxField.hh>
+#include "CompositeState.hh"
+using namespace std;
+
+const fl32 CompositeState::_missing = -9.0e33;
+
+// identifies a checkpoint file, and its layout version
+
+static const char _checkpointMagic[16] = "CompositeState1";
+
+// Constructor
+
+CompositeState::CompositeState(Params::composite_t compositeType,
+			       const vector<string> &fieldNames,
+			       bool debug) :
+  _compositeType(compositeType),
+  _fieldNames(fieldNames),
+  _debug(debug),
+  _nPoints(0)
+
+{
+
+}
+
+// destructor
+
+CompositeState::~CompositeState()
+
+{
+
+}
+
+//////////////////////////////////////////////////
+// empty out everything
+
+void CompositeState::clear()
+{
+  _ring.clear();
+  _sum.clear();
+  _count.clear();
+  _extreme.clear();
+  _nPoints = 0;
+}
+
+//////////////////////////////////////////////////
+// true if a time is in the state
+
+bool CompositeState::has(time_t t) const
+{
+  return _ring.find(t) != _ring.end();
+}
+
+//////////////////////////////////////////////////
+// add the data for a time
+
+int CompositeState::add(time_t t, const DsMdvx &mdvx, int nPoints)
+{
+
+  if (!_ring.empty() && nPoints != _nPoints) {
+    cerr << "WARNING - CompositeState::add" << endl;
+    cerr << "  Grid size changed from " << _nPoints
+	 << " to " << nPoints << ", starting over" << endl;
+    clear();
+  }
+
+  // copy out the data first, so nothing changes on failure
+
+  fields_t data(_fieldNames.size());
+  for (size_t ifield = 0; ifield < _fieldNames.size(); ifield++) {
+    const MdvxField *fld = mdvx.getField(_fieldNames[ifield].c_str());
+    if (fld == NULL) {
+      cerr << "ERROR - CompositeState::add" << endl;
+      cerr << "  No field " << _fieldNames[ifield] << " at "
+	   << DateTime::str(t) << endl;
+      return -1;
+    }
+    fl32 missing = fld->getFieldHeader().missing_data_value;
+    const fl32 *ff = (const fl32 *) fld->getVol();
+    vector<fl32> &d = data[ifield];
+    d.resize(nPoints);
+    for (int j = 0; j < nPoints; j++) {
+      d[j] = (ff[j] == missing) ? _missing : ff[j];
+    }
+  }
+
+  if (_ring.empty()) {
+    _init(nPoints);
+  }
+
+  map<time_t, fields_t>::iterator it = _ring.find(t);
+  if (it != _ring.end()) {
+    // rewritten, take the old data out first
+    fields_t old;
+    old.swap(it->second);
+    _ring.erase(it);
+    _exclude(old);
+  }
+
+  _ring[t] = data;
+  _include(data);
+
+  if (_debug) {
+    cerr << "CompositeState added " << DateTime::str(t)
+	 << ", n times: " << _ring.size() << endl;
+  }
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// drop all times outside [t0, t1]
+
+void CompositeState::retire(time_t t0, time_t t1)
+{
+  map<time_t, fields_t>::iterator it;
+  for (it = _ring.begin(); it != _ring.end(); ) {
+    if (it->first >= t0 && it->first <= t1) {
+      ++it;
+      continue;
+    }
+    if (_debug) {
+      cerr << "CompositeState dropped " << DateTime::str(it->first) << endl;
+    }
+    fields_t old;
+    old.swap(it->second);
+    _ring.erase(it++);
+    _exclude(old);
+  }
+}
+
+//////////////////////////////////////////////////
+// write the composite into working
+
+int CompositeState::fill(DsMdvx &working, int nPoints) const
+{
+
+  if (nPoints != _nPoints) {
+    cerr << "ERROR - CompositeState::fill" << endl;
+    cerr << "  Npoints " << nPoints << " state has " << _nPoints << endl;
+    return -1;
+  }
+
+  for (size_t ifield = 0; ifield < _fieldNames.size(); ifield++) {
+    MdvxField *fld = working.getField(_fieldNames[ifield].c_str());
+    if (fld == NULL) {
+      cerr << "ERROR - CompositeState::fill" << endl;
+      cerr << "  No field " << _fieldNames[ifield] << endl;
+      return -1;
+    }
+    fl32 missing = fld->getFieldHeader().missing_data_value;
+    fl32 *ff = (fl32 *) fld->getVol();
+    if (_compositeType == Params::AVERAGE) {
+      const vector<double> &sum = _sum[ifield];
+      const vector<int> &count = _count[ifield];
+      for (int j = 0; j < nPoints; j++) {
+	ff[j] = count[j] > 0 ? (fl32) (sum[j] / count[j]) : missing;
+      }
+    } else {
+      const vector<fl32> &ext = _extreme[ifield];
+      for (int j = 0; j < nPoints; j++) {
+	ff[j] = ext[j] == _missing ? missing : ext[j];
+      }
+    }
+  }
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// write a checkpoint file
+
+int CompositeState::checkpoint(const string &path) const
+{
+
+  string tmpPath = path + ".tmp";
+  FILE *out = fopen(tmpPath.c_str(), "w");
+  if (out == NULL) {
+    int errNum = errno;
+    cerr << "ERROR - CompositeState::checkpoint" << endl;
+    cerr << "  Cannot open file: " << tmpPath << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    return -1;
+  }
+
+  int nFields = (int) _fieldNames.size();
+  int nTimes = (int) _ring.size();
+  bool ok = (fwrite(_checkpointMagic, sizeof(_checkpointMagic), 1, out) == 1 &&
+	     fwrite(&_nPoints, sizeof(int), 1, out) == 1 &&
+	     fwrite(&nFields, sizeof(int), 1, out) == 1);
+  for (int ifield = 0; ok && ifield < nFields; ifield++) {
+    char name[MDV_SHORT_FIELD_LEN];
+    memset(name, 0, sizeof(name));
+    strncpy(name, _fieldNames[ifield].c_str(), sizeof(name) - 1);
+    ok = (fwrite(name, sizeof(name), 1, out) == 1);
+  }
+  ok = ok && fwrite(&nTimes, sizeof(int), 1, out) == 1;
+  map<time_t, fields_t>::const_iterator it;
+  for (it = _ring.begin(); ok && it != _ring.end(); ++it) {
+    si64 t = it->first;
+    ok = (fwrite(&t, sizeof(t), 1, out) == 1);
+    for (int ifield = 0; ok && ifield < nFields; ifield++) {
+      ok = (_nPoints == 0 ||
+	    fwrite(&it->second[ifield][0], sizeof(fl32), _nPoints, out) ==
+	    (size_t) _nPoints);
+    }
+  }
+
+  if (fclose(out)) {
+    ok = false;
+  }
+  if (!ok || rename(tmpPath.c_str(), path.c_str())) {
+    cerr << "ERROR - CompositeState::checkpoint" << endl;
+    cerr << "  Cannot write file: " << path << endl;
+    unlink(tmpPath.c_str());
+    return -1;
+  }
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// restore from a checkpoint file
+
+int CompositeState::restore(const string &path)
+{
+
+  clear();
+  FILE *in = fopen(path.c_str(), "r");
+  if (in == NULL) {
+    if (_debug) {
+      cerr << "CompositeState - no checkpoint file: " << path << endl;
+    }
+    return -1;
+  }
+
+  char magic[sizeof(_checkpointMagic)];
+  int nPoints = 0, nFields = 0, nTimes = 0;
+  bool ok = (fread(magic, sizeof(magic), 1, in) == 1 &&
+	     memcmp(magic, _checkpointMagic, sizeof(magic)) == 0 &&
+	     fread(&nPoints, sizeof(int), 1, in) == 1 && nPoints >= 0 &&
+	     fread(&nFields, sizeof(int), 1, in) == 1 &&
+	     nFields == (int) _fieldNames.size());
+  for (int ifield = 0; ok && ifield < nFields; ifield++) {
+    char name[MDV_SHORT_FIELD_LEN];
+    ok = (fread(name, sizeof(name), 1, in) == 1);
+    name[sizeof(name) - 1] = '\0';
+    ok = ok && _fieldNames[ifield] == name;
+  }
+  ok = ok && fread(&nTimes, sizeof(int), 1, in) == 1 && nTimes >= 0;
+  if (ok && nTimes > 0) {
+    _init(nPoints);
+  }
+  for (int itime = 0; ok && itime < nTimes; itime++) {
+    si64 t;
+    fields_t data(nFields);
+    ok = (fread(&t, sizeof(t), 1, in) == 1);
+    for (int ifield = 0; ok && ifield < nFields; ifield++) {
+      data[ifield].resize(nPoints);
+      ok = (nPoints == 0 ||
+	    fread(&data[ifield][0], sizeof(fl32), nPoints, in) ==
+	    (size_t) nPoints);
+    }
+    if (ok) {
+      _ring[(time_t) t] = data;
+      _include(data);
+    }
+  }
+  fclose(in);
+
+  if (!ok) {
+    cerr << "WARNING - CompositeState::restore" << endl;
+    cerr << "  Bad checkpoint file, or for other fields, ignored: "
+	 << path << endl;
+    clear();
+    return -1;
+  }
+  if (_debug) {
+    cerr << "CompositeState restored " << nTimes << " times from "
+	 << path << endl;
+  }
+  return 0;
+
+}
+
+//////////////////////////////////////////////////
+// set up an empty composite
+
+void CompositeState::_init(int nPoints)
+{
+  _nPoints = nPoints;
+  size_t nFields = _fieldNames.size();
+  _sum.clear();
+  _count.clear();
+  _extreme.clear();
+  if (_compositeType == Params::AVERAGE) {
+    _sum.assign(nFields, vector<double>(nPoints, 0.0));
+    _count.assign(nFields, vector<int>(nPoints, 0));
+  } else {
+    _extreme.assign(nFields, vector<fl32>(nPoints, _missing));
+  }
+}
+
+//////////////////////////////////////////////////
+// add one time's data into the composite
+
+void CompositeState::_include(const fields_t &data)
+{
+  for (size_t ifield = 0; ifield < data.size(); ifield++) {
+    const vector<fl32> &d = data[ifield];
+    if (_compositeType == Params::AVERAGE) {
+      vector<double> &sum = _sum[ifield];
+      vector<int> &count = _count[ifield];
+      for (int j = 0; j < _nPoints; j++) {
+	if (d[j] != _missing) {
+	  sum[j] += d[j];
+	  count[j]++;
+	}
+      }
+    } else {
+      vector<fl32> &ext = _extreme[ifield];
+      for (int j = 0; j < _nPoints; j++) {
+	if (d[j] != _missing && (ext[j] == _missing || _better(d[j], ext[j]))) {
+	  ext[j] = d[j];
+	}
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+// take one time's data out of the composite, which must
+// already have been removed from _ring
+
+void CompositeState::_exclude(const fields_t &data)
+{
+  for (size_t ifield = 0; ifield < data.size(); ifield++) {
+    const vector<fl32> &d = data[ifield];
+    if (_compositeType == Params::AVERAGE) {
+      vector<double> &sum = _sum[ifield];
+      vector<int> &count = _count[ifield];
+      for (int j = 0; j < _nPoints; j++) {
+	if (d[j] != _missing) {
+	  if (--count[j] <= 0) {
+	    // exactly empty, no rounding left over
+	    count[j] = 0;
+	    sum[j] = 0.0;
+	  } else {
+	    sum[j] -= d[j];
+	  }
+	}
+      }
+    } else {
+      // only points where the dropped value was the extreme change
+      vector<fl32> &ext = _extreme[ifield];
+      for (int j = 0; j < _nPoints; j++) {
+	if (d[j] == _missing || d[j] != ext[j]) {
+	  continue;
+	}
+	fl32 e = _missing;
+	map<time_t, fields_t>::const_iterator it;
+	for (it = _ring.begin(); it != _ring.end(); ++it) {
+	  fl32 v = it->second[ifield][j];
+	  if (v != _missing && (e == _missing || _better(v, e))) {
+	    e = v;
+	  }
+	}
+	ext[j] = e;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+// true if a is the better extreme than b
+
+bool CompositeState::_better(fl32 a, fl32 b) const
+{
+  if (_compositeType == Params::MINIMUM) {
+    return a < b;
+  }
+  return a > b;
+}
@@ -0,0 +1,144 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// CompositeState.hh
+//
+// Incremental time composite state for MdvTComp
+//
+///////////////////////////////////////////////////////////////
+//
+// Holds the data for every file in the composite period, one
+// fl32 array per field, along with the running composite:
+// sums and counts for AVERAGE, the running value for MAXIMUM
+// and MINIMUM.
+//
+// Adding a file updates the composite in one pass over the
+// points. Dropping a file subtracts it for AVERAGE. For
+// MAXIMUM and MINIMUM only the points at which the dropped
+// value was the extreme are recomputed from the remaining
+// files.
+//
+// The checkpoint file holds the times and data in the
+// composite period. The running composite is rebuilt from
+// those on restore.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef CompositeState_H
+#define CompositeState_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ctime>
+#include <Mdv/DsMdvx.hh>
+#include "Params.hh"
+using namespace std;
+
+class CompositeState {
+  
+public:
+
+  // constructor
+
+  CompositeState(Params::composite_t compositeType,
+		 const vector<string> &fieldNames,
+		 bool debug);
+
+  // destructor
+  
+  ~CompositeState();
+
+  // empty out everything
+
+  void clear();
+
+  // true if a time is in the state
+
+  bool has(time_t t) const;
+
+  // number of times in the state
+
+  int nTimes() const { return (int) _ring.size(); }
+
+  // Add the data for a time, replacing it if it is already there.
+  // All fields must be in mdvx, uncompressed FLOAT32, nPoints long.
+  // If nPoints differs from what is in the state, the state is
+  // cleared first.
+  // Returns 0 on success, -1 on failure.
+
+  int add(time_t t, const DsMdvx &mdvx, int nPoints);
+
+  // drop all times outside [t0, t1]
+
+  void retire(time_t t0, time_t t1);
+
+  // Write the composite into the fields in working, which must be
+  // uncompressed FLOAT32, nPoints long. Points with no data get the
+  // field missing value.
+  // Returns 0 on success, -1 on failure.
+
+  int fill(DsMdvx &working, int nPoints) const;
+
+  // write the times and data to a checkpoint file, atomically.
+  // Returns 0 on success, -1 on failure.
+
+  int checkpoint(const string &path) const;
+
+  // Replace the state with the contents of a checkpoint file.
+  // Returns 0 on success, -1 if there is none, or it is bad or
+  // for different fields.
+
+  int restore(const string &path);
+
+protected:
+  
+private:
+
+  // data for one time, one array per field, missing set to _missing
+
+  typedef vector< vector<fl32> > fields_t;
+
+  Params::composite_t _compositeType;
+  vector<string> _fieldNames;
+  bool _debug;
+  int _nPoints;
+  map<time_t, fields_t> _ring;
+
+  // running composite, per field
+
+  vector< vector<double> > _sum;
+  vector< vector<int> > _count;
+  vector< vector<fl32> > _extreme;
+
+  static const fl32 _missing;
+
+  void _init(int nPoints);
+  void _include(const fields_t &data);
+  void _exclude(const fields_t &data);
+  bool _better(fl32 a, fl32 b) const;
+
+};
+
+#endif
@@ -36,6 +36,7 @@
 //
 ///////////////////////////////////////////////////////////////
 
+#include <cstring>
 #include <dataport/bigend.h>
 #include <toolsa/umisc.h>
 #include <toolsa/pmu.h>
@@ -50,6 +51,8 @@ static void _updateAverage(fl32 *wff, fl32 wmissing, fl32 *pff, fl32 pmissing,
 			   fl32 *cff, int nPointsField);
 static void _updateMax(fl32 *wff, fl32 wmissing, fl32 *pff, fl32 pmissing, 
 		       int nPointsField);
+static void _updateMin(fl32 *wff, fl32 wmissing, fl32 *pff, fl32 pmissing, 
+		       int nPointsField);
 static void _constrainField(const Params::field_t &field, int nPointsField,
 			    DsMdvx &working);
 
@@ -60,6 +63,8 @@ MdvTComp::MdvTComp(int argc, char **argv)
 {
 
   isOK = true;
+  _state = NULL;
+  _stateRestored = false;
 
   // set programe name
 
@@ -95,6 +100,22 @@ MdvTComp::MdvTComp(int argc, char **argv)
     }
   }
 
+  // set up incremental compositing
+
+  if (_params.incremental) {
+    if (_params.min_delta_time != 0) {
+      cerr << "WARNING - " << _progName << endl;
+      cerr << "  incremental is ignored when min_delta_time is not 0" << endl;
+    } else {
+      vector<string> names;
+      for (int i = 0; i < _params.fields_n; i++) {
+	names.push_back(_params._fields[i].name);
+      }
+      _state = new CompositeState(_params.composite_type, names,
+				  _params.debug >= Params::DEBUG_VERBOSE);
+    }
+  }
+
   // init process mapper registration
 
   PMU_auto_init((char *) _progName.c_str(),
@@ -130,6 +151,10 @@ MdvTComp::~MdvTComp()
 
 {
 
+  if (_state != NULL) {
+    delete _state;
+  }
+
   // unregister process
 
   PMU_auto_unregister();
@@ -257,15 +282,22 @@ int  MdvTComp::_processNewData(DsMdvx &inMdvx, time_t &lastOutputTime)
     
   // create time composite
 
-  if (_doComposite(working, workingCounts, nPointsField)) {
+  if (_state != NULL) {
+
+    if (_doIncremental(working, nPointsField)) {
+      cerr << "ERROR - MdvTComp::Run" << endl;
+      cerr << "  Cannot perform incremental time composite." << endl;
+      return 0;
+    }
+
+  } else if (_doComposite(working, workingCounts, nPointsField)) {
     cerr << "ERROR - MdvTComp::Run" << endl;
     cerr << "  Cannot perform time composite." << endl;
 
     // return 0 so outer loop will continue
     return 0;
-  }
 
-  if (_params.composite_type == Params::AVERAGE) {
+  } else if (_params.composite_type == Params::AVERAGE) {
 
     // finish up averaging
 
@@ -373,28 +405,9 @@ int MdvTComp::_doComposite(DsMdvx &working, DsMdvx &workingCounts,
   const Mdvx::master_header_t &mhdr = working.getMasterHeader();
   time_t lastTimeProcessed = mhdr.time_centroid;
   DsMdvx times;
-  times.clearTimeListMode();
-  times.setTimeListModeValid(_params.input_url,
-			     mhdr.time_centroid - _params.composite_period,
-			     mhdr.time_centroid - 1);
-  
-  if (_params.debug >= Params::DEBUG_VERBOSE) {
-    times.printTimeListRequest(cerr);
-  }
-
-  if (times.compileTimeList()) {
-    cerr << "ERROR - MdvTComp::_doComposite()" << endl;
-    cerr << "  Cannot compile time list" << endl;
-    cerr << times.getErrStr() << endl;
+  if (_compileTimeList(working, times)) {
     return -1;
   }
-  
-  if (_params.debug >= Params::DEBUG_VERBOSE) {
-    for (int i = 0; i < times.getNTimesInList(); i++) {
-      cerr << "  Time " << i << ": " <<
-	DateTime::str(times.getTimeFromList(i)) << endl;
-    }
-  }
 
   if (times.getNTimesInList() == 0) {
     if (_params.debug) {
@@ -423,12 +436,122 @@ int MdvTComp::_doComposite(DsMdvx &working, DsMdvx &workingCounts,
   return 0;
 }
 
+//////////////////////////////////////////////////
+// Incremental composite: drop the files that left the composite
+// period, read only the past files not already in the state, add
+// the new file, then fill working from the state
+
+int MdvTComp::_doIncremental(DsMdvx &working, int nPointsField)
+
+{
+
+  bool checkpointing = (_params.mode == Params::REALTIME &&
+			strlen(_params.incremental_checkpoint_path) > 0);
+  if (!_stateRestored) {
+    _stateRestored = true;
+    if (checkpointing) {
+      _state->restore(_params.incremental_checkpoint_path);
+    }
+  }
+
+  const Mdvx::master_header_t &mhdr = working.getMasterHeader();
+  time_t t = mhdr.time_centroid;
+  _state->retire(t - _params.composite_period, t);
+
+  DsMdvx times;
+  if (_compileTimeList(working, times)) {
+    return -1;
+  }
+
+  DsMdvx past;
+  past.setDebug(_params.debug);
+  for (int itime = 0; itime < times.getNTimesInList(); itime++) {
+    time_t pastFileTime = times.getTimeFromList(itime);
+    if (_state->has(pastFileTime)) {
+      continue;
+    }
+    if (_readPast(pastFileTime, nPointsField, past, working) == 0) {
+      for (int ifield = 0; ifield < _params.fields_n; ifield++) {
+	_constrainField(_params._fields[ifield], nPointsField, past);
+      }
+      _state->add(pastFileTime, past, nPointsField);
+    }
+  }
+
+  // working has already been constrained
+
+  if (_state->add(t, working, nPointsField)) {
+    return -1;
+  }
+  if (_state->fill(working, nPointsField)) {
+    return -1;
+  }
+
+  if (checkpointing) {
+    _state->checkpoint(_params.incremental_checkpoint_path);
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////
+// compile the list of past file times for the composite
+
+int MdvTComp::_compileTimeList(const DsMdvx &working, DsMdvx &times) const
+
+{
+
+  const Mdvx::master_header_t &mhdr = working.getMasterHeader();
+  times.clearTimeListMode();
+  times.setTimeListModeValid(_params.input_url,
+			     mhdr.time_centroid - _params.composite_period,
+			     mhdr.time_centroid - 1);
+  
+  if (_params.debug >= Params::DEBUG_VERBOSE) {
+    times.printTimeListRequest(cerr);
+  }
+
+  if (times.compileTimeList()) {
+    cerr << "ERROR - MdvTComp::_doComposite()" << endl;
+    cerr << "  Cannot compile time list" << endl;
+    cerr << times.getErrStr() << endl;
+    return -1;
+  }
+  
+  if (_params.debug >= Params::DEBUG_VERBOSE) {
+    for (int i = 0; i < times.getNTimesInList(); i++) {
+      cerr << "  Time " << i << ": " <<
+	DateTime::str(times.getTimeFromList(i)) << endl;
+    }
+  }
+
+  return 0;
+}
+
 //////////////////////////////////////////////////
 // accumulate composite information using data from pastFileTime
 
 void MdvTComp::_accumulateComposite(const time_t pastFileTime, int nPointsField,
 				    DsMdvx &past, DsMdvx &working,
 				    DsMdvx &workingCounts) const
+{
+  if (_readPast(pastFileTime, nPointsField, past, working)) {
+    return;
+  }
+    
+  // loop through the fields, accumulate into each of them
+    
+  for (int ifield = 0; ifield < _params.fields_n; ifield++) {
+    _accumulateFieldComposite(_params._fields[ifield], nPointsField,
+			      past, working, workingCounts);
+  } 
+}
+
+//////////////////////////////////////////////////
+// read the past file at pastFileTime and check its size
+// returns 0 on success, -1 on failure
+
+int MdvTComp::_readPast(const time_t pastFileTime, int nPointsField,
+			DsMdvx &past, const DsMdvx &working) const
 {
   // set up the read
 
@@ -447,14 +570,14 @@ void MdvTComp::_accumulateComposite(const time_t pastFileTime, int nPointsField,
     cerr << "ERROR - MdvTComp::_doComposite()" << endl;
     cerr << "  Cannot read volume" << endl;
     cerr << past.getErrStr() << endl;
-    return;
+    return -1;
   }
     
   // check field lengths
     
   int nPointsThisFile = 0;
   if (!_uniformFields(past, nPointsThisFile)) {
-    return;
+    return -1;
   }
   if (nPointsThisFile != nPointsField) {
     cerr << "ERROR - MdvTComp::_doComposite()" << endl;
@@ -463,15 +586,9 @@ void MdvTComp::_accumulateComposite(const time_t pastFileTime, int nPointsField,
     cerr << "    Npoints in this file: " << nPointsThisFile << endl;
     cerr << "  Main file: " << working.getPathInUse() << endl;
     cerr << "    Npoints in main file: " << nPointsField << endl;
-    return;
+    return -1;
   }
-    
-  // loop through the fields, accumulate into each of them
-    
-  for (int ifield = 0; ifield < _params.fields_n; ifield++) {
-    _accumulateFieldComposite(_params._fields[ifield], nPointsField,
-			      past, working, workingCounts);
-  } 
+  return 0;
 }
 
 //////////////////////////////////////////////////
@@ -504,6 +621,8 @@ void MdvTComp::_accumulateFieldComposite(const Params::field_t &field,
     MdvxField *cfld = workingCounts.getField(field.name);
     fl32 *cff = (fl32 *) cfld->getVol();
     _updateAverage(wff, wmissing, pff, pmissing, cff, nPointsField);
+  } else if (_params.composite_type == Params::MINIMUM) {
+    _updateMin(wff, wmissing, pff, pmissing, nPointsField);
   } else {
     _updateMax(wff, wmissing, pff, pmissing, nPointsField);
   }
@@ -688,3 +807,21 @@ void _updateMax(fl32 *wff, fl32 wmissing, fl32 *pff, fl32 pmissing,
 }
 
 
+
+void _updateMin(fl32 *wff, fl32 wmissing, fl32 *pff, fl32 pmissing, 
+		       int nPointsField)
+{
+  for (int j = 0; j < nPointsField; j++, wff++, pff++) {
+    fl32 wfff = *wff;
+    fl32 pfff = *pff;
+    if (pfff != pmissing) {
+      if (wfff != wmissing) { 
+	if (pfff < wfff) {
+	  *wff = pfff;
+	}
+      } else {
+	*wff = pfff;
+      }
+    }
+  } // j
+}
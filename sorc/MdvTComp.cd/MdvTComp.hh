@@ -43,6 +43,7 @@
 #include <string>
 #include "Args.hh"
 #include "Params.hh"
+#include "CompositeState.hh"
 #include <Mdv/DsMdvxInput.hh>
 using namespace std;
 
@@ -78,6 +79,8 @@ private:
   Args _args;
   Params _params;
   DsMdvxInput _input;
+  CompositeState *_state;
+  bool _stateRestored;
 
   int  _processNewData(DsMdvx &inMdvx, time_t &lastOutputTime);
   void _setupRead(DsMdvx &mdvx) const;
@@ -85,6 +88,10 @@ private:
 		    DsMdvx &working, DsMdvx &workingCounts) const;
   int _doComposite(DsMdvx &working, DsMdvx &workingCounts,
 		   int nPointsField) const;
+  int _doIncremental(DsMdvx &working, int nPointsField);
+  int _compileTimeList(const DsMdvx &working, DsMdvx &times) const;
+  int _readPast(const time_t pastFileTime, int nPointsField,
+		DsMdvx &past, const DsMdvx &working) const;
   void _accumulateComposite(const time_t pastFileTime, int nPointsField,
 			    DsMdvx &past, DsMdvx &working,
 			    DsMdvx &workingCounts) const;
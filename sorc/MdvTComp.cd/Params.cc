@@ -701,16 +701,18 @@
     tt->ptype = ENUM_TYPE;
     tt->param_name = tdrpStrDup("composite_type");
     tt->descr = tdrpStrDup("Composite type");
-    tt->help = tdrpStrDup("composite_type=MAXIMUM or AVERAGE.  At each point either the maximum or average is accumulated.  Default = MAXIMUM");
+    tt->help = tdrpStrDup("composite_type=MAXIMUM, MINIMUM or AVERAGE.  At each point the maximum, minimum or average is accumulated.  Default = MAXIMUM");
     tt->val_offset = (char *) &composite_type - &_start_;
     tt->enum_def.name = tdrpStrDup("composite_t");
-    tt->enum_def.nfields = 2;
+    tt->enum_def.nfields = 3;
     tt->enum_def.fields = (enum_field_t *)
         tdrpMalloc(tt->enum_def.nfields * sizeof(enum_field_t));
       tt->enum_def.fields[0].name = tdrpStrDup("MAXIMUM");
       tt->enum_def.fields[0].val = MAXIMUM;
       tt->enum_def.fields[1].name = tdrpStrDup("AVERAGE");
       tt->enum_def.fields[1].val = AVERAGE;
+      tt->enum_def.fields[2].name = tdrpStrDup("MINIMUM");
+      tt->enum_def.fields[2].val = MINIMUM;
     tt->single_val.e = MAXIMUM;
     tt++;
     
@@ -900,6 +902,39 @@
         tdrpMalloc(tt->n_struct_vals * sizeof(tdrpVal_t));
     tt++;
     
+    // Parameter 'Comment 5'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 5");
+    tt->comment_hdr = tdrpStrDup("INCREMENTAL COMPOSITING");
+    tt->comment_text = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'incremental'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("incremental");
+    tt->descr = tdrpStrDup("Option to update the composite incrementally.");
+    tt->help = tdrpStrDup("If true, the files in the composite period are kept in memory along with running sums and counts (AVERAGE) or the running maximum or minimum. Each new file is read once, and files are dropped when they leave the composite period, so the cost per file does not grow with composite_period. Only used when min_delta_time is 0, since otherwise the files chosen depend on the time of each new file.");
+    tt->val_offset = (char *) &incremental - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'incremental_checkpoint_path'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("incremental_checkpoint_path");
+    tt->descr = tdrpStrDup("File in which to save the incremental state.");
+    tt->help = tdrpStrDup("REALTIME mode only. The files in the composite period are saved here after each output, and restored from here at startup, so only newer files need to be read after a restart. Empty for no checkpointing.");
+    tt->val_offset = (char *) &incremental_checkpoint_path - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
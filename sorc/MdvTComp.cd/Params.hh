@@ -81,7 +81,8 @@ public:
 
   typedef enum {
     MAXIMUM = 0,
-    AVERAGE = 1
+    AVERAGE = 1,
+    MINIMUM = 2
   } composite_t;
 
   typedef enum {
@@ -432,6 +433,10 @@ public:
   Hms_t *_output_times;
   int output_times_n;
 
+  tdrp_bool_t incremental;
+
+  char* incremental_checkpoint_path;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -439,7 +444,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[22];
+  mutable TDRPtable _table[25];
 
   const char *_className;
 
@@ -25,10 +25,22 @@
 #include <ConvWxIO/InterfaceIO.hh>
 #include <ConvWxIO/Trigger.hh>
 #include <ConvWx/Grid.hh>
+#include <ConvWx/PhaseTimer.hh>
 #include <toolsa/LogStream.hh>
+#include <toolsa/TaThreadSimple.hh>
 
 #include <vector>
 using std::vector;
+using std::string;
+
+//----------------------------------------------------------------
+TaThread *ObarComputeMgr::ObarComputeThreads::clone(int index)
+{
+  TaThreadSimple *t = new TaThreadSimple(index);
+  t->setThreadContext(this);
+  t->setThreadMethod(ObarComputeMgr::compute);
+  return dynamic_cast<TaThread *>(t);
+}
 
 //----------------------------------------------------------------
 ObarComputeMgr::
@@ -37,18 +49,33 @@ ObarComputeMgr(const ParmsObarComputeIO &parms, void tidyAndExit(int)) :
   _obsTime(0),
   _spdb(parms._obarSpdb, parms._inputField, parms._tileInfo,
 	parms._obsThreshold),
-  _obarInfo((int)parms._obsThreshold.size(), parms._tileInfo.numTiles())
+  _obarInfo((int)parms._obsThreshold.size(), parms._tileInfo.numTiles()),
+  _motherFail(false),
+  _motherSet(false),
+  _tileObar(parms._tileInfo.numTiles())
 {
   // Standard initialization
   if (!InterfaceParm::driverInit(_parms._main, tidyAndExit))
   {
     tidyAndExit(convWx::BAD_EXIT);
   }
+  Instrumentation::setMode(_parms._instrumentation,
+			   _parms._instrumentationJsonDir);
+  _thread.init(_parms._numThreads, false);
 }
 
 //----------------------------------------------------------------
 ObarComputeMgr::~ObarComputeMgr()
 {
+  _thread.waitForThreads();
+}
+
+//----------------------------------------------------------------
+void ObarComputeMgr::compute(void *ti)
+{
+  TileTask *task = static_cast<TileTask *>(ti);
+  task->_alg->_computeTile(*task->_obsGrid, task->_tileIndex);
+  delete task;
 }
 
 //----------------------------------------------------------------
@@ -66,6 +93,7 @@ void ObarComputeMgr::run(void)
 //----------------------------------------------------------------
 void ObarComputeMgr::_process(const time_t &obsTime)
 {
+  PhaseTimer timer("trigger");
   Grid obsGrid;
   bool hasObs = InterfaceIO::loadObs(obsTime, _parms._proj,
 				     _parms._obs.pUrl,
@@ -80,23 +108,52 @@ void ObarComputeMgr::_process(const time_t &obsTime)
 
   _obsTime = obsTime;
   _spdb.updateTime(_obsTime);
-  _processTiles(obsGrid);
-  _obarInfo.update(_spdb);
-  //_spdb.print();
-  _spdb.write(obsTime);
+  {
+    PhaseTimer t("tileStats");
+    _processTiles(obsGrid);
+  }
+  {
+    PhaseTimer t("spdbWrite");
+    _obarInfo.update(_spdb);
+    //_spdb.print();
+    _spdb.write(obsTime);
+  }
+  timer.stop();
+  string s = Instrumentation::report("ObarCompute", obsTime);
+  if (!s.empty())
+  {
+    LOG(PRINT) << s;
+  }
 }
 
 //----------------------------------------------------------------
 void ObarComputeMgr::_processTiles(const Grid &obsGrid)
 {
+  // where the obs are in the tiles, so empty tiles and tiles entirely on
+  // one side of every threshold need no scan, stored with the obar values
+  _occupancy = TileOccupancy(_parms._tileInfo, obsGrid);
+  _spdb.setOccupancy(_occupancy);
+  LOG(DEBUG) << _occupancy.numEmpty() << " of " << _occupancy.numTiles()
+	     << " tiles have no obs data";
 
-  // for each obar threshold
+  // one pass over each tile gives obar at all thresholds, tiles in parallel
+  for (int tileIndex=0; tileIndex<_parms._tileInfo.numTiles(); ++tileIndex)
+  {
+    TileTask *task = new TileTask();
+    task->_alg = this;
+    task->_obsGrid = &obsGrid;
+    task->_tileIndex = tileIndex;
+    _thread.thread(tileIndex, task);
+  }
+  _thread.waitForThreads();
+
+  // for each obar threshold, fill in from the results in tile order, which
+  // matters for the fallbacks to mother tile and tile below
   for (size_t i=0; i<_parms._obsThreshold.size(); ++i)
   {
     // do the mothertile first
     int motherIndex = TileInfo::motherTileIndex();
-    TileObarInfo info = _setupAndRunAlg(obsGrid, motherIndex,
-					i, true);
+    TileObarInfo info = _setupAndRunAlg(motherIndex, i, true);
     _obarInfo[i][motherIndex] = info;
     if (!_motherFail)
     {
@@ -109,8 +166,7 @@ void ObarComputeMgr::_processTiles(const Grid &obsGrid)
     {
       if (tileIndex != motherIndex)
       {
-	info = _setupAndRunAlg(obsGrid, tileIndex,
-			       i, false);
+	info = _setupAndRunAlg(tileIndex, i, false);
 	_obarInfo[i][tileIndex] = info;
       }
     }
@@ -118,8 +174,7 @@ void ObarComputeMgr::_processTiles(const Grid &obsGrid)
 }
 
 //----------------------------------------------------------------
-TileObarInfo ObarComputeMgr::_setupAndRunAlg(const Grid &obsGrid,
-					     int tileIndex,
+TileObarInfo ObarComputeMgr::_setupAndRunAlg(int tileIndex,
 					     int threshIndex,
 					     bool isMotherTile)
 {
@@ -137,30 +192,49 @@ TileObarInfo ObarComputeMgr::_setupAndRunAlg(const Grid &obsGrid,
     return ret;
   }
 
-  double oBar;
-  TileRange r = _parms._tileInfo.range(tileIndex);
-  if (!_obsSetup(r, _parms._obsThreshold[threshIndex], obsGrid, oBar))
+  const TileObar &t = _tileObar[tileIndex];
+  if (!t._ok)
   {
     ret = _setToMotherOrColdstart(tileIndex, isMotherTile);
     return ret;
   }
   else
   {
-    return TileObarInfo(oBar, tileIndex, isMotherTile, false);
+    return TileObarInfo(t._oBar[threshIndex], tileIndex, isMotherTile, false);
   }
 }
 
 //-----------------------------------------------------------------------
-bool ObarComputeMgr::_obsSetup(const TileRange &r,
-			       double thresh,
-			       const Grid &obsGrid,
-			       double &oBar)
+void ObarComputeMgr::_computeTile(const Grid &obsGrid, int tileIndex)
 {
+  TileObar &t = _tileObar[tileIndex];
+  t._ok = false;
+  int belowTile;
+  if (_parms._tileInfo.outOfBoundsY(tileIndex, belowTile))
+  {
+    // filled in from the tile below later
+    return;
+  }
+
+  if (_occupancy.isEmpty(tileIndex))
+  {
+    LOG(DEBUG_VERBOSE) << "Cannot compute percent obs data above threshold, all missing";
+    return;
+  }
+  if (_occupancy.fractionsAbove(tileIndex, _parms._obsThreshold, t._oBar))
+  {
+    Instrumentation::addCount("tilesFromOccupancy");
+    t._ok = true;
+    return;
+  }
+
+  PhaseTimer timer("tileScan");
   bool outOfBounds;
-  if (!obsGrid.percentAboveThresholdSubset(thresh,
-					   r.getX0(), r.getY0(),
-					   r.getNx(), r.getNy(),
-					   true, false, oBar, outOfBounds))
+  TileRange r = _parms._tileInfo.range(tileIndex);
+  if (!obsGrid.percentAboveThresholdsSubset(_parms._obsThreshold,
+					    r.getX0(), r.getY0(),
+					    r.getNx(), r.getNy(),
+					    true, false, t._oBar, outOfBounds))
   {
     if (outOfBounds)
     {
@@ -170,13 +244,17 @@ bool ObarComputeMgr::_obsSetup(const TileRange &r,
     {
       LOG(DEBUG_VERBOSE) << "Cannot compute percent obs data above threshold, all missing";
     }
-    return false;
+    return;
   }
-  if (oBar == 0.0)
+  t._ok = true;
+  for (size_t i=0; i<t._oBar.size(); ++i)
   {
-    LOG(DEBUG_VERBOSE) << "No obs data above threshold " << thresh;
+    if (t._oBar[i] == 0.0)
+    {
+      LOG(DEBUG_VERBOSE) << "No obs data above threshold "
+			 << _parms._obsThreshold[i];
+    }
   }
-  return true;
 }
 
 //-----------------------------------------------------------------------
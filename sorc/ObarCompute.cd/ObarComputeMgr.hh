@@ -32,7 +32,10 @@
 #include "ParmsObarComputeIO.hh"
 #include "ObarForEachThresh.hh"
 #include <Epoch/SpdbObsHandler.hh>
+#include <Epoch/TileOccupancy.hh>
+#include <toolsa/TaThreadDoubleQue.hh>
 #include <string>
+#include <vector>
 
 class Grid;
 class TileRange;
@@ -57,9 +60,50 @@ public:
    */
   void run(void);
 
+  /**
+   * Compute obar at all thresholds for one tile, the thread method
+   * @param[in] i  Pointer to a TileTask
+   */
+  static void compute(void *i);
+
 protected:
 private:
 
+  /**
+   * @class ObarComputeThreads
+   * @brief Instantiation to implement the clone() method
+   */
+  class ObarComputeThreads : public TaThreadDoubleQue
+  {
+  public:
+    inline ObarComputeThreads(void) : TaThreadDoubleQue() {}
+    inline virtual ~ObarComputeThreads(void) {}
+    TaThread *clone(int index);
+  };
+
+  /**
+   * @class TileTask
+   * @brief What one thread computes, obar at all thresholds for one tile
+   */
+  class TileTask
+  {
+  public:
+    ObarComputeMgr *_alg;   /**< Pointer back to the manager */
+    const Grid *_obsGrid;   /**< The obs data */
+    int _tileIndex;         /**< The tile */
+  };
+
+  /**
+   * @class TileObar
+   * @brief Result of one pass over one tile
+   */
+  class TileObar
+  {
+  public:
+    bool _ok;                   /**< False if no obs data or out of bounds */
+    std::vector<double> _oBar;  /**< Obar at each threshold, when _ok */
+  };
+
   ParmsObarComputeIO _parms;   /**< Params */
   time_t _obsTime;             /**< Current obs time */
   SpdbObsHandler _spdb;        /**< database object */
@@ -69,11 +113,15 @@ private:
   bool _motherSet;             /**< True if _motherInfo is set */
   TileObarInfo _motherInfo;    /**< Information for the mother tile */
 
+  ObarComputeThreads _thread;    /**< Threads on tiles */
+  std::vector<TileObar> _tileObar; /**< One pass results, for each tile */
+  TileOccupancy _occupancy;      /**< Obs data in each tile, this trigger */
+
   void _process(const time_t &obsTime);
   void _processTiles(const Grid &obsGrid);
-  TileObarInfo _setupAndRunAlg(const Grid &obsGrid, int tileIndex,
-			       int threshIndex, bool isMotherTile);
-  bool _obsSetup(const TileRange &r, double thresh, const Grid &obsGrid, double &oBar);
+  TileObarInfo _setupAndRunAlg(int tileIndex, int threshIndex,
+			       bool isMotherTile);
+  void _computeTile(const Grid &obsGrid, int tileIndex);
   TileObarInfo _setToMotherOrColdstart(int tileIndex, bool isMotherTile);
 };
 
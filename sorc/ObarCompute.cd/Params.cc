@@ -627,6 +627,61 @@
       tt->array_vals[0].d = 0;
     tt++;
     
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("INSTRUMENTATION");
+    tt->comment_text = tdrpStrDup("Per trigger timing of the processing phases (load, count, tile stats, SPDB read/write, MDV write), broken down by thread");
+    tt++;
+    
+    // Parameter 'instrumentation'
+    // ctype is 'Instrumentation_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = ENUM_TYPE;
+    tt->param_name = tdrpStrDup("instrumentation");
+    tt->descr = tdrpStrDup("Instrumentation output");
+    tt->help = tdrpStrDup("OFF for none. LOG to log summary lines after each trigger. JSON to also write a JSON file to instrumentationJsonDir after each trigger.");
+    tt->val_offset = (char *) &instrumentation - &_start_;
+    tt->enum_def.name = tdrpStrDup("Instrumentation_t");
+    tt->enum_def.nfields = 3;
+    tt->enum_def.fields = (enum_field_t *)
+        tdrpMalloc(tt->enum_def.nfields * sizeof(enum_field_t));
+      tt->enum_def.fields[0].name = tdrpStrDup("INSTRUMENTATION_OFF");
+      tt->enum_def.fields[0].val = INSTRUMENTATION_OFF;
+      tt->enum_def.fields[1].name = tdrpStrDup("INSTRUMENTATION_LOG");
+      tt->enum_def.fields[1].val = INSTRUMENTATION_LOG;
+      tt->enum_def.fields[2].name = tdrpStrDup("INSTRUMENTATION_JSON");
+      tt->enum_def.fields[2].val = INSTRUMENTATION_JSON;
+    tt->single_val.e = INSTRUMENTATION_OFF;
+    tt++;
+    
+    // Parameter 'instrumentationJsonDir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("instrumentationJsonDir");
+    tt->descr = tdrpStrDup("Directory for JSON instrumentation output");
+    tt->help = tdrpStrDup("Used when instrumentation = INSTRUMENTATION_JSON, one file per trigger named yyyymmdd_hhmmss_<trigger>.json");
+    tt->val_offset = (char *) &instrumentationJsonDir - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'num_threads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("num_threads");
+    tt->descr = tdrpStrDup("");
+    tt->help = tdrpStrDup("Number of threads on tiles, 0 or 1 for no threading. Each tile is scanned once for all obs thresholds.");
+    tt->val_offset = (char *) &num_threads - &_start_;
+    tt->single_val.i = 0;
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
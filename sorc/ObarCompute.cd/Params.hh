@@ -65,6 +65,12 @@ class Params {
 
 public:
 
+  typedef enum {
+    INSTRUMENTATION_OFF = 0,
+    INSTRUMENTATION_LOG = 1,
+    INSTRUMENTATION_JSON = 2
+  } Instrumentation_t;
+
   ///////////////////////////
   // Member functions
   //
@@ -368,6 +374,12 @@ public:
   double *_obs_threshold;
   int obs_threshold_n;
 
+  Instrumentation_t instrumentation;
+
+  char* instrumentationJsonDir;
+
+  int num_threads;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -375,7 +387,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[7];
+  mutable TDRPtable _table[11];
 
   const char *_className;
 
@@ -31,6 +31,7 @@
 #include <ConvWx/ParmTiling.hh>
 #include <Epoch/TileInfo.hh>
 #include <ConvWx/ParmFcst.hh>
+#include <ConvWx/Instrumentation.hh>
 #include <vector>
 
 class ParmsObarCompute
@@ -45,6 +46,9 @@ public:
   std::string _obarSpdb;   /**< Obar database URL */
   std::string _inputField;  /**< gridded field name */
   std::vector<double> _obsThreshold;    /**< Observation threshold to compute obar*/
+  Instrumentation::Mode_t _instrumentation; /**< Per trigger timing output */
+  std::string _instrumentationJsonDir;      /**< Where JSON timing goes */
+  int _numThreads;         /**< Threads on tiles, 0 or 1 for none */
   
 protected:
 private:
@@ -87,6 +87,22 @@ ParmsObarComputeIO::ParmsObarComputeIO(int argc, char **argv)
   {
     _obsThreshold.push_back(p._obs_threshold[i]);
   }
+
+  switch (p.instrumentation)
+  {
+  case Params::INSTRUMENTATION_LOG:
+    _instrumentation = Instrumentation::MODE_LOG;
+    break;
+  case Params::INSTRUMENTATION_JSON:
+    _instrumentation = Instrumentation::MODE_JSON;
+    break;
+  case Params::INSTRUMENTATION_OFF:
+  default:
+    _instrumentation = Instrumentation::MODE_OFF;
+    break;
+  }
+  _instrumentationJsonDir = p.instrumentationJsonDir;
+  _numThreads = p.num_threads;
 }
 
 //----------------------------------------------------------------
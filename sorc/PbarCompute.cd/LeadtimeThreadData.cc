@@ -145,6 +145,20 @@ void LeadtimeThreadData::normalizeCountSums(void)
   {
     _aGrid2[i]->normalize();
   }
+
+  // so the tile loops can skip tiles with no data or constant pbar
+  _occupancy1.clear();
+  for (size_t i=0; i<_aGrid1.size(); ++i)
+  {
+    _occupancy1.push_back(TileOccupancy(_params._tileInfo,
+					_aGrid1[i]->dataGridRef()));
+  }
+  _occupancy2.clear();
+  for (size_t i=0; i<_aGrid2.size(); ++i)
+  {
+    _occupancy2.push_back(TileOccupancy(_params._tileInfo,
+					_aGrid2[i]->dataGridRef()));
+  }
 }
 
 //------------------------------------------------------------------------
@@ -162,7 +176,8 @@ void LeadtimeThreadData::normalizeCountSums(void)
     {
       double pBar;
       // pull pbar out of averaging grid at this index (threshold)
-      if (_fcstComputePbarAtThresh(r, _aGrid1[i]->dataGridRef(), pBar))
+      if (_fcstComputePbarAtThresh(r, _occupancy1[i],
+				   _aGrid1[i]->dataGridRef(), pBar))
       {
 	ret.setValue(i, pBar, which);
       }
@@ -174,7 +189,8 @@ void LeadtimeThreadData::normalizeCountSums(void)
     {
       double pBar;
       // pull pbar out of averaging grid at this index (threshold pair)
-      if (_fcstComputePbarAtThresh(r, _aGrid2[i]->dataGridRef(), pBar))
+      if (_fcstComputePbarAtThresh(r, _occupancy2[i],
+				   _aGrid2[i]->dataGridRef(), pBar))
       {
 	ret.setValue(i, pBar, which);
       }
@@ -200,9 +216,20 @@ bool LeadtimeThreadData::useTileBelow(int tileIndex, int &belowTile)
 
 //------------------------------------------------------------------------
 bool LeadtimeThreadData::_fcstComputePbarAtThresh(const TileRange &r,
+						  const TileOccupancy &occupancy,
 						  const Grid &fcst, 
 						  double &pBar) const
 {
+  int tileIndex = r.getTileIndex();
+  if (occupancy.isEmpty(tileIndex))
+  {
+    LOG(WARNING) << "Cannot compute mean forecast data above threshold";
+    return false;
+  }
+  if (occupancy.isConstant(tileIndex, pBar))
+  {
+    return true;
+  }
   bool outOfBounds;
   if (!fcst.meanSubset(r.getX0(), r.getY0(), r.getNx(), r.getNy(),
 		       true, false, pBar, outOfBounds))
@@ -11,6 +11,7 @@
 #include "ParmsPbarComputeIO.hh"
 #include "AdditionalInputs.hh"
 #include <Epoch/AveragingGrids.hh>
+#include <Epoch/TileOccupancy.hh>
 
 class TaThreadDoubleQue;
 class MultiGrid;
@@ -78,7 +79,8 @@ public:
 		       bool hasValue2, double thresholdedValue2);
 
   /**
-   * Normalize all the count/sum averaging grids
+   * Normalize all the count/sum averaging grids, and build the tile
+   * occupancy of each
    */
   void normalizeCountSums(void);
 
@@ -131,9 +133,15 @@ private:
    */
   std::vector<AveragingGrids *> _aGrid2;
 
+  /**
+   * Tile occupancy of each normalized _aGrid1 and _aGrid2 grid
+   */
+  std::vector<TileOccupancy> _occupancy1;
+  std::vector<TileOccupancy> _occupancy2;
 
-  bool _fcstComputePbarAtThresh(const TileRange &r, const Grid &fcst, 
-				double &pBar) const;
+  bool _fcstComputePbarAtThresh(const TileRange &r,
+				const TileOccupancy &occupancy,
+				const Grid &fcst, double &pBar) const;
 };
 
 #endif
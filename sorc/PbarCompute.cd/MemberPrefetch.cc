@@ -0,0 +1,166 @@
+/**
+ * @file MemberPrefetch.cc
+ */
+
+#include "MemberPrefetch.hh"
+#include "ParmsPbarComputeIO.hh"
+#include <ConvWxIO/InterfaceIO.hh>
+#include <ConvWx/Instrumentation.hh>
+#include <ConvWx/PhaseTimer.hh>
+#include <toolsa/LogStream.hh>
+#include <toolsa/DateTime.hh>
+
+using std::string;
+
+//----------------------------------------------------------------------
+MemberPrefetch::MemberPrefetch(const ParmsPbarComputeIO &params,
+			       const time_t &genTime, int leadTime) :
+  _params(params),
+  _genTime(genTime),
+  _leadTime(leadTime),
+  _numMembers(static_cast<int>(params._modelInput.size())),
+  _nextToLoad(0),
+  _stop(false)
+{
+  int depth = params._prefetchDepth;
+  if (depth < 1)
+  {
+    depth = 1;
+  }
+  _buf.resize(depth);
+  _state.resize(depth, SLOT_FREE);
+  _member.resize(depth, -1);
+
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_loaded, NULL);
+  pthread_cond_init(&_freed, NULL);
+
+  int nthread = params._prefetchThreads;
+  if (nthread > depth)
+  {
+    nthread = depth;
+  }
+  if (nthread > _numMembers)
+  {
+    nthread = _numMembers;
+  }
+  for (int i=0; i<nthread; ++i)
+  {
+    pthread_t t;
+    if (pthread_create(&t, NULL, _ioMain, this) == 0)
+    {
+      _threads.push_back(t);
+    }
+    else
+    {
+      LOG(ERROR) << "Could not start prefetch thread " << i;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+MemberPrefetch::~MemberPrefetch(void)
+{
+  pthread_mutex_lock(&_mutex);
+  _stop = true;
+  pthread_cond_broadcast(&_freed);
+  pthread_mutex_unlock(&_mutex);
+  for (size_t i=0; i<_threads.size(); ++i)
+  {
+    pthread_join(_threads[i], NULL);
+  }
+  pthread_cond_destroy(&_freed);
+  pthread_cond_destroy(&_loaded);
+  pthread_mutex_destroy(&_mutex);
+}
+
+//----------------------------------------------------------------------
+const MultiFcstGrid *MemberPrefetch::get(int index)
+{
+  int k = index % static_cast<int>(_buf.size());
+  pthread_mutex_lock(&_mutex);
+  if (_threads.empty() && _member[k] != index)
+  {
+    // no I/O threads, load here
+    _member[k] = index;
+    _state[k] = _load(index, _buf[k]) ? SLOT_READY : SLOT_FAILED;
+  }
+  while (_member[k] != index || _state[k] == SLOT_FREE ||
+	 _state[k] == SLOT_LOADING)
+  {
+    pthread_cond_wait(&_loaded, &_mutex);
+  }
+  bool ok = _state[k] == SLOT_READY;
+  pthread_mutex_unlock(&_mutex);
+  if (ok)
+  {
+    return &_buf[k];
+  }
+  else
+  {
+    return NULL;
+  }
+}
+
+//----------------------------------------------------------------------
+void MemberPrefetch::release(int index)
+{
+  int k = index % static_cast<int>(_buf.size());
+  pthread_mutex_lock(&_mutex);
+  if (_member[k] == index)
+  {
+    _state[k] = SLOT_FREE;
+    pthread_cond_broadcast(&_freed);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+//----------------------------------------------------------------------
+void *MemberPrefetch::_ioMain(void *prefetch)
+{
+  MemberPrefetch *p = static_cast<MemberPrefetch *>(prefetch);
+  int depth = static_cast<int>(p->_buf.size());
+
+  pthread_mutex_lock(&p->_mutex);
+  while (!p->_stop && p->_nextToLoad < p->_numMembers)
+  {
+    // back pressure: wait until the buffer for the next member is free
+    int index = p->_nextToLoad;
+    int k = index % depth;
+    if (p->_state[k] != SLOT_FREE)
+    {
+      pthread_cond_wait(&p->_freed, &p->_mutex);
+      continue;
+    }
+    ++p->_nextToLoad;
+    p->_member[k] = index;
+    p->_state[k] = SLOT_LOADING;
+    pthread_mutex_unlock(&p->_mutex);
+
+    // the buffer belongs to this thread until it is marked loaded
+    bool ok = p->_load(index, p->_buf[k]);
+
+    pthread_mutex_lock(&p->_mutex);
+    p->_state[k] = ok ? SLOT_READY : SLOT_FAILED;
+    pthread_cond_broadcast(&p->_loaded);
+  }
+  pthread_mutex_unlock(&p->_mutex);
+  return NULL;
+}
+
+//----------------------------------------------------------------------
+bool MemberPrefetch::_load(int index, MultiFcstGrid &grid) const
+{
+  string url = _params._modelInput[index].pUrl;
+  LOG(DEBUG_VERBOSE) << "Loading model data from " << url;
+  if (!InterfaceIO::loadMultiFcst(_genTime, _leadTime, _params._proj,
+				  url, _params._inputFieldNames,
+				  _params._modelInput[index].pRemap, grid))
+  {
+    LOG(WARNING) << "Failure to load fcst data at "
+		 << DateTime::strn(_genTime) << "+" << _leadTime
+		 << " from url " << url;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file MemberPrefetch.hh
+ * @brief Reads ensemble members ahead of the counting, for one lead time
+ * @class MemberPrefetch
+ * @brief Reads ensemble members ahead of the counting, for one lead time
+ *
+ * A small pool of I/O threads loads members, in order, into a ring of
+ * depth reusable buffers while the caller processes earlier members.
+ * Member i goes into buffer i % depth, and is not loaded until the caller
+ * has released member i - depth, so at most depth members are in memory.
+ *
+ * @code
+ *   MemberPrefetch p(params, genTime, leadTime);
+ *   for (i=0; i<n; ++i)
+ *   {
+ *     const MultiFcstGrid *g = p.get(i);
+ *     if (g != NULL) ... use g ...
+ *     p.release(i);
+ *   }
+ * @endcode
+ */
+
+#ifndef MemberPrefetch_HH
+#define MemberPrefetch_HH
+
+#include <ConvWx/MultiFcstGrid.hh>
+#include <vector>
+#include <ctime>
+#include <pthread.h>
+
+class ParmsPbarComputeIO;
+
+class MemberPrefetch
+{
+public:
+
+  /**
+   * Constructor, starts the I/O threads
+   * @param[in] params  Parameters, with the member URLs, field names and
+   *                    prefetch depth and thread count, depth must be > 0
+   * @param[in] genTime
+   * @param[in] leadTime
+   */
+  MemberPrefetch(const ParmsPbarComputeIO &params, const time_t &genTime,
+		 int leadTime);
+
+  /**
+   * Destructor, stops the I/O threads
+   */
+  ~MemberPrefetch(void);
+
+  /**
+   * Wait for a member to be loaded
+   * @param[in] index  Member index, called in increasing order
+   * @return pointer to the member's grids, or NULL if it could not be
+   *         loaded. Valid until release(index)
+   */
+  const MultiFcstGrid *get(int index);
+
+  /**
+   * Done with a member, its buffer can be reused
+   * @param[in] index  Member index
+   */
+  void release(int index);
+
+private:
+
+  /**
+   * @enum Slot_t
+   * @brief State of one buffer
+   */
+  typedef enum
+  {
+    SLOT_FREE,     /**< Available for the next member */
+    SLOT_LOADING,  /**< An I/O thread is loading into it */
+    SLOT_READY,    /**< Loaded successfully */
+    SLOT_FAILED    /**< Load failed */
+  } Slot_t;
+
+  const ParmsPbarComputeIO &_params; /**< Parameters */
+  time_t _genTime;                   /**< Gen time */
+  int _leadTime;                     /**< Lead time */
+  int _numMembers;                   /**< Number of members */
+  std::vector<MultiFcstGrid> _buf;   /**< The ring of buffers */
+  std::vector<Slot_t> _state;        /**< State of each buffer */
+  std::vector<int> _member;          /**< Member in each buffer */
+  int _nextToLoad;                   /**< Next member for an I/O thread */
+  bool _stop;                        /**< True to end the I/O threads */
+  pthread_mutex_t _mutex;            /**< Protects all of the above */
+  pthread_cond_t _loaded;            /**< Signaled when a load finishes */
+  pthread_cond_t _freed;             /**< Signaled when a buffer is freed */
+  std::vector<pthread_t> _threads;   /**< The I/O threads */
+
+  /**
+   * I/O thread main loop
+   */
+  static void *_ioMain(void *prefetch);
+
+  /**
+   * Load one member into one buffer
+   * @param[in] index  Member index
+   * @param[out] grid  Buffer
+   * @return true if loaded
+   */
+  bool _load(int index, MultiFcstGrid &grid) const;
+
+  MemberPrefetch(const MemberPrefetch &);
+  MemberPrefetch &operator=(const MemberPrefetch &);
+};
+
+#endif
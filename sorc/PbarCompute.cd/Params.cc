@@ -946,6 +946,184 @@
     tt->single_val.b = pFALSE;
     tt++;
     
+    // Parameter 'Comment 1'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 1");
+    tt->comment_hdr = tdrpStrDup("GRID HANDOFF");
+    tt->comment_text = tdrpStrDup("Optionally take forecast input from a shared memory queue published by the upstream app (PrecipAccumCalc), instead of reading the files.  Anything not found in the queue, or with a different projection, is read from the file as usual.");
+    tt++;
+    
+    // Parameter 'gridHandoff'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoff");
+    tt->descr = tdrpStrDup("Set TRUE to look for input in the grid handoff queue");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &gridHandoff - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'gridHandoffUrl'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffUrl");
+    tt->descr = tdrpStrDup("Grid handoff queue");
+    tt->help = tdrpStrDup("Must agree with the publisher.");
+    tt->val_offset = (char *) &gridHandoffUrl - &_start_;
+    tt->single_val.s = tdrpStrDup("/tmp/fmq/shmem_27000");
+    tt++;
+    
+    // Parameter 'gridHandoffNumSlots'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffNumSlots");
+    tt->descr = tdrpStrDup("Number of slots in the grid handoff queue");
+    tt->help = tdrpStrDup("Must agree with the publisher.");
+    tt->val_offset = (char *) &gridHandoffNumSlots - &_start_;
+    tt->single_val.i = 100;
+    tt++;
+    
+    // Parameter 'gridHandoffBufSize'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffBufSize");
+    tt->descr = tdrpStrDup("Size of the grid handoff queue buffer (bytes)");
+    tt->help = tdrpStrDup("Must agree with the publisher.");
+    tt->val_offset = (char *) &gridHandoffBufSize - &_start_;
+    tt->single_val.i = 500000000;
+    tt++;
+    
+    // Parameter 'gridHandoffMaxEntries'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffMaxEntries");
+    tt->descr = tdrpStrDup("Number of forecasts to keep in memory from the queue");
+    tt->help = tdrpStrDup("Zero or less to hold two generation times, members times lead times times two, so that every input of a trigger can come from memory.  Forecasts of the oldest generation time are dropped first.  Each one is all the fields for one member and lead time, as float32.");
+    tt->val_offset = (char *) &gridHandoffMaxEntries - &_start_;
+    tt->single_val.i = 0;
+    tt++;
+    
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("INSTRUMENTATION");
+    tt->comment_text = tdrpStrDup("Per trigger timing of the processing phases (load, count, tile stats, SPDB read/write, MDV write), broken down by thread");
+    tt++;
+    
+    // Parameter 'instrumentation'
+    // ctype is 'Instrumentation_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = ENUM_TYPE;
+    tt->param_name = tdrpStrDup("instrumentation");
+    tt->descr = tdrpStrDup("Instrumentation output");
+    tt->help = tdrpStrDup("OFF for none. LOG to log summary lines after each trigger. JSON to also write a JSON file to instrumentationJsonDir after each trigger.");
+    tt->val_offset = (char *) &instrumentation - &_start_;
+    tt->enum_def.name = tdrpStrDup("Instrumentation_t");
+    tt->enum_def.nfields = 3;
+    tt->enum_def.fields = (enum_field_t *)
+        tdrpMalloc(tt->enum_def.nfields * sizeof(enum_field_t));
+      tt->enum_def.fields[0].name = tdrpStrDup("INSTRUMENTATION_OFF");
+      tt->enum_def.fields[0].val = INSTRUMENTATION_OFF;
+      tt->enum_def.fields[1].name = tdrpStrDup("INSTRUMENTATION_LOG");
+      tt->enum_def.fields[1].val = INSTRUMENTATION_LOG;
+      tt->enum_def.fields[2].name = tdrpStrDup("INSTRUMENTATION_JSON");
+      tt->enum_def.fields[2].val = INSTRUMENTATION_JSON;
+    tt->single_val.e = INSTRUMENTATION_OFF;
+    tt++;
+    
+    // Parameter 'instrumentationJsonDir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("instrumentationJsonDir");
+    tt->descr = tdrpStrDup("Directory for JSON instrumentation output");
+    tt->help = tdrpStrDup("Used when instrumentation = INSTRUMENTATION_JSON, one file per trigger named yyyymmdd_hhmmss_<trigger>.json");
+    tt->val_offset = (char *) &instrumentationJsonDir - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
+    // Parameter 'Comment 3'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 3");
+    tt->comment_hdr = tdrpStrDup("MEMBER PREFETCH");
+    tt->comment_text = tdrpStrDup("Within each lead time thread, ensemble members are read ahead by I/O threads while the current member is being counted");
+    tt++;
+    
+    // Parameter 'prefetchDepth'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("prefetchDepth");
+    tt->descr = tdrpStrDup("Number of ensemble members read ahead of the one being counted");
+    tt->help = tdrpStrDup("Each lead time thread holds at most this many members in memory, so memory use is about num_threads * prefetchDepth * (all fields for one member). 0 to read each member only when it is needed.");
+    tt->val_offset = (char *) &prefetchDepth - &_start_;
+    tt->single_val.i = 2;
+    tt++;
+    
+    // Parameter 'prefetchThreads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("prefetchThreads");
+    tt->descr = tdrpStrDup("Number of I/O threads reading ahead, per lead time thread");
+    tt->help = tdrpStrDup("Used when prefetchDepth > 0. No more than prefetchDepth are used.");
+    tt->val_offset = (char *) &prefetchThreads - &_start_;
+    tt->single_val.i = 1;
+    tt++;
+    
+    // Parameter 'Comment 4'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 4");
+    tt->comment_hdr = tdrpStrDup("STREAMING");
+    tt->comment_text = tdrpStrDup("Process each ensemble member as it arrives rather than waiting for the whole gen time");
+    tt++;
+    
+    // Parameter 'streaming'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("streaming");
+    tt->descr = tdrpStrDup("True to count each member as soon as it arrives");
+    tt->help = tdrpStrDup("Counts for each lead time are accumulated as members arrive. A lead time is finished (tile pbar computed and SPDB written) as soon as all its members have arrived, or the URL timeout (urlTimeoutMinutes) expires. The SPDB output for the gen time is rewritten as each lead time finishes. If false, nothing is done until all lead times of a gen time have triggered.");
+    tt->val_offset = (char *) &streaming - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'streamingCheckpointDir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("streamingCheckpointDir");
+    tt->descr = tdrpStrDup("Directory for the streaming checkpoint files");
+    tt->help = tdrpStrDup("Used when streaming = TRUE. For each lead time being accumulated, the members counted so far are recorded here, in yyyymmdd/hhmmss_<lead>.members. After a restart those members are counted again so no partial counts are lost. Empty for no checkpointing.");
+    tt->val_offset = (char *) &streamingCheckpointDir - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
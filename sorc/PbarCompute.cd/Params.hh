@@ -49,6 +49,12 @@ public:
     LESS_THAN_OR_EQUAL = 1
   } Comparison_t;
 
+  typedef enum {
+    INSTRUMENTATION_OFF = 0,
+    INSTRUMENTATION_LOG = 1,
+    INSTRUMENTATION_JSON = 2
+  } Instrumentation_t;
+
   ///////////////////////////
   // Member functions
   //
@@ -402,6 +408,28 @@ public:
 
   tdrp_bool_t debug_state;
 
+  tdrp_bool_t gridHandoff;
+
+  char* gridHandoffUrl;
+
+  int gridHandoffNumSlots;
+
+  int gridHandoffBufSize;
+
+  int gridHandoffMaxEntries;
+
+  Instrumentation_t instrumentation;
+
+  char* instrumentationJsonDir;
+
+  int prefetchDepth;
+
+  int prefetchThreads;
+
+  tdrp_bool_t streaming;
+
+  char* streamingCheckpointDir;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -409,7 +437,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[31];
+  mutable TDRPtable _table[46];
 
   const char *_className;
 
@@ -16,6 +16,7 @@
 #include <ConvWx/ParmMain.hh>
 #include <ConvWx/ParmTiling.hh>
 #include <ConvWx/Grid.hh>
+#include <ConvWx/Instrumentation.hh>
 
 #include <string>
 #include <vector>
@@ -144,6 +145,33 @@ public:
    */
   bool _debugState;
   
+  /**
+   * Grid handoff queue input (see InterfaceIO::setGridHandoffSubscriber())
+   */
+  bool _gridHandoff;              /**< True to use the queue */
+  std::string _gridHandoffUrl;    /**< Queue location */
+  int _gridHandoffNumSlots;       /**< Queue slots */
+  int _gridHandoffBufSize;        /**< Queue buffer size */
+  int _gridHandoffMaxEntries;     /**< Forecasts to keep in memory */
+
+  /**
+   * Read ahead of ensemble members within a lead time (see MemberPrefetch)
+   */
+  int _prefetchDepth;     /**< Members held in memory, 0 for no read ahead */
+  int _prefetchThreads;   /**< I/O threads per lead time thread */
+
+  /**
+   * Count members as they arrive (see StreamingLead)
+   */
+  bool _streaming;
+  std::string _streamingCheckpointDir;  /**< Where checkpoints go */
+
+  /**
+   * Per gen time timing output (see Instrumentation)
+   */
+  Instrumentation::Mode_t _instrumentation;
+  std::string _instrumentationJsonDir;  /**< Where JSON timing goes */
+
   /**
    * @return true if value passed test relative to currentThresh 
    * @param[in] value
@@ -178,6 +178,31 @@ ParmsPbarComputeIO::ParmsPbarComputeIO(int argc, char **argv)
 
   _numThreads = params.num_threads;
   _debugState = params.debug_state;
+
+  _gridHandoff = params.gridHandoff;
+  _gridHandoffUrl = params.gridHandoffUrl;
+  _gridHandoffNumSlots = params.gridHandoffNumSlots;
+  _gridHandoffBufSize = params.gridHandoffBufSize;
+  _gridHandoffMaxEntries = params.gridHandoffMaxEntries;
+  _prefetchDepth = params.prefetchDepth;
+  _prefetchThreads = params.prefetchThreads;
+  _streaming = params.streaming;
+  _streamingCheckpointDir = params.streamingCheckpointDir;
+
+  switch (params.instrumentation)
+  {
+  case Params::INSTRUMENTATION_LOG:
+    _instrumentation = Instrumentation::MODE_LOG;
+    break;
+  case Params::INSTRUMENTATION_JSON:
+    _instrumentation = Instrumentation::MODE_JSON;
+    break;
+  case Params::INSTRUMENTATION_OFF:
+  default:
+    _instrumentation = Instrumentation::MODE_OFF;
+    break;
+  }
+  _instrumentationJsonDir = params.instrumentationJsonDir;
 }
 
 //-----------------------------------------------------------------
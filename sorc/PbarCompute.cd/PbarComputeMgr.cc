@@ -6,12 +6,15 @@
 #include "Info.hh"
 #include "LeadtimeThreadData.hh"
 #include "PbarVector.hh"
+#include "MemberPrefetch.hh"
+#include "StreamingLead.hh"
 #include <Epoch/SpdbPbarHandler2.hh>
 #include <Epoch/TileRange.hh>
 #include <ConvWxIO/InterfaceIO.hh>
 #include <ConvWx/FcstGrid.hh>
 #include <ConvWx/MultiFcstGrid.hh>
 #include <ConvWx/InterfaceLL.hh>
+#include <ConvWx/PhaseTimer.hh>
 #include <dsdata/DsEnsembleLeadTrigger.hh>
 #include <toolsa/LogStream.hh>
 #include <toolsa/DateTime.hh>
@@ -57,6 +60,15 @@ TaThread *PbarComputeMgr::PbarComputeThreads::clone(int index)
   return dynamic_cast<TaThread *>(t);
 }
 
+//----------------------------------------------------------------------
+TaThread *PbarComputeMgr::PbarStreamThreads::clone(int index)
+{
+  TaThreadSimple *t = new TaThreadSimple(index);
+  t->setThreadContext(this);
+  t->setThreadMethod(PbarComputeMgr::computeStream);
+  return dynamic_cast<TaThread *>(t);
+}
+
 //----------------------------------------------------------------------
 PbarComputeMgr::
 PbarComputeMgr(const ParmsPbarComputeIO &params, void cleanExit(int)):
@@ -64,7 +76,8 @@ PbarComputeMgr(const ParmsPbarComputeIO &params, void cleanExit(int)):
   _trigger(NULL),
   _latestGen(0),
   _state(),
-  _pbarSpdb(_params._pbarSpdb)
+  _pbarSpdb(_params._pbarSpdb),
+  _streamGen(0)
 {
   time_t t = time(0);
   LOG(DEBUG) << "Restarted at " << DateTime::strn(t);
@@ -96,6 +109,31 @@ PbarComputeMgr(const ParmsPbarComputeIO &params, void cleanExit(int)):
 					 params._leadSeconds);
   }
   _thread.init(params._numThreads, false);
+  if (params._streaming)
+  {
+    LOG(DEBUG) << "Streaming, members counted as they arrive";
+    _trigger->setMemberEvents(true);
+    _streamThread.init(params._numThreads, false);
+  }
+  if (params._gridHandoff)
+  {
+    // by default, every member and lead of two generation times
+    int maxEntries = params._gridHandoffMaxEntries;
+    if (maxEntries <= 0)
+    {
+      maxEntries = 2*static_cast<int>(params._modelUrls.size()*
+				       params._leadSeconds.size());
+    }
+    if (!InterfaceIO::setGridHandoffSubscriber(params._gridHandoffUrl,
+					       params._gridHandoffNumSlots,
+					       params._gridHandoffBufSize,
+					       maxEntries))
+    {
+      LOG(WARNING) << "No grid handoff, reading all input from files";
+    }
+  }
+  Instrumentation::setMode(params._instrumentation,
+			   params._instrumentationJsonDir);
   LOG(DEBUG) << "end of constructor";
 }
 
@@ -103,6 +141,12 @@ PbarComputeMgr(const ParmsPbarComputeIO &params, void cleanExit(int)):
 PbarComputeMgr::~PbarComputeMgr()
 {
   _thread.waitForThreads();
+  if (_params._streaming)
+  {
+    // checkpoints stay so a restart picks up where this left off
+    _streamThread.waitForThreads();
+    _streamClear(false);
+  }
   if (_trigger != NULL)
   {
     delete _trigger;
@@ -123,6 +167,12 @@ bool PbarComputeMgr::run(void)
   vector<string> url;
   bool complete;
  
+  if (_params._streaming)
+  {
+    _runStreaming();
+    return true;
+  }
+
   // Process data while trigger returns valid generation and lead time pair
   LOG(DEBUG) << "Triggering";
   
@@ -175,19 +225,9 @@ void PbarComputeMgr::_process(const time_t &genTime, int leadTime,
 void PbarComputeMgr::_processGenTime(const time_t &genTime)
 {
   _genTime = genTime;
+  PhaseTimer timer("trigger");
 
-  SpdbPbarMetadata2 pmeta(genTime, _params._ltHours, _params._tileInfo,
-			  _params._inputThresholdedField1,
-			  _params._inputThresholdedField2,
-			  _params._thresh1, _params._thresh2,
-			  _params._hasFixedField1,
-			  _params._inputFixedField1,
-			  _params._fixedFieldThresh1,
-			  _params._hasFixedField2,
-			  _params._inputFixedField2,
-			  _params._fixedFieldThresh2);
-  
-  _pbarSpdb = SpdbPbarHandler2(_params._pbarSpdb, pmeta);  
+  _setPbarSpdb(genTime);
 
   _modified = false;
   for (size_t i=0; i<_state.size(); ++i)
@@ -199,8 +239,15 @@ void PbarComputeMgr::_processGenTime(const time_t &genTime)
   _thread.waitForThreads();
   if (_modified)
   {
+    PhaseTimer t("spdbWrite");
     _pbarSpdb.write();
   }
+  timer.stop();
+  string s = Instrumentation::report("PbarCompute", genTime);
+  if (!s.empty())
+  {
+    LOG(PRINT) << s;
+  }
 }    
 
 //----------------------------------------------------------------------
@@ -234,9 +281,41 @@ bool PbarComputeMgr::_processGenLead(const time_t &genTime,
   ltData.setupCountSums(egrid);
 
   // now loop through the ensembles
-  for (size_t i=0; i<_params._modelInput.size(); ++i)
+  int nmember = static_cast<int>(_params._modelInput.size());
+  if (_params._prefetchDepth > 0)
   {
-    _processEnsembleMember(genTime, leadTime, i, ltData);
+    // members are read ahead while earlier ones are counted
+    MemberPrefetch prefetch(_params, genTime, leadTime);
+    for (int i=0; i<nmember; ++i)
+    {
+      PhaseTimer wait("loadWait");
+      const MultiFcstGrid *mInGrid = prefetch.get(i);
+      wait.stop();
+      _processEnsembleMember(genTime, leadTime, i, mInGrid, ltData);
+      prefetch.release(i);
+    }
+  }
+  else
+  {
+    for (int i=0; i<nmember; ++i)
+    {
+      MultiFcstGrid mInGrid;
+      string url = _params._modelInput[i].pUrl;
+      LOG(DEBUG_VERBOSE) << "Loading model data from " << url;
+      if (InterfaceIO::loadMultiFcst(genTime, leadTime, _params._proj, 
+				     url, _params._inputFieldNames,
+				     _params._modelInput[i].pRemap, mInGrid))
+      {
+	_processEnsembleMember(genTime, leadTime, i, &mInGrid, ltData);
+      }
+      else
+      {
+	LOG(WARNING) << "Failure to load fcst data at "
+		     << DateTime::strn(genTime) << "+" << leadTime
+		     << " from url " << url;
+	_processEnsembleMember(genTime, leadTime, i, NULL, ltData);
+      }
+    }
   }
   
   // hopeless if grid1 was not go
@@ -246,6 +325,7 @@ bool PbarComputeMgr::_processGenLead(const time_t &genTime,
     return false;
   }
   LOG(DEBUG_VERBOSE) << "Normalizing results";
+  PhaseTimer t("count");
   ltData.normalizeCountSums();
   return true;
 }
@@ -254,37 +334,34 @@ bool PbarComputeMgr::_processGenLead(const time_t &genTime,
 void PbarComputeMgr::_processEnsembleMember(const time_t &genTime,
 					      int leadTime,
 					      int ensembleIndex,
+					      const MultiFcstGrid *mInGrid,
 					      LeadtimeThreadData &ltData)
 {
-  MultiFcstGrid mInGrid;
-  string url = _params._modelInput[ensembleIndex].pUrl;
-  LOG(DEBUG_VERBOSE) << "Loading model data from " << url;
-  if (!InterfaceIO::loadMultiFcst(genTime, leadTime, _params._proj, 
-				  url, _params._inputFieldNames,
-				  _params._modelInput[ensembleIndex].pRemap,
-				  mInGrid))
+  if (mInGrid == NULL)
   {
-    LOG(WARNING) << "Failure to load fcst data at "
-		  << DateTime::strn(genTime) << "+" << leadTime  << " from url " << url;
+    Instrumentation::addCount("membersMissing");
     return;
   }
+  Instrumentation::addCount("membersLoaded");
+  string url = _params._modelInput[ensembleIndex].pUrl;
 
   LOG(DEBUG_VERBOSE) << "Got model data at " << DateTime::strn(genTime)
 		     << "+" << leadTime << " from url " << url;
 
-  const Grid *thresholdedGrid1 = mInGrid.constGridPtr(_params._inputThresholdedField1);
-  const Grid *thresholdedGrid2 = mInGrid.constGridPtr(_params._inputThresholdedField2);
+  const Grid *thresholdedGrid1 = mInGrid->constGridPtr(_params._inputThresholdedField1);
+  const Grid *thresholdedGrid2 = mInGrid->constGridPtr(_params._inputThresholdedField2);
   if (thresholdedGrid1 == NULL || thresholdedGrid2 == NULL)
   {
     LOG(ERROR) << "Could not set  pointers to ensemble data";
     return;
   }
-  if (!ltData.setAdditionalGridPointers(mInGrid))
+  if (!ltData.setAdditionalGridPointers(*mInGrid))
   {
     LOG(ERROR) << "Could not set additional input pointers to ensemble data";
     return;
   }
 
+  PhaseTimer t("count");
   for (int gridIndex=0; gridIndex<thresholdedGrid1->getNdata(); ++gridIndex)
   {
     double thresholdedValue1, thresholdedValue2;
@@ -325,6 +402,8 @@ PbarComputeMgr::_processTiles(const time_t &genTime,
 			      const ForecastState::LeadStatus_t s,
 			      LeadtimeThreadData &ltData)
 {
+  PhaseTimer t("tileStats");
+
   // do the mothertile first
   int motherIndex = TileInfo::motherTileIndex();
   _setupAndRunAlg(ltData, motherIndex);
@@ -363,3 +442,258 @@ void PbarComputeMgr::_setupAndRunAlg(LeadtimeThreadData &ltData,
   _pbarSpdb.setPbarForAllThresh(ltData.getLeadSeconds(), tileIndex, pbar.getPbar(), 2);
   _thread.unlockAfterIO();
 }
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_setPbarSpdb(const time_t &genTime)
+{
+  SpdbPbarMetadata2 pmeta(genTime, _params._ltHours, _params._tileInfo,
+			  _params._inputThresholdedField1,
+			  _params._inputThresholdedField2,
+			  _params._thresh1, _params._thresh2,
+			  _params._hasFixedField1,
+			  _params._inputFixedField1,
+			  _params._fixedFieldThresh1,
+			  _params._hasFixedField2,
+			  _params._inputFixedField2,
+			  _params._fixedFieldThresh2);
+  
+  _pbarSpdb = SpdbPbarHandler2(_params._pbarSpdb, pmeta);  
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::computeStream(void *ti)
+{
+  StreamTask *task = static_cast<StreamTask *>(ti);
+  task->_alg->_streamCount(*task->_lead, task->_url);
+  delete task;
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_runStreaming(void)
+{
+  time_t genTime;
+  int leadTime;
+  vector<string> url;
+  bool complete, member;
+
+  LOG(DEBUG) << "Triggering, streaming";
+  while (_trigger->nextTrigger(genTime, leadTime, url, complete, member))
+  {
+    if (member)
+    {
+      _streamMember(genTime, leadTime, url[0]);
+    }
+    else
+    {
+      _streamFinish(genTime, leadTime, url, complete);
+    }
+  }
+  _streamThread.waitForThreads();
+  LOG(DEBUG) << "No more triggering";
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_streamMember(const time_t &genTime, int leadTime,
+				   const std::string &url)
+{
+  LOG(DEBUG_VERBOSE) << "Member arrived " << DateTime::strn(genTime) << "+"
+		     << leadTime << " " << url;
+  _streamSetGen(genTime);
+  _streamQueue(_streamLead(leadTime), url);
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_streamFinish(const time_t &genTime, int leadTime,
+				   const std::vector<std::string> &url,
+				   bool complete)
+{
+  LOG(DEBUG) << "Finishing " << DateTime::strn(genTime) << "+" << leadTime
+	     << " with " << url.size() << " URLs, "
+	     << (complete ? "Complete" : "Incomplete");
+  _streamSetGen(genTime);
+  StreamingLead *lead = _streamLead(leadTime);
+
+  // anything the trigger has that was not counted yet
+  for (size_t i=0; i<url.size(); ++i)
+  {
+    _streamQueue(lead, url[i]);
+  }
+  _streamThread.waitForThreads();
+
+  PhaseTimer timer("trigger");
+  bool ok = lead->isSetup() && lead->data().agrid1WasModified();
+  if (ok)
+  {
+    {
+      PhaseTimer t("count");
+      lead->data().normalizeCountSums();
+    }
+    ForecastState::LeadStatus_t s;
+    s.leadSeconds = leadTime;
+    s.fcstTriggered = true;
+    _processTiles(genTime, s, lead->data());
+    PhaseTimer t("spdbWrite");
+    _pbarSpdb.write();
+  }
+  else
+  {
+    LOG(ERROR) << "No data at all for " << DateTime::strn(genTime) << "+"
+	       << leadTime << ", nothing possible";
+  }
+  lead->removeCheckpoint();
+  delete lead;
+  _streamLeads.erase(leadTime);
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_streamSetGen(const time_t &genTime)
+{
+  if (genTime == _streamGen)
+  {
+    return;
+  }
+  _streamThread.waitForThreads();
+  if (_streamGen != 0)
+  {
+    if (!_streamLeads.empty())
+    {
+      LOG(WARNING) << _streamLeads.size() << " lead times never finished at "
+		   << DateTime::strn(_streamGen);
+    }
+    _streamClear(true);
+    string s = Instrumentation::report("PbarCompute", _streamGen);
+    if (!s.empty())
+    {
+      LOG(PRINT) << s;
+    }
+  }
+  _streamGen = genTime;
+  _genTime = genTime;
+
+  // keep lead times written before a restart
+  SpdbPbarHandler2 existing(_params._pbarSpdb);
+  if (existing.read(genTime))
+  {
+    LOG(DEBUG) << "Adding to existing pbar at " << DateTime::strn(genTime);
+    _pbarSpdb = existing;
+  }
+  else
+  {
+    _setPbarSpdb(genTime);
+  }
+}
+
+//----------------------------------------------------------------
+StreamingLead *PbarComputeMgr::_streamLead(int leadTime)
+{
+  std::map<int, StreamingLead *>::iterator i = _streamLeads.find(leadTime);
+  if (i != _streamLeads.end())
+  {
+    return i->second;
+  }
+
+  StreamingLead *lead = new StreamingLead(_params, _streamGen, leadTime,
+					  _params._streamingCheckpointDir);
+  _streamLeads[leadTime] = lead;
+
+  // count again whatever was counted before a restart
+  vector<string> urls = lead->checkpointMembers();
+  if (!urls.empty())
+  {
+    LOG(DEBUG) << "Restoring " << urls.size() << " members from checkpoint "
+	       << DateTime::strn(_streamGen) << "+" << leadTime;
+  }
+  for (size_t j=0; j<urls.size(); ++j)
+  {
+    _streamQueue(lead, urls[j]);
+  }
+  return lead;
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_streamQueue(StreamingLead *lead, const std::string &url)
+{
+  lead->lock();
+  bool has = lead->hasMember(url);
+  lead->unlock();
+  if (has)
+  {
+    return;
+  }
+  StreamTask *task = new StreamTask();
+  task->_alg = this;
+  task->_lead = lead;
+  task->_url = url;
+  _streamThread.thread(static_cast<int>(_streamLeads.size()), task);
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_streamCount(StreamingLead &lead, const std::string &url)
+{
+  int index = -1;
+  for (size_t i=0; i<_params._modelInput.size(); ++i)
+  {
+    if (_params._modelInput[i].pUrl == url)
+    {
+      index = static_cast<int>(i);
+      break;
+    }
+  }
+  if (index < 0)
+  {
+    LOG(ERROR) << "URL not configured " << url;
+    return;
+  }
+
+  // load without the lock so members of one lead time load in parallel
+  time_t gt = lead.getGenTime();
+  int lt = lead.getLeadSeconds();
+  MultiFcstGrid mInGrid;
+  if (!InterfaceIO::loadMultiFcst(gt, lt, _params._proj, url,
+				  _params._inputFieldNames,
+				  _params._modelInput[index].pRemap, mInGrid))
+  {
+    LOG(WARNING) << "Failure to load fcst data at "
+		 << DateTime::strn(gt) << "+" << lt << " from url " << url;
+    Instrumentation::addCount("membersMissing");
+    return;
+  }
+
+  lead.lock();
+  if (!lead.hasMember(url))
+  {
+    if (!lead.isSetup())
+    {
+      const Grid *egrid = mInGrid.constGridPtr(_params._inputThresholdedField1);
+      if (egrid != NULL)
+      {
+	lead.setup(*egrid);
+      }
+    }
+    if (lead.isSetup())
+    {
+      _processEnsembleMember(gt, lt, index, &mInGrid, lead.data());
+      lead.addMember(url);
+    }
+    else
+    {
+      LOG(ERROR) << "No " << _params._inputThresholdedField1 << " in " << url;
+    }
+  }
+  lead.unlock();
+}
+
+//----------------------------------------------------------------
+void PbarComputeMgr::_streamClear(bool removeCheckpoints)
+{
+  std::map<int, StreamingLead *>::iterator i;
+  for (i=_streamLeads.begin(); i!=_streamLeads.end(); ++i)
+  {
+    if (removeCheckpoints)
+    {
+      i->second->removeCheckpoint();
+    }
+    delete i->second;
+  }
+  _streamLeads.clear();
+}
@@ -16,9 +16,12 @@
 #include <Epoch/SpdbPbarHandler2.hh>
 #include <dsdata/DsUrlTrigger.hh>
 #include <toolsa/TaThreadDoubleQue.hh>
+#include <map>
 
 class DsEnsembleLeadTrigger;
 class LeadtimeThreadData;
+class MultiFcstGrid;
+class StreamingLead;
 
 class PbarComputeMgr
 {
@@ -49,6 +52,12 @@ public:
    */
   static void compute(void *i);
 
+  /**
+   * Method needed for threading in streaming mode
+   * @param[in] i  StreamTask pointer
+   */
+  static void computeStream(void *i);
+
 protected:
 private:
 
@@ -64,6 +73,30 @@ private:
     TaThread *clone(int index);
   };
 
+  /**
+   * @class PbarStreamThreads
+   * @brief Instantiation to implement the clone() method, streaming mode
+   */
+  class PbarStreamThreads : public TaThreadDoubleQue
+  {
+  public:
+    inline PbarStreamThreads(void) : TaThreadDoubleQue() {}
+    inline virtual ~PbarStreamThreads(void) {}
+    TaThread *clone(int index);
+  };
+
+  /**
+   * @class StreamTask
+   * @brief One member to count in streaming mode
+   */
+  class StreamTask
+  {
+  public:
+    PbarComputeMgr *_alg;   /**< Pointer to context */
+    StreamingLead *_lead;   /**< Where to count it */
+    std::string _url;       /**< The member */
+  };
+
 
   /**
    *  User defined parameters
@@ -85,18 +118,38 @@ private:
    * True if a lead time modified the state, used during threading and checked after
    */
   bool _modified;
-  
+
+  PbarStreamThreads _streamThread;  /**< Threading, streaming mode */
+  time_t _streamGen;                /**< Gen time being streamed */
+
+  /**
+   * Lead times being accumulated at _streamGen, streaming mode
+   */
+  std::map<int, StreamingLead *> _streamLeads;
+
 
   void _process(const time_t &genTime, int leadTime, size_t num, bool complete);
   void _processGenTime(const time_t &genTime);
   bool _processGenLead(const time_t &gt, const ForecastState::LeadStatus_t st,
 		       LeadtimeThreadData &ltData);
   void _processEnsembleMember(const time_t &genTime, int leadTime,int ensembleIndex,
+			      const MultiFcstGrid *mInGrid,
 			      LeadtimeThreadData &ltData);
   bool _loadExampleInputData(const time_t &genTime, int leadTime, FcstGrid &grid) const;
   bool _processTiles(const time_t &genTime, const ForecastState::LeadStatus_t s,
 		     LeadtimeThreadData &ltData);
   void _setupAndRunAlg(LeadtimeThreadData &ltData, int tileIndex);
+  void _setPbarSpdb(const time_t &genTime);
+  void _runStreaming(void);
+  void _streamMember(const time_t &genTime, int leadTime,
+		     const std::string &url);
+  void _streamFinish(const time_t &genTime, int leadTime,
+		     const std::vector<std::string> &url, bool complete);
+  void _streamSetGen(const time_t &genTime);
+  StreamingLead *_streamLead(int leadTime);
+  void _streamQueue(StreamingLead *lead, const std::string &url);
+  void _streamCount(StreamingLead &lead, const std::string &url);
+  void _streamClear(bool removeCheckpoints);
 };
 
 #endif
@@ -0,0 +1,121 @@
+/**
+ * @file StreamingLead.cc
+ */
+
+#include "StreamingLead.hh"
+#include "ParmsPbarCompute.hh"
+#include <ConvWx/InterfaceLL.hh>
+#include <toolsa/LogStream.hh>
+#include <toolsa/DateTime.hh>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+using std::string;
+using std::vector;
+
+//----------------------------------------------------------------------
+StreamingLead::StreamingLead(const ParmsPbarCompute &params,
+			     const time_t &gt, int lt,
+			     const std::string &checkpointDir) :
+  _genTime(gt),
+  _leadTime(lt),
+  _data(params, gt, lt),
+  _isSetup(false),
+  _path("")
+{
+  pthread_mutex_init(&_mutex, NULL);
+  if (!checkpointDir.empty())
+  {
+    DateTime dt(gt);
+    char buf[1000];
+    sprintf(buf, "%s/%s/%s_%08d.members", checkpointDir.c_str(),
+	    dt.getDateStrPlain().c_str(), dt.getTimeStrPlain().c_str(), lt);
+    _path = buf;
+  }
+}
+
+//----------------------------------------------------------------------
+StreamingLead::~StreamingLead(void)
+{
+  pthread_mutex_destroy(&_mutex);
+}
+
+//----------------------------------------------------------------------
+void StreamingLead::setup(const Grid &egrid)
+{
+  _data.setupCountSums(egrid);
+  _isSetup = true;
+}
+
+//----------------------------------------------------------------------
+bool StreamingLead::hasMember(const std::string &url) const
+{
+  return _members.find(url) != _members.end();
+}
+
+//----------------------------------------------------------------------
+void StreamingLead::addMember(const std::string &url)
+{
+  _members.insert(url);
+  if (_path.empty() || _checkpointed.find(url) != _checkpointed.end())
+  {
+    return;
+  }
+  if (_checkpointed.empty())
+  {
+    InterfaceLL::makeDirRecurse(_path);
+  }
+  FILE *fp = fopen(_path.c_str(), "a");
+  if (fp == NULL)
+  {
+    LOG(WARNING) << "Cannot append to checkpoint " << _path;
+    return;
+  }
+  fprintf(fp, "%s\n", url.c_str());
+  fflush(fp);
+  fsync(fileno(fp));
+  fclose(fp);
+  _checkpointed.insert(url);
+}
+
+//----------------------------------------------------------------------
+vector<string> StreamingLead::checkpointMembers(void)
+{
+  vector<string> ret;
+  if (_path.empty())
+  {
+    return ret;
+  }
+  FILE *fp = fopen(_path.c_str(), "r");
+  if (fp == NULL)
+  {
+    return ret;
+  }
+  char buf[1000];
+  while (fgets(buf, sizeof(buf), fp) != NULL)
+  {
+    string s = buf;
+    while (!s.empty() && (s[s.size()-1] == '\n' || s[s.size()-1] == '\r'))
+    {
+      s.erase(s.size()-1);
+    }
+    if (!s.empty() && _checkpointed.find(s) == _checkpointed.end())
+    {
+      _checkpointed.insert(s);
+      ret.push_back(s);
+    }
+  }
+  fclose(fp);
+  return ret;
+}
+
+//----------------------------------------------------------------------
+void StreamingLead::removeCheckpoint(void)
+{
+  if (!_path.empty())
+  {
+    unlink(_path.c_str());
+    _checkpointed.clear();
+  }
+}
@@ -0,0 +1,109 @@
+/**
+ * @file StreamingLead.hh
+ * @brief Counts for one gen/lead time accumulated as members arrive
+ * @class StreamingLead
+ * @brief Counts for one gen/lead time accumulated as members arrive
+ *
+ * Used in streaming mode. Holds the count/sum grids for the lead time, the
+ * set of members counted so far, and a checkpoint file listing those
+ * members. The checkpoint is appended to as each member is counted, and
+ * after a restart the members it lists are counted again, so partial
+ * counts are not lost. It is removed when the lead time is finished.
+ *
+ * Callers lock() around any use of data() or the member set, since
+ * members for one lead time can be counted from several threads.
+ */
+
+#ifndef StreamingLead_HH
+#define StreamingLead_HH
+
+#include "LeadtimeThreadData.hh"
+#include <set>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <pthread.h>
+
+class ParmsPbarCompute;
+
+class StreamingLead
+{
+public:
+
+  /**
+   * Constructor
+   * @param[in] params  The algorithm parameters
+   * @param[in] gt  Gen time
+   * @param[in] lt  Lead seconds
+   * @param[in] checkpointDir  Top directory for checkpoints, empty for none
+   */
+  StreamingLead(const ParmsPbarCompute &params, const time_t &gt, int lt,
+		const std::string &checkpointDir);
+
+  /**
+   * Destructor, leaves the checkpoint file in place
+   */
+  ~StreamingLead(void);
+
+  inline void lock(void) {pthread_mutex_lock(&_mutex);}
+  inline void unlock(void) {pthread_mutex_unlock(&_mutex);}
+
+  inline time_t getGenTime(void) const {return _genTime;}
+  inline int getLeadSeconds(void) const {return _leadTime;}
+
+  /**
+   * @return the count/sum grids, set up when the first member is counted
+   */
+  inline LeadtimeThreadData &data(void) {return _data;}
+
+  /**
+   * @return true if the count/sum grids have been set up
+   */
+  inline bool isSetup(void) const {return _isSetup;}
+
+  /**
+   * Set up the count/sum grids
+   * @param[in] egrid  Template grid for dimensions
+   */
+  void setup(const Grid &egrid);
+
+  /**
+   * @return true if a member has been counted
+   * @param[in] url  The member
+   */
+  bool hasMember(const std::string &url) const;
+
+  /**
+   * Record that a member has been counted, appending it to the checkpoint
+   * if not already there
+   * @param[in] url  The member
+   */
+  void addMember(const std::string &url);
+
+  /**
+   * @return the members listed in the checkpoint file, from an earlier run
+   */
+  std::vector<std::string> checkpointMembers(void);
+
+  /**
+   * Remove the checkpoint file
+   */
+  void removeCheckpoint(void);
+
+protected:
+private:
+
+  time_t _genTime;     /**< Gen time */
+  int _leadTime;       /**< Lead seconds */
+  LeadtimeThreadData _data;  /**< Count/sum grids */
+  bool _isSetup;       /**< True once _data has been set up */
+  std::set<std::string> _members;  /**< Members counted */
+  std::set<std::string> _checkpointed; /**< Members in the checkpoint */
+  std::string _path;   /**< Checkpoint file, empty for none */
+  pthread_mutex_t _mutex;  /**< Lock for the above */
+
+  StreamingLead(const StreamingLead &);
+  StreamingLead &operator=(const StreamingLead &);
+};
+
+#endif
@@ -805,6 +805,75 @@ using namespace std;
       tt->struct_vals[5].s = tdrpStrDup("Unknown local use paramater number");
     tt++;
     
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("GRID HANDOFF");
+    tt->comment_text = tdrpStrDup("Optionally publish each output forecast to a shared memory queue, so that downstream apps (PbarCompute, EnsLookupGen) can pick up the grids without reading the files.  The files are always written.  Only FLOAT32 output is published.");
+    tt++;
+    
+    // Parameter 'gridHandoff'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoff");
+    tt->descr = tdrpStrDup("Set TRUE to publish output to the grid handoff queue");
+    tt->help = tdrpStrDup("");
+    tt->val_offset = (char *) &gridHandoff - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'gridHandoffUrl'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffUrl");
+    tt->descr = tdrpStrDup("Grid handoff queue");
+    tt->help = tdrpStrDup("A file name of the form shmem_<key> makes a shared memory queue, with <key> the shared memory key. Subscribers must use the same value.");
+    tt->val_offset = (char *) &gridHandoffUrl - &_start_;
+    tt->single_val.s = tdrpStrDup("/tmp/fmq/shmem_27000");
+    tt++;
+    
+    // Parameter 'gridHandoffNumSlots'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffNumSlots");
+    tt->descr = tdrpStrDup("Number of slots in the grid handoff queue");
+    tt->help = tdrpStrDup("Subscribers must use the same value.");
+    tt->val_offset = (char *) &gridHandoffNumSlots - &_start_;
+    tt->single_val.i = 100;
+    tt++;
+    
+    // Parameter 'gridHandoffBufSize'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffBufSize");
+    tt->descr = tdrpStrDup("Size of the grid handoff queue buffer (bytes)");
+    tt->help = tdrpStrDup("Should hold at least one full cycle of output.  Subscribers must use the same value.");
+    tt->val_offset = (char *) &gridHandoffBufSize - &_start_;
+    tt->single_val.i = 500000000;
+    tt++;
+    
+    // Parameter 'gridHandoffBlocking'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("gridHandoffBlocking");
+    tt->descr = tdrpStrDup("Set TRUE to wait rather than overwrite unread entries");
+    tt->help = tdrpStrDup("If TRUE, writes wait while the queue is full of forecasts the subscriber has not read. Fmq supports this for one reader only, so only the first subscriber to start reads the queue, and any other subscriber (for example PbarCompute and EnsLookupGen both on the same queue) reads its input from the files.  Output stalls if that subscriber stops running.");
+    tt->val_offset = (char *) &gridHandoffBlocking - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
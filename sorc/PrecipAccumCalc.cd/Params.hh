@@ -383,6 +383,16 @@ public:
   Mdv_name_t *_mdv_6hr_names;
   int mdv_6hr_names_n;
 
+  tdrp_bool_t gridHandoff;
+
+  char* gridHandoffUrl;
+
+  int gridHandoffNumSlots;
+
+  int gridHandoffBufSize;
+
+  tdrp_bool_t gridHandoffBlocking;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -390,7 +400,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[16];
+  mutable TDRPtable _table[22];
 
   const char *_className;
 
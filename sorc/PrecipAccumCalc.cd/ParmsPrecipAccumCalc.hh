@@ -98,6 +98,15 @@ public:
    */ 
   int numThreads;
 
+  /**
+   * Grid handoff queue output (see InterfaceIO::setGridHandoffPublisher())
+   */
+  bool gridHandoff;
+  std::string gridHandoffUrl;
+  int gridHandoffNumSlots;
+  int gridHandoffBufSize;
+  bool gridHandoffBlocking;
+
   /**
    * All the long names, 3 hours
    */
@@ -141,6 +141,12 @@ ParmsPrecipAccumCalcIO::ParmsPrecipAccumCalcIO(int argc, char **argv)
 
   numThreads = params.numThreads;
 
+  gridHandoff = params.gridHandoff;
+  gridHandoffUrl = params.gridHandoffUrl;
+  gridHandoffNumSlots = params.gridHandoffNumSlots;
+  gridHandoffBufSize = params.gridHandoffBufSize;
+  gridHandoffBlocking = params.gridHandoffBlocking;
+
   for (int i=0; i<params.mdv_6hr_names_n; ++i)
   {
     pair<string,string> p(params._mdv_6hr_names[i].shortName,
@@ -62,6 +62,17 @@ PrecipAccumCalcMgr::PrecipAccumCalcMgr(const ParmsPrecipAccumCalcIO &params,
 					params.main.pArchiveT1,
 					urls, params.leadSeconds);
   }
+
+  if (pParams.gridHandoff)
+  {
+    if (!InterfaceIO::setGridHandoffPublisher(pParams.gridHandoffUrl,
+					      pParams.gridHandoffNumSlots,
+					      pParams.gridHandoffBufSize,
+					      pParams.gridHandoffBlocking))
+    {
+      LOG(WARNING) << "No grid handoff, output to files only";
+    }
+  }
   
   pThread.init(pParams.numThreads, false, static_cast<void *>(this),
                PrecipAccumCalcMgr::process);
@@ -0,0 +1,100 @@
+ 
+/**
+ * @mainpage SpdbCompact
+ *
+ * This application compacts SPDB data bases: for each day in a time range,
+ * the data file is rewritten with only the chunks the index refers to, in
+ * valid time order, reclaiming the space left by overwritten and erased
+ * chunks. It takes the same locks as a writer, so can run alongside the
+ * apps that use the data bases.
+ */
+
+/**
+ * @file MainSpdbCompact.cc
+ */
+
+#include "SpdbCompactMgr.hh"
+#include "Params.hh"
+#include <toolsa/LogStream.hh>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * Return value of program to indicate success
+ */
+const static int success = 0;
+
+/**
+ *  Return value of program to indicate failure
+ */
+const static int failure = 1;
+
+/**
+ * Exit program, return signal to operating system
+ * @param[in] sig  Signal
+ */
+static void cleanExit (int sig);
+
+/**
+ * New handler function
+ */
+static void outOfStore(void);
+
+/**
+ * Mgr
+ */
+static SpdbCompactMgr *_mgr = NULL;
+
+/**
+ * Create the manager and compact the data bases
+ * @param[in] argc  Number of command line arguments
+ * @param[in] argv  Typical command line is 'SpdbCompact -params SpdbCompact.params'
+ *
+ * @return integer status
+ */
+
+int main(int argc, char **argv)
+{
+  // set new() memory failure handler function
+  std::set_new_handler(outOfStore);
+
+  // Read in parameters
+  Params params;
+  char *path;
+  if (params.loadFromArgs(argc, argv, NULL, &path))
+  {
+    std::cerr << "ERROR - SpdbCompact, problem with params" << std::endl;
+    exit(failure);
+  }
+  LOG_STREAM_INIT(params.debug, params.debug_verbose, true, true);
+
+  _mgr = new SpdbCompactMgr(params);
+  int iret;
+  if (_mgr->run())
+  {
+    iret = success;
+  }
+  else
+  {
+    iret = failure;
+  }
+  cleanExit(iret);
+  return iret;
+}
+
+static void cleanExit (int sig)
+{
+  if (_mgr != NULL)
+  {
+    delete _mgr;
+    _mgr = NULL;
+  }
+  exit(sig);
+}
+
+static void outOfStore()
+{
+  std::cerr << "FATAL ERROR - program SpdbCompact " << std::endl;
+  std::cerr << "Operator new failed - out of store" << std::endl;
+  exit(failure);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file SpdbCompactMgr.cc
+ */
+
+#include "SpdbCompactMgr.hh"
+#include <Spdb/Spdb.hh>
+#include <toolsa/DateTime.hh>
+#include <toolsa/LogStream.hh>
+#include <toolsa/udatetime.h>
+#include <string>
+
+using std::string;
+
+//----------------------------------------------------------------------
+SpdbCompactMgr::SpdbCompactMgr(const Params &params) :
+  _params(params)
+{
+}
+
+//----------------------------------------------------------------------
+SpdbCompactMgr::~SpdbCompactMgr()
+{
+}
+
+//----------------------------------------------------------------------
+bool SpdbCompactMgr::run(void)
+{
+  time_t startTime, endTime;
+  if (!_timeRange(startTime, endTime))
+  {
+    return false;
+  }
+  LOG(DEBUG) << "Compacting " << DateTime::strn(startTime) << " to "
+	     << DateTime::strn(endTime) << ", min fragment fraction "
+	     << _params.min_frag_fraction;
+
+  bool ok = true;
+  for (int i=0; i<_params.spdb_dirs_n; ++i)
+  {
+    string dir = _params._spdb_dirs[i];
+    Spdb spdb;
+    spdb.setAppName("SpdbCompact");
+    if (spdb.compact(dir, startTime, endTime, _params.min_frag_fraction))
+    {
+      LOG(ERROR) << "Compacting " << dir << "\n" << spdb.getErrStr();
+      ok = false;
+    }
+    LOG(DEBUG) << dir << ": " << spdb.getNDaysCompacted()
+	       << " days compacted, "
+	       << spdb.getNBytesReclaimed()/1.0e6 << " MB reclaimed";
+  }
+  return ok;
+}
+
+//----------------------------------------------------------------------
+bool SpdbCompactMgr::_timeRange(time_t &startTime, time_t &endTime) const
+{
+  string start = _params.start_time;
+  string end = _params.end_time;
+  if (start.empty() || end.empty())
+  {
+    endTime = time(0);
+    startTime = endTime - _params.lookback_days*SECS_IN_DAY;
+    return true;
+  }
+  startTime = DateTime::parseDateTime(start.c_str());
+  endTime = DateTime::parseDateTime(end.c_str());
+  if (startTime == DateTime::NEVER || endTime == DateTime::NEVER ||
+      endTime < startTime)
+  {
+    LOG(ERROR) << "Bad time range " << start << " to " << end;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file SpdbCompactMgr.hh
+ * @brief Compacts the data files of one or more SPDB data bases
+ * @class SpdbCompactMgr
+ * @brief Compacts the data files of one or more SPDB data bases
+ *
+ * Each directory is compacted with Spdb::compact() over the days set in
+ * the parameters, so the same locks are taken as by a writer.
+ */
+
+#ifndef SPDB_COMPACT_MGR_HH
+#define SPDB_COMPACT_MGR_HH
+
+#include "Params.hh"
+#include <ctime>
+
+class SpdbCompactMgr
+{
+public:
+
+  /**
+   * Constructor
+   * @param[in] params  The parameters
+   */
+  SpdbCompactMgr(const Params &params);
+
+  /**
+   * Destructor
+   */
+  ~SpdbCompactMgr(void);
+
+  /**
+   * Compact every data base
+   * @return true if all were compacted without error
+   */
+  bool run(void);
+
+protected:
+private:
+
+  Params _params;  /**< Parameters */
+
+  /**
+   * Set the days to compact from the parameters
+   * @param[out] startTime
+   * @param[out] endTime
+   * @return true if the times are good
+   */
+  bool _timeRange(time_t &startTime, time_t &endTime) const;
+};
+
+#endif
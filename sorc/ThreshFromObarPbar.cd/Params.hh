@@ -73,6 +73,12 @@ public:
     double targetBias;
   } ThreshBias_t;
 
+  typedef enum {
+    INSTRUMENTATION_OFF = 0,
+    INSTRUMENTATION_LOG = 1,
+    INSTRUMENTATION_JSON = 2
+  } Instrumentation_t;
+
   ///////////////////////////
   // Member functions
   //
@@ -423,6 +429,10 @@ public:
 
   int thresholdsMaxDaysBack;
 
+  Instrumentation_t instrumentation;
+
+  char* instrumentationJsonDir;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -430,7 +440,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[18];
+  mutable TDRPtable _table[21];
 
   const char *_className;
 
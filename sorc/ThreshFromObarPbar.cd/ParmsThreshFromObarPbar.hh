@@ -13,6 +13,7 @@
 #include <ConvWx/ParmProjection.hh>
 #include <ConvWx/ParmMain.hh>
 #include <ConvWx/ParmTiling.hh>
+#include <ConvWx/Instrumentation.hh>
 
 #include <string>
 #include <vector>
@@ -115,6 +116,12 @@ public:
    */
   bool _debugState;
   
+  /**
+   * Per gen time timing output (see Instrumentation)
+   */
+  Instrumentation::Mode_t _instrumentation;
+  std::string _instrumentationJsonDir;  /**< Where JSON timing goes */
+
 protected:
 private:
 
@@ -104,6 +104,21 @@ ParmsThreshFromObarPbarIO::ParmsThreshFromObarPbarIO(int argc, char **argv)
 
   _numThreads = params.num_threads;
   _debugState = params.debug_state;
+
+  switch (params.instrumentation)
+  {
+  case Params::INSTRUMENTATION_LOG:
+    _instrumentation = Instrumentation::MODE_LOG;
+    break;
+  case Params::INSTRUMENTATION_JSON:
+    _instrumentation = Instrumentation::MODE_JSON;
+    break;
+  case Params::INSTRUMENTATION_OFF:
+  default:
+    _instrumentation = Instrumentation::MODE_OFF;
+    break;
+  }
+  _instrumentationJsonDir = params.instrumentationJsonDir;
 }
 
 //-----------------------------------------------------------------
@@ -6,6 +6,7 @@
 #include <toolsa/TaThreadSimple.hh>
 #include <toolsa/DateTime.hh>
 #include <ConvWx/InterfaceLL.hh>
+#include <ConvWx/PhaseTimer.hh>
 #include <algorithm>
 #include "Info.hh"
 #include <Epoch/SpdbObsHandler.hh>
@@ -50,6 +51,8 @@ ThreshFromObarPbarMgr(const ParmsThreshFromObarPbarIO &params, void cleanExit(in
 				 DsUrlTrigger::OBS, false, true);
   }
   _thread.init(params._numThreads, false);
+  Instrumentation::setMode(params._instrumentation,
+			   params._instrumentationJsonDir);
   LOG(DEBUG) << "end of constructor";
 }
 
@@ -109,6 +112,7 @@ void ThreshFromObarPbarMgr::compute(void *ti)
 
   bool has1=true;
   bool has2=true;
+  PhaseTimer readTimer("spdbRead");
   if (!obs1.read(vt))
   {
     LOG(DEBUG_VERBOSE) << "No precip oBar from database yet at " << DateTime::strn(vt);
@@ -119,6 +123,8 @@ void ThreshFromObarPbarMgr::compute(void *ti)
     LOG(DEBUG_VERBOSE) << "No CTH oBar from database yet at " << DateTime::strn(vt);
     has2=false;
   }
+  readTimer.stop();
+
   // make sure thresholds match
   if (has1)
   {
@@ -188,6 +194,7 @@ void ThreshFromObarPbarMgr::compute(void *ti)
   alg->_thread.unlockAfterIO();
 
   vector<int> pbarIndexAtTile;
+  PhaseTimer tileTimer("tileStats");
   if (has1)
   {
     //  for each threshold, field 1
@@ -285,13 +292,16 @@ void ThreshFromObarPbarMgr::_processGenTime(const ForecastState &state)
 {
   time_t gt = state.getGenTime();
   _genTime = gt;
+  PhaseTimer timer("trigger");
 
+  PhaseTimer readTimer("spdbRead");
   if (!_pbarSpdb.read(_genTime))
   {
     LOG(DEBUG) << "No pbar at gen time " << DateTime::strn(_genTime);
     return;
   }
   _queryThreshSpdbAtGenTime(gt);
+  readTimer.stop();
   _modified = false;
   for (size_t i=0; i<state.size(); ++i)
   {
@@ -302,9 +312,16 @@ void ThreshFromObarPbarMgr::_processGenTime(const ForecastState &state)
   _thread.waitForThreads();
   if (_modified)
   {
+    PhaseTimer t("spdbWrite");
     _threshSpdb1.write();
     _threshSpdb2.write();
   }
+  timer.stop();
+  string s = Instrumentation::report("ThreshFromObarPbar", gt);
+  if (!s.empty())
+  {
+    LOG(PRINT) << s;
+  }
 }
 
 //----------------------------------------------------------------------
@@ -620,6 +620,51 @@
     tt->single_val.d = 2;
     tt++;
     
+    // Parameter 'Comment 2'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = COMMENT_TYPE;
+    tt->param_name = tdrpStrDup("Comment 2");
+    tt->comment_hdr = tdrpStrDup("Incremental averaging");
+    tt->comment_text = tdrpStrDup("Running sums and counts, updated as chunks enter and leave the thresholds_max_days_back window");
+    tt++;
+    
+    // Parameter 'incremental'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("incremental");
+    tt->descr = tdrpStrDup("Keep running sums instead of re-reading the whole window");
+    tt->help = tdrpStrDup("TRUE to keep per hour of day counts and sums in a state file in state_dir. Each trigger then reads the chunk refs in the window to check none was rewritten, the chunk that entered the window and the chunk that left it. The sums are rebuilt from the full window every thresholds_max_days_back triggers, and whenever the thresholds SPDB does not keep at least one day more than thresholds_max_days_back.");
+    tt->val_offset = (char *) &incremental - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'state_dir'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("state_dir");
+    tt->descr = tdrpStrDup("Directory for incremental state files");
+    tt->help = tdrpStrDup("Directory for the state files when incremental = TRUE, one file per thresholds URL and hour of day");
+    tt->val_offset = (char *) &state_dir - &_start_;
+    tt->single_val.s = tdrpStrDup("$(DATA_DIR)/ThreshHist/state");
+    tt++;
+    
+    // Parameter 'full_rebuild'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("full_rebuild");
+    tt->descr = tdrpStrDup("Always rebuild the incremental sums");
+    tt->help = tdrpStrDup("TRUE to rebuild the sums from every chunk in the window on each trigger, as when incremental = FALSE, and save the state. For validating incremental results.");
+    tt->val_offset = (char *) &full_rebuild - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
     // trailing entry has param_name set to NULL
     
     tt->param_name = NULL;
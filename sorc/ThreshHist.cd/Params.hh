@@ -367,6 +367,12 @@ public:
 
   double coldstart_threshold;
 
+  tdrp_bool_t incremental;
+
+  char* state_dir;
+
+  tdrp_bool_t full_rebuild;
+
   char _end_; // end of data region
               // needed for zeroing out data
 
@@ -374,7 +380,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[7];
+  mutable TDRPtable _table[11];
 
   const char *_className;
 
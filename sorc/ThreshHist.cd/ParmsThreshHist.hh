@@ -62,6 +62,21 @@ public:
    */
   double _coldstartThresh;
 
+  /**
+   * True to average incrementally using running sums in a state file
+   */
+  bool _incremental;
+
+  /**
+   * Directory for incremental state files
+   */
+  std::string _stateDir;
+
+  /**
+   * True to rebuild the sums from the full window every time
+   */
+  bool _fullRebuild;
+
 protected:
 private:  
 
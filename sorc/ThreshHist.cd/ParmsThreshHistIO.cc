@@ -53,6 +53,9 @@ ParmsThreshHistIO::ParmsThreshHistIO(int argc, char **argv)
   _outputSpdb = p.thresholds_spdb_out;
   _daysBack = p.thresholds_max_days_back;
   _coldstartThresh = p.coldstart_threshold;
+  _incremental = p.incremental;
+  _stateDir = p.state_dir;
+  _fullRebuild = p.full_rebuild;
 }
 
 //----------------------------------------------------------------
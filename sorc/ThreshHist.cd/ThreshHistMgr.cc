@@ -83,8 +83,18 @@ void ThreshHistMgr::_process(const time_t &t)
   {
     LOG(DEBUG) << "Couldn't read at " << DateTime::strn(t);
   }
-  if (_reader.average(t, _parms._daysBack, _parms._coldstartThresh,
-		      _writer))
+  bool ok;
+  if (_parms._incremental)
+  {
+    ok = _reader.averageIncremental(t, _parms._daysBack, _parms._stateDir,
+				    _parms._fullRebuild, _writer);
+  }
+  else
+  {
+    ok = _reader.average(t, _parms._daysBack, _parms._coldstartThresh,
+			 _writer);
+  }
+  if (ok)
   {
     _writer.write();
   }
@@ -299,6 +299,7 @@ void Grid::digitalFilter(void)
 //----------------------------------------------------------------
 void Grid::filterNans(void)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     if (!finite(pDataPtr[i]))
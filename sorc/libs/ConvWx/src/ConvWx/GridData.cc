@@ -25,6 +25,8 @@
 #include <cmath>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <utility>
 
 #include <ConvWxIO/ILogMsg.hh>
 #include <ConvWxIO/ConvWxMultiThreadMgr.hh>
@@ -36,10 +38,14 @@
 #include <ConvWx/InterfaceLL.hh>
 #include <ConvWx/GridLoopA.hh>
 #include <ConvWx/GridLoopAlg.hh>
+#include <toolsa/TaBoxFilter.hh>
 // #include <toolsa/LogStream.hh>
 
 using std::string;
 using std::vector;
+using std::pair;
+using std::sort;
+using std::lower_bound;
 
 //----------------------------------------------------------------
 /**
@@ -73,6 +79,185 @@ static void sSetSigned(const bool abs, const double v, double &signedv,
   }
 }
 
+//----------------------------------------------------------------
+/**
+ * Visit the non-missing points with indices in [k0,k1) using a validity
+ * mask: f.all(data+k, 64) for each 64 points (one mask word) that are all
+ * non-missing, f.one(data[k]) for each other non-missing point.  Words
+ * with no non-missing data are skipped.
+ *
+ * @param[in] mask  Validity mask
+ * @param[in] data  Data
+ * @param[in] k0  First index
+ * @param[in] k1  One past the last index
+ * @param[in,out] f  Object with all() and one() methods
+ */
+template <class F>
+static void sForValid(const unsigned long long *mask, const double *data,
+		      const int k0, const int k1, F &f)
+{
+  int k = k0;
+  while (k < k1)
+  {
+    int w = k >> 6;
+    int kNextWord = (w + 1) << 6;
+    int kEnd = kNextWord < k1 ? kNextWord : k1;
+    unsigned long long bits = mask[w];
+    if (bits == 0ULL)
+    {
+      k = kEnd;
+      continue;
+    }
+    int b = k & 63;
+    if (b == 0 && kEnd == kNextWord && bits == ~0ULL)
+    {
+      f.all(data + k, 64);
+      k = kEnd;
+      continue;
+    }
+    bits >>= b;
+    int n = kEnd - k;
+    if (n < 64)
+    {
+      bits &= (1ULL << n) - 1ULL;
+    }
+    while (bits != 0ULL)
+    {
+      f.one(data[k + __builtin_ctzll(bits)]);
+      bits &= bits - 1ULL;
+    }
+    k = kEnd;
+  }
+}
+
+//----------------------------------------------------------------
+/**
+ * Visit the non-missing points in a subset of the first level of a grid,
+ * as with sForValid(), one contiguous run of x at a time
+ *
+ * @param[in] g  The grid, with a validity mask
+ * @param[in] data  The grid data
+ * @param[in] x0  Minimum x index
+ * @param[in] y0  Minimum y index
+ * @param[in] nx  Number of x indices
+ * @param[in] ny  Number of y indices
+ * @param[in,out] f  Object with all() and one() methods
+ */
+template <class F>
+static void sForValidSubset(const GridData &g, const double *data,
+			    const int x0, const int y0, const int nx,
+			    const int ny, F &f)
+{
+  const unsigned long long *mask = &(g.validMask()[0]);
+  int gnx = g.getNx();
+  for (int y=y0; y < y0+ny; ++y)
+  {
+    int iy = g.wraparoundY(y);
+    int x = x0;
+    int remaining = nx;
+    while (remaining > 0)
+    {
+      int ix = g.wraparoundX(x);
+      int len = gnx - ix;
+      if (len > remaining)
+      {
+	len = remaining;
+      }
+      int k = iy*gnx + ix;
+      sForValid(mask, data, k, k + len, f);
+      x += len;
+      remaining -= len;
+    }
+  }
+}
+
+/**
+ * @class SumOfValid
+ * @brief Sum and count, for sForValid()
+ */
+class SumOfValid
+{
+public:
+  inline SumOfValid(void) : _sum(0.0), _count(0.0) {}
+  inline void all(const double *d, const int n)
+  {
+    double sum = 0.0;
+    for (int i=0; i<n; ++i)
+    {
+      sum += d[i];
+    }
+    _sum += sum;
+    _count += n;
+  }
+  inline void one(const double v)
+  {
+    _sum += v;
+    _count += 1.0;
+  }
+  double _sum;    /**< Sum of values */
+  double _count;  /**< Number of values */
+};
+
+/**
+ * @class AboveThreshold
+ * @brief Count of values above a threshold, for sForValid()
+ */
+class AboveThreshold
+{
+public:
+  inline AboveThreshold(const double threshold) :
+    _threshold(threshold), _above(0.0), _count(0.0) {}
+  inline void all(const double *d, const int n)
+  {
+    int above = 0;
+    for (int i=0; i<n; ++i)
+    {
+      above += (d[i] > _threshold);
+    }
+    _above += above;
+    _count += n;
+  }
+  inline void one(const double v)
+  {
+    if (v > _threshold)
+    {
+      _above += 1.0;
+    }
+    _count += 1.0;
+  }
+  double _threshold; /**< Threshold */
+  double _above;     /**< Number of values above threshold */
+  double _count;     /**< Number of values */
+};
+
+/**
+ * @class ThresholdHistogram
+ * @brief Histogram against sorted thresholds, for sForValid()
+ */
+class ThresholdHistogram
+{
+public:
+  inline ThresholdHistogram(const vector<double> &sorted,
+			    vector<double> &hist) :
+    _sorted(sorted), _hist(hist), _count(0.0) {}
+  inline void all(const double *d, const int n)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      one(d[i]);
+    }
+  }
+  inline void one(const double v)
+  {
+    _hist[lower_bound(_sorted.begin(), _sorted.end(), v) -
+	  _sorted.begin()] += 1.0;
+    _count += 1.0;
+  }
+  const vector<double> &_sorted; /**< Sorted thresholds */
+  vector<double> &_hist;         /**< hist[k] = number above exactly k */
+  double _count;                 /**< Number of values */
+};
+
 //----------------------------------------------------------------
 GridData::GridData(void) :
   pDataPtr(NULL),
@@ -80,7 +265,9 @@ GridData::GridData(void) :
   pNptX(0),
   pNptY(0),
   pNptZ(0),
-  pMissing(0.0)
+  pMissing(0.0),
+  pValid(),
+  pValidCurrent(false)
 {
 }
 
@@ -92,10 +279,13 @@ GridData::GridData(const double *data, const int nx, const int ny,
   pNptX(nx),
   pNptY(ny),
   pNptZ(1),
-  pMissing(bad)
+  pMissing(bad),
+  pValid(),
+  pValidCurrent(false)
 {
   pDataPtr = new double[pNptTotal];
   memcpy(pDataPtr, data, pNptTotal*sizeof(double));
+  buildValidMask();
 }
 
 //----------------------------------------------------------------
@@ -106,7 +296,9 @@ GridData::GridData(const std::vector<double> &data, const int nx,
   pNptX(nx),
   pNptY(ny),
   pNptZ(1),
-  pMissing(bad)
+  pMissing(bad),
+  pValid(),
+  pValidCurrent(false)
 {
   pDataPtr = new double[pNptTotal];
   for (size_t i=0; i<data.size(); ++i)
@@ -121,6 +313,7 @@ GridData::GridData(const std::vector<double> &data, const int nx,
       pDataPtr[i] = data[i];
     }
   }
+  buildValidMask();
 }
 
 //----------------------------------------------------------------
@@ -131,10 +324,13 @@ GridData::GridData(const double *data, const int nx, const int ny,
   pNptX(nx),
   pNptY(ny),
   pNptZ(nz),
-  pMissing(bad)
+  pMissing(bad),
+  pValid(),
+  pValidCurrent(false)
 {
   pDataPtr = new double[pNptTotal];
   memcpy(pDataPtr, data, pNptTotal*sizeof(double));
+  buildValidMask();
 }
 
 //----------------------------------------------------------------
@@ -144,13 +340,16 @@ GridData::GridData(const int nx, const int ny, const double bad) :
   pNptX(nx),
   pNptY(ny),
   pNptZ(1),
-  pMissing(bad)
+  pMissing(bad),
+  pValid(),
+  pValidCurrent(false)
 {
   pDataPtr = new double[pNptTotal];
   for (int i=0; i<pNptTotal; ++i)
   {
     pDataPtr[i] = pMissing;
   }
+  buildValidMask();
 }
 
 //----------------------------------------------------------------
@@ -160,13 +359,16 @@ GridData::GridData(const int nx, const int ny, const int nz, const double bad) :
   pNptX(nx),
   pNptY(ny),
   pNptZ(nz),
-  pMissing(bad)
+  pMissing(bad),
+  pValid(),
+  pValidCurrent(false)
 {
   pDataPtr = new double[pNptTotal];
   for (int i=0; i<pNptTotal; ++i)
   {
     pDataPtr[i] = pMissing;
   }
+  buildValidMask();
 }
 
 //----------------------------------------------------------------
@@ -176,7 +378,9 @@ GridData::GridData(const GridData &b) :
   pNptX(b.pNptX),
   pNptY(b.pNptY),
   pNptZ(b.pNptZ),
-  pMissing(b.pMissing)
+  pMissing(b.pMissing),
+  pValid(b.pValid),
+  pValidCurrent(b.pValidCurrent)
 {
   // pDataPtr needs a memory allocation, then a copy
   if (pNptTotal > 0)
@@ -232,6 +436,8 @@ GridData & GridData::operator=(const GridData &b)
   {
     memcpy(pDataPtr, b.pDataPtr, pNptTotal*sizeof(double));
   }
+  pValid = b.pValid;
+  pValidCurrent = b.pValidCurrent;
   return *this;
 }
 
@@ -249,6 +455,8 @@ bool GridData::copyValues(const GridData &g)
     pDataPtr[i] = g.pDataPtr[i];
   }
   pMissing = g.pMissing;
+  pValid = g.pValid;
+  pValidCurrent = g.pValidCurrent;
   return true;
 }
 
@@ -656,24 +864,34 @@ bool GridData::meanSubset(int x0, int y0, int nx, int ny, bool xWrap,
   double count = 0;
   double sum = 0;
 
-  for (int y=y0; y < y0+ny; ++y)
+  if (pValidCurrent)
+  {
+    SumOfValid f;
+    sForValidSubset(*this, pDataPtr, x0, y0, nx, ny, f);
+    sum = f._sum;
+    count = f._count;
+  }
+  else
   {
-    int iy = wraparoundY(y);
-    for (int x=x0; x<x0+nx; ++x)
+    for (int y=y0; y < y0+ny; ++y)
     {
-      int ix = wraparoundX(x);
-      double d = pDataPtr[pIpt(ix, iy)];
-      if (d == pMissing)
+      int iy = wraparoundY(y);
+      for (int x=x0; x<x0+nx; ++x)
       {
-	continue;
-      }
-      else
-      {
-	sum += d;
-	count += 1.0;
+	int ix = wraparoundX(x);
+	double d = pDataPtr[pIpt(ix, iy)];
+	if (d == pMissing)
+	{
+	  continue;
+	}
+	else
+	{
+	  sum += d;
+	  count += 1.0;
+	}
       }
-    }
-  }    
+    }    
+  }
   if (count == 0.0)
   {
     value = 0.0;
@@ -717,27 +935,37 @@ bool GridData::percentAboveThresholdSubset(double threshold, int x0, int y0,
   double count = 0;
   double sum = 0;
 
-  for (int y=y0; y < y0+ny; ++y)
+  if (pValidCurrent)
+  {
+    AboveThreshold f(threshold);
+    sForValidSubset(*this, pDataPtr, x0, y0, nx, ny, f);
+    sum = f._above;
+    count = f._count;
+  }
+  else
   {
-    int iy = wraparoundY(y);
-    for (int x=x0; x<x0+nx; ++x)
+    for (int y=y0; y < y0+ny; ++y)
     {
-      int ix = wraparoundX(x);
-      double d = pDataPtr[pIpt(ix, iy)];
-      if (d == pMissing)
-      {
-	continue;
-      }
-      else
+      int iy = wraparoundY(y);
+      for (int x=x0; x<x0+nx; ++x)
       {
-	count += 1.0;
-	if (d > threshold)
+	int ix = wraparoundX(x);
+	double d = pDataPtr[pIpt(ix, iy)];
+	if (d == pMissing)
 	{
-	  sum += 1.0;
+	  continue;
+	}
+	else
+	{
+	  count += 1.0;
+	  if (d > threshold)
+	  {
+	    sum += 1.0;
+	  }
 	}
       }
-    }
-  }    
+    }    
+  }
   if (count == 0.0)
   {
     value = 0.0;
@@ -750,6 +978,93 @@ bool GridData::percentAboveThresholdSubset(double threshold, int x0, int y0,
   }
 }
 
+//----------------------------------------------------------------
+bool GridData::percentAboveThresholdsSubset(const vector<double> &thresholds,
+					    int x0, int y0, int nx, int ny,
+					    bool xWrap, bool yWrap,
+					    vector<double> &values,
+					    bool &outOfBounds) const
+{
+  values.assign(thresholds.size(), 0.0);
+  if (x0 < 0 || x0+nx > pNptX)
+  {
+    if (!xWrap)
+    {
+      ILOGF(ERROR, "subset out of grid range X [%d,%d]  [0,%d]",
+	    x0, x0+nx-1, pNptX-1);
+      outOfBounds = true;
+      return false;
+    }
+  }
+  if (y0 < 0 || y0+ny > pNptY)
+  {
+    if (!yWrap)
+    {
+      ILOGF(ERROR, "subset out of grid range Y [%d,%d]  [0,%d]",
+	    y0, y0+ny-1, pNptY-1);
+      outOfBounds = true;
+      return false;
+    }
+  }
+  outOfBounds = false;
+
+  // sorted thresholds, remembering where each came from
+  int nt = static_cast<int>(thresholds.size());
+  vector<pair<double,int> > order(nt);
+  for (int i=0; i<nt; ++i)
+  {
+    order[i] = pair<double,int>(thresholds[i], i);
+  }
+  sort(order.begin(), order.end());
+  vector<double> sorted(nt);
+  for (int i=0; i<nt; ++i)
+  {
+    sorted[i] = order[i].first;
+  }
+
+  // hist[k] = number of points above exactly the k lowest thresholds
+  vector<double> hist(nt+1, 0.0);
+  double count = 0;
+  if (pValidCurrent)
+  {
+    ThresholdHistogram f(sorted, hist);
+    sForValidSubset(*this, pDataPtr, x0, y0, nx, ny, f);
+    count = f._count;
+  }
+  else
+  {
+    for (int y=y0; y < y0+ny; ++y)
+    {
+      int iy = wraparoundY(y);
+      for (int x=x0; x<x0+nx; ++x)
+      {
+	int ix = wraparoundX(x);
+	double d = pDataPtr[pIpt(ix, iy)];
+	if (d == pMissing)
+	{
+	  continue;
+	}
+	count += 1.0;
+	hist[lower_bound(sorted.begin(), sorted.end(), d) -
+	     sorted.begin()] += 1.0;
+      }
+    }    
+  }
+  if (count == 0.0)
+  {
+    return false;
+  }
+
+  // points above sorted threshold j are those in bins j+1 and up
+  double sum = 0.0;
+  for (int j=nt-1; j>=0; --j)
+  {
+    sum += hist[j+1];
+    values[order[j].second] = sum/count;
+  }
+  return true;
+}
+
 //----------------------------------------------------------------
 bool GridData::getRange(double &minv, double &maxv) const
 {
@@ -839,11 +1154,25 @@ void GridData::setAllToValue(const double value)
   {
     pDataPtr[i] = value;
   }
+
+  // every bit the same, with the unused bits of the last word clear
+  unsigned long long bits = 0ULL;
+  if (value != pMissing)
+  {
+    bits = ~0ULL;
+  }
+  pValid.assign((pNptTotal + 63)/64, bits);
+  if (value != pMissing && pNptTotal%64 != 0)
+  {
+    pValid.back() = (1ULL << (pNptTotal%64)) - 1ULL;
+  }
+  pValidCurrent = true;
 }
 
 //----------------------------------------------------------------
 void GridData::changeValue(const double vold, const double vnew)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     if (pDataPtr[i] == vold)
@@ -856,6 +1185,7 @@ void GridData::changeValue(const double vold, const double vnew)
 //----------------------------------------------------------------
 void GridData::changeMissing(const double missingValue)
 {
+  pValidStale();
   if (missingValue == pMissing)
   {
     return;
@@ -871,6 +1201,105 @@ void GridData::changeMissing(const double missingValue)
   pMissing = missingValue;
 }
 
+//----------------------------------------------------------------
+void GridData::buildValidMask(void)
+{
+  pValid.assign((pNptTotal + 63)/64, 0ULL);
+  int k = 0;
+  for (size_t w=0; w<pValid.size(); ++w)
+  {
+    int n = pNptTotal - k;
+    if (n > 64)
+    {
+      n = 64;
+    }
+    unsigned long long bits = 0ULL;
+    for (int b=0; b<n; ++b, ++k)
+    {
+      bits |= static_cast<unsigned long long>(pDataPtr[k] != pMissing) << b;
+    }
+    pValid[w] = bits;
+  }
+  pValidCurrent = true;
+}
+
+//----------------------------------------------------------------
+int GridData::numValid(void) const
+{
+  int n = 0;
+  if (pValidCurrent)
+  {
+    for (size_t w=0; w<pValid.size(); ++w)
+    {
+      n += __builtin_popcountll(pValid[w]);
+    }
+  }
+  else
+  {
+    for (int i=0; i<pNptTotal; ++i)
+    {
+      if (pDataPtr[i] != pMissing)
+      {
+	++n;
+      }
+    }
+  }
+  return n;
+}
+
+//----------------------------------------------------------------
+bool GridData::addWeighted(const GridData &g, const double weight,
+			   GridData &weightSum)
+{
+  if (pNptTotal != g.pNptTotal || pNptTotal != weightSum.pNptTotal)
+  {
+    ILOGF(ERROR, "dims unequal %d %d %d", pNptTotal, g.pNptTotal,
+	  weightSum.pNptTotal);
+    return false;
+  }
+  if (!g.pValidCurrent)
+  {
+    for (int i=0; i<pNptTotal; ++i)
+    {
+      if (g.pDataPtr[i] != g.pMissing)
+      {
+	pAddWeighted(i, g.pDataPtr[i]*weight, weight, weightSum);
+      }
+    }
+    return true;
+  }
+
+  // by mask word, fast where the local and weight grids have no missing
+  // data either
+  bool full = pValidCurrent && weightSum.pValidCurrent;
+  for (size_t w=0; w<g.pValid.size(); ++w)
+  {
+    unsigned long long bits = g.pValid[w];
+    if (bits == 0ULL)
+    {
+      continue;
+    }
+    int k0 = static_cast<int>(w) << 6;
+    if (bits == ~0ULL && full && pValid[w] == ~0ULL &&
+	weightSum.pValid[w] == ~0ULL)
+    {
+      for (int k=k0; k<k0+64; ++k)
+      {
+	pDataPtr[k] += g.pDataPtr[k]*weight;
+	weightSum.pDataPtr[k] += weight;
+      }
+      continue;
+    }
+    while (bits != 0ULL)
+    {
+      int k = k0 + __builtin_ctzll(bits);
+      pAddWeighted(k, g.pDataPtr[k]*weight, weight, weightSum);
+      bits &= bits - 1ULL;
+    }
+  }
+  return true;
+}
+
 //----------------------------------------------------------------
 string GridData::sprintData(void) const
 {
@@ -994,33 +1423,26 @@ void GridData::logValues(const int ix0, const int ix1, const int iy0,
 
 //----------------------------------------------------------------
 void GridData::smooth(int sx, int sy, bool isExclude,
-		      double excludeValue, bool rejectCenterExclude)
+		      double excludeValue, bool rejectCenterExclude,
+		      bool xWrap, int numThread)
 {
-  // make a temporary grid
-  GridData tmp(*this);
-
-  // for each point
-  for (int iy=0; iy<pNptY; ++iy)
+  pValidStale();
+  if (pNptX <= 0 || pNptY <= 0)
   {
-    for (int ix=0; ix<pNptX; ++ix)
-    {
-      // compute a local average
-      double v = pLocalAverage(ix, iy, sx, sy, isExclude, excludeValue,
-			       rejectCenterExclude);
-
-      // store to temporary grid
-      tmp.setv(ix, iy, v);
-    }
+    return;
   }
 
-  // replace local state with temp.
-  *this = tmp;
+  // filter a copy of the first level back into the local grid
+  vector<double> tmp(pDataPtr, pDataPtr + pNptX*pNptY);
+  pBoxFilter(&tmp[0], sx, sy, isExclude, excludeValue, rejectCenterExclude,
+	     xWrap, numThread, pDataPtr);
 }
 
 //----------------------------------------------------------------
 void GridData::fastsmooth(int sx, int sy, bool isExclude,
 			  double excludeValue, bool rejectCenterExclude)
 {
+  pValidStale();
   // make an object to loop through the grid
   GridLoopA g(pNptX, pNptY, sx, sy);
 
@@ -1049,8 +1471,10 @@ void GridData::fastsmooth(int sx, int sy, bool isExclude,
 //----------------------------------------------------------------
 bool GridData::smoothInMask(const GridData &mask, const double maskValue,
 			    const int sx, const int sy, const bool isExclude,
-			    const double excludeValue)
+			    const double excludeValue, const bool xWrap,
+			    const int numThread)
 {
+  pValidStale();
   // does mask look like local grid?
   if (!sizeEqual(mask))
   {
@@ -1058,22 +1482,18 @@ bool GridData::smoothInMask(const GridData &mask, const double maskValue,
     return false;
   }
 
-  // make a copy of local grid
-  GridData tmp(*this);
-
-  for (int iy=0; iy<pNptY; ++iy)
+  // smooth everywhere into a separate array, then take the mask points
+  vector<double> smoothed(pNptX*pNptY);
+  pBoxFilter(pDataPtr, sx, sy, isExclude, excludeValue, true, xWrap,
+	     numThread, &smoothed[0]);
+  for (int i=0; i<pNptX*pNptY; ++i)
   {
-    for (int ix=0; ix<pNptX; ++ix)
+    if (mask.isEqualAt(i, maskValue))
     {
-      if (mask.isEqualAt(ix, iy, maskValue))
-      {
-	// mask === maskValue at this point, do the averaging
-	double v = pLocalAverage(ix, iy, sx, sy, isExclude, excludeValue, true);
-	tmp.setv(ix, iy, v);
-      }
+      // mask === maskValue at this point, take the average
+      pDataPtr[i] = smoothed[i];
     }
   }
-  *this = tmp;
   return true;
 }
 
@@ -1081,6 +1501,7 @@ bool GridData::smoothInMask(const GridData &mask, const double maskValue,
 void GridData::highSmooth(const int sx, const int sy, const bool isExclude,
 			  const double excludeValue)
 {
+  pValidStale();
   // make a temporary grid
   GridData tmp(*this);
 
@@ -1107,6 +1528,7 @@ bool GridData::highSmoothInMask(const GridData &mask, const double maskValue,
 				const bool isExclude,
 				const double excludeValue)
 {
+  pValidStale();
   // does mask look like local grid?
   if (!sizeEqual(mask))
   {
@@ -1136,6 +1558,7 @@ bool GridData::highSmoothInMask(const GridData &mask, const double maskValue,
 //----------------------------------------------------------------
 void GridData::max(const int sx, const int sy, const bool isAbsoluteMax)
 {
+  pValidStale();
   // make a temporary grid
   GridData tmp(*this);
 
@@ -1159,6 +1582,7 @@ void GridData::max(const int sx, const int sy, const bool isAbsoluteMax)
 //----------------------------------------------------------------
 void GridData::fillGaps(const int sx, const int sy)
 {
+  pValidStale();
   GridData tmp(*this);
   double v;
   for (int iy=0; iy<pNptY; ++iy)
@@ -1179,6 +1603,7 @@ void GridData::fillGaps(const int sx, const int sy)
 //----------------------------------------------------------------
 bool GridData::multiply(const GridData &weight)
 {
+  pValidStale();
   if (pNptX != weight.pNptX || pNptY != weight.pNptY ||  pNptZ != weight.pNptZ)
   {
     ILOG(ERROR, "dimensions are off");
@@ -1211,29 +1636,45 @@ bool GridData::divide(const GridData &divisor)
     return false;
   }
 
-  for (int i=0; i<pNptTotal; ++i)
+  // setv() keeps the mask up to date, so with a mask only the words
+  // with some non-missing data need looking at
+  int nword = pValidCurrent ? static_cast<int>(pValid.size()) : 1;
+  for (int word=0; word<nword; ++word)
   {
-    double v;
-    if (getValue(i, v))
+    int i0 = 0, i1 = pNptTotal;
+    if (pValidCurrent)
+    {
+      if (pValid[word] == 0ULL)
+      {
+	continue;
+      }
+      i0 = word*64;
+      i1 = i0 + 64 < pNptTotal ? i0 + 64 : pNptTotal;
+    }
+    for (int i=i0; i<i1; ++i)
     {
-      double w;
-      if (divisor.getValue(i, w))
+      double v;
+      if (getValue(i, v))
       {
-	if (w != 0)
+	double w;
+	if (divisor.getValue(i, w))
 	{
-	  v = v/w;
+	  if (w != 0)
+	  {
+	    v = v/w;
 
-	  setv(i, v);
+	    setv(i, v);
+	  }
+	  else
+	  {
+	    setv(i,pMissing);
+	  }
 	}
 	else
 	{
 	  setv(i,pMissing);
 	}
       }
-      else
-      {
-	setv(i,pMissing);
-      }
     }
   }
   return true;
@@ -1242,6 +1683,7 @@ bool GridData::divide(const GridData &divisor)
 //----------------------------------------------------------------
 bool GridData::squareRoot(void)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     double w;
@@ -1264,6 +1706,7 @@ bool GridData::squareRoot(void)
 //----------------------------------------------------------------
 bool GridData::sine(void)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     double w;
@@ -1279,6 +1722,7 @@ bool GridData::sine(void)
 //----------------------------------------------------------------
 bool GridData::cosine(void)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     double w;
@@ -1293,6 +1737,7 @@ bool GridData::cosine(void)
 //----------------------------------------------------------------
 bool GridData::arctan(void)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     double w;
@@ -1308,6 +1753,7 @@ bool GridData::arctan(void)
 //----------------------------------------------------------------
 bool GridData::arcsine(void)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     double w;
@@ -1330,6 +1776,7 @@ bool GridData::arcsine(void)
 //----------------------------------------------------------------
 bool GridData::add(const GridData &inp)
 {
+  pValidStale();
   if (inp.pNptTotal != pNptTotal)
   {
     ILOG(ERROR, "grids not same size");
@@ -1356,6 +1803,7 @@ bool GridData::add(const GridData &inp)
 //----------------------------------------------------------------
 bool GridData::subtract(const GridData &inp)
 {
+  pValidStale();
   if (inp.pNptTotal != pNptTotal)
   {
     ILOG(ERROR, "grids not same size");
@@ -1378,6 +1826,7 @@ bool GridData::subtract(const GridData &inp)
 //----------------------------------------------------------------
 bool GridData::add(const double &val)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     if (pDataPtr[i] != pMissing)
@@ -1435,6 +1884,7 @@ bool GridData::nearbyMax(const int centerX, const int centerY, const int sx,
 //----------------------------------------------------------------
 bool GridData::reduce(const int f)
 {
+  pValidStale();
   if (f < 2)
   {
     ILOGF(WARNING, "cant reduce grid f=%d (too small)",f);
@@ -1480,6 +1930,7 @@ bool GridData::reduce(const int f)
 //----------------------------------------------------------------
 bool GridData::interpolate(const GridData &lowres, const int res)
 {
+  pValidStale();
   if (lowres.pNptX != pNptX/res)
   {
     ILOG(ERROR, "lowrespNptX != pNptX/res");
@@ -1513,6 +1964,7 @@ bool GridData::interpolate(const GridData &lowres, const int res)
 void GridData::interpolate(const GridData &lowres, const int res,
 			   bool &status)
 {
+  pValidStale();
   if (lowres.pNptX != pNptX/res)
   {
     ILOG(ERROR, "lowrespNptX != pNptX/res");
@@ -1546,6 +1998,7 @@ void GridData::interpolate(const GridData &lowres, const int res,
 //----------------------------------------------------------------
 void GridData::multiply(const int x, const int y, const double value)
 {
+  pValidStale();
   double v;
   if (getValue(x, y, v))
   {
@@ -1556,6 +2009,7 @@ void GridData::multiply(const int x, const int y, const double value)
 //----------------------------------------------------------------
 void GridData::multiply(const double value)
 {
+  pValidStale();
   for (int i=0; i<pNptTotal; ++i)
   {
     if (pDataPtr[i] != pMissing)
@@ -1576,6 +2030,7 @@ void GridData::incrementValueAtPoint(const int ipt, const double value)
   {
     pDataPtr[ipt] = value;
   }
+  pValidUpdate(ipt);
 }
 
 //----------------------------------------------------------------
@@ -1591,12 +2046,14 @@ void GridData::incrementValueAtPoint(const int x, const int y,
   {
     pDataPtr[ipt] = value;
   }
+  pValidUpdate(ipt);
 }
 
 
 //----------------------------------------------------------------
 int GridData::replace(const double oldv, const double newv)
 {
+  pValidStale();
   ILOGF(DEBUG_VERBOSE, "replacing %lf with %lf", oldv, newv);
   int count = 0;
   for (int i=0; i<pNptTotal; ++i)
@@ -1613,6 +2070,7 @@ int GridData::replace(const double oldv, const double newv)
 //----------------------------------------------------------------
 void GridData::replaceValueWithNearestMax(const double value)
 {
+  pValidStale();
   // need a copy to do this
   GridData tmp(*this);
 
@@ -1662,6 +2120,7 @@ void GridData::replaceValueWithNearestMax(const double value)
 //----------------------------------------------------------------
 void GridData::applyFuzzyF(const ConvWxFuzzy &f)
 {
+  pValidStale();
   for (int i=0; i<pNptX*pNptY; ++i)
   {
     if (pDataPtr[i] != pMissing)
@@ -1674,6 +2133,7 @@ void GridData::applyFuzzyF(const ConvWxFuzzy &f)
 //----------------------------------------------------------------
 bool GridData::maskMissingToMissing(const GridData &mask)
 {
+  pValidStale();
   if (pNptX != mask.pNptX || pNptY != mask.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1696,6 +2156,7 @@ bool GridData::maskMissingToValue(const GridData &mask,
 				  const double replaceV,
 				  const bool overwritepMissing)
 {
+  pValidStale();
   if (pNptX != mask.pNptX || pNptY != mask.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1729,6 +2190,7 @@ bool GridData::maskThreshOrMissingToValue(const GridData &mask,
 					  const double replaceV,
 					  const bool overwritepMissing)
 {
+  pValidStale();
   if (pNptX != mask.pNptX || pNptY != mask.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1759,6 +2221,7 @@ bool GridData::maskThreshOrMissingToValue(const GridData &mask,
 bool GridData::maskBelowThreshToMissing(const GridData &maskGrid, 
 					const double maskThresh)
 {
+  pValidStale();
   if (pNptX != maskGrid.pNptX || pNptY != maskGrid.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1779,6 +2242,7 @@ bool GridData::maskBelowThreshToMissing(const GridData &maskGrid,
 bool GridData::maskAboveThreshToMissing(const GridData &maskGrid, 
 					const double maskThresh)
 {
+  pValidStale();
   if (pNptX != maskGrid.pNptX || pNptY != maskGrid.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1880,6 +2344,7 @@ bool GridData::maxInMask(const GridData &mask,
 bool GridData::setValueInMask(const GridData &mask, const double maskValue,
 			      const double value, double maskTolerance)
 {
+  pValidStale();
   if (pNptX != mask.pNptX || pNptY != mask.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1912,6 +2377,7 @@ bool GridData::setValueInMask(const GridData &mask, const double maskValue,
 bool GridData::setMissingAndMaskNonMissingToValue(const GridData &mask,
 						  const double value)
 {
+  pValidStale();
   if (pNptX != mask.pNptX || pNptY != mask.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1934,6 +2400,7 @@ bool GridData::setMissingAndMaskNonMissingToValue(const GridData &mask,
 //----------------------------------------------------------------
 bool GridData::minimum(const GridData &inp)
 {
+  pValidStale();
   if (pNptX != inp.pNptX || pNptY != inp.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1964,6 +2431,7 @@ bool GridData::minimum(const GridData &inp)
 //----------------------------------------------------------------
 bool GridData::maximum(const GridData &inp)
 {
+  pValidStale();
   if (pNptX != inp.pNptX || pNptY != inp.pNptY)
   {
     ILOG(ERROR, "grids not same size");
@@ -1995,6 +2463,7 @@ bool GridData::maximum(const GridData &inp)
 void GridData::setDataInRangeToValue(const double v0, const double v1, 
 				     const double newValue)
 {
+  pValidStale();
   for (int i=0; i<pNptX*pNptY; ++i)
   {
     double v;
@@ -2312,6 +2781,7 @@ bool GridData::distanceToNonMissing(const int searchScale,
 //----------------------------------------------------------------
 void GridData::invertMissing(void)
 {
+  pValidStale();
   GridData tmp(*this);
   double v = pMissing + 100.0;
   for (int i=0; i<pNptTotal; ++i)
@@ -2354,6 +2824,7 @@ double GridData::diffSq(int x0, int y0, int xoff, int yoff,
 //----------------------------------------------------------------
 void GridData::monotonicDecreasing(const GridData &g)
 {
+  pValidStale();
   if (pNptX != g.pNptX || pNptY != g.pNptY)
   {
     ILOG(ERROR, "Dimensions inconsistent");
@@ -2378,6 +2849,7 @@ void GridData::monotonicDecreasing(const GridData &g)
 //----------------------------------------------------------------
 void GridData::monotonicIncreasing(const GridData &g)
 {
+  pValidStale();
   if (pNptX != g.pNptX || pNptY != g.pNptY)
   {
     ILOG(ERROR, "Dimensions inconsistent");
@@ -2402,6 +2874,7 @@ void GridData::monotonicIncreasing(const GridData &g)
 //----------------------------------------------------------------
 void GridData::oneMinus(const GridData &g)
 {
+  pValidStale();
   if (pNptX != g.pNptX || pNptY != g.pNptY)
   {
     ILOG(ERROR, "Dimensions inconsistent");
@@ -2421,6 +2894,46 @@ void GridData::oneMinus(const GridData &g)
   }
 }
 
+//----------------------------------------------------------------
+void GridData::pAddWeighted(const int i, const double value,
+			    const double weight, GridData &weightSum)
+{
+  if (pDataPtr[i] == pMissing)
+  {
+    pDataPtr[i] = value;
+  }
+  else
+  {
+    pDataPtr[i] += value;
+  }
+  pValidUpdate(i);
+  if (weightSum.pDataPtr[i] == weightSum.pMissing)
+  {
+    weightSum.pDataPtr[i] = weight;
+  }
+  else
+  {
+    weightSum.pDataPtr[i] += weight;
+  }
+  weightSum.pValidUpdate(i);
+}
+
+//----------------------------------------------------------------
+void GridData::pBoxFilter(const double *in, const int sx, const int sy,
+			  const bool isExclude, const double excludeValue,
+			  const bool rejectCenterExclude, const bool xWrap,
+			  const int numThread, double *out) const
+{
+  TaBoxFilter f(sx, sy);
+  if (isExclude)
+  {
+    f.setExclude(excludeValue, rejectCenterExclude);
+  }
+  f.setWraparoundX(xWrap);
+  f.setNumThreads(numThread);
+  f.apply(in, pNptX, pNptY, pMissing, out);
+}
+
 //----------------------------------------------------------------
 double GridData::pLocalAverage(const int ix, const int iy, 
 			       const int sx, const int sy,
@@ -0,0 +1,669 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file Instrumentation.cc
+ */
+
+#include <ConvWx/Instrumentation.hh>
+#include <ConvWx/InterfaceLL.hh>
+#include <pthread.h>
+#include <cstdio>
+#include <cmath>
+#include <map>
+#include <vector>
+
+using std::string;
+using std::map;
+using std::vector;
+
+/**
+ * Number of power of 2 histogram bins
+ */
+static const int NUM_HIST_BINS = 32;
+
+/**
+ * Accumulated timing for one phase
+ */
+typedef struct
+{
+  int n;         /**< Number of timings */
+  double total;  /**< Total seconds */
+  double min;    /**< Shortest */
+  double max;    /**< Longest */
+} PhaseAccum_t;
+
+/**
+ * Accumulated histogram
+ */
+typedef struct
+{
+  int n;                       /**< Number of samples */
+  double sum;                  /**< Sum of samples */
+  int bins[NUM_HIST_BINS];     /**< Counts per bin */
+} HistAccum_t;
+
+/**
+ * Everything accumulated by one thread
+ */
+typedef struct
+{
+  pthread_mutex_t mutex;                 /**< Guards the maps and exited */
+  int index;                             /**< Order of first use */
+  bool exited;                           /**< True once the thread exits */
+  map<string, PhaseAccum_t> phases;      /**< Timing per phase */
+  map<string, double> counts;            /**< Counters */
+  map<string, HistAccum_t> hists;        /**< Histograms */
+} ThreadAccum_t;
+
+/**
+ * Current mode, set once at startup
+ */
+static Instrumentation::Mode_t sMode = Instrumentation::MODE_OFF;
+
+/**
+ * Directory for JSON output
+ */
+static string sJsonDir = "";
+
+/**
+ * Guards sThreads
+ */
+static pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * All the thread records, owned here. The record of a thread that has
+ * exited is kept until its results have been reported, or reset
+ */
+static vector<ThreadAccum_t *> sThreads;
+
+/**
+ * Next ThreadAccum_t::index
+ */
+static int sNextIndex = 0;
+
+/**
+ * This thread's record, NULL until first used
+ */
+static __thread ThreadAccum_t *sThis = NULL;
+
+/**
+ * Key whose destructor marks a thread's record as exited
+ */
+static pthread_key_t sExitKey;
+static pthread_once_t sExitKeyOnce = PTHREAD_ONCE_INIT;
+
+//----------------------------------------------------------------
+static void sThreadExit(void *record)
+{
+  ThreadAccum_t *t = static_cast<ThreadAccum_t *>(record);
+  pthread_mutex_lock(&t->mutex);
+  t->exited = true;
+  pthread_mutex_unlock(&t->mutex);
+  sThis = NULL;
+}
+
+//----------------------------------------------------------------
+static void sMakeExitKey(void)
+{
+  pthread_key_create(&sExitKey, sThreadExit);
+}
+
+//----------------------------------------------------------------
+static ThreadAccum_t *sThread(void)
+{
+  if (sThis == NULL)
+  {
+    ThreadAccum_t *t = new ThreadAccum_t;
+    pthread_mutex_init(&t->mutex, NULL);
+    t->exited = false;
+    pthread_mutex_lock(&sMutex);
+    t->index = sNextIndex++;
+    sThreads.push_back(t);
+    pthread_mutex_unlock(&sMutex);
+    pthread_once(&sExitKeyOnce, sMakeExitKey);
+    pthread_setspecific(sExitKey, t);
+    sThis = t;
+  }
+  return sThis;
+}
+
+//----------------------------------------------------------------
+/**
+ * Clear every thread's results, and drop the records of threads that
+ * have exited. Call with sMutex held.
+ */
+static void sResetLocked(void)
+{
+  vector<ThreadAccum_t *> keep;
+  for (size_t i=0; i<sThreads.size(); ++i)
+  {
+    ThreadAccum_t *t = sThreads[i];
+    pthread_mutex_lock(&t->mutex);
+    t->phases.clear();
+    t->counts.clear();
+    t->hists.clear();
+    bool exited = t->exited;
+    pthread_mutex_unlock(&t->mutex);
+    if (exited)
+    {
+      pthread_mutex_destroy(&t->mutex);
+      delete t;
+    }
+    else
+    {
+      keep.push_back(t);
+    }
+  }
+  sThreads = keep;
+}
+
+//----------------------------------------------------------------
+static void sAddPhase(PhaseAccum_t &a, const PhaseAccum_t &b)
+{
+  if (b.n == 0)
+  {
+    return;
+  }
+  if (a.n == 0 || b.min < a.min)
+  {
+    a.min = b.min;
+  }
+  if (a.n == 0 || b.max > a.max)
+  {
+    a.max = b.max;
+  }
+  a.n += b.n;
+  a.total += b.total;
+}
+
+//----------------------------------------------------------------
+static void sAddHist(HistAccum_t &a, const HistAccum_t &b)
+{
+  a.n += b.n;
+  a.sum += b.sum;
+  for (int i=0; i<NUM_HIST_BINS; ++i)
+  {
+    a.bins[i] += b.bins[i];
+  }
+}
+
+//----------------------------------------------------------------
+static PhaseAccum_t sEmptyPhase(void)
+{
+  PhaseAccum_t a;
+  a.n = 0;
+  a.total = a.min = a.max = 0.0;
+  return a;
+}
+
+//----------------------------------------------------------------
+static HistAccum_t sEmptyHist(void)
+{
+  HistAccum_t h;
+  h.n = 0;
+  h.sum = 0.0;
+  for (int i=0; i<NUM_HIST_BINS; ++i)
+  {
+    h.bins[i] = 0;
+  }
+  return h;
+}
+
+//----------------------------------------------------------------
+/**
+ * Copy of every thread's results, taken under lock, with totals.
+ * With reset, the results are cleared under the same lock, so that
+ * nothing added meanwhile is lost or counted twice.
+ */
+class InstrumentationSnapshot
+{
+public:
+  InstrumentationSnapshot(bool reset)
+  {
+    pthread_mutex_lock(&sMutex);
+    for (size_t i=0; i<sThreads.size(); ++i)
+    {
+      ThreadAccum_t *t = sThreads[i];
+      pthread_mutex_lock(&t->mutex);
+      _index.push_back(t->index);
+      _phases.push_back(t->phases);
+      _counts.push_back(t->counts);
+      _hists.push_back(t->hists);
+      pthread_mutex_unlock(&t->mutex);
+    }
+    if (reset)
+    {
+      sResetLocked();
+    }
+    pthread_mutex_unlock(&sMutex);
+
+    for (size_t i=0; i<_phases.size(); ++i)
+    {
+      map<string, PhaseAccum_t>::const_iterator p;
+      for (p=_phases[i].begin(); p!=_phases[i].end(); ++p)
+      {
+	if (_phaseTotal.find(p->first) == _phaseTotal.end())
+	{
+	  _phaseTotal[p->first] = sEmptyPhase();
+	}
+	sAddPhase(_phaseTotal[p->first], p->second);
+	_phaseNthread[p->first] += 1;
+      }
+      map<string, double>::const_iterator c;
+      for (c=_counts[i].begin(); c!=_counts[i].end(); ++c)
+      {
+	_countTotal[c->first] += c->second;
+	_countNthread[c->first] += 1;
+      }
+      map<string, HistAccum_t>::const_iterator h;
+      for (h=_hists[i].begin(); h!=_hists[i].end(); ++h)
+      {
+	if (_histTotal.find(h->first) == _histTotal.end())
+	{
+	  _histTotal[h->first] = sEmptyHist();
+	}
+	sAddHist(_histTotal[h->first], h->second);
+      }
+    }
+  }
+
+  inline bool isEmpty(void) const
+  {
+    return _phaseTotal.empty() && _countTotal.empty() && _histTotal.empty();
+  }
+
+  vector<int> _index;
+  vector<map<string, PhaseAccum_t> > _phases;
+  vector<map<string, double> > _counts;
+  vector<map<string, HistAccum_t> > _hists;
+  map<string, PhaseAccum_t> _phaseTotal;
+  map<string, int> _phaseNthread;
+  map<string, double> _countTotal;
+  map<string, int> _countNthread;
+  map<string, HistAccum_t> _histTotal;
+};
+
+//----------------------------------------------------------------
+static string sPhaseLine(const string &label, const string &name,
+			 const string &who, const PhaseAccum_t &a)
+{
+  char buf[1000];
+  sprintf(buf, "%s phase %s %s n=%d total=%.3f mean=%.4f min=%.4f max=%.4f",
+	  label.c_str(), name.c_str(), who.c_str(), a.n, a.total,
+	  a.n > 0 ? a.total/(double)a.n : 0.0, a.min, a.max);
+  return buf;
+}
+
+//----------------------------------------------------------------
+static string sPhaseJson(const PhaseAccum_t &a)
+{
+  char buf[1000];
+  sprintf(buf, "{\"n\":%d,\"total\":%.6f,\"mean\":%.6f,\"min\":%.6f,"
+	  "\"max\":%.6f}", a.n, a.total, a.n > 0 ? a.total/(double)a.n : 0.0,
+	  a.min, a.max);
+  return buf;
+}
+
+//----------------------------------------------------------------
+static string sJsonString(const string &s)
+{
+  string ret = "\"";
+  for (size_t i=0; i<s.size(); ++i)
+  {
+    if (s[i] == '"' || s[i] == '\\')
+    {
+      ret += '\\';
+    }
+    ret += s[i];
+  }
+  ret += "\"";
+  return ret;
+}
+
+//----------------------------------------------------------------
+static string sTimeString(const time_t &t)
+{
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  char buf[100];
+  sprintf(buf, "%04d%02d%02d_%02d%02d%02d", tm.tm_year+1900, tm.tm_mon+1,
+	  tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+  return buf;
+}
+
+//----------------------------------------------------------------
+void Instrumentation::setMode(Mode_t mode, const std::string &jsonDir)
+{
+  sMode = mode;
+  sJsonDir = jsonDir;
+}
+
+//----------------------------------------------------------------
+bool Instrumentation::isEnabled(void)
+{
+  return sMode != MODE_OFF;
+}
+
+//----------------------------------------------------------------
+double Instrumentation::now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec*1.0e-9;
+}
+
+//----------------------------------------------------------------
+void Instrumentation::addTime(const char *phase, double seconds)
+{
+  if (sMode == MODE_OFF)
+  {
+    return;
+  }
+  ThreadAccum_t *t = sThread();
+  pthread_mutex_lock(&t->mutex);
+  map<string, PhaseAccum_t>::iterator i = t->phases.find(phase);
+  if (i == t->phases.end())
+  {
+    i = t->phases.insert(std::make_pair(string(phase), sEmptyPhase())).first;
+  }
+  PhaseAccum_t e = sEmptyPhase();
+  e.n = 1;
+  e.total = e.min = e.max = seconds;
+  sAddPhase(i->second, e);
+  pthread_mutex_unlock(&t->mutex);
+}
+
+//----------------------------------------------------------------
+void Instrumentation::addCount(const char *counter, double n)
+{
+  if (sMode == MODE_OFF)
+  {
+    return;
+  }
+  ThreadAccum_t *t = sThread();
+  pthread_mutex_lock(&t->mutex);
+  t->counts[counter] += n;
+  pthread_mutex_unlock(&t->mutex);
+}
+
+//----------------------------------------------------------------
+void Instrumentation::addSample(const char *histogram, double value)
+{
+  if (sMode == MODE_OFF)
+  {
+    return;
+  }
+  int bin = 0;
+  if (value >= 1.0)
+  {
+    int e;
+    frexp(value, &e);
+    bin = e < NUM_HIST_BINS ? e : NUM_HIST_BINS-1;
+  }
+  ThreadAccum_t *t = sThread();
+  pthread_mutex_lock(&t->mutex);
+  map<string, HistAccum_t>::iterator i = t->hists.find(histogram);
+  if (i == t->hists.end())
+  {
+    i = t->hists.insert(std::make_pair(string(histogram),
+				       sEmptyHist())).first;
+  }
+  i->second.n++;
+  i->second.sum += value;
+  i->second.bins[bin]++;
+  pthread_mutex_unlock(&t->mutex);
+}
+
+//----------------------------------------------------------------
+static string sLines(const InstrumentationSnapshot &s, const string &prefix)
+{
+  string ret;
+  char buf[1000];
+
+  map<string, PhaseAccum_t>::const_iterator p;
+  for (p=s._phaseTotal.begin(); p!=s._phaseTotal.end(); ++p)
+  {
+    ret += sPhaseLine(prefix, p->first, "all", p->second) + "\n";
+    if (s._phaseNthread.find(p->first)->second < 2)
+    {
+      continue;
+    }
+    for (size_t i=0; i<s._phases.size(); ++i)
+    {
+      map<string, PhaseAccum_t>::const_iterator pi =
+	s._phases[i].find(p->first);
+      if (pi != s._phases[i].end() && pi->second.n > 0)
+      {
+	sprintf(buf, "thread%d", s._index[i]);
+	ret += sPhaseLine(prefix, p->first, buf, pi->second) + "\n";
+      }
+    }
+  }
+
+  map<string, double>::const_iterator c;
+  for (c=s._countTotal.begin(); c!=s._countTotal.end(); ++c)
+  {
+    sprintf(buf, "%s count %s all %.0f", prefix.c_str(), c->first.c_str(),
+	    c->second);
+    ret += buf;
+    ret += "\n";
+    if (s._countNthread.find(c->first)->second < 2)
+    {
+      continue;
+    }
+    for (size_t i=0; i<s._counts.size(); ++i)
+    {
+      map<string, double>::const_iterator ci = s._counts[i].find(c->first);
+      if (ci != s._counts[i].end())
+      {
+	sprintf(buf, "%s count %s thread%d %.0f", prefix.c_str(),
+		c->first.c_str(), s._index[i], ci->second);
+	ret += buf;
+	ret += "\n";
+      }
+    }
+  }
+
+  map<string, HistAccum_t>::const_iterator h;
+  for (h=s._histTotal.begin(); h!=s._histTotal.end(); ++h)
+  {
+    const HistAccum_t &a = h->second;
+    sprintf(buf, "%s hist %s all n=%d mean=%.4f bins", prefix.c_str(),
+	    h->first.c_str(), a.n, a.n > 0 ? a.sum/(double)a.n : 0.0);
+    ret += buf;
+    for (int i=0; i<NUM_HIST_BINS; ++i)
+    {
+      if (a.bins[i] > 0)
+      {
+	// upper bound of the bin, then count
+	sprintf(buf, " <%.0f:%d", ldexp(1.0, i), a.bins[i]);
+	ret += buf;
+      }
+    }
+    ret += "\n";
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------
+static string sJson(const InstrumentationSnapshot &s, const string &label,
+		    const time_t &t)
+{
+  char buf[1000];
+  string ret = "{\"label\":" + sJsonString(label);
+  ret += ",\"time\":" + sJsonString(sTimeString(t));
+
+  ret += ",\"phases\":{";
+  map<string, PhaseAccum_t>::const_iterator p;
+  for (p=s._phaseTotal.begin(); p!=s._phaseTotal.end(); ++p)
+  {
+    if (p != s._phaseTotal.begin())
+    {
+      ret += ",";
+    }
+    ret += sJsonString(p->first) + ":{\"all\":" + sPhaseJson(p->second);
+    ret += ",\"threads\":{";
+    bool first = true;
+    for (size_t i=0; i<s._phases.size(); ++i)
+    {
+      map<string, PhaseAccum_t>::const_iterator pi =
+	s._phases[i].find(p->first);
+      if (pi != s._phases[i].end() && pi->second.n > 0)
+      {
+	sprintf(buf, "%s\"%d\":", first ? "" : ",", s._index[i]);
+	ret += buf + sPhaseJson(pi->second);
+	first = false;
+      }
+    }
+    ret += "}}";
+  }
+
+  ret += "},\"counters\":{";
+  map<string, double>::const_iterator c;
+  for (c=s._countTotal.begin(); c!=s._countTotal.end(); ++c)
+  {
+    if (c != s._countTotal.begin())
+    {
+      ret += ",";
+    }
+    sprintf(buf, ":{\"all\":%.0f,\"threads\":{", c->second);
+    ret += sJsonString(c->first) + buf;
+    bool first = true;
+    for (size_t i=0; i<s._counts.size(); ++i)
+    {
+      map<string, double>::const_iterator ci = s._counts[i].find(c->first);
+      if (ci != s._counts[i].end())
+      {
+	sprintf(buf, "%s\"%d\":%.0f", first ? "" : ",", s._index[i],
+		ci->second);
+	ret += buf;
+	first = false;
+      }
+    }
+    ret += "}}";
+  }
+
+  ret += "},\"histograms\":{";
+  map<string, HistAccum_t>::const_iterator h;
+  for (h=s._histTotal.begin(); h!=s._histTotal.end(); ++h)
+  {
+    if (h != s._histTotal.begin())
+    {
+      ret += ",";
+    }
+    const HistAccum_t &a = h->second;
+    sprintf(buf, ":{\"n\":%d,\"sum\":%.6f,\"bins\":[", a.n, a.sum);
+    ret += sJsonString(h->first) + buf;
+    for (int i=0; i<NUM_HIST_BINS; ++i)
+    {
+      sprintf(buf, "%s%d", i == 0 ? "" : ",", a.bins[i]);
+      ret += buf;
+    }
+    ret += "]}";
+  }
+  ret += "}}\n";
+  return ret;
+}
+
+//----------------------------------------------------------------
+std::string Instrumentation::summaryLines(const std::string &prefix)
+{
+  InstrumentationSnapshot s(false);
+  return sLines(s, prefix);
+}
+
+//----------------------------------------------------------------
+std::string Instrumentation::summaryJson(const std::string &label,
+					 const time_t &t)
+{
+  InstrumentationSnapshot s(false);
+  return sJson(s, label, t);
+}
+
+//----------------------------------------------------------------
+std::string Instrumentation::report(const std::string &label,
+				    const time_t &t)
+{
+  if (sMode == MODE_OFF)
+  {
+    return "";
+  }
+
+  // one snapshot, cleared as it is taken, for both outputs
+  InstrumentationSnapshot s(true);
+  if (s.isEmpty())
+  {
+    return "";
+  }
+  string ret = sLines(s, label + " " + sTimeString(t));
+  if (sMode == MODE_JSON && !sJsonDir.empty())
+  {
+    string path = pJsonFileName(label, t);
+    if (InterfaceLL::makeDirRecurse(path))
+    {
+      FILE *fp = fopen(path.c_str(), "w");
+      if (fp != NULL)
+      {
+	string j = sJson(s, label, t);
+	fputs(j.c_str(), fp);
+	fclose(fp);
+      }
+      else
+      {
+	ret += "Cannot write " + path + "\n";
+      }
+    }
+    else
+    {
+      ret += "Cannot create " + sJsonDir + "\n";
+    }
+  }
+  if (!ret.empty() && ret[ret.size()-1] == '\n')
+  {
+    ret = ret.substr(0, ret.size()-1);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------
+void Instrumentation::reset(void)
+{
+  pthread_mutex_lock(&sMutex);
+  sResetLocked();
+  pthread_mutex_unlock(&sMutex);
+}
+
+//----------------------------------------------------------------
+std::string Instrumentation::pJsonFileName(const std::string &label,
+					   const time_t &t)
+{
+  string name = sTimeString(t) + "_";
+  for (size_t i=0; i<label.size(); ++i)
+  {
+    char c = label[i];
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	(c >= '0' && c <= '9'))
+    {
+      name += c;
+    }
+    else
+    {
+      name += '_';
+    }
+  }
+  return sJsonDir + "/" + name + ".json";
+}
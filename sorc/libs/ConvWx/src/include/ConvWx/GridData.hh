@@ -584,6 +584,37 @@ public:
 				   bool yWrap, double &value,
 				   bool &outOfBounds) const;
 
+  /**
+   * Compute the percent of data above each of several thresholds over a
+   * grid subset, in one pass over the subset.
+   *
+   * Each non-missing point is placed against the sorted thresholds with a
+   * binary search, so the cost is one scan plus log(number of thresholds)
+   * per point, instead of one scan per threshold.
+   *
+   * @param[in] thresholds  The thresholds, any order
+   * @param[in] x0  Minimum x index
+   * @param[in] y0  Minimum y index
+   * @param[in] nx  Number of x indices
+   * @param[in] ny  Number of y indices
+   * @param[in] xWrap  True to allow wraparound in X 
+   * @param[in] yWrap  True to allow wraparound in Y 
+   * @param[out] values  percentage returned for each threshold, same order
+   *                     as thresholds
+   * @param[out] outOfBounds  set True of the window goes out of bounds,
+   *                          and there is not wraparound
+   * @return true if at least one point is non-missing and subset is 
+   *         entirely in range, false otherwise
+   *
+   * Each value is identical to what percentAboveThresholdSubset() gives
+   * for that threshold.
+   */
+  bool percentAboveThresholdsSubset(const std::vector<double> &thresholds,
+				    int x0, int y0, int nx, int ny,
+				    bool xWrap, bool yWrap,
+				    std::vector<double> &values,
+				    bool &outOfBounds) const;
+
   /**
    * Return the range of data values
    *
@@ -725,6 +756,7 @@ public:
     else
     {
       pDataPtr[i] = value;
+      pValidUpdate(i);
     }
   }
 
@@ -737,7 +769,9 @@ public:
    */
   inline void setv(const int x, const int y, const double value)
   {
-    pDataPtr[pIpt(x, y, 0)] = value;
+    int i = pIpt(x, y, 0);
+    pDataPtr[i] = value;
+    pValidUpdate(i);
   }
 
   
@@ -751,7 +785,9 @@ public:
    */
   inline void setv(const int x, const int y, const int z, const double value)
   {
-    pDataPtr[pIpt(x, y, z)] = value;
+    int i = pIpt(x, y, z);
+    pDataPtr[i] = value;
+    pValidUpdate(i);
   }
 
   /**
@@ -801,6 +837,67 @@ public:
 
   /** @} */
 
+  //////////////////////////////////////////////////////////////////////
+  /**
+   * @name Validity mask
+   *
+   * A packed bitmask with one bit per grid point, set where the data is not
+   * missing.  It is built by the constructors and by copyValues() and
+   * setAllToValue(), and kept up to date bit by bit by setv(),
+   * setToMissing() and incrementValueAtPoint().  Other methods that change
+   * data in bulk drop it, after which buildValidMask() brings it back.
+   * It is never built inside a const method, so a grid can be read by
+   * several threads at once.
+   *
+   * The subset statistics, numValid(), divide() and addWeighted() use it
+   * when it is there to skip 64 missing points at a time, and to run with
+   * no missing data test over each 64 points that have no missing data,
+   * otherwise they test each point.
+   *
+   * @{
+   */
+
+  /**
+   * Build the validity mask from the data
+   */
+  void buildValidMask(void);
+
+  /**
+   * @return true if the validity mask agrees with the data
+   */
+  inline bool hasValidMask(void) const {return pValidCurrent;}
+
+  /**
+   * @return the validity mask, bit i%64 of word i/64 set when point i is
+   *         not missing, unused bits of the last word clear.  Only
+   *         meaningful when hasValidMask() is true.
+   */
+  inline const std::vector<unsigned long long> &validMask(void) const
+  {
+    return pValid;
+  }
+
+  /**
+   * @return number of non-missing points
+   */
+  int numValid(void) const;
+
+  /**
+   * At each point where an input grid is not missing, add weight times the
+   * input to the local grid and add weight to a weight sum grid.  Local
+   * or weight sum values that are missing at those points are treated as 0.
+   *
+   * @param[in] g  Input grid
+   * @param[in] weight  Weight for the input grid
+   * @param[in,out] weightSum  Running sum of weights
+   *
+   * @return false if the three grids are not the same size
+   */
+  bool addWeighted(const GridData &g, const double weight,
+		   GridData &weightSum);
+
+  /** @} */
+
 
 
   //////////////////////////////////////////////////////////////////////
@@ -882,9 +979,17 @@ public:
    * data in it, the smoothed value is equal to the excludeValue, otherwise
    * it is equal to the average of all non-excludeValue point in the box.
    * 
+   * Done with a separable running sum box filter (TaBoxFilter), so the
+   * cost per point does not depend on sx, sy.  Only the first z level
+   * is smoothed.
+   *
+   * @param[in] xWrap  True if the grid wraps around in x, so the box at
+   *                   each edge takes in points from the other edge
+   * @param[in] numThread  Number of threads, 1 for none
    */
   void smooth(int sx, int sy, bool isExclude = false, double excludeValue=0.0,
-	      bool rejectCenterExclude=true);
+	      bool rejectCenterExclude=true, bool xWrap=false,
+	      int numThread=1);
 
   /**
    * Apply a sx by sy smoothing (averaging) filter to the local grid
@@ -929,13 +1034,18 @@ public:
    * @param[in] isExclude  True to exclude a value from the smoothing
    * @param[in] excludeValue  Value to exclude from smoothing when
    *                          isExclude = true
+   * @param[in] xWrap  True if the grid wraps around in x
+   * @param[in] numThread  Number of threads, 1 for none
    *
    * @return  False if the mask and local grid don't have the same dimensions,
    *          True otherwise
+   *
+   * The smoothing is as in smooth() with rejectCenterExclude=true.
    */
   bool smoothInMask(const GridData &mask, const double maskValue, const int sx,
 		    const int sy, const bool isExclude=false,
-		    const double excludeValue=0.0);
+		    const double excludeValue=0.0, const bool xWrap=false,
+		    const int numThread=1);
 
   /**
    * Apply a sx by sy high smoothing filter to the local grid
@@ -1545,6 +1655,40 @@ protected:
   int pNptZ;        /**< number of z dimension data grid points */
   double pMissing;/**< data missing value */
 
+  /**
+   * Validity mask, bit i%64 of word i/64 set when point i is not missing.
+   * Only meaningful when pValidCurrent is true.
+   */
+  std::vector<unsigned long long> pValid;
+  bool pValidCurrent; /**< True if pValid agrees with the data */
+
+  /**
+   * Bring the validity mask bit for one point up to date, if the mask is
+   * being kept
+   * @param[in] i  One dimensional index
+   */
+  inline void pValidUpdate(const int i)
+  {
+    if (pValidCurrent)
+    {
+      unsigned long long bit = 1ULL << (i & 63);
+      if (pDataPtr[i] != pMissing)
+      {
+	pValid[i >> 6] |= bit;
+      }
+      else
+      {
+	pValid[i >> 6] &= ~bit;
+      }
+    }
+  }
+
+  /**
+   * Note that the data has changed in bulk, so the validity mask no longer
+   * agrees with it
+   */
+  inline void pValidStale(void) {pValidCurrent = false;}
+
 private:  
 
   /**
@@ -1594,6 +1738,42 @@ private:
     return ipt -  (pZpt(ipt) * pNptX * pNptY) - (pYpt(ipt) * pNptX);
   }
 
+  /**
+   * Apply a sx by sy smoothing (averaging) filter to the first level of
+   * a grid the same size as the local grid
+   *
+   * @param[in] in  Data to smooth, pNptX*pNptY values
+   * @param[in] sx  Box radius x
+   * @param[in] sy  Box radius y
+   * @param[in] isExclude  True to exclude a particular value from the
+   *                       smoothing, false to allow all values
+   * @param[in] excludeValue  The value to exclude when isExclude = true
+   * @param[in] rejectCenterExclude  As in smooth()
+   * @param[in] xWrap  True if the grid wraps around in x
+   * @param[in] numThread  Number of threads, 1 for none
+   * @param[out] out  Smoothed first level, pNptX*pNptY values, not in
+   *
+   * Called by GridData::smooth() and GridData::smoothInMask()
+   */
+  void pBoxFilter(const double *in, const int sx, const int sy,
+		  const bool isExclude, const double excludeValue,
+		  const bool rejectCenterExclude, const bool xWrap,
+		  const int numThread, double *out) const;
+
+  /**
+   * Add a value to the local grid and a weight to a weight sum grid at a
+   * point, where missing counts as 0, keeping both validity masks
+   *
+   * @param[in] i  One dimensional index
+   * @param[in] value  Value to add
+   * @param[in] weight  Weight to add
+   * @param[in,out] weightSum  Weight sum grid
+   *
+   * Called by GridData::addWeighted()
+   */
+  void pAddWeighted(const int i, const double value, const double weight,
+		    GridData &weightSum);
+
   /**
    * Apply a sx by sy smoothing (averaging) filter to the local grid
    * at a point
@@ -1612,7 +1792,7 @@ private:
    * @return the average of all data in the box bounded by
    * [ix-sx,iy-sy],[ix+sx,iy+xy]
    *
-   * called by GridData::smooth()
+   * called by GridData::fillGaps()
    * 
    */
   double pLocalAverage(const int ix, const int iy, const int sx, const int sy,
@@ -0,0 +1,144 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+#include <toolsa/copyright.h>
+/**
+ * @file Instrumentation.hh
+ * @brief  Per phase timing, counters and histograms, all static.
+ * @class Instrumentation
+ * @brief  Per phase timing, counters and histograms, all static.
+ *
+ * Each thread accumulates into its own record, so adding a timing or count
+ * from inside a worker thread costs one uncontended lock and a map lookup.
+ * The records are merged only when a summary is produced, normally once
+ * per trigger via report(), which also resets everything for the next
+ * trigger.
+ *
+ * Nothing is accumulated until setMode() turns instrumentation on, so apps
+ * that never call it pay only the cost of a flag test.
+ *
+ * Phase names are free form; the EPOCH apps use "load", "count",
+ * "tileStats", "spdbRead", "spdbWrite" and "mdvWrite" (see PhaseTimer for
+ * the scoped timer).
+ */
+
+#ifndef INSTRUMENTATION_HH
+#define INSTRUMENTATION_HH
+
+#include <string>
+#include <ctime>
+
+//----------------------------------------------------------------
+class Instrumentation
+{
+public:
+
+  /**
+   * @enum Mode_t
+   * @brief What report() does with the results
+   */
+  typedef enum
+  {
+    MODE_OFF = 0,  /**< Nothing accumulated, nothing reported */
+    MODE_LOG = 1,  /**< One summary line per phase/counter/histogram */
+    MODE_JSON = 2  /**< Lines as with MODE_LOG, plus a JSON file per trigger */
+  } Mode_t;
+
+  /**
+   * Set the reporting mode
+   * @param[in] mode
+   * @param[in] jsonDir  Directory for JSON output when mode=MODE_JSON
+   */
+  static void setMode(Mode_t mode, const std::string &jsonDir="");
+
+  /**
+   * @return true if instrumentation is accumulating
+   */
+  static bool isEnabled(void);
+
+  /**
+   * @return seconds from a monotonic clock, for computing elapsed times
+   */
+  static double now(void);
+
+  /**
+   * Add elapsed time to a phase, for the calling thread
+   * @param[in] phase  Phase name
+   * @param[in] seconds  Elapsed time
+   */
+  static void addTime(const char *phase, double seconds);
+
+  /**
+   * Add to a counter, for the calling thread
+   * @param[in] counter  Counter name
+   * @param[in] n  Amount to add
+   */
+  static void addCount(const char *counter, double n=1.0);
+
+  /**
+   * Add a sample to a histogram with power of 2 bins, for the calling
+   * thread. Bin 0 holds values < 1, bin k holds [2^(k-1), 2^k).
+   * @param[in] histogram  Histogram name
+   * @param[in] value  Sample, in whatever units the caller chooses
+   */
+  static void addSample(const char *histogram, double value);
+
+  /**
+   * @return a line oriented summary, totals across threads then per thread
+   * @param[in] prefix  Prefix for each line
+   */
+  static std::string summaryLines(const std::string &prefix);
+
+  /**
+   * @return the summary as a JSON object
+   * @param[in] label  Label, typically the app name
+   * @param[in] t  Time, typically the trigger time
+   */
+  static std::string summaryJson(const std::string &label, const time_t &t);
+
+  /**
+   * Produce the per trigger summary according to the mode, then reset.
+   * The results are taken and cleared in one step, so values added by
+   * other threads meanwhile go into the next report. Records of threads
+   * that have exited are dropped once reported.
+   *
+   * @param[in] label  Label, typically the app name
+   * @param[in] t  Time, typically the trigger time
+   *
+   * @return the summary lines, each prefixed by 'label yyyymmdd_hhmmss',
+   *         empty if the mode is MODE_OFF or nothing was accumulated.
+   *         The caller logs these.
+   *
+   * For MODE_JSON the file is <jsonDir>/yyyymmdd_hhmmss_<label>.json, with
+   * characters that are not alphanumeric in the label replaced by '_'.
+   */
+  static std::string report(const std::string &label, const time_t &t);
+
+  /**
+   * Clear all accumulated values in all threads
+   */
+  static void reset(void);
+
+private:
+
+  /**
+   * @return the JSON file path for a label and time
+   */
+  static std::string pJsonFileName(const std::string &label,
+				   const time_t &t);
+};
+
+#endif
@@ -0,0 +1,90 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+#include <toolsa/copyright.h>
+/**
+ * @file PhaseTimer.hh
+ * @brief  Scoped timer that adds its lifetime to an Instrumentation phase
+ * @class PhaseTimer
+ * @brief  Scoped timer that adds its lifetime to an Instrumentation phase
+ *
+ * @code
+ *   {
+ *     PhaseTimer t("load");
+ *     InterfaceIO::loadMultiFcst(...);
+ *   }
+ * @endcode
+ *
+ * When instrumentation is off the constructor and destructor only test
+ * a flag.
+ */
+
+#ifndef PHASE_TIMER_HH
+#define PHASE_TIMER_HH
+
+#include <ConvWx/Instrumentation.hh>
+
+//----------------------------------------------------------------
+class PhaseTimer
+{
+public:
+
+  /**
+   * Start timing
+   * @param[in] phase  Phase name, must outlive this object (use a literal)
+   */
+  inline PhaseTimer(const char *phase) :
+    pPhase(phase),
+    pOn(Instrumentation::isEnabled()),
+    pT0(0.0)
+  {
+    if (pOn)
+    {
+      pT0 = Instrumentation::now();
+    }
+  }
+
+  /**
+   * Stop timing, add to the phase
+   */
+  inline ~PhaseTimer(void)
+  {
+    stop();
+  }
+
+  /**
+   * Stop timing early, add to the phase. Later calls do nothing.
+   */
+  inline void stop(void)
+  {
+    if (pOn)
+    {
+      Instrumentation::addTime(pPhase, Instrumentation::now() - pT0);
+      pOn = false;
+    }
+  }
+
+private:
+
+  const char *pPhase;  /**< Phase name */
+  bool pOn;            /**< True while timing */
+  double pT0;          /**< Start time */
+
+  PhaseTimer(const PhaseTimer &);
+  PhaseTimer &operator=(const PhaseTimer &);
+};
+
+#endif
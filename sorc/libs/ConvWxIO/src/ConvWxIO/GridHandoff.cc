@@ -0,0 +1,634 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+#include <toolsa/copyright.h>
+/**
+ * @file GridHandoff.cc
+ */
+
+//----------------------------------------------------------------
+#include <cstring>
+#include <ConvWxIO/GridHandoff.hh>
+#include <ConvWxIO/ILogMsg.hh>
+#include <ConvWx/ParmProjection.hh>
+#include <ConvWx/Grid.hh>
+#include <ConvWx/MultiGrid.hh>
+#include <ConvWx/MetaData.hh>
+#include <ConvWx/ConvWxTime.hh>
+#include <Fmq/DsFmq.hh>
+#include <Mdv/Mdvx.hh>
+#include <didss/DsURL.hh>
+#include <dataport/port_types.h>
+#include <toolsa/file_io.h>
+#include <toolsa/uusleep.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+using std::string;
+using std::vector;
+using std::deque;
+
+/**
+ * Magic cookie at the start of each message
+ */
+static const si32 sMagic = 20220601;
+
+/**
+ * Number of projection values in the message header
+ */
+static const int sNproj = 14;
+
+/**
+ * Number of strings in the message, in this order:
+ * url, path, metadata name, metadata info, metadata source, metadata xml
+ */
+static const int sNstring = 6;
+
+/**
+ * Milliseconds the subscriber drain thread sleeps when the queue is empty
+ */
+static const int sDrainSleepMsec = 100;
+
+/**
+ * Message header, followed by nfields sFieldHdr_t, then the strings (no
+ * null termination) padded to 4 bytes, then nfields*nx*ny*nz fl32 values.
+ *
+ * Messages stay in native byte order, as the intended device is shared
+ * memory on a single node.
+ */
+typedef struct
+{
+  si32 magic;
+  si32 nfields;
+  si64 genTime;
+  si64 timeWritten;
+  si32 leadTime;
+  si32 projType;
+  si32 nx;
+  si32 ny;
+  si32 nz;
+  si32 spare;
+  fl64 proj[sNproj];
+  si32 strLen[sNstring];
+} sMsgHdr_t;
+
+/**
+ * Per field header
+ */
+typedef struct
+{
+  char name[64];
+  char units[64];
+  fl64 missing;
+} sFieldHdr_t;
+
+//----------------------------------------------------------------
+static void sProjToArray(const ParmProjection &p, fl64 *v)
+{
+  v[0] = p.pDx;
+  v[1] = p.pDy;
+  v[2] = p.pDz;
+  v[3] = p.pMinx;
+  v[4] = p.pMiny;
+  v[5] = p.pMinz;
+  v[6] = p.pOriginLat;
+  v[7] = p.pOriginLon;
+  v[8] = p.pLat1;
+  v[9] = p.pLat2;
+  v[10] = p.pOffsetOriginLat;
+  v[11] = p.pOffsetOriginLon;
+  v[12] = p.pRotation;
+  v[13] = p.pEarthRadiusKm;
+}
+
+//----------------------------------------------------------------
+static size_t sPad4(const size_t n)
+{
+  return ((n + 3)/4)*4;
+}
+
+//----------------------------------------------------------------
+GridHandoff::GridHandoff(void) :
+  pFmq(NULL),
+  pIsPublisher(false),
+  pMaxEntries(0),
+  pThreadRunning(false),
+  pStop(false),
+  pReaderLockFd(-1)
+{
+  pthread_mutex_init(&pMutex, NULL);
+}
+
+//----------------------------------------------------------------
+GridHandoff::~GridHandoff(void)
+{
+  if (pThreadRunning)
+  {
+    pthread_mutex_lock(&pMutex);
+    pStop = true;
+    pthread_mutex_unlock(&pMutex);
+    pthread_join(pThread, NULL);
+  }
+  if (pReaderLockFd >= 0)
+  {
+    close(pReaderLockFd);
+  }
+  if (pFmq != NULL)
+  {
+    pFmq->closeMsgQueue();
+    delete pFmq;
+    pFmq = NULL;
+  }
+  pthread_mutex_destroy(&pMutex);
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::initPublisher(const string &fmqUrl, const int numSlots,
+				const int bufSize, const bool blocking)
+{
+  pFmq = new DsFmq();
+  if (pFmq->initReadWrite(fmqUrl.c_str(), "GridHandoff", false,
+			  Fmq::END, false, numSlots, bufSize))
+  {
+    ILOGF(ERROR, "Cannot open grid handoff queue %s for writing",
+	  fmqUrl.c_str());
+    delete pFmq;
+    pFmq = NULL;
+    return false;
+  }
+  if (blocking)
+  {
+    ILOGF(DEBUG, "Blocking writes to %s, only one subscriber will read it",
+	  fmqUrl.c_str());
+    pFmq->setBlockingWrite();
+  }
+  pIsPublisher = true;
+  ILOGF(DEBUG, "Publishing grids to %s, %d slots, %d bytes",
+	fmqUrl.c_str(), numSlots, bufSize);
+  return true;
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::initSubscriber(const string &fmqUrl, const int numSlots,
+				 const int bufSize, const int maxEntries)
+{
+  pFmq = new DsFmq();
+
+  // read/write so that blocking writers see our read position.  Start at
+  // the end, anything published earlier is read from the files
+  if (pFmq->initReadWrite(fmqUrl.c_str(), "GridHandoff", false,
+			  Fmq::END, false, numSlots, bufSize))
+  {
+    ILOGF(ERROR, "Cannot open grid handoff queue %s for reading",
+	  fmqUrl.c_str());
+    delete pFmq;
+    pFmq = NULL;
+    return false;
+  }
+  pIsPublisher = false;
+  pMaxEntries = maxEntries;
+  if (pMaxEntries < 1)
+  {
+    pMaxEntries = 1;
+  }
+  if (!pLockReader(pFmq->getFmqPath()))
+  {
+    ILOGF(DEBUG, "Another subscriber holds the reader lock for %s",
+	  fmqUrl.c_str());
+  }
+
+  // read continuously, so the cache fills as the producer writes rather
+  // than when the trigger fires, and a blocking producer never waits on us
+  if (pthread_create(&pThread, NULL, pDrainThread, this) != 0)
+  {
+    ILOGF(ERROR, "Cannot start grid handoff thread for %s", fmqUrl.c_str());
+    pFmq->closeMsgQueue();
+    delete pFmq;
+    pFmq = NULL;
+    return false;
+  }
+  pThreadRunning = true;
+  ILOGF(DEBUG, "Subscribed to grids from %s, caching up to %d",
+	fmqUrl.c_str(), pMaxEntries);
+  return true;
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::publish(const time_t &gt, const int lt, const string &url,
+			  const ParmProjection &proj, const MultiGrid &grids,
+			  const MetaData &metadata, const string &path,
+			  const time_t &timeWritten)
+{
+  if (pFmq == NULL || !pIsPublisher || grids.num() == 0)
+  {
+    return false;
+  }
+
+  // only publish what the file holds exactly
+  for (int i=0; i<grids.num(); ++i)
+  {
+    const Grid *g = grids.ithConstGrid(i);
+    if (g->getEncoding() != Grid::ENCODING_FLOAT32)
+    {
+      ILOGF(DEBUG_VERBOSE, "Not publishing %s, %s is not float32",
+	    url.c_str(), g->getName().c_str());
+      return false;
+    }
+  }
+
+  int nx, ny, nz;
+  grids.ithConstGrid(0)->getDim(nx, ny, nz);
+  int npt = nx*ny*nz;
+
+  string strings[sNstring];
+  strings[0] = pNormalizeUrl(url);
+  strings[1] = path;
+
+  // same truncation as the master header, so the file and message agree
+  strings[2] = metadata.hasName() ? metadata.nameCStr() : "";
+  strings[2] = strings[2].substr(0, MDV_NAME_LEN-1);
+  strings[3] = metadata.hasInfo() ? metadata.infoCStr() : "";
+  strings[3] = strings[3].substr(0, MDV_INFO_LEN-1);
+  strings[4] = metadata.hasSource() ? metadata.sourceCStr() : "";
+  strings[4] = strings[4].substr(0, MDV_NAME_LEN-1);
+  strings[5] = metadata.hasXml() ? metadata.xmlCStr() : "";
+
+  sMsgHdr_t hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = sMagic;
+  hdr.nfields = grids.num();
+  hdr.genTime = gt;
+  hdr.timeWritten = timeWritten;
+  hdr.leadTime = lt;
+  hdr.projType = static_cast<si32>(proj.pProjection);
+  hdr.nx = nx;
+  hdr.ny = ny;
+  hdr.nz = nz;
+  sProjToArray(proj, hdr.proj);
+  size_t slen = 0;
+  for (int i=0; i<sNstring; ++i)
+  {
+    hdr.strLen[i] = static_cast<si32>(strings[i].size());
+    slen += strings[i].size();
+  }
+
+  MemBuf buf;
+  buf.add(&hdr, sizeof(hdr));
+  for (int i=0; i<grids.num(); ++i)
+  {
+    const Grid *g = grids.ithConstGrid(i);
+    sFieldHdr_t fh;
+    memset(&fh, 0, sizeof(fh));
+    strncpy(fh.name, g->getName().c_str(), MDV_LONG_FIELD_LEN-1);
+    strncpy(fh.units, g->getUnits().c_str(), MDV_UNITS_LEN-1);
+    fh.missing = g->getMissing();
+    buf.add(&fh, sizeof(fh));
+  }
+  for (int i=0; i<sNstring; ++i)
+  {
+    buf.add(strings[i].c_str(), strings[i].size());
+  }
+  size_t pad = sPad4(slen) - slen;
+  if (pad > 0)
+  {
+    char zeros[4] = {0, 0, 0, 0};
+    buf.add(zeros, pad);
+  }
+
+  // decode straight into the message, same NaN filtering as the file
+  size_t off = buf.getLen();
+  buf.reserve(off + static_cast<size_t>(grids.num())*npt*sizeof(fl32));
+  for (int i=0; i<grids.num(); ++i)
+  {
+    const Grid *g = grids.ithConstGrid(i);
+    fl32 *data = reinterpret_cast<fl32 *>(static_cast<char *>(buf.getPtr()) +
+					  off) + static_cast<size_t>(i)*npt;
+    if (!g->copyFloatFilterNans(data, g->getName(), npt))
+    {
+      return false;
+    }
+  }
+
+  // writers can be called from several threads
+  pthread_mutex_lock(&pMutex);
+  int stat = pFmq->writeMsg(GRID_MSG, 0, buf.getPtr(),
+			    static_cast<int>(buf.getLen()));
+  pthread_mutex_unlock(&pMutex);
+  if (stat)
+  {
+    ILOGF(WARNING, "Failed to publish %s %s+%d to grid handoff queue",
+	  url.c_str(), ConvWxTime::stime(gt).c_str(), lt);
+    return false;
+  }
+  ILOGF(DEBUG_VERBOSE, "Published %s %s+%d, %d fields",
+	url.c_str(), ConvWxTime::stime(gt).c_str(), lt, grids.num());
+  return true;
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::retrieve(const time_t &gt, const int lt, const string &url,
+			   const ParmProjection &proj,
+			   const vector<string> &fields,
+			   MultiGrid &grids, string &path, MetaData &metadata,
+			   time_t &timeWritten)
+{
+  // pFmq is checked under the lock, the drain thread may close it
+  if (pIsPublisher)
+  {
+    return false;
+  }
+
+  string key = pNormalizeUrl(url);
+  bool ret = false;
+
+  pthread_mutex_lock(&pMutex);
+  if (pFmq != NULL)
+  {
+    pDrain();
+  }
+
+  // newest first, in case of rewrites
+  deque<Entry>::reverse_iterator i;
+  for (i=pCache.rbegin(); i!=pCache.rend(); ++i)
+  {
+    if (i->gt == gt && i->lt == lt && i->url == key)
+    {
+      ret = pDecode(*i, proj, fields, grids, path, metadata, timeWritten);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&pMutex);
+
+  if (ret)
+  {
+    ILOGF(DEBUG_VERBOSE, "Grid handoff hit %s %s+%d", url.c_str(),
+	  ConvWxTime::stime(gt).c_str(), lt);
+  }
+  else
+  {
+    ILOGF(DEBUG_VERBOSE, "Grid handoff miss %s %s+%d, reading file",
+	  url.c_str(), ConvWxTime::stime(gt).c_str(), lt);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------
+void *GridHandoff::pDrainThread(void *arg)
+{
+  GridHandoff *h = static_cast<GridHandoff *>(arg);
+  while (true)
+  {
+    pthread_mutex_lock(&h->pMutex);
+    if (h->pStop || h->pFmq == NULL)
+    {
+      pthread_mutex_unlock(&h->pMutex);
+      return NULL;
+    }
+    h->pDrain();
+    pthread_mutex_unlock(&h->pMutex);
+    umsleep(sDrainSleepMsec);
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------
+void GridHandoff::pDrain(void)
+{
+  while (true)
+  {
+    bool gotOne = false;
+    if (pFmq->readMsg(&gotOne, GRID_MSG) || !gotOne)
+    {
+      return;
+    }
+    if (pFmq->isBlockingWrite() && pReaderLockFd < 0)
+    {
+      // a second reader would move the position the producer waits on
+      ILOGF(ERROR, "Grid handoff queue %s is blocking and has another "
+	    "subscriber, reading all input from files",
+	    pFmq->getFmqPath().c_str());
+      pFmq->closeMsgQueue();
+      delete pFmq;
+      pFmq = NULL;
+      pCache.clear();
+      return;
+    }
+    int len = pFmq->getMsgLen();
+    if (!pIsValid(pFmq->getMsg(), len))
+    {
+      ILOG(WARNING, "Grid handoff message is truncated or not a grid, "
+	   "skipped");
+      continue;
+    }
+    const sMsgHdr_t *hdr = static_cast<const sMsgHdr_t *>(pFmq->getMsg());
+
+    Entry e;
+    e.gt = static_cast<time_t>(hdr->genTime);
+    e.lt = hdr->leadTime;
+    const char *s = static_cast<const char *>(pFmq->getMsg()) +
+      sizeof(sMsgHdr_t) + hdr->nfields*sizeof(sFieldHdr_t);
+    e.url = string(s, hdr->strLen[0]);
+    e.buf.load(pFmq->getMsg(), len);
+    pCache.push_back(e);
+
+    // drop from the oldest generation time, whatever the arrival order
+    while (static_cast<int>(pCache.size()) > pMaxEntries)
+    {
+      deque<Entry>::iterator oldest = pCache.begin();
+      deque<Entry>::iterator i;
+      for (i=pCache.begin(); i!=pCache.end(); ++i)
+      {
+	if (i->gt < oldest->gt)
+	{
+	  oldest = i;
+	}
+      }
+      pCache.erase(oldest);
+    }
+  }
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::pLockReader(const string &fmqPath)
+{
+  string path = fmqPath + ".reader_lock";
+  ta_makedir_for_file(path.c_str());
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+  if (fd < 0)
+  {
+    ILOGF(WARNING, "Cannot open grid handoff reader lock %s", path.c_str());
+    return false;
+  }
+
+  // held until the object goes away or the process exits.  flock() rather
+  // than fcntl() so that two subscribers in one process also exclude
+  if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+  {
+    close(fd);
+    return false;
+  }
+  pReaderLockFd = fd;
+  return true;
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::pIsValid(const void *msg, const int len)
+{
+  if (len < static_cast<int>(sizeof(sMsgHdr_t)))
+  {
+    return false;
+  }
+  const sMsgHdr_t *hdr = static_cast<const sMsgHdr_t *>(msg);
+  if (hdr->magic != sMagic || hdr->nfields < 1 || hdr->nx < 1 ||
+      hdr->ny < 1 || hdr->nz < 1)
+  {
+    return false;
+  }
+
+  // add up the parts, stopping before any of them can overflow
+  size_t n = static_cast<size_t>(len);
+  size_t need = sizeof(sMsgHdr_t);
+  if (static_cast<size_t>(hdr->nfields) > (n - need)/sizeof(sFieldHdr_t))
+  {
+    return false;
+  }
+  const sFieldHdr_t *fh = reinterpret_cast<const sFieldHdr_t *>
+    (static_cast<const char *>(msg) + need);
+  need += hdr->nfields*sizeof(sFieldHdr_t);
+  for (int i=0; i<hdr->nfields; ++i)
+  {
+    if (memchr(fh[i].name, 0, sizeof(fh[i].name)) == NULL ||
+	memchr(fh[i].units, 0, sizeof(fh[i].units)) == NULL)
+    {
+      return false;
+    }
+  }
+  size_t slen = 0;
+  for (int i=0; i<sNstring; ++i)
+  {
+    if (hdr->strLen[i] < 0 ||
+	static_cast<size_t>(hdr->strLen[i]) > n - need - slen)
+    {
+      return false;
+    }
+    slen += hdr->strLen[i];
+  }
+  if (sPad4(slen) > n - need)
+  {
+    return false;
+  }
+  need += sPad4(slen);
+  size_t avail = (n - need)/sizeof(fl32);
+  size_t npt = static_cast<size_t>(hdr->nx);
+  if (static_cast<size_t>(hdr->ny) > avail/npt)
+  {
+    return false;
+  }
+  npt *= hdr->ny;
+  if (static_cast<size_t>(hdr->nz) > avail/npt)
+  {
+    return false;
+  }
+  npt *= hdr->nz;
+  return static_cast<size_t>(hdr->nfields) <= avail/npt;
+}
+
+//----------------------------------------------------------------
+bool GridHandoff::pDecode(const Entry &e, const ParmProjection &proj,
+			  const vector<string> &fields,
+			  MultiGrid &grids, string &path, MetaData &metadata,
+			  time_t &timeWritten) const
+{
+  const char *msg = static_cast<const char *>(e.buf.getPtr());
+  const sMsgHdr_t *hdr = reinterpret_cast<const sMsgHdr_t *>(msg);
+
+  fl64 p[sNproj];
+  sProjToArray(proj, p);
+  if (hdr->projType != static_cast<si32>(proj.pProjection) ||
+      hdr->nx != proj.pNx || hdr->ny != proj.pNy || hdr->nz != proj.pNz ||
+      memcmp(p, hdr->proj, sizeof(p)) != 0)
+  {
+    ILOG(DEBUG_VERBOSE, "Grid handoff projection differs from request");
+    return false;
+  }
+
+  const sFieldHdr_t *fh =
+    reinterpret_cast<const sFieldHdr_t *>(msg + sizeof(sMsgHdr_t));
+  const char *s = msg + sizeof(sMsgHdr_t) + hdr->nfields*sizeof(sFieldHdr_t);
+  string strings[sNstring];
+  size_t slen = 0;
+  for (int i=0; i<sNstring; ++i)
+  {
+    strings[i] = string(s + slen, hdr->strLen[i]);
+    slen += hdr->strLen[i];
+  }
+  const fl32 *data =
+    reinterpret_cast<const fl32 *>(s + sPad4(slen));
+  size_t npt = static_cast<size_t>(hdr->nx)*hdr->ny*hdr->nz;
+
+  MultiGrid out;
+  for (size_t i=0; i<fields.size(); ++i)
+  {
+    int k;
+    for (k=0; k<hdr->nfields; ++k)
+    {
+      if (fields[i] == fh[k].name)
+      {
+	break;
+      }
+    }
+    if (k == hdr->nfields)
+    {
+      return false;
+    }
+    const fl32 *v = data + static_cast<size_t>(k)*npt;
+    Grid g(fields[i], fh[k].units, hdr->nx, hdr->ny, hdr->nz, fh[k].missing);
+    fl32 missing = static_cast<fl32>(fh[k].missing);
+    for (size_t j=0; j<npt; ++j)
+    {
+      if (v[j] != missing)
+      {
+	g.setv(static_cast<int>(j), static_cast<double>(v[j]));
+      }
+    }
+    out.append(g);
+  }
+
+  grids = out;
+  path = strings[1];
+  metadata.setName(strings[2]);
+  metadata.setInfo(strings[3]);
+  metadata.setSource(strings[4]);
+  metadata.xmlClear();
+  if (!strings[5].empty())
+  {
+    metadata.setXml(strings[5]);
+  }
+  timeWritten = static_cast<time_t>(hdr->timeWritten);
+  return true;
+}
+
+//----------------------------------------------------------------
+string GridHandoff::pNormalizeUrl(const string &url)
+{
+  DsURL u(url);
+  string f = u.getFile();
+  if (f.empty())
+  {
+    return url;
+  }
+  return f;
+}
@@ -23,11 +23,13 @@
 
 //----------------------------------------------------------------
 #include <algorithm>
+#include <cstdlib>
 
 #include <ConvWxIO/InterfaceIO.hh>
 #include <ConvWxIO/ILogMsg.hh>
 #include <ConvWxIO/EarthRadius.hh>
 #include <ConvWxIO/ConvWxThreadMgr.hh>
+#include <ConvWxIO/GridHandoff.hh>
 #include <ConvWx/ConvWxConstants.hh>
 #include <ConvWx/ConvWxTime.hh>
 #include <ConvWx/TriggerState.hh>
@@ -38,6 +40,7 @@
 #include <ConvWx/FcstGrid.hh>
 #include <ConvWx/MultiGrid.hh>
 #include <ConvWx/MultiFcstGrid.hh>
+#include <ConvWx/PhaseTimer.hh>
 
 #include <dsdata/DsUrlTrigger.hh>
 #include <didss/DsInputPath.hh>
@@ -68,6 +71,7 @@ static bool sNoWait = false;
 static int sMaxWaitSeconds = 0;
 static bool sMaxValidAgeChanged = false;
 static int sMaxValidAge = DsUrlTrigger::defaultMaxValidAge();
+static GridHandoff *sHandoff = NULL;
 
 //------------------------------------------------------------------
 static void sTriggeringCheck(const string &url, 
@@ -906,6 +910,53 @@ static bool sLoadAny(DsMdvx &D, const string &url, const time_t t,
   return true;
 }
 
+//------------------------------------------------------------------
+static void sHandoffPublish(const time_t &gt, const int lt, const string &url,
+			    const ParmProjection &p, const MultiGrid &o,
+			    const MetaData &metadata, DsMdvx &output)
+{
+  if (sHandoff == NULL || !sHandoff->isPublisher())
+  {
+    return;
+  }
+  sHandoff->publish(gt, lt, url, p, o, metadata, output.getPathInUse(),
+		    output.getMasterHeader().time_written);
+}
+
+//------------------------------------------------------------------
+static bool sHandoffRetrieve(const time_t &gt, const int lt,
+			     const string &url, const ParmProjection &p,
+			     const string &field, FcstGrid &g)
+{
+  if (sHandoff == NULL || sVlevelRestricted)
+  {
+    return false;
+  }
+  vector<string> fields;
+  fields.push_back(field);
+  MultiGrid gr;
+  string path;
+  MetaData metadata;
+  time_t twritten;
+  if (!sHandoff->retrieve(gt, lt, url, p, fields, gr, path, metadata,
+			  twritten))
+  {
+    return false;
+  }
+  if (sAllowStoringVerticalLevels)
+  {
+    // same levels the writer puts in the vlevel header
+    sVlevel.clear();
+    for (int z=0; z<p.pNz; ++z)
+    {
+      sVlevel.push_back(p.pMinz + z*p.pDz);
+    }
+  }
+  g = FcstGrid(gt, lt, *gr.ithConstGrid(0), path, metadata);
+  g.setTimeWritten(twritten);
+  return true;
+}
+
 //------------------------------------------------------------------
 static time_t sGetTimeWritten(const time_t &gt, int lt, const ParmFcst &parm)
 {
@@ -942,6 +993,18 @@ void InterfaceIO::startup(const string &process, const string &instance,
   {
     ILOG_LOGFILE_INIT(process, instance, ""); // writes to $LOGFILE_DIR
   }
+
+  // LOG_ASYNC=<messages per thread> hands logging to a background writer,
+  // LOG_ASYNC_OVERFLOW=block waits rather than drops debug and informational
+  // messages when a queue is full (warnings and errors always wait)
+  valstr = getenv("LOG_ASYNC");
+  if (valstr != NULL)
+  {
+    int capacity = atoi(valstr);
+    const char *policy = getenv("LOG_ASYNC_OVERFLOW");
+    bool block = policy != NULL && string(policy) == "block";
+    ILOG_ASYNC_INIT(capacity, block);
+  }
 }
 
 //------------------------------------------------------------------
@@ -976,10 +1039,16 @@ void InterfaceIO::doRegister(const string &msg)
 void InterfaceIO::finish(void)
 {
   PMU_auto_unregister();
+  ILOG_SYNC();
   if (sTrigger != NULL)
   {
     delete sTrigger;
   }
+  if (sHandoff != NULL)
+  {
+    delete sHandoff;
+    sHandoff = NULL;
+  }
 }
 
 //------------------------------------------------------------------
@@ -1718,6 +1787,7 @@ bool InterfaceIO::loadObs(const time_t &t, const ParmProjection &p,
 			  const string &url, const string &field,
 			  const bool remap, FcstGrid &g, bool suppresswarnings)
 {
+  PhaseTimer timer("load");
   DsMdvx D;
   D.setReadTime(Mdvx::READ_FIRST_BEFORE, url, 0, t);
   return sLoad(D, url, t, 0, field, remap, p, g, suppresswarnings);
@@ -1774,6 +1844,7 @@ bool InterfaceIO::loadMultiObs(const time_t &t, const ParmProjection &p,
 			       const string &url, const vector<string> &field,
 			       const bool remap, MultiGrid &g)
 {
+  PhaseTimer timer("load");
   DsMdvx D;
   D.setReadTime(Mdvx::READ_FIRST_BEFORE, url, 0, t);
   string path;
@@ -1804,6 +1875,12 @@ bool InterfaceIO::loadFcst(const time_t &gt, const int lt,
 			   const string &field, const bool remap,
 			   FcstGrid &g)
 {
+  PhaseTimer timer("load");
+  if (sHandoffRetrieve(gt, lt, url, p, field, g))
+  {
+    Instrumentation::addCount("handoffHits");
+    return true;
+  }
   DsMdvx D;
   D.setReadTime(Mdvx::READ_SPECIFIED_FORECAST, url, 0, gt, lt);
   return sLoad(D, url, gt, lt, field, remap, p, g, false);
@@ -1831,11 +1908,21 @@ bool InterfaceIO::loadMultiFcst(const time_t gt, const int lt,
 				const vector<string> &field, const bool remap,
 				MultiFcstGrid &g, bool suppressErrorMessages)
 {
-  DsMdvx D;
-  D.setReadTime(Mdvx::READ_SPECIFIED_FORECAST, url, 0, gt, lt);
+  PhaseTimer timer("load");
   MultiGrid gr;
   string path;
   MetaData metadata;
+  time_t twritten;
+  if (sHandoff != NULL && !sVlevelRestricted &&
+      sHandoff->retrieve(gt, lt, url, p, field, gr, path, metadata, twritten))
+  {
+    Instrumentation::addCount("handoffHits");
+    g.init(gr, gt, lt, path, metadata);
+    return true;
+  }
+
+  DsMdvx D;
+  D.setReadTime(Mdvx::READ_SPECIFIED_FORECAST, url, 0, gt, lt);
   bool stat = sLoad(D, url, gt, field, remap, p, suppressErrorMessages, gr,
 		    path, metadata);
   if (stat)
@@ -1944,6 +2031,7 @@ void InterfaceIO::write(const time_t &t, const string &url,
   Mdvx::field_header_t fieldHdr;
   Mdvx::vlevel_header_t vlevelHdr;
 
+  PhaseTimer timer("mdvWrite");
   sOutputInit(t, p, output, metadata, fieldHdr, vlevelHdr);
   for (int i=0; i<static_cast<int>(o.num()); ++i)
   {
@@ -1971,6 +2059,7 @@ void InterfaceIO::write(const time_t &gt, const int lt, const string &url,
   Mdvx::field_header_t fieldHdr;
   Mdvx::vlevel_header_t vlevelHdr;
 
+  PhaseTimer timer("mdvWrite");
   sOutputInit(gt, lt, p, output, metadata, fieldHdr, vlevelHdr);
   for (int i=0; i<o.num(); ++i)
   {
@@ -1985,6 +2074,10 @@ void InterfaceIO::write(const time_t &gt, const int lt, const string &url,
   {
     ILOG(ERROR, "Unable to write mdv");
   }
+  else
+  {
+    sHandoffPublish(gt, lt, url, p, o, metadata, output);
+  }
 }
 
 //------------------------------------------------------------------
@@ -2002,6 +2095,7 @@ void InterfaceIO::write(const time_t &gt, const int lt, const string &url,
   Mdvx::field_header_t fieldHdr;
   Mdvx::vlevel_header_t vlevelHdr;
 
+  PhaseTimer timer("mdvWrite");
   sOutputInit(gt, lt, p, output, metadata, fieldHdr, vlevelHdr);
   for (int i=0; i<o.num(); ++i)
   {
@@ -2017,6 +2111,10 @@ void InterfaceIO::write(const time_t &gt, const int lt, const string &url,
   {
     ILOG(ERROR, "Unable to write mdv");
   }
+  else
+  {
+    sHandoffPublish(gt, lt, url, p, o, metadata, output);
+  }
   threads.unlock();
 }
 
@@ -2217,3 +2315,43 @@ void InterfaceIO::setNoWaitTriggering(int maxWaitSeconds)
     exit(-1);
   }
 }
+
+//------------------------------------------------------------------
+bool InterfaceIO::setGridHandoffPublisher(const string &fmqUrl,
+					  const int numSlots,
+					  const int bufSize,
+					  const bool blocking)
+{
+  if (sHandoff != NULL)
+  {
+    delete sHandoff;
+  }
+  sHandoff = new GridHandoff();
+  if (!sHandoff->initPublisher(fmqUrl, numSlots, bufSize, blocking))
+  {
+    delete sHandoff;
+    sHandoff = NULL;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------
+bool InterfaceIO::setGridHandoffSubscriber(const string &fmqUrl,
+					   const int numSlots,
+					   const int bufSize,
+					   const int maxEntries)
+{
+  if (sHandoff != NULL)
+  {
+    delete sHandoff;
+  }
+  sHandoff = new GridHandoff();
+  if (!sHandoff->initSubscriber(fmqUrl, numSlots, bufSize, maxEntries))
+  {
+    delete sHandoff;
+    sHandoff = NULL;
+    return false;
+  }
+  return true;
+}
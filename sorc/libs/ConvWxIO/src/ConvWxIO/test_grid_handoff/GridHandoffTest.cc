@@ -0,0 +1,256 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+//  University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file GridHandoffTest.cc
+ *
+ * Publishes every member and lead of one generation time through a
+ * blocking grid handoff queue with far fewer slots than forecasts, the
+ * subscriber only looking once it is all written, as PbarCompute and
+ * EnsLookupGen do when their trigger fires.  That only completes if the
+ * subscriber drains the queue while the producer writes, and every
+ * forecast should then come from memory.
+ *
+ * Also checks that a truncated message in the queue is skipped, and that a
+ * second subscriber to a blocking queue stands aside without taking
+ * anything from the first.
+ *
+ * The queue is in shared memory as in production, with a key taken from
+ * the process id, and is removed at the end.
+ *
+ * Exits 0 if everything works, 1 otherwise.  A hang is ended by an alarm.
+ */
+#include <ConvWxIO/GridHandoff.hh>
+#include <ConvWx/ParmProjection.hh>
+#include <ConvWx/Grid.hh>
+#include <ConvWx/MultiGrid.hh>
+#include <ConvWx/MetaData.hh>
+#include <Fmq/DsFmq.hh>
+#include <toolsa/file_io.h>
+#include <toolsa/ushmem.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+static const int NUM_MEMBERS = 21;
+static const int NUM_LEADS = 16;
+static const int NUM_SLOTS = 20;
+static const int BUF_SIZE = 20000000;
+static const int NX = 40;
+static const int NY = 20;
+static const double MISSING = -99.0;
+static const int ALARM_SECONDS = 60;
+static const int BASE_KEY = 38000;
+
+static int _nFail = 0;
+
+//----------------------------------------------------------------
+static string _memberUrl(int m)
+{
+  char buf[100];
+  sprintf(buf, "mdvp:://localhost::gefs/mem%02d", m);
+  return buf;
+}
+
+//----------------------------------------------------------------
+static double _value(time_t gt, int m, int lt, int field, int i)
+{
+  if (i % 17 == 0)
+  {
+    return MISSING;
+  }
+  return (gt % 1000) + m*100.0 + lt/3600.0 + field*0.5 + i*0.001;
+}
+
+//----------------------------------------------------------------
+static MultiGrid _grids(time_t gt, int m, int lt)
+{
+  MultiGrid ret;
+  const char *names[2] = {"APCP", "ULWRF"};
+  for (int f=0; f<2; ++f)
+  {
+    Grid g(names[f], "mm", NX, NY, MISSING);
+    for (int i=0; i<NX*NY; ++i)
+    {
+      double v = _value(gt, m, lt, f, i);
+      if (v != MISSING)
+      {
+	g.setv(i, v);
+      }
+    }
+    g.setEncoding(Grid::ENCODING_FLOAT32);
+    ret.append(g);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------
+static void _publish(GridHandoff &pub, const ParmProjection &proj,
+		     time_t gt, int nlead)
+{
+  MetaData md;
+  for (int j=0; j<nlead; ++j)
+  {
+    for (int m=0; m<NUM_MEMBERS; ++m)
+    {
+      int lt = j*10800;
+      if (!pub.publish(gt, lt, _memberUrl(m), proj, _grids(gt, m, lt), md,
+		       "/dev/null", gt))
+      {
+	fprintf(stderr, "FAIL: publish member %d lead %d\n", m, lt);
+	_nFail++;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------
+// returns the number of forecasts found, checking their values
+
+static int _retrieve(GridHandoff &sub, const ParmProjection &proj,
+		     time_t gt, int nlead)
+{
+  vector<string> fields;
+  fields.push_back("ULWRF");
+  fields.push_back("APCP");
+  int nhit = 0;
+  for (int j=0; j<nlead; ++j)
+  {
+    for (int m=0; m<NUM_MEMBERS; ++m)
+    {
+      int lt = j*10800;
+      MultiGrid grids;
+      string path;
+      MetaData md;
+      time_t written;
+      if (!sub.retrieve(gt, lt, _memberUrl(m), proj, fields, grids, path,
+			md, written))
+      {
+	continue;
+      }
+      ++nhit;
+      for (int f=0; f<2; ++f)
+      {
+	const Grid *g = grids.ithConstGrid(f);
+	for (int i=0; i<NX*NY; ++i)
+	{
+	  double want = _value(gt, m, lt, 1-f, i);
+	  double v;
+	  bool got = g->getValue(i, v);
+	  if (got != (want != MISSING) ||
+	      (got && static_cast<float>(v) != static_cast<float>(want)))
+	  {
+	    fprintf(stderr, "FAIL: member %d lead %d field %s point %d\n",
+		    m, lt, g->getName().c_str(), i);
+	    _nFail++;
+	    break;
+	  }
+	}
+      }
+    }
+  }
+  return nhit;
+}
+
+//----------------------------------------------------------------
+static void _run(const string &path)
+{
+  ParmProjection proj(ParmProjection::LATLON, NX, NY, 0.0, -10.0, 1.0, 1.0,
+		      0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 6371.229);
+  time_t gt = 1600000000;
+  int nfcst = NUM_MEMBERS*NUM_LEADS;
+
+  // sized as the apps do by default
+  GridHandoff sub;
+  if (!sub.initSubscriber(path, NUM_SLOTS, BUF_SIZE, 2*nfcst))
+  {
+    fprintf(stderr, "FAIL: initSubscriber %s\n", path.c_str());
+    _nFail++;
+    return;
+  }
+  GridHandoff pub;
+  if (!pub.initPublisher(path, NUM_SLOTS, BUF_SIZE, true))
+  {
+    fprintf(stderr, "FAIL: initPublisher %s\n", path.c_str());
+    _nFail++;
+    return;
+  }
+
+  // a header claiming more fields and strings than the message holds
+  DsFmq raw;
+  if (raw.initReadWrite(path.c_str(), "GridHandoffTest", false, Fmq::END,
+			false, NUM_SLOTS, BUF_SIZE) == 0)
+  {
+    vector<char> bad(256, 0);
+    si32 hdr[4] = {20220601, 1000000, 0, 0};
+    memcpy(&bad[0], hdr, sizeof(hdr));
+    raw.writeMsg(GridHandoff::GRID_MSG, 0, &bad[0],
+		 static_cast<int>(bad.size()));
+    raw.closeMsgQueue();
+  }
+
+  _publish(pub, proj, gt, NUM_LEADS);
+  int nhit = _retrieve(sub, proj, gt, NUM_LEADS);
+  fprintf(stderr, "Whole generation time: %d of %d forecasts from memory\n",
+	  nhit, nfcst);
+  if (nhit != nfcst)
+  {
+    _nFail++;
+  }
+
+  // a second subscriber to the blocking queue reads nothing, and takes
+  // nothing from the first
+  GridHandoff sub2;
+  sub2.initSubscriber(path, NUM_SLOTS, BUF_SIZE, 2*nfcst);
+  gt += 21600;
+  _publish(pub, proj, gt, 1);
+  sleep(1);
+  int nhit1 = _retrieve(sub, proj, gt, 1);
+  int nhit2 = _retrieve(sub2, proj, gt, 1);
+  fprintf(stderr, "Second subscriber: first %d, second %d of %d\n",
+	  nhit1, nhit2, NUM_MEMBERS);
+  if (nhit1 != NUM_MEMBERS || nhit2 != 0)
+  {
+    _nFail++;
+  }
+}
+
+//----------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  // a shared memory queue uses key and key+1
+  key_t key = BASE_KEY + 2*(getpid() % 1000);
+  char buf[200];
+  sprintf(buf, "/tmp/GridHandoffTest/shmem_%d", (int) key);
+  string path = buf;
+  ta_makedir_for_file(path.c_str());
+  alarm(ALARM_SECONDS);
+
+  _run(path);
+
+  ushm_remove(key);
+  ushm_remove(key + 1);
+  unlink((path + ".lock").c_str());
+  unlink((path + ".reader_lock").c_str());
+  fprintf(stderr, "%s\n", _nFail == 0 ? "Passed" : "FAILED");
+  return _nFail == 0 ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// � University Corporation for Atmospheric Research (UCAR) 2009-2010. 
+// All rights reserved.  The Government's right to use this data and/or 
+// software (the "Work") is restricted, per the terms of Cooperative 
+// Agreement (ATM (AGS)-0753581 10/1/08) between UCAR and the National 
+// Science Foundation, to a "nonexclusive, nontransferable, irrevocable, 
+// royalty-free license to exercise or have exercised for or on behalf of 
+// the U.S. throughout the world all the exclusive rights provided by 
+// copyrights.  Such license, however, does not include the right to sell 
+// copies or phonorecords of the copyrighted works to the public."   The 
+// Work is provided "AS IS" and without warranty of any kind.  UCAR 
+// EXPRESSLY DISCLAIMS ALL OTHER WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+// ANY IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+// PURPOSE.  
+//  
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+#include <toolsa/copyright.h>
+/**
+ * @file GridHandoff.hh
+ * @brief Hands decoded forecast grids from one app to another through an FMQ
+ * @class GridHandoff
+ * @brief Hands decoded forecast grids from one app to another through an FMQ
+ *
+ * A producer publishes each forecast it writes (all fields as float32,
+ * plus projection and metadata) to a message queue, normally a shared
+ * memory queue (FMQ path with a 'shmem_<key>' file name).  A subscriber
+ * drains the queue on a background thread into a bounded local cache, and
+ * hands the grids back without reading or decompressing the MDV file.
+ * When the cache is full the entries of the oldest generation time go
+ * first, so it should hold at least members x lead times of one
+ * generation time.
+ *
+ * The queue is a fixed ring of slots, so entries can be overwritten before
+ * the subscriber gets to them.  In that case retrieve() fails and the caller
+ * reads the file as usual.  With blocking writes the producer waits rather
+ * than overwrite the slot the subscriber is positioned at.  Fmq supports
+ * that for one reader only, so the first subscriber holds a lock file next
+ * to the queue, and any other subscriber stops reading a blocking queue and
+ * falls back to the files.
+ */
+
+# ifndef    GRID_HANDOFF_HH
+# define    GRID_HANDOFF_HH
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <pthread.h>
+#include <toolsa/MemBuf.hh>
+
+class DsFmq;
+class ParmProjection;
+class MultiGrid;
+class MetaData;
+
+//----------------------------------------------------------------
+class GridHandoff
+{
+public:
+
+  /**
+   * FMQ message type used for handoff grids
+   */
+  static const int GRID_MSG = 200001;
+
+  /**
+   * Constructor, not usable until one of the init methods is called
+   */
+  GridHandoff(void);
+
+  /**
+   * Destructor
+   */
+  virtual ~GridHandoff(void);
+
+  /**
+   * Set up as a producer
+   *
+   * @param[in] fmqUrl  Queue location, 'shmem_<key>' file name for
+   *                    shared memory
+   * @param[in] numSlots  Number of slots in the ring
+   * @param[in] bufSize  Total size of the ring buffer (bytes)
+   * @param[in] blocking  True to wait rather than overwrite the entry the
+   *                      subscriber is about to read
+   *
+   * @return true for success
+   */
+  bool initPublisher(const std::string &fmqUrl, const int numSlots,
+		     const int bufSize, const bool blocking);
+
+  /**
+   * Set up as a subscriber, seeing only what is published from now on,
+   * and start the thread that drains the queue
+   *
+   * @param[in] fmqUrl  Queue location
+   * @param[in] numSlots  Number of slots in the ring, should agree with
+   *                      the producer in case this side creates the queue
+   * @param[in] bufSize  Total size of the ring buffer (bytes), should agree
+   *                     with the producer
+   * @param[in] maxEntries  Maximum number of forecasts to hold in the
+   *                        local cache, at least members x lead times
+   *                        for all the hits of one generation time
+   *
+   * @return true for success
+   */
+  bool initSubscriber(const std::string &fmqUrl, const int numSlots,
+		      const int bufSize, const int maxEntries);
+
+  /**
+   * @return true if set up as a producer
+   */
+  inline bool isPublisher(void) const {return pIsPublisher;}
+
+  /**
+   * Publish grids that were just written to a forecast file
+   *
+   * @param[in] gt  Generation time
+   * @param[in] lt  Lead seconds
+   * @param[in] url  The URL the file was written to
+   * @param[in] proj  Projection of the grids
+   * @param[in] grids  The grids
+   * @param[in] metadata  Metadata written with the grids
+   * @param[in] path  Path to the file that was written
+   * @param[in] timeWritten  Time the file was written
+   *
+   * @return true if published, false if not (for example grids with a lossy
+   *         encoding, which are never published so subscribers see exactly
+   *         the file contents)
+   */
+  bool publish(const time_t &gt, const int lt, const std::string &url,
+	       const ParmProjection &proj, const MultiGrid &grids,
+	       const MetaData &metadata, const std::string &path,
+	       const time_t &timeWritten);
+
+  /**
+   * Look for a forecast in the queue and local cache
+   *
+   * @param[in] gt  Generation time
+   * @param[in] lt  Lead seconds
+   * @param[in] url  The URL the caller would otherwise read
+   * @param[in] proj  Projection the caller expects
+   * @param[in] fields  Fields wanted, all must be present
+   * @param[out] grids  The grids, one per field in order
+   * @param[out] path  Path of the file the grids were written to
+   * @param[out] metadata  Metadata written with the grids
+   * @param[out] timeWritten  Time the file was written
+   *
+   * @return true if everything was found, false to fall back to the file
+   */
+  bool retrieve(const time_t &gt, const int lt, const std::string &url,
+		const ParmProjection &proj,
+		const std::vector<std::string> &fields,
+		MultiGrid &grids, std::string &path, MetaData &metadata,
+		time_t &timeWritten);
+
+protected:
+private:
+
+  /**
+   * @class Entry
+   * @brief One cached forecast, the raw queue message plus its key
+   */
+  class Entry
+  {
+  public:
+    inline Entry(void) : gt(0), lt(0) {}
+    std::string url; /**< Normalized URL */
+    time_t gt;       /**< Generation time */
+    int lt;          /**< Lead seconds */
+    MemBuf buf;      /**< The message */
+  };
+
+  DsFmq *pFmq;          /**< The queue */
+  bool pIsPublisher;    /**< True for producer, false for subscriber */
+  int pMaxEntries;      /**< Subscriber cache size */
+  std::deque<Entry> pCache; /**< Subscriber cache, oldest first */
+  pthread_mutex_t pMutex;   /**< Both sides are called from threads */
+  pthread_t pThread;        /**< Subscriber drain thread */
+  bool pThreadRunning;      /**< True if pThread was started */
+  bool pStop;               /**< Set to stop pThread, under pMutex */
+  int pReaderLockFd;        /**< Subscriber lock file, -1 if not held */
+
+  /**
+   * Subscriber drain thread, calls pDrain() until pStop is set
+   * @param[in] arg  Pointer to the GridHandoff
+   */
+  static void *pDrainThread(void *arg);
+
+  /**
+   * Read everything new in the queue into the cache, dropping cache
+   * entries beyond pMaxEntries, oldest generation time first.  Stops
+   * reading for good if the queue is blocking and another subscriber
+   * holds the reader lock.  Call with pMutex locked.
+   */
+  void pDrain(void);
+
+  /**
+   * Try to take the reader lock file next to the queue
+   * @param[in] fmqPath  Path of the queue
+   * @return true if this subscriber holds the lock
+   */
+  bool pLockReader(const std::string &fmqPath);
+
+  /**
+   * @return true if a queue message is a complete handoff message, all its
+   *         parts within len bytes
+   * @param[in] msg  The message
+   * @param[in] len  Its length
+   */
+  static bool pIsValid(const void *msg, const int len);
+
+  /**
+   * Decode a cached message into grids, the message already checked by
+   * pIsValid()
+   *
+   * @param[in] e  The cached entry
+   * @param[in] proj  Projection the caller expects, must agree with the entry
+   * @param[in] fields  Fields wanted
+   * @param[out] grids  Returned grids
+   * @param[out] path  Returned file path
+   * @param[out] metadata  Returned metadata
+   * @param[out] timeWritten  Returned write time
+   *
+   * @return true if the entry has the projection and all the fields
+   */
+  bool pDecode(const Entry &e, const ParmProjection &proj,
+	       const std::vector<std::string> &fields,
+	       MultiGrid &grids, std::string &path, MetaData &metadata,
+	       time_t &timeWritten) const;
+
+  /**
+   * @return the file part of a URL, so that 'mdvp:://host::dir' and 'dir'
+   *         match
+   * @param[in] url
+   */
+  static std::string pNormalizeUrl(const std::string &url);
+};
+
+# endif
@@ -105,6 +105,19 @@
 
 #define ILOG_LOGFILE_INIT(app,instance,logpath) (LOG_STREAM_TO_LOGFILE((app),(instance),(logpath)))
 
+/**
+ * Switch to asynchronous, batched output of logged messages
+ *
+ * @param[in] capacity  Messages queued per thread
+ * @param[in] blockOnFull  True to wait when a queue is full, false to drop
+ */
+#define ILOG_ASYNC_INIT(capacity,blockOnFull) (LOG_STREAM_ASYNC((capacity),(blockOnFull)))
+
+/**
+ * Write anything queued for asynchronous output and go back to synchronous
+ */
+#define ILOG_SYNC() (LOG_STREAM_SYNC())
+
 /**
  * Disable a particular severity type
  *
@@ -77,6 +77,11 @@ public:
    * software that monitors its health and is kept aware of its existence
    * through calls to the InterfaceIO::doRegister() method.
    *
+   * Logging goes to log files if $AUTO_LOGFILES is set, and is written
+   * asynchronously by a background thread if $LOG_ASYNC is set (its value
+   * is the number of messages queued per thread, messages are dropped when
+   * a queue is full unless $LOG_ASYNC_OVERFLOW=block).
+   *
    * @param[in] process  Process name
    * @param[in] instance  Process instance 
    * @param[in] maxSeconds  Expected max interval (seconds) between calls to the
@@ -1207,6 +1212,40 @@ public:
    */
   static void setNoWaitTriggering(int maxWaitSeconds);
 
+  /**
+   * Publish every forecast written by the write() methods to a grid handoff
+   * queue (see GridHandoff), in addition to writing the file.
+   *
+   * @param[in] fmqUrl  Queue location, 'shmem_<key>' file name for
+   *                    shared memory
+   * @param[in] numSlots  Number of slots in the queue
+   * @param[in] bufSize  Size of the queue buffer (bytes)
+   * @param[in] blocking  True to wait rather than overwrite forecasts a
+   *                      subscriber has not yet read
+   *
+   * @return true if the queue was opened
+   */
+  static bool setGridHandoffPublisher(const std::string &fmqUrl,
+				      const int numSlots, const int bufSize,
+				      const bool blocking);
+
+  /**
+   * Look in a grid handoff queue (see GridHandoff) before reading forecast
+   * files in loadFcst() and loadMultiFcst(), falling back to the file when
+   * a forecast is not there.
+   *
+   * @param[in] fmqUrl  Queue location, same as the publisher
+   * @param[in] numSlots  Number of slots in the queue, same as the publisher
+   * @param[in] bufSize  Size of the queue buffer (bytes), same as the
+   *                     publisher
+   * @param[in] maxEntries  Maximum number of forecasts to keep locally
+   *
+   * @return true if the queue was opened
+   */
+  static bool setGridHandoffSubscriber(const std::string &fmqUrl,
+				       const int numSlots, const int bufSize,
+				       const int maxEntries);
+
 protected:
 private:  
 
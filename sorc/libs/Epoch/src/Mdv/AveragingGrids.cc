@@ -47,26 +47,8 @@ void AveragingGrids::increment(int index)
 //-------------------------------------------------------------------------
 void AveragingGrids::normalize(void)
 {
-  for (int k = 0; k < _counts.getNdata(); ++k)
-  { 
-    double v=0.0;
-    bool hasCount = _counts.getValue(k, v);
-    if (hasCount && v <= 0)
-    {
-      hasCount = false;
-    }
-    if (!hasCount)
-    {
-      _sums.setToMissing(k);
-    }
-    else
-    {
-      double val;
-      if (_sums.getValue(k, val))
-      {
-	_sums.setv(k, val/v);
-      }
-    }
-  }
+  // counts are never negative, so this is missing where the count is
+  // missing or 0 and the mean elsewhere
+  _sums.divide(_counts);
   _sums.changeName(_fieldName);
 }
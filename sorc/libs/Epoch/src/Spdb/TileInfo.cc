@@ -6,7 +6,6 @@
 #include <Epoch/TileRange.hh>
 #include <euclid/Grid2d.hh>
 #include <euclid/GridAlgs.hh>
-#include <euclid/GridExpandX.hh>
 #include <toolsa/TaXml.hh>
 #include <toolsa/LogStream.hh>
 #include <cstdio>
@@ -603,11 +602,9 @@ TileInfo::constructWeightedTiledGrid(const std::string &fieldName,
   sums.divide(counts);
   if (nptSmooth > 0)
   {
-    // create and expanded grid in X to allow wraparound in smoothing
-    GridExpandX exp(sums, nptSmooth*2);
-    exp.fill(sums, true);
-    exp.smooth(nptSmooth, nptSmooth);
-    grid = exp.unexpand();
+    // smooth with wraparound in X
+    sums.smooth(nptSmooth, nptSmooth, true);
+    grid = sums;
   }
   else
   {
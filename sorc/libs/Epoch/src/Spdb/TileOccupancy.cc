@@ -0,0 +1,288 @@
+/**
+ * @file TileOccupancy.cc
+ */
+
+#include <Epoch/TileOccupancy.hh>
+#include <Epoch/TileInfo.hh>
+#include <Epoch/TileRange.hh>
+#include <ConvWx/GridData.hh>
+#include <toolsa/TaXml.hh>
+#include <toolsa/LogStream.hh>
+#include <algorithm>
+
+using std::vector;
+using std::pair;
+using std::string;
+
+const std::string TileOccupancy::_tag = "TileOccupancy";
+
+//-------------------------------------------------------------------------
+TileOccupancy::TileOccupancy(const TileInfo &tiling, const GridData &grid) :
+  _ok(true)
+{
+  int nx = grid.getNx();
+  int ny = grid.getNy();
+  int ntiles = tiling.numTiles();
+  if (nx != tiling.gridNptX() || ny != tiling.gridNptY())
+  {
+    LOG(ERROR) << "Grid dimensions " << nx << "," << ny
+	       << " not the tiling dimensions " << tiling.gridNptX()
+	       << "," << tiling.gridNptY();
+    _ok = false;
+    return;
+  }
+
+  // the x segments and y range of each tile, and the cell edges
+  vector<vector<pair<int,int> > > segments(ntiles);
+  vector<int> xEdges, yEdges;
+  xEdges.push_back(0);
+  xEdges.push_back(nx);
+  yEdges.push_back(0);
+  yEdges.push_back(ny);
+  _tiles.resize(ntiles);
+  for (int i=0; i<ntiles; ++i)
+  {
+    TileRange r = tiling.range(i);
+    if (!r.isOk() || r.getY0() < 0 || r.getY0() + r.getNy() > ny)
+    {
+      _tiles[i]._count = -1;
+      continue;
+    }
+    yEdges.push_back(r.getY0());
+    yEdges.push_back(r.getY0() + r.getNy());
+    _xSegments(r.getX0(), r.getNx(), nx, segments[i]);
+    for (size_t j=0; j<segments[i].size(); ++j)
+    {
+      xEdges.push_back(segments[i][j].first);
+      xEdges.push_back(segments[i][j].second);
+    }
+  }
+  sort(xEdges.begin(), xEdges.end());
+  xEdges.erase(unique(xEdges.begin(), xEdges.end()), xEdges.end());
+  sort(yEdges.begin(), yEdges.end());
+  yEdges.erase(unique(yEdges.begin(), yEdges.end()), yEdges.end());
+  int ncx = static_cast<int>(xEdges.size()) - 1;
+  int ncy = static_cast<int>(yEdges.size()) - 1;
+
+  // cell index of each x and y
+  vector<int> cellX(nx), cellY(ny);
+  for (int c=0; c<ncx; ++c)
+  {
+    for (int x=xEdges[c]; x<xEdges[c+1]; ++x)
+    {
+      cellX[x] = c;
+    }
+  }
+  for (int c=0; c<ncy; ++c)
+  {
+    for (int y=yEdges[c]; y<yEdges[c+1]; ++y)
+    {
+      cellY[y] = c;
+    }
+  }
+
+  // the one pass over the data, skipping 64 points at a time where the
+  // grid mask shows them all missing
+  vector<Stats> cells(ncx*ncy);
+  const vector<unsigned long long> *mask = NULL;
+  if (grid.hasValidMask())
+  {
+    mask = &grid.validMask();
+  }
+  for (int k=0; k<nx*ny; ++k)
+  {
+    if (mask != NULL && (k & 63) == 0 && (*mask)[k >> 6] == 0ULL)
+    {
+      k += 63;
+      continue;
+    }
+    double v;
+    if (!grid.getValue(k, v))
+    {
+      continue;
+    }
+    Stats &s = cells[cellY[k/nx]*ncx + cellX[k%nx]];
+    if (s._count == 0)
+    {
+      s._min = s._max = v;
+    }
+    else
+    {
+      if (v < s._min) s._min = v;
+      if (v > s._max) s._max = v;
+    }
+    ++s._count;
+  }
+
+  // each tile is a union of cells
+  for (int i=0; i<ntiles; ++i)
+  {
+    if (_tiles[i]._count < 0)
+    {
+      continue;
+    }
+    TileRange r = tiling.range(i);
+    int cy0 = static_cast<int>(lower_bound(yEdges.begin(), yEdges.end(),
+					   r.getY0()) - yEdges.begin());
+    int cy1 = static_cast<int>(lower_bound(yEdges.begin(), yEdges.end(),
+					   r.getY0() + r.getNy()) -
+			       yEdges.begin());
+    for (size_t j=0; j<segments[i].size(); ++j)
+    {
+      int cx0 = cellX[segments[i][j].first];
+      int cx1 = static_cast<int>(lower_bound(xEdges.begin(), xEdges.end(),
+					     segments[i][j].second) -
+				 xEdges.begin());
+      for (int cy=cy0; cy<cy1; ++cy)
+      {
+	for (int cx=cx0; cx<cx1; ++cx)
+	{
+	  _tiles[i].add(cells[cy*ncx + cx]);
+	}
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------
+TileOccupancy::TileOccupancy(const std::string &xml) :
+  _ok(true)
+{
+  string block;
+  if (TaXml::readString(xml, _tag, block))
+  {
+    _ok = false;
+    LOG(ERROR) << "No Tag in data " << _tag;
+    return;
+  }
+  vector<string> vstring;
+  if (TaXml::readStringArray(block, "Tile", vstring))
+  {
+    LOG(ERROR) << "String array tag missing, Tile";
+    _ok = false;
+    return;
+  }
+  for (size_t i=0; i<vstring.size(); ++i)
+  {
+    Stats s;
+    if (TaXml::readInt(vstring[i], "Count", s._count))
+    {
+      LOG(ERROR) << "No tag Count in string";
+      _ok = false;
+    }
+    if (s._count > 0)
+    {
+      if (TaXml::readDouble(vstring[i], "Min", s._min) ||
+	  TaXml::readDouble(vstring[i], "Max", s._max))
+      {
+	LOG(ERROR) << "No tag Min or Max in string";
+	_ok = false;
+      }
+    }
+    _tiles.push_back(s);
+  }
+}
+
+//-------------------------------------------------------------------------
+std::string TileOccupancy::toXml(void) const
+{
+  string xml = TaXml::writeStartTag(_tag, 0);
+  for (size_t i=0; i<_tiles.size(); ++i)
+  {
+    xml += TaXml::writeStartTag("Tile", 1);
+    xml += TaXml::writeInt("Count", 2, _tiles[i]._count);
+    if (_tiles[i]._count > 0)
+    {
+      xml += TaXml::writeDouble("Min", 2, _tiles[i]._min);
+      xml += TaXml::writeDouble("Max", 2, _tiles[i]._max);
+    }
+    xml += TaXml::writeEndTag("Tile", 1);
+  }
+  xml += TaXml::writeEndTag(_tag, 0);
+  return xml;
+}
+
+//-------------------------------------------------------------------------
+bool TileOccupancy::isConstant(int tileIndex, double &value) const
+{
+  if (!isKnown(tileIndex))
+  {
+    return false;
+  }
+  const Stats &s = _tiles[tileIndex];
+  if (s._count > 0 && s._min == s._max)
+  {
+    value = s._min;
+    return true;
+  }
+  return false;
+}
+
+//-------------------------------------------------------------------------
+bool TileOccupancy::fractionsAbove(int tileIndex,
+				   const std::vector<double> &thresholds,
+				   std::vector<double> &fractions) const
+{
+  if (!isKnown(tileIndex) || _tiles[tileIndex]._count == 0)
+  {
+    return false;
+  }
+  const Stats &s = _tiles[tileIndex];
+  fractions.assign(thresholds.size(), 0.0);
+  for (size_t i=0; i<thresholds.size(); ++i)
+  {
+    if (s._min > thresholds[i])
+    {
+      fractions[i] = 1.0;
+    }
+    else if (s._max <= thresholds[i])
+    {
+      fractions[i] = 0.0;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------
+int TileOccupancy::numEmpty(void) const
+{
+  int n = 0;
+  for (size_t i=0; i<_tiles.size(); ++i)
+  {
+    if (_tiles[i]._count == 0)
+    {
+      ++n;
+    }
+  }
+  return n;
+}
+
+//-------------------------------------------------------------------------
+void TileOccupancy::_xSegments(int x0, int nx, int gridNx,
+			       std::vector<std::pair<int,int> > &segments)
+{
+  // the same wraparound as GridData::wraparoundX()
+  segments.clear();
+  int x = x0;
+  int remaining = nx;
+  while (remaining > 0)
+  {
+    int ix = x % gridNx;
+    if (ix < 0)
+    {
+      ix += gridNx;
+    }
+    int len = gridNx - ix;
+    if (len > remaining)
+    {
+      len = remaining;
+    }
+    segments.push_back(pair<int,int>(ix, ix + len));
+    x += len;
+    remaining -= len;
+  }
+}
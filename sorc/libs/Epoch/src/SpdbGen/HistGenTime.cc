@@ -6,11 +6,15 @@
 #include <Epoch/TileInfo.hh>
 #include <toolsa/LogStream.hh>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
 
 //-------------------------------------------------------------------------
 HistGenTime::HistGenTime(const time_t &gen, std::vector<int> &leadSeconds,
 			 int numObarThresh, int numTiles) :
-  _genTime(gen), _leadSeconds(leadSeconds)
+  _genTime(gen), _leadSeconds(leadSeconds), _numObarThresh(numObarThresh),
+  _numTiles(numTiles)
 {
   for (size_t i=0; i<_leadSeconds.size(); ++i)
   {
@@ -31,6 +35,19 @@ void HistGenTime::update(const std::vector<TileThreshInfoGenBased> &info,
   _histAtLead[i].update(info, obarThreshIndex);
 }
 
+//-------------------------------------------------------------------------
+void HistGenTime::subtract(const std::vector<TileThreshInfoGenBased> &info,
+			   int ltSec, int obarThreshIndex)
+{
+  int i = _leadIndex(ltSec);
+  if (i < 0)
+  {
+    LOG(ERROR) << "Bad lead  " << ltSec;
+    return;
+  }
+  _histAtLead[i].subtract(info, obarThreshIndex);
+}
+
 //-------------------------------------------------------------------------
 std::vector<double> HistGenTime::getAverages(int ltSec, int obarThreshIndex) const
 {
@@ -59,6 +76,36 @@ void HistLeadTime::update(const std::vector<TileThreshInfoGenBased> &info,
   _histOneObarThresh[obarThreshIndex].update(info);
 }
 
+//-------------------------------------------------------------------------
+void HistLeadTime::subtract(const std::vector<TileThreshInfoGenBased> &info,
+			    int obarThreshIndex)
+{
+  if (obarThreshIndex < 0 || obarThreshIndex >= (int)_histOneObarThresh.size())
+  {
+    LOG(ERROR) << "Index bad " << obarThreshIndex;
+    return;
+  }
+  _histOneObarThresh[obarThreshIndex].subtract(info);
+}
+
+//-------------------------------------------------------------------------
+void HistLeadTime::appendState(std::vector<double> &state) const
+{
+  for (size_t i=0; i<_histOneObarThresh.size(); ++i)
+  {
+    _histOneObarThresh[i].appendState(state);
+  }
+}
+
+//-------------------------------------------------------------------------
+void HistLeadTime::setState(const std::vector<double> &state, size_t &k)
+{
+  for (size_t i=0; i<_histOneObarThresh.size(); ++i)
+  {
+    _histOneObarThresh[i].setState(state, k);
+  }
+}
+
 //-------------------------------------------------------------------------
 std::vector<double> HistLeadTime::getAverages(int obarThreshIndex) const
 {
@@ -82,6 +129,33 @@ void HistOneObarThresh::update(const std::vector<TileThreshInfoGenBased> &info)
   }
 }
 
+//-------------------------------------------------------------------------
+void HistOneObarThresh::subtract(const std::vector<TileThreshInfoGenBased> &info)
+{
+  for (size_t i=0; i<info.size(); ++i)
+  {
+    _histOneTile[i].subtract(info[i]);
+  }
+}
+
+//-------------------------------------------------------------------------
+void HistOneObarThresh::appendState(std::vector<double> &state) const
+{
+  for (size_t i=0; i<_histOneTile.size(); ++i)
+  {
+    _histOneTile[i].appendState(state);
+  }
+}
+
+//-------------------------------------------------------------------------
+void HistOneObarThresh::setState(const std::vector<double> &state, size_t &k)
+{
+  for (size_t i=0; i<_histOneTile.size(); ++i)
+  {
+    _histOneTile[i].setState(state, k);
+  }
+}
+
 //-------------------------------------------------------------------------
 std::vector<double> HistOneObarThresh::getAverages(void) const
 {
@@ -103,19 +177,45 @@ std::vector<double> HistOneObarThresh::getAverages(void) const
 
 //-------------------------------------------------------------------------
 void HistOneTile::update(const TileThreshInfoGenBased &info)
+{
+  if (!_accepts(info))
+  {
+    return;
+  }
+  _count += 1.0;
+  _sum = _sum + info.getThresh();
+}
+
+//-------------------------------------------------------------------------
+void HistOneTile::subtract(const TileThreshInfoGenBased &info)
+{
+  if (!_accepts(info))
+  {
+    return;
+  }
+  _count -= 1.0;
+  _sum = _sum - info.getThresh();
+  if (_count <= 0.0)
+  {
+    // clear out any rounding left over
+    _count = 0.0;
+    _sum = 0.0;
+  }
+}
+
+//-------------------------------------------------------------------------
+bool HistOneTile::_accepts(const TileThreshInfoGenBased &info) const
 {
   bool isMother = TileInfo::isMotherTile(_index);
   if (info.getMotherTile() && !isMother)
   {
-    return;
+    return false;
   }
   if (info.getColdstart())
   {
-    return;
+    return false;
   }
-  
-  _count += 1.0;
-  _sum = _sum + info.getThresh();
+  return true;
 }
 
 //-------------------------------------------------------------------------
@@ -132,3 +232,122 @@ int HistGenTime::_leadIndex(int leadTime) const
     return (int)(i - _leadSeconds.begin());
   }
 }
+
+/**
+ * Identifies a HistGenTime state file, and its layout version
+ */
+static const char *histStateMagic = "HistGenTime2";
+
+//-------------------------------------------------------------------------
+bool HistGenTime::writeState(const std::string &path, const std::string &key,
+			     int numUpdates,
+			     const std::vector<std::pair<time_t,time_t> > &times) const
+{
+  std::vector<double> state;
+  for (size_t i=0; i<_histAtLead.size(); ++i)
+  {
+    _histAtLead[i].appendState(state);
+  }
+
+  // text, so the file does not depend on type sizes or byte order, with
+  // enough digits that the doubles read back exactly
+  std::string tmp = path + ".tmp";
+  FILE *fp = fopen(tmp.c_str(), "w");
+  if (fp == NULL)
+  {
+    LOG(ERROR) << "Opening " << tmp;
+    return false;
+  }
+  bool ok = fprintf(fp, "%s\n%s\n%d\n%d\n", histStateMagic, key.c_str(),
+		    numUpdates, static_cast<int>(_leadSeconds.size())) > 0;
+  for (size_t i=0; ok && i<_leadSeconds.size(); ++i)
+  {
+    ok = fprintf(fp, "%d\n", _leadSeconds[i]) > 0;
+  }
+  ok = ok && fprintf(fp, "%d\n%d\n%d\n", _numObarThresh, _numTiles,
+		     static_cast<int>(times.size())) > 0;
+  for (size_t i=0; ok && i<times.size(); ++i)
+  {
+    ok = fprintf(fp, "%ld %ld\n", static_cast<long>(times[i].first),
+		 static_cast<long>(times[i].second)) > 0;
+  }
+  ok = ok && fprintf(fp, "%d\n", static_cast<int>(state.size())) > 0;
+  for (size_t i=0; ok && i<state.size(); ++i)
+  {
+    ok = fprintf(fp, "%.17g\n", state[i]) > 0;
+  }
+  if (fclose(fp) != 0)
+  {
+    ok = false;
+  }
+  if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+  {
+    LOG(ERROR) << "Writing " << path;
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------
+bool HistGenTime::readState(const std::string &path, const std::string &key,
+			    int &numUpdates,
+			    std::vector<std::pair<time_t,time_t> > &times)
+{
+  times.clear();
+  numUpdates = 0;
+  FILE *fp = fopen(path.c_str(), "r");
+  if (fp == NULL)
+  {
+    LOG(DEBUG) << "No state file " << path;
+    return false;
+  }
+
+  char line[1024];
+  int nlead, nobar, ntiles, ntimes, nstate;
+  bool ok = (fgets(line, sizeof(line), fp) != NULL &&
+	     std::string(line) == std::string(histStateMagic) + "\n" &&
+	     fgets(line, sizeof(line), fp) != NULL &&
+	     std::string(line) == key + "\n" &&
+	     fscanf(fp, "%d", &numUpdates) == 1 &&
+	     fscanf(fp, "%d", &nlead) == 1 &&
+	     nlead == static_cast<int>(_leadSeconds.size()));
+  for (int i=0; ok && i<nlead; ++i)
+  {
+    int lead;
+    ok = fscanf(fp, "%d", &lead) == 1 && lead == _leadSeconds[i];
+  }
+  ok = ok &&
+    fscanf(fp, "%d", &nobar) == 1 && nobar == _numObarThresh &&
+    fscanf(fp, "%d", &ntiles) == 1 && ntiles == _numTiles &&
+    fscanf(fp, "%d", &ntimes) == 1 && ntimes >= 0;
+  for (int i=0; ok && i<ntimes; ++i)
+  {
+    long t0, t1;
+    ok = fscanf(fp, "%ld %ld", &t0, &t1) == 2;
+    times.push_back(std::pair<time_t,time_t>(t0, t1));
+  }
+  std::vector<double> state;
+  ok = ok && fscanf(fp, "%d", &nstate) == 1 &&
+    nstate == nlead*nobar*ntiles*2;
+  for (int i=0; ok && i<nstate; ++i)
+  {
+    double v;
+    ok = fscanf(fp, "%lf", &v) == 1;
+    state.push_back(v);
+  }
+  fclose(fp);
+  if (!ok)
+  {
+    LOG(WARNING) << "State file " << path << " bad or does not match";
+    times.clear();
+    return false;
+  }
+
+  size_t k = 0;
+  for (size_t i=0; i<_histAtLead.size(); ++i)
+  {
+    _histAtLead[i].setState(state, k);
+  }
+  return true;
+}
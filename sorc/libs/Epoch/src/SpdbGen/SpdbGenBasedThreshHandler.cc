@@ -8,6 +8,11 @@
 #include <Spdb/DsSpdb.hh>
 #include <toolsa/DateTime.hh>
 #include <toolsa/LogStream.hh>
+#include <ConvWx/InterfaceLL.hh>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <cstdio>
 
 //------------------------------------------------------------------------
 SpdbGenBasedThreshHandler::
@@ -247,37 +252,203 @@ bool SpdbGenBasedThreshHandler::average(const time_t &recentTime, int daysBack,
   for (size_t i=0; i<times.size(); ++i)
   {
     LOG(DEBUG) << "time = " << DateTime::strn(times[i]);
-    // read in the data for this time
-    if (!read(times[i]))
+    if (!_accumulate(times[i], ltimes, numObarThresh, true, hist))
     {
-      LOG(ERROR) << "Expected data at " << DateTime::strn(times[i]);
       return false;
     }
+  }
+  _setAverages(hist, ltimes, numObarThresh, out);
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool SpdbGenBasedThreshHandler::averageIncremental(const time_t &recentTime,
+						   int daysBack,
+						   const std::string &stateDir,
+						   bool fullRebuild,
+						   SpdbGenBasedMetadata &out)
+{
+  time_t t0 = recentTime - daysBack*24*3600;
+  vector<time_t> times = timesInRangeWithMatchingHour(t0, recentTime);
+
+  out = *this;  // the thresholds are all wrong, everything else is ok.
+
+  int nTiles = getNumTiles();
+  vector<int> ltimes = getLeadSeconds();
+  int numObarThresh = getNumObarThresh();
+
+  if (times.empty())
+  {
+    LOG(ERROR) << "No history found";
+    return false;
+  }
+
+  // one state file per URL and hour of day
+  string name = _url;
+  for (size_t i=0; i<name.size(); ++i)
+  {
+    if (!isalnum(name[i]))
+    {
+      name[i] = '_';
+    }
+  }
+  char buf[1000];
+  sprintf(buf, "%s/hist_%s_%02d.state", stateDir.c_str(), name.c_str(),
+	  DateTime(recentTime).getHour());
+  string path = buf;
 
-    if (getNumObarThresh()  != numObarThresh)
+  // time written of every chunk in the window, from the refs alone
+  map<time_t, time_t> written;
+  DsSpdb D;
+  bool haveRefs = D.getInterval(_url, t0, recentTime, 0, 0, true) == 0;
+  if (haveRefs)
+  {
+    const Spdb::chunk_ref_t *refs = D.getChunkRefs();
+    const Spdb::aux_ref_t *aux = D.getAuxRefs();
+    for (int i=0; i<D.getNChunks(); ++i)
+    {
+      written[refs[i].valid_time] = aux[i].write_time;
+    }
+  }
+
+  HistGenTime hist(recentTime, ltimes, numObarThresh, nTiles);
+  vector<std::pair<time_t,time_t> > state, newState;
+  int numUpdates = 0;
+  bool incremental = !fullRebuild && haveRefs &&
+    hist.readState(path, _url, numUpdates, state);
+
+  // rebuild once per window, so the rounding left by adding and
+  // subtracting does not build up
+  if (incremental && numUpdates >= daysBack)
+  {
+    LOG(DEBUG) << "Periodic rebuild";
+    incremental = false;
+  }
+  for (size_t i=0; incremental && i<state.size(); ++i)
+  {
+    time_t t = state[i].first;
+    if (find(times.begin(), times.end(), t) != times.end())
+    {
+      // still in the window, unchanged unless rewritten
+      map<time_t, time_t>::const_iterator w = written.find(t);
+      if (w == written.end() || w->second != state[i].second)
+      {
+	LOG(DEBUG) << "Chunk at " << DateTime::strn(t) << " changed, rebuild";
+	incremental = false;
+	break;
+      }
+      newState.push_back(state[i]);
+      continue;
+    }
+
+    // left the window
+    if (!read(t) || getChunkTimeWritten() != state[i].second)
+    {
+      LOG(DEBUG) << "Chunk at " << DateTime::strn(t) << " changed, rebuild";
+      incremental = false;
+      break;
+    }
+    LOG(DEBUG) << "subtract time = " << DateTime::strn(t);
+    if (!_accumulate(t, ltimes, numObarThresh, false, hist))
+    {
+      incremental = false;
+    }
+  }
+  if (incremental)
+  {
+    ++numUpdates;
+  }
+  else
+  {
+    // start over with nothing in the sums
+    hist = HistGenTime(recentTime, ltimes, numObarThresh, nTiles);
+    newState.clear();
+    numUpdates = 0;
+  }
+  
+  for (size_t i=0; i<times.size(); ++i)
+  {
+    bool has = false;
+    for (size_t j=0; j<newState.size(); ++j)
+    {
+      if (newState[j].first == times[i])
+      {
+	has = true;
+	break;
+      }
+    }
+    if (has)
+    {
+      continue;
+    }
+    LOG(DEBUG) << "time = " << DateTime::strn(times[i]);
+    if (!_accumulate(times[i], ltimes, numObarThresh, true, hist))
     {
-      LOG(ERROR) << "Obar thresh changed";
       return false;
     }
+    newState.push_back(std::pair<time_t,time_t>(times[i],
+						getChunkTimeWritten()));
+  }
+
+  if (InterfaceLL::makeDirRecurse(path))
+  {
+    hist.writeState(path, _url, numUpdates, newState);
+  }
+  _setAverages(hist, ltimes, numObarThresh, out);
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool SpdbGenBasedThreshHandler::_accumulate(const time_t &t,
+					    const vector<int> &ltimes,
+					    int numObarThresh, bool add,
+					    HistGenTime &hist)
+{
+  // read in the data for this time
+  if (!read(t))
+  {
+    LOG(ERROR) << "Expected data at " << DateTime::strn(t);
+    return false;
+  }
+
+  if (getNumObarThresh()  != numObarThresh)
+  {
+    LOG(ERROR) << "Obar thresh changed";
+    return false;
+  }
     
-    // for each lead time
-    vector<TileThreshInfoGenBased> info;
-    for (size_t l=0; l<ltimes.size(); ++l)
-    {
-      int ltSec = ltimes[l];
+  // for each lead time
+  vector<TileThreshInfoGenBased> info;
+  for (size_t l=0; l<ltimes.size(); ++l)
+  {
+    int ltSec = ltimes[l];
 
-      for (int o=0; o<numObarThresh; ++o)
+    for (int o=0; o<numObarThresh; ++o)
+    {
+      // pull out the threshold info for this lead time/threshold
+      info = getTileThreshInfo(ltSec, o);
+      if (!info.empty())
       {
-	// pull out the threshold info for this lead time/threshold
-	info = getTileThreshInfo(ltSec, o);
-	if (!info.empty())
+	if (add)
 	{
 	  hist.update(info, ltSec, o);
 	}
+	else
+	{
+	  hist.subtract(info, ltSec, o);
+	}
       }
-    }    
-  }
+    }
+  }    
+  return true;
+}
 
+//------------------------------------------------------------------------
+void SpdbGenBasedThreshHandler::_setAverages(const HistGenTime &hist,
+					     const vector<int> &ltimes,
+					     int numObarThresh,
+					     SpdbGenBasedMetadata &out) const
+{
   // now pull out the averages at each lead time/obar thresh and store to the output object
   for (size_t l=0; l<ltimes.size(); ++l)
   {
@@ -298,7 +469,6 @@ bool SpdbGenBasedThreshHandler::average(const time_t &recentTime, int daysBack,
       }
     }
   }
-  return true;
 }
 
 //------------------------------------------------------------------------
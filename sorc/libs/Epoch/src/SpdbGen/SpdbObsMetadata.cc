@@ -63,6 +63,7 @@ bool SpdbObsMetadata::fromXml(const std::string &xml)
   {
     return false;
   }
+  _occupancyFromXml(xml);
   return true;
 }
 
@@ -75,6 +76,10 @@ std::string SpdbObsMetadata::toXml(void) const
   ret += _tiling.toXml();
   ret +=_obsTimeToXml();
   ret +=_infoToXml();
+  if (_occupancy.isOk())
+  {
+    ret += _occupancy.toXml();
+  }
   return ret;
 }
 
@@ -285,6 +290,21 @@ bool SpdbObsMetadata::_threshFromXml(const std::string &xml)
   return true;
 }
 
+//------------------------------------------------------------------
+void SpdbObsMetadata::_occupancyFromXml(const std::string &xml)
+{
+  // optional, not in older data
+  string block;
+  if (TaXml::readString(xml, TileOccupancy::_tag, block))
+  {
+    _occupancy = TileOccupancy();
+  }
+  else
+  {
+    _occupancy = TileOccupancy(xml);
+  }
+}
+
 //------------------------------------------------------------------
 bool SpdbObsMetadata::_tilingFromXml(const std::string &xml)
 {
@@ -12,6 +12,8 @@
 
 #include <Epoch/HistLeadTime.hh>
 #include <vector>
+#include <string>
+#include <utility>
 #include <ctime>
 
 class HistGenTime
@@ -41,6 +43,48 @@ public:
   void update(const std::vector<TileThreshInfoGenBased> &info, int ltSec,
 	      int obarThreshIndex);
 
+  /**
+   * Remove what update() added for a particular lead time, all tiles
+   * @param[in] info  The information for all tiles at this lead time
+   * @param[in] ltSec  The lead time (seconds)
+   * @param[in] obarThreshIndex  Obar threshold index
+   */
+  void subtract(const std::vector<TileThreshInfoGenBased> &info, int ltSec,
+		int obarThreshIndex);
+
+  /**
+   * Write counts and sums to a text state file, along with the gen times
+   * that went into them
+   *
+   * @param[in] path  File to write, replaced atomically
+   * @param[in] key  Identifies the data the sums are for, such as the URL
+   * @param[in] numUpdates  Number of incremental updates since the sums
+   *                        were last rebuilt
+   * @param[in] times  Gen time and SPDB time written of each chunk in the
+   *                   sums
+   * @return true for success
+   */
+  bool writeState(const std::string &path, const std::string &key,
+		  int numUpdates,
+		  const std::vector<std::pair<time_t,time_t> > &times) const;
+
+  /**
+   * Read counts and sums from a state file written by writeState()
+   *
+   * @param[in] path  File to read
+   * @param[in] key  Must match the key the file was written with
+   * @param[out] numUpdates  Number of incremental updates since the sums
+   *                         were last rebuilt
+   * @param[out] times  Gen time and SPDB time written of each chunk in the
+   *                    sums
+   * @return true for success, false if the file is missing, bad, or was
+   *         written for a different key, lead times, obar thresholds or
+   *         tiles
+   */
+  bool readState(const std::string &path, const std::string &key,
+		 int &numUpdates,
+		 std::vector<std::pair<time_t,time_t> > &times);
+
   /**
    * @return the average threshold for all tiles at a lead time
    * If the average was not computed in a tile the returned value is -1
@@ -58,6 +102,8 @@ private:
   std::vector<int> _leadSeconds;        /**< The set of lead seconds */
   std::vector<HistLeadTime> _histAtLead; /**< The count/sums for all tiles
 					  * at each lead time */
+  int _numObarThresh;                   /**< Number of obar thresholds */
+  int _numTiles;                        /**< Number of tiles */
 
   int _leadIndex(int leadTime) const;
 };
@@ -44,6 +44,27 @@ public:
   void update(const std::vector<TileThreshInfoGenBased> &info,
 	      int obarThreshIndex);
 
+  /**
+   * Remove what update() added for the input
+   * @param[in] info  The information for each tile
+   * @param[in] obarThreshIndex
+   */
+  void subtract(const std::vector<TileThreshInfoGenBased> &info,
+		int obarThreshIndex);
+
+  /**
+   * Append counts and sums for all obar thresholds to a state vector
+   * @param[in,out] state
+   */
+  void appendState(std::vector<double> &state) const;
+
+  /**
+   * Set counts and sums for all obar thresholds from a state vector
+   * @param[in] state
+   * @param[in,out] k  Index to the next value in state, advanced
+   */
+  void setState(const std::vector<double> &state, size_t &k);
+
   /**
    * @return the average threshold for all tiles for some obar threshold
    *
@@ -40,6 +40,25 @@ public:
    */
   void update(const std::vector<TileThreshInfoGenBased> &info);
 
+  /**
+   * Remove what update() added for the input
+   * @param[in] info  The information for each tile
+   */
+  void subtract(const std::vector<TileThreshInfoGenBased> &info);
+
+  /**
+   * Append counts and sums for all tiles to a state vector
+   * @param[in,out] state
+   */
+  void appendState(std::vector<double> &state) const;
+
+  /**
+   * Set counts and sums for all tiles from a state vector
+   * @param[in] state
+   * @param[in,out] k  Index to the next value in state, advanced
+   */
+  void setState(const std::vector<double> &state, size_t &k);
+
   /**
    * @return the average threshold for all tiles
    * If the average was not computed in a tile the returned value is -1
@@ -8,6 +8,9 @@
 #ifndef HistOneTile_hh
 #define HistOneTile_hh
 
+#include <vector>
+#include <cstddef>
+
 class TileThreshInfoGenBased;
 
 class HistOneTile
@@ -57,6 +60,33 @@ public:
    * If the info says it was coldstart, do not update anything
    */
   void update(const TileThreshInfoGenBased &info);
+
+  /**
+   * Remove from local count/sum what update() added for the input info
+   * @param[in] info
+   */
+  void subtract(const TileThreshInfoGenBased &info);
+
+  /**
+   * Append count and sum to a state vector
+   * @param[in,out] state
+   */
+  inline void appendState(std::vector<double> &state) const
+  {
+    state.push_back(_count);
+    state.push_back(_sum);
+  }
+
+  /**
+   * Set count and sum from a state vector
+   * @param[in] state
+   * @param[in,out] k  Index to the next value in state, advanced
+   */
+  inline void setState(const std::vector<double> &state, size_t &k)
+  {
+    _count = state[k++];
+    _sum = state[k++];
+  }
   
 protected:
 private:
@@ -64,6 +94,7 @@ private:
   double _count; /**< Count of number of things in the sum */
   double _sum;   /**< number of things */
 
+  bool _accepts(const TileThreshInfoGenBased &info) const;
 };
 
 #endif
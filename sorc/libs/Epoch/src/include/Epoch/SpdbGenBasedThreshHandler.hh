@@ -18,6 +18,7 @@
 
 class DsSpdb;
 class TileThreshInfoGenBased;
+class HistGenTime;
 
 //----------------------------------------------------------------
 class SpdbGenBasedThreshHandler : public SpdbGenBasedMetadata
@@ -120,6 +121,33 @@ public:
   bool average(const time_t &recentTime, int daysBack, double coldstartThresh,
 	       SpdbGenBasedMetadata &out);
 
+  /**
+   * The average() result, kept up to date incrementally using counts and
+   * sums saved in a state file, one file per URL and hour of the day.
+   *
+   * Each call reads the chunk refs in the window to check that no chunk in
+   * the sums was rewritten, then reads only the chunks that entered the
+   * window since the state was saved (added) and those that left it
+   * (subtracted). If the state is missing or does not match, or a chunk in
+   * the sums was rewritten or cannot be read back, the sums are rebuilt
+   * from all chunks in the window as average() does. They are also rebuilt
+   * after daysBack incremental updates, so the result differs from
+   * average() by no more than the rounding of one window of updates.
+   *
+   * @param[in] recentTime  Maximum time to put into the average
+   * @param[in] daysBack  Number of days back in which to accumulate averages
+   *                      that have the same hour as recentTime
+   * @param[in] stateDir  Directory for the state files
+   * @param[in] fullRebuild  True to always rebuild from all chunks, and
+   *                         save the state
+   * @param[out] out  The object that is created
+   *
+   * @return true for success
+   */
+  bool averageIncremental(const time_t &recentTime, int daysBack,
+			  const std::string &stateDir, bool fullRebuild,
+			  SpdbGenBasedMetadata &out);
+
   /**
    * @return the gen times that are in the range of inputs 
    *
@@ -157,6 +185,10 @@ private:
   
   bool _readExisting(const time_t &genTime, const std::string &description);
   bool _load(DsSpdb &s, const std::string &description);
+  bool _accumulate(const time_t &t, const std::vector<int> &ltimes,
+		   int numObarThresh, bool add, HistGenTime &hist);
+  void _setAverages(const HistGenTime &hist, const std::vector<int> &ltimes,
+		    int numObarThresh, SpdbGenBasedMetadata &out) const;
 		
 };
 
@@ -10,6 +10,7 @@
 
 #include <Epoch/TileInfo.hh>
 #include <Epoch/ThreshObarInfo.hh>
+#include <Epoch/TileOccupancy.hh>
 #include <string>
 #include <vector>
 
@@ -154,6 +155,21 @@ public:
    */
   inline std::vector<double> getObarThresh(void) const {return _thresh;}
 
+  /**
+   * Store the tile occupancy of the obs data, written with the obar values
+   * @param[in] occupancy
+   */
+  inline void setOccupancy(const TileOccupancy &occupancy)
+  {
+    _occupancy = occupancy;
+  }
+
+  /**
+   * @return the tile occupancy of the obs data, not ok if it was not
+   * stored
+   */
+  inline const TileOccupancy &getOccupancy(void) const {return _occupancy;}
+
  protected:
  private:  
 
@@ -162,6 +178,7 @@ public:
   std::vector<double> _thresh; /**< the obar thresholds (one for each _info) */
   TileInfo _tiling;            /**< Information about tiles */
   time_t _obsTime;             /**< Observations time=chunk time */
+  TileOccupancy _occupancy;    /**< Obs data tile occupancy, optional */
 
   /**
    * obar info for each obar threshold
@@ -182,6 +199,7 @@ public:
   bool _threshFromXml(const std::string &xml);
   bool _obsTimeFromXml(const std::string &xml);
   bool _infoFromXml(const std::string &xml);
+  void _occupancyFromXml(const std::string &xml);
 
 };
 
@@ -0,0 +1,180 @@
+/**
+ * @file TileOccupancy.hh
+ * @brief Per tile count of non-missing points and data range, for one grid
+ * @class TileOccupancy
+ * @brief Per tile count of non-missing points and data range, for one grid
+ *
+ * Built in one pass over a grid: the grid is cut into cells at every tile
+ * edge, statistics are kept per cell, and each tile is the union of the
+ * cells it covers, so overlapping tiles do not rescan the data.  Tiles
+ * that extend past the grid in y, which are filled in from the tile below,
+ * are marked as not known.  Tiles wrap in x, as with the tile statistics.
+ *
+ * Tile loops use it to skip tiles with no data, and tiles whose data is
+ * constant or entirely on one side of a threshold, where the result is
+ * known without a scan.
+ */
+
+# ifndef    TileOccupancy_hh
+# define    TileOccupancy_hh
+
+#include <string>
+#include <utility>
+#include <vector>
+class TileInfo;
+class GridData;
+
+//----------------------------------------------------------------
+class TileOccupancy
+{
+public:
+
+  /**
+   * Empty, not ok
+   */
+  inline TileOccupancy(void) : _ok(false) {}
+
+  /**
+   * Build from a grid
+   *
+   * @param[in] tiling  The tiles
+   * @param[in] grid  The data, first level used, same dimensions as tiling
+   */
+  TileOccupancy(const TileInfo &tiling, const GridData &grid);
+
+  /**
+   * Constructor from XML
+   *
+   * @param[in] xml  The xml data
+   */
+  TileOccupancy(const std::string &xml);
+
+  /**
+   * Destructor
+   */
+  inline ~TileOccupancy(void) {}
+
+  /**
+   * @return XML representation of state
+   */
+  std::string toXml(void) const;
+
+  /**
+   * @return true if object is valid
+   */
+  inline bool isOk(void) const {return _ok;}
+
+  /**
+   * @return number of tiles
+   */
+  inline int numTiles(void) const {return static_cast<int>(_tiles.size());}
+
+  /**
+   * @return true if the statistics for a tile are known
+   * @param[in] tileIndex
+   */
+  inline bool isKnown(int tileIndex) const
+  {
+    return _ok && tileIndex >= 0 && tileIndex < numTiles() &&
+      _tiles[tileIndex]._count >= 0;
+  }
+
+  /**
+   * @return number of non-missing points in a tile, -1 if not known.
+   * Points in a tile that is wider than the grid are counted once
+   * per time they are in the tile.
+   * @param[in] tileIndex
+   */
+  inline int numValid(int tileIndex) const
+  {
+    return isKnown(tileIndex) ? _tiles[tileIndex]._count : -1;
+  }
+
+  /**
+   * @return true if a tile is known to have no data
+   * @param[in] tileIndex
+   */
+  inline bool isEmpty(int tileIndex) const
+  {
+    return isKnown(tileIndex) && _tiles[tileIndex]._count == 0;
+  }
+
+  /**
+   * @return true if a tile is known to have data, all the same value
+   * @param[in] tileIndex
+   * @param[out] value  The value
+   */
+  bool isConstant(int tileIndex, double &value) const;
+
+  /**
+   * Fraction of the data in a tile above each of several thresholds,
+   * from the data range alone
+   *
+   * @param[in] tileIndex
+   * @param[in] thresholds
+   * @param[out] fractions  One per threshold, 0 where the tile maximum is at
+   *                        or below the threshold, 1 where the tile minimum
+   *                        is above it
+   *
+   * @return true if every threshold is resolved that way, false if the
+   * tile is not known, is empty, or the data range straddles a threshold
+   */
+  bool fractionsAbove(int tileIndex, const std::vector<double> &thresholds,
+		      std::vector<double> &fractions) const;
+
+  /**
+   * @return number of tiles known to be empty
+   */
+  int numEmpty(void) const;
+
+  /**
+   * Value of XML tag
+   */
+  static const std::string _tag;
+
+protected:
+private:
+
+  /**
+   * @class Stats
+   * @brief Statistics for one tile or cell
+   */
+  class Stats
+  {
+  public:
+    inline Stats(void) : _count(0), _min(0.0), _max(0.0) {}
+    int _count;   /**< Non-missing points, -1 for not known */
+    double _min;  /**< Minimum non-missing value, when _count > 0 */
+    double _max;  /**< Maximum non-missing value, when _count > 0 */
+
+    /**
+     * Include another set of statistics
+     */
+    inline void add(const Stats &s)
+    {
+      if (s._count <= 0)
+      {
+	return;
+      }
+      if (_count == 0)
+      {
+	_min = s._min;
+	_max = s._max;
+      }
+      else
+      {
+	if (s._min < _min) _min = s._min;
+	if (s._max > _max) _max = s._max;
+      }
+      _count += s._count;
+    }
+  };
+
+  bool _ok;                 /**< status */
+  std::vector<Stats> _tiles; /**< Statistics for each tile */
+
+  static void _xSegments(int x0, int nx, int gridNx,
+			 std::vector<std::pair<int,int> > &segments);
+};
+
+# endif
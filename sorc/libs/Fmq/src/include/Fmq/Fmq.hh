@@ -432,6 +432,13 @@ public:
     return _stat.buf_size;
   }
 
+  // true if a writer has used blocking writes, as of the last read
+
+  inline bool isBlockingWrite() const
+  {
+    return _stat.blocking_write != 0;
+  }
+
   ////////////////////////////////////////////////
   // get details of message returned from read()
   
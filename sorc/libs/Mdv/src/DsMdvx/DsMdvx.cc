@@ -1279,6 +1279,7 @@ int DsMdvx::writeMultForecasts(const string &output_url)
 
   // create a set containing unique times
 
+  _decodeMappedFields();
   set<time_t> ftimes;
   for (int ifield = 0; ifield < (int) _fields.size(); ifield++) {
     ftimes.insert(_fields[ifield]->getFieldHeader().forecast_time);
@@ -78,6 +78,8 @@ Mdvx::Mdvx()
 {
   _debug = false;
   _heartbeatFunc = NULL;
+  _mappedRead = NULL;
+  _initMappedMutex();
   clear();
 }
 
@@ -88,6 +90,8 @@ Mdvx::Mdvx()
 Mdvx::Mdvx(const Mdvx &rhs)
 
 {
+  _mappedRead = NULL;
+  _initMappedMutex();
   if (this != &rhs) {
     clear();
     _copy(rhs);
@@ -101,6 +105,7 @@ Mdvx::~Mdvx()
 
 {
   clear();
+  pthread_mutex_destroy(&_mappedMutex);
 }
 
 /////////////////////////////
@@ -138,6 +143,7 @@ void Mdvx::clear()
 void Mdvx::clearFields()
 
 {
+  _clearMappedRead();
   for (unsigned int i = 0; i < _fields.size(); i++) {
     delete _fields[i];
   }
@@ -167,6 +173,10 @@ Mdvx &Mdvx::_copy(const Mdvx &rhs)
     return *this;
   }
 
+  // fields left by a mapped read are decoded before copying
+
+  rhs._decodeMappedFields();
+
   // copy members
 
   // headers
@@ -183,6 +193,7 @@ Mdvx &Mdvx::_copy(const Mdvx &rhs)
 
   // fields
   
+  _clearMappedRead();
   for (size_t i = 0; i < _fields.size(); i++) {
     delete _fields[i];
   }
@@ -273,6 +284,7 @@ Mdvx &Mdvx::_copy(const Mdvx &rhs)
 
   _readTimeListAlso = rhs._readTimeListAlso;
   _readAsSingleBuffer = rhs._readAsSingleBuffer;
+  _readMapped = rhs._readMapped;
 
   // write request members
 
@@ -347,6 +359,7 @@ int Mdvx::deleteField(MdvxField *toBeDeleted)
   for (vector<MdvxField *>::iterator ii = _fields.begin();
        ii != _fields.end(); ii++) {
     if (*ii == toBeDeleted) {
+      _forgetMappedField(*ii);
       delete *ii;
       _fields.erase(ii);
       _mhdr.n_fields = _fields.size();
@@ -523,6 +536,7 @@ void Mdvx::setForecastTime(time_t forecast_time)
     _ncfForecastTime = forecast_time;
   } else {
     _mhdr.forecast_time = forecast_time;
+    _decodeMappedFields();
     for (int ii = 0; ii < (int) _fields.size(); ii++) {
       _fields[ii]->_fhdr.forecast_time = forecast_time;
     }
@@ -537,6 +551,7 @@ void Mdvx::setForecastLeadSecs(int lead_secs)
     _ncfForecastDelta = lead_secs;
   } else {
     _mhdr.forecast_delta = lead_secs;
+    _decodeMappedFields();
     for (int ii = 0; ii < (int) _fields.size(); ii++) {
       _fields[ii]->_fhdr.forecast_delta = lead_secs;
     }
@@ -783,6 +798,8 @@ MdvxField *Mdvx::getFieldByNum(int field_num) const
 {
   if (field_num < 0 || field_num > (int) (_fields.size() - 1)) {
     return NULL;
+  } else if (_decodeMappedField(_fields[field_num])) {
+    return NULL;
   } else {
     return (_fields[field_num]);
   }
@@ -920,6 +937,7 @@ Mdvx::projection_type_t Mdvx::getProjection() const
   if (_fields.size() < 1) {
     return PROJ_UNKNOWN;
   }
+  _decodeMappedField(_fields[0]);
   const field_header_t &fhdr = _fields[0]->getFieldHeader();
   return (projection_type_t) fhdr.proj_type;
 }
@@ -85,6 +85,7 @@ void Mdvx::printAllHeaders(ostream &out) const
 
 {
 
+  _decodeMappedFields();
   printMasterHeader(out);
 
   for (size_t i = 0; i < _fields.size(); i++) {
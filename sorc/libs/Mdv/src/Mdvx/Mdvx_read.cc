@@ -48,8 +48,36 @@
 #include <toolsa/Path.hh>
 #include <dataport/bigend.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 using namespace std;
 
+//////////////////////////////////////////////////////////
+// State of a mapped read: the file mapping, a copy of the
+// read settings, and the fields not yet decoded.
+
+class MdvxMappedRead {
+public:
+  MdvxMappedRead() :
+          fileBuf(NULL), fileLen(0), request(NULL),
+          fillMissing(false), doDecimate(false), doFinalConvert(true) {}
+  ~MdvxMappedRead() {
+    if (fileBuf != NULL) {
+      munmap(fileBuf, fileLen);
+    }
+    delete request;
+  }
+  void *fileBuf;
+  size_t fileLen;
+  Mdvx *request;
+  bool fillMissing;
+  bool doDecimate;
+  bool doFinalConvert;
+  MdvxRemapLut remapLut;
+  set<const MdvxField *> pending;
+};
+
 //////////////////////////////
 // Setting up to read
 //
@@ -83,6 +111,7 @@ void Mdvx::clearRead()
   clearReadChunks();
   clearReadTimeListAlso();
   clearReadAsSingleBuffer();
+  clearReadMapped();
   clearReadFormat();
   clearCheckLatestValidModTime();
   clearConstrainFcastLeadTimes();
@@ -1100,6 +1129,19 @@ void Mdvx::setReadAsSinglePart()
   setReadAsSingleBuffer();
 }
 
+///////////////////////
+// readMapped
+
+void Mdvx::setReadMapped()
+{
+  _readMapped = true;
+}
+
+void Mdvx::clearReadMapped()
+{
+  _readMapped = false;
+}
+
 void Mdvx::clearReadAsSinglePart()
 {
   clearReadAsSingleBuffer();
@@ -2623,9 +2665,19 @@ int Mdvx::_read_volume(bool fill_missing,
 
   }
 
-  // create the fields, read in the data volume for each field
+  // create the fields, read in the data volume for each field.
+  // For a mapped read, the fields are left to be decoded when
+  // they are first got.
+
+  // The object owns the mapped read state from here, so that it is
+  // freed with the fields whatever happens to the read.
 
   MdvxRemapLut remapLut;
+  MdvxMappedRead *mapped = NULL;
+  if (_readMapped && !is_vsection) {
+    mapped = _mapForRead(infile, fill_missing, do_decimate, do_final_convert);
+    _mappedRead = mapped;
+  }
 
   for (size_t i = 0; i < _readFieldNums.size(); i++) {
     
@@ -2638,6 +2690,13 @@ int Mdvx::_read_volume(bool fill_missing,
        _errStr += errstr;
        return -1;
     }
+
+    if (mapped != NULL) {
+      field->_volBuf.free();
+      mapped->pending.insert(field);
+      _fields.push_back(field);
+      continue;
+    }
     
     if (field->_read_volume(infile, *this, fill_missing,
 			    do_decimate, do_final_convert, remapLut,
@@ -2688,6 +2747,10 @@ int Mdvx::_read_volume(bool fill_missing,
 
   infile.fclose();
 
+  if (mapped != NULL && mapped->pending.size() == 0) {
+    _clearMappedRead();
+  }
+
   // set data set info from chunks as appropriate
 
   _setDataSetInfoFromChunks();
@@ -2700,6 +2763,178 @@ int Mdvx::_read_volume(bool fill_missing,
 
 }
 
+//////////////////////////////////////////////////////////
+// Map the file the headers were read from, open in infile,
+// and save the read settings for decoding the fields later.
+// A compressed file is mapped as uncompressed in memory.
+//
+// Returns NULL if the file cannot be mapped, in which case
+// the read is done as normal.
+
+MdvxMappedRead *Mdvx::_mapForRead(TaFile &infile,
+                                  bool fill_missing,
+                                  bool do_decimate,
+                                  bool do_final_convert)
+  
+{
+
+  if (infile.getFILE() == NULL) {
+    return NULL;
+  }
+  int fd = fileno(infile.getFILE());
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) ||
+      fileStat.st_size < (off_t) sizeof(master_header_t)) {
+    return NULL;
+  }
+  void *fileBuf = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (fileBuf == MAP_FAILED) {
+    return NULL;
+  }
+
+  // check the mapping against the headers read
+
+  master_header_t mhdr;
+  memcpy(&mhdr, fileBuf, sizeof(master_header_t));
+  master_header_from_BE(mhdr);
+  if (mhdr.struct_id != _mhdrFile.struct_id ||
+      mhdr.n_fields != _mhdrFile.n_fields) {
+    munmap(fileBuf, fileStat.st_size);
+    return NULL;
+  }
+
+  MdvxMappedRead *mapped = new MdvxMappedRead;
+  mapped->fileBuf = fileBuf;
+  mapped->fileLen = fileStat.st_size;
+  mapped->request = new Mdvx(*this);
+  mapped->fillMissing = fill_missing;
+  mapped->doDecimate = do_decimate;
+  mapped->doFinalConvert = do_final_convert;
+  
+  return mapped;
+
+}
+
+//////////////////////////////////////////////////////////
+// Decode a field left by a mapped read, if it has not
+// been decoded yet.
+//
+// Returns 0 on success, -1 on failure
+
+int Mdvx::_decodeMappedField(MdvxField *field) const
+  
+{
+
+  if (field == NULL) {
+    return 0;
+  }
+
+  // decoding changes the field, the pending set and the master
+  // header, so it is serialized for const access from several threads
+
+  pthread_mutex_lock(&_mappedMutex);
+  if (_mappedRead == NULL) {
+    pthread_mutex_unlock(&_mappedMutex);
+    return 0;
+  }
+  set<const MdvxField *>::iterator it = _mappedRead->pending.find(field);
+  if (it == _mappedRead->pending.end()) {
+    pthread_mutex_unlock(&_mappedMutex);
+    return 0;
+  }
+  _mappedRead->pending.erase(it);
+
+  int iret = 0;
+  if (field->_read_volume(_mappedRead->fileBuf, _mappedRead->fileLen,
+                          *_mappedRead->request,
+                          _mappedRead->fillMissing,
+                          _mappedRead->doDecimate,
+                          _mappedRead->doFinalConvert,
+                          _mappedRead->remapLut)) {
+    _errStr += "ERROR - Mdvx::_decodeMappedField.\n";
+    _errStr += field->getErrStr();
+    iret = -1;
+  }
+
+  if (_mappedRead->pending.size() == 0) {
+    _clearMappedRead();
+  }
+
+  // update the master header to match any changes in the field
+
+  updateMasterHeader();
+  pthread_mutex_unlock(&_mappedMutex);
+
+  return iret;
+
+}
+
+//////////////////////////////////////////////////////////
+// Decode all the fields left by a mapped read
+//
+// Returns 0 on success, -1 on failure
+
+int Mdvx::_decodeMappedFields() const
+  
+{
+
+  int iret = 0;
+  pthread_mutex_lock(&_mappedMutex);
+  for (size_t i = 0; i < _fields.size() && _mappedRead != NULL; i++) {
+    if (_decodeMappedField(_fields[i])) {
+      iret = -1;
+    }
+  }
+  pthread_mutex_unlock(&_mappedMutex);
+  return iret;
+
+}
+
+//////////////////////////////////////////////////////////
+// Drop a field from the fields left by a mapped read, when
+// it is removed from the object without being decoded.
+
+void Mdvx::_forgetMappedField(const MdvxField *field) const
+  
+{
+  pthread_mutex_lock(&_mappedMutex);
+  if (_mappedRead != NULL) {
+    _mappedRead->pending.erase(field);
+    if (_mappedRead->pending.size() == 0) {
+      _clearMappedRead();
+    }
+  }
+  pthread_mutex_unlock(&_mappedMutex);
+}
+
+//////////////////////////////////////////////////////////
+// Free the mapped read state, leaving any fields not yet
+// decoded without data.
+
+void Mdvx::_clearMappedRead() const
+  
+{
+  pthread_mutex_lock(&_mappedMutex);
+  delete _mappedRead;
+  _mappedRead = NULL;
+  pthread_mutex_unlock(&_mappedMutex);
+}
+
+//////////////////////////////////////////////////////////
+// Initialize the mutex guarding the mapped read state.
+// It is recursive since decoding a field may clear the
+// state. It is never copied.
+
+void Mdvx::_initMappedMutex()
+  
+{
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&_mappedMutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
 //////////////////////////////////////////////////////////
 // Private read vertical section method
 // Returns 0 on success, -1 on failure
@@ -2802,6 +3037,13 @@ int Mdvx::_read_rhi(bool respectUserDistance /* = false */)
     return -1;
   }
 
+  // the fields are used here, so decode any left by a mapped read
+
+  if (_decodeMappedFields()) {
+    _errStr += "ERROR - _read_rhi\n";
+    return -1;
+  }
+
   // check we have RHI data
 
   if (_fields.size() == 0) {
@@ -3123,6 +3365,7 @@ void Mdvx::constrainVertical()
 
 {
 
+  _decodeMappedFields();
   for (size_t ii = 0; ii < _fields.size(); ii++) {
     _fields[ii]->constrainVertical(*this);
   }
@@ -3137,6 +3380,7 @@ void Mdvx::constrainHorizontal()
 
 {
 
+  _decodeMappedFields();
   for (size_t ii = 0; ii < _fields.size(); ii++) {
     _fields[ii]->constrainHorizontal(*this);
   }
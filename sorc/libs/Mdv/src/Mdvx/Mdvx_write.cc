@@ -256,6 +256,7 @@ int Mdvx::writeToPath(const string &output_path)
 {
 
   clearErrStr();
+  _decodeMappedFields();
   updateMasterHeader();
   time_t now = time(NULL);
   _mhdr.time_written = (si32) now;
@@ -441,6 +442,7 @@ void Mdvx::writeToBuffer(MemBuf &buf) const
 
 {
 
+  _decodeMappedFields();
   updateMasterHeader();
   
   if (_debug) {
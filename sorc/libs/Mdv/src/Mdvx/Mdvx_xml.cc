@@ -67,6 +67,7 @@ void Mdvx::writeToXmlBuffer(string &hdr, MemBuf &buf,
   // free up the buffer
 
   buf.free();
+  _decodeMappedFields();
 
   // add the fields to the buffer
   // updating the field headers with the length and offset
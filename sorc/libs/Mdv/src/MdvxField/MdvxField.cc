@@ -44,6 +44,7 @@
 #include <toolsa/toolsa_macros.h>
 #include <toolsa/compress.h>
 #include <toolsa/umisc.h>
+#include <toolsa/TaEncodeKernels.hh>
 #include <toolsa/str.h>
 #include <toolsa/pjg.h>
 #include <euclid/PjgMath.hh>
@@ -2975,6 +2976,10 @@ int MdvxField::remap(MdvxRemapLut &lut,
   
   lut.computeOffsets(projSource, proj_target);
 
+  if (lut.isWeighted()) {
+    return _remapWeighted(lut, proj_target, compression_type);
+  }
+
   // set up working buffer
 
   MemBuf workBuf;
@@ -3071,6 +3076,80 @@ int MdvxField::remap(MdvxRemapLut &lut,
 }
 
 
+///////////////////////////////////////////////////////////////////////
+// Remap with the weights in the lookup table, which has been computed.
+// The data is uncompressed on entry.
+//
+// Returns 0 on success, -1 on failure.
+
+int MdvxField::_remapWeighted(MdvxRemapLut &lut,
+                              MdvxProj &proj_target,
+                              int compression_type)
+
+{
+
+  if (_fhdr.encoding_type == Mdvx::ENCODING_RGBA32) {
+    _errStr += "ERROR - MdvxField::remap\n";
+    _errStr += "  Cannot interpolate RGBA data, use nearest neighbor\n";
+    return -1;
+  }
+
+  // weights apply to floats
+
+  int encoding_type = _fhdr.encoding_type;
+  if (encoding_type != Mdvx::ENCODING_FLOAT32) {
+    if (convertType(Mdvx::ENCODING_FLOAT32, Mdvx::COMPRESSION_NONE)) {
+      _errStr += "ERROR - MdvxField::remap\n";
+      return -1;
+    }
+  }
+
+  const Mdvx::coord_t &targetCoords = proj_target.getCoord();
+  int nPointsSourcePlane = _fhdr.nx * _fhdr.ny;
+  int nPointsTargetPlane = targetCoords.nx * targetCoords.ny;
+  int nBytesTargetVol = nPointsTargetPlane * _fhdr.nz * sizeof(fl32);
+
+  MemBuf workBuf;
+  workBuf.prepare(nBytesTargetVol);
+  if (workBuf.getPtr() == NULL) {
+    _errStr += "ERROR - MdvxField::remap\n";
+    return -1;
+  }
+
+  // one sparse matrix-vector product per plane
+
+  const fl32 *source = (const fl32 *) _volBuf.getPtr();
+  fl32 *target = (fl32 *) workBuf.getPtr();
+  fl32 missing = (fl32) _fhdr.missing_data_value;
+  fl32 bad = (fl32) _fhdr.bad_data_value;
+  for (int iz = 0; iz < _fhdr.nz; iz++) {
+    lut.applyWeights(source + iz * nPointsSourcePlane, missing, bad,
+                     target + iz * nPointsTargetPlane);
+  }
+
+  // set the field header appropriately
+
+  proj_target.syncXyToFieldHdr(_fhdr);
+  _fhdr.volume_size = nBytesTargetVol;
+  _volBuf = workBuf;
+
+  // back to the original encoding
+
+  if (encoding_type != Mdvx::ENCODING_FLOAT32) {
+    if (convertType((Mdvx::encoding_type_t) encoding_type,
+                    (Mdvx::compression_type_t) compression_type)) {
+      _errStr += "ERROR - MdvxField::remap\n";
+      return -1;
+    }
+  } else if (compress(compression_type)) {
+    _errStr += "ERROR - MdvxField::remap\n";
+    return -1;
+  }
+
+  return 0;
+
+}
+
 ///////////////////////////////////////////////////////////////////////
 // Remap to specified type, using the existing grid parameters to
 // estimate the best target grid.
@@ -3711,20 +3790,9 @@ void MdvxField::_int8_to_float32()
   fl32 float_missing_val = _fhdr.missing_data_value * scale + bias;
   fl32 float_bad_val = _fhdr.bad_data_value * scale + bias;
   
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    if (*in == byte_missing_val) {
-      *out = float_missing_val;
-    } else if (*in == byte_bad_val) {
-      *out = float_bad_val;
-    } else {
-      fl32 outval = ((fl32) *in * scale + bias);
-      if (fabs(outval) < threshold_val) {
-	*out = 0.0;
-      } else {
-	*out = outval;
-      }
-    }
-  }
+  TaEncodeKernels::decodeInt8(in, npoints, byte_missing_val, byte_bad_val,
+                              scale, bias, threshold_val,
+                              float_missing_val, float_bad_val, out);
 
   // adjust header
 
@@ -3776,20 +3844,9 @@ void MdvxField::_int16_to_float32()
   fl32 float_missing_val = _fhdr.missing_data_value * scale + bias;
   fl32 float_bad_val = _fhdr.bad_data_value * scale + bias;
   
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    if (*in == short_missing_val) {
-      *out = float_missing_val;
-    } else if (*in == short_bad_val) {
-      *out = float_bad_val;
-    } else {
-      fl32 outval = ((fl32) *in * scale + bias);
-      if (fabs(outval) < threshold_val) {
-	*out = 0.0;
-      } else {
-	*out = outval;
-      }
-    }
-  }
+  TaEncodeKernels::decodeInt16(in, npoints, short_missing_val, short_bad_val,
+                               scale, bias, threshold_val,
+                               float_missing_val, float_bad_val, out);
 
   // adjust header
   
@@ -3876,27 +3933,9 @@ void MdvxField::_float32_to_int8(int output_scaling)
   
   fl32 *in = (fl32 *) copyBuf.getPtr();
   ui08 *out = (ui08 *) _volBuf.getPtr();
-  size_t nBad = 0;
-
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    fl32 in_val = *in;
-    if (in_val == in_missing) {
-      *out = out_missing;
-    } else if (in_val == in_bad) {
-      *out = out_bad;
-    } else {
-      int out_val = (int) ((in_val - bias) / scale + 0.49999);
-      if (out_val > 255) {
-        nBad++;
- 	*out = 255;
-      } else if (out_val < 3) {
-        nBad++;
- 	*out = 3;
-      } else {
-	*out = (ui08) out_val;
-      }
-    }
-  } // i */
+  size_t nBad = TaEncodeKernels::encodeInt8(in, npoints, in_missing, in_bad,
+                                            scale, bias, 3, 255,
+                                            out_missing, out_bad, out);
 
   if (nBad > 0) {
     cerr << "ERROR - MdvxField::_float32_to_int8" << endl;
@@ -3991,33 +4030,15 @@ void MdvxField::_float32_to_int8(double output_scale,
   fl32 *in = (fl32 *) copyBuf.getPtr();
   ui08 *out = (ui08 *) _volBuf.getPtr();
 
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    fl32 in_val = *in;
-    if (in_val == in_missing) {
-      *out = out_missing;
-    } else if (in_val == in_bad) {
-      *out = out_bad;
-    } else {
-      int out_val = (int) ((in_val - output_bias) / output_scale + 0.49999);
-      if (out_missing == 0) {
-	if (out_val > 255) {
-	  *out = 255;
-	} else if (out_val < 2) {
-	  *out = 2;
-	} else {
-	  *out = (ui08) out_val;
-	}
-      } else {
-	if (out_val > 253) {
-	  *out = 253;
-	} else if (out_val < 0) {
-	  *out = 0;
-	} else {
-	  *out = (ui08) out_val;
-	}
-      }
-    }
-  } // i */
+  if (out_missing == 0) {
+    TaEncodeKernels::encodeInt8(in, npoints, in_missing, in_bad,
+                                output_scale, output_bias, 2, 255,
+                                out_missing, out_bad, out);
+  } else {
+    TaEncodeKernels::encodeInt8(in, npoints, in_missing, in_bad,
+                                output_scale, output_bias, 0, 253,
+                                out_missing, out_bad, out);
+  }
 
   // adjust header
   
@@ -4095,27 +4116,9 @@ void MdvxField::_float32_to_int16(int output_scaling)
   
   fl32 *in = (fl32 *) copyBuf.getPtr();
   ui16 *out = (ui16 *) _volBuf.getPtr();
-  size_t nBad = 0;
-
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    fl32 in_val = *in;
-    if (in_val == in_missing) {
-      *out = out_missing;
-    } else if (in_val == in_bad) {
-      *out = out_bad;
-    } else {
-      int out_val = (int) ((in_val - bias) / scale + 0.49999);
-      if (out_val > 65535) {
-        nBad++;
- 	*out = 65535;
-      } else if (out_val < 20) {
-        nBad++;
- 	*out = 20;
-      } else {
-	*out = (ui16) out_val;
-      }
-    }
-  } // i */
+  size_t nBad = TaEncodeKernels::encodeInt16(in, npoints, in_missing, in_bad,
+                                             scale, bias, 20, 65535,
+                                             out_missing, out_bad, out);
 
   if (nBad > 0) {
     cerr << "ERROR - MdvxField::_float32_to_int16" << endl;
@@ -4210,33 +4213,15 @@ void MdvxField::_float32_to_int16(double output_scale,
   fl32 *in = (fl32 *) copyBuf.getPtr();
   ui16 *out = (ui16 *) _volBuf.getPtr();
 
-  for (size_t i = 0; i < npoints; i++, in++, out++) {
-    fl32 in_val = *in;
-    if (in_val == in_missing) {
-      *out = out_missing;
-    } else if (in_val == in_bad) {
-      *out = out_bad;
-    } else {
-      int out_val = (int) ((in_val - output_bias) / output_scale + 0.49999);
-      if (out_missing == 0) {
-	if (out_val > 65535) {
-	  *out = 65535;
-	} else if (out_val < 2) {
-	  *out = 2;
-	} else {
-	  *out = (ui16) out_val;
-	}
-      } else {
-	if (out_val > 65533) {
-	  *out = 65533;
-	} else if (out_val < 0) {
-	  *out = 0;
-	} else {
-	  *out = (ui16) out_val;
-	}
-      }
-    }
-  } // i */
+  if (out_missing == 0) {
+    TaEncodeKernels::encodeInt16(in, npoints, in_missing, in_bad,
+                                 output_scale, output_bias, 2, 65535,
+                                 out_missing, out_bad, out);
+  } else {
+    TaEncodeKernels::encodeInt16(in, npoints, in_missing, in_bad,
+                                 output_scale, output_bias, 0, 65533,
+                                 out_missing, out_bad, out);
+  }
 
   // adjust header
   
@@ -5773,14 +5758,8 @@ int MdvxField::computeMinAndMax(bool force /* = false*/ )
     ui08 max_val = 0;
     ui08 missing = (ui08) _fhdr.missing_data_value;
     ui08 bad = (ui08) _fhdr.bad_data_value;
-    
-    for (int i = 0; i < npoints; i++, val++) {
-      ui08 this_val = *val;
-      if (this_val != missing && this_val != bad) {
-	min_val = MIN(min_val, this_val);
-	max_val = MAX(max_val, this_val);
-      }
-    }
+
+    TaEncodeKernels::minMax(val, npoints, missing, bad, min_val, max_val);
     
     if (min_val <= max_val) {
       _fhdr.min_value =
@@ -5796,14 +5775,8 @@ int MdvxField::computeMinAndMax(bool force /* = false*/ )
     ui16 max_val = 0;
     ui16 missing = (ui16) _fhdr.missing_data_value;
     ui16 bad = (ui16) _fhdr.bad_data_value;
-   
-    for (int i = 0; i < npoints; i++, val++) {
-      ui16 this_val = *val;
-      if (this_val != missing && this_val != bad) {
-	min_val = MIN(min_val, this_val);
-	max_val = MAX(max_val, this_val);
-      }
-    }
+
+    TaEncodeKernels::minMax(val, npoints, missing, bad, min_val, max_val);
 
     if (min_val <= max_val) {
       _fhdr.min_value =
@@ -5819,14 +5792,8 @@ int MdvxField::computeMinAndMax(bool force /* = false*/ )
     fl32 max_val = -1 * numeric_limits<float>::max(); //-1.0e99;
     fl32 missing = _fhdr.missing_data_value;
     fl32 bad = _fhdr.bad_data_value;
-    
-    for (int i = 0; i < npoints; i++, val++) {
-      fl32 this_val = *val;
-      if (this_val != missing && this_val != bad) {
-	min_val = MIN(min_val, this_val);
-	max_val = MAX(max_val, this_val);
-      }
-    }
+
+    TaEncodeKernels::minMax(val, npoints, missing, bad, min_val, max_val);
 
     if (min_val <= max_val) {
       _fhdr.min_value = min_val;
@@ -5961,6 +5928,83 @@ int MdvxField::_read_volume(TaFile &infile,
     return -1;
   }
 
+  if (_convert_read_volume(mdvx, fill_missing, do_decimate,
+                           do_final_convert, remapLut, is_vsection,
+                           vsection_min_lon, vsection_max_lon)) {
+    _errStr += "ERROR - MdvxField::_read_volume\n";
+    return -1;
+  }
+    
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Read a field volume from a file mapped into memory, file_buf
+// being the start of the file. As for the read from a TaFile,
+// the data offset and size in the field header are used.
+//
+// Returns 0 on success, -1 on failure.
+//
+
+int MdvxField::_read_volume(const void *file_buf,
+			    size_t file_len,
+			    const Mdvx &mdvx,
+			    bool fill_missing,
+			    bool do_decimate,
+			    bool do_final_convert,
+			    MdvxRemapLut &remapLut)
+  
+{
+
+  clearErrStr();
+
+  int volume_size = _fhdr.volume_size;
+  if (_fhdr.field_data_offset < 0 || volume_size < 0 ||
+      (size_t) _fhdr.field_data_offset + volume_size > file_len) {
+    _errStr += "ERROR - MdvxField::_read_volume\n";
+    _errStr += "  Field data past end of file, field: ";
+    _errStr += _fhdr.field_name;
+    _errStr += "\n";
+    return -1;
+  }
+
+  _volBuf.free();
+  _volBuf.add((const char *) file_buf + _fhdr.field_data_offset,
+              volume_size);
+
+  if (_convert_read_volume(mdvx, fill_missing, do_decimate,
+                           do_final_convert, remapLut,
+                           false, -360.0, 360.0)) {
+    _errStr += "ERROR - MdvxField::_read_volume\n";
+    return -1;
+  }
+    
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// convert a field volume just read from the file
+//
+// The volume is swapped as appropriate, the file headers are set,
+// and the read constraints applied.
+//
+// Returns 0 on success, -1 on failure.
+
+int MdvxField::_convert_read_volume(const Mdvx &mdvx,
+                                    bool fill_missing,
+                                    bool do_decimate,
+                                    bool do_final_convert,
+                                    MdvxRemapLut &remapLut,
+                                    bool is_vsection,
+                                    double vsection_min_lon,
+                                    double vsection_max_lon)
+  
+{
+
   // byte swap as needed
 
   _data_from_BE(_fhdr, _volBuf.getPtr(), _volBuf.getLen());
@@ -5976,7 +6020,7 @@ int MdvxField::_read_volume(TaFile &infile,
                               do_final_convert,
                               remapLut, is_vsection,
                               vsection_min_lon, vsection_max_lon)) {
-    _errStr += "ERROR - MdvxField::_read_volume\n";
+    _errStr += "ERROR - MdvxField::_convert_read_volume\n";
     return -1;
   }
     
@@ -7661,22 +7705,13 @@ void MdvxField::_check_finite(const void *vol_data)
     return;
   }
   
-  int numNans = 0;
   fl32 *floatData = (fl32 *) vol_data;
   fl32 bad = _fhdr.bad_data_value;
 
-  for (int i=0; i <  _fhdr.nx *  _fhdr.ny *  _fhdr.nz; i++, floatData++) {
-
-    // The finite() function returns a non-zero value if value is
-    // neither infinite nor a "not-a-number" (NaN) value,  and  0
-    // otherwise.
-
-    if (!isfinite(*floatData)) {
-      numNans++;
-      *floatData = bad;
-    }
-    
-  }
+  int numNans =
+    (int) TaEncodeKernels::replaceNonFinite(floatData,
+                                            _fhdr.nx * _fhdr.ny * _fhdr.nz,
+                                            bad);
 
   // If any NaNs or infinites were found, say so.
 
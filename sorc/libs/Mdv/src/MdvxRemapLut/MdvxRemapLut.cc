@@ -40,8 +40,29 @@
 
 #include <Mdv/MdvxRemapLut.hh>
 #include <toolsa/pjg.h>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/TaThreadSimple.hh>
+#include <algorithm>
+#include <cmath>
 using namespace std;
 
+////////////////////////////////////////////////////////////////////////
+// threads on bands of target rows
+
+class MdvxRemapLutThreads : public TaThreadDoubleQue
+{
+public:
+  MdvxRemapLutThreads() : TaThreadDoubleQue() {}
+  virtual ~MdvxRemapLutThreads() {}
+  TaThread *clone(int index)
+  {
+    TaThreadSimple *t = new TaThreadSimple(index);
+    t->setThreadMethod(MdvxRemapLut::computeBand);
+    t->setThreadContext(this);
+    return (TaThread *)t;
+  }
+};
+
 ////////////////////////////////////////////////////////////////////////
 // Default constructor
 //
@@ -55,6 +76,10 @@ MdvxRemapLut::MdvxRemapLut()
   _sourceOffsets = NULL;
   _targetOffsets = NULL;
   _offsetsComputed = false;
+  _method = REMAP_NEAREST;
+  _nConservSamples = 4;
+  _nThreads = 1;
+  _sourceWrapsLon = false;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -68,6 +93,10 @@ MdvxRemapLut::MdvxRemapLut(const MdvxProj &proj_source,
   _sourceOffsets = NULL;
   _targetOffsets = NULL;
   _offsetsComputed = false;
+  _method = REMAP_NEAREST;
+  _nConservSamples = 4;
+  _nThreads = 1;
+  _sourceWrapsLon = false;
   computeOffsets(proj_source, proj_target);
 
   return;
@@ -83,6 +112,35 @@ MdvxRemapLut::~MdvxRemapLut()
   return;
 }
 
+/////////////////////////////
+// set the remapping method
+
+void MdvxRemapLut::setMethod(remap_method_t method)
+
+{
+  if (method != _method) {
+    _method = method;
+    _offsetsComputed = false;
+  }
+}
+
+/////////////////////////////////////////////////
+// set the number of samples per conservative cell
+
+void MdvxRemapLut::setNConservSamples(int n)
+
+{
+  if (n < 1) {
+    n = 1;
+  }
+  if (n != _nConservSamples) {
+    _nConservSamples = n;
+    if (_method == REMAP_CONSERVATIVE) {
+      _offsetsComputed = false;
+    }
+  }
+}
+
 ///////////////////////////////
 // compute lookup table offsets
 
@@ -135,24 +193,167 @@ void MdvxRemapLut::computeOffsets(const MdvxProj &proj_source,
   }
   _projTarget.setConditionLon2Ref(true, refLon);
 
-  // compute lookup offsets
+  // a global lat/lon source wraps in longitude, for interpolating
+  // between the last and first columns
+
+  _sourceWrapsLon = false;
+  if (_projSource.getProjType() == Mdvx::PROJ_LATLON) {
+    const Mdvx::coord_t &coord = _projSource.getCoord();
+    _sourceWrapsLon = (fabs(coord.nx * coord.dx - 360.0) < 0.01 * coord.dx);
+  }
+
+  // compute lookup offsets or weights, in bands of target rows
 
   _sourceOffsetBuf.free();
   _targetOffsetBuf.free();
   _nOffsets = 0;
+  _weightRowStart.clear();
+  _weightSourceIndex.clear();
+  _weights.clear();
 
-  // loop through the target
+  const Mdvx::coord_t &coord = _projTarget.getCoord();
+  int nBands = _nThreads;
+  if (nBands > coord.ny) {
+    nBands = coord.ny;
+  }
+  if (nBands < 1) {
+    nBands = 1;
+  }
+  vector<Band> bands(nBands);
+  for (int i = 0; i < nBands; i++) {
+    bands[i].lut = this;
+    bands[i].apply = false;
+    bands[i].iy0 = (coord.ny * i) / nBands;
+    bands[i].iy1 = (coord.ny * (i + 1)) / nBands;
+  }
+  _runBands(bands);
 
-  double yy = inTarget.miny;
-  int targetIndex = 0;
-  for (int iy = 0; iy < inTarget.ny; iy++, yy += inTarget.dy) {
-    
-    double xx = inTarget.minx;
-    for (int ix = 0; ix < inTarget.nx;
-	 ix++, xx += inTarget.dx, targetIndex++) {
+  // put the bands together, in target order
 
-      // get lat/lon of target point
+  if (_method == REMAP_NEAREST) {
+    for (int i = 0; i < nBands; i++) {
+      int n = (int) bands[i].sourceOffsets.size();
+      if (n > 0) {
+        _sourceOffsetBuf.add(&bands[i].sourceOffsets[0], n * sizeof(int));
+        _targetOffsetBuf.add(&bands[i].targetOffsets[0], n * sizeof(int));
+        _nOffsets += n;
+      }
+    }
+  } else {
+    _weightRowStart.reserve(coord.nx * coord.ny + 1);
+    _weightRowStart.push_back(0);
+    for (int i = 0; i < nBands; i++) {
+      Band &band = bands[i];
+      for (size_t j = 0; j < band.rowLen.size(); j++) {
+        _weightRowStart.push_back(_weightRowStart.back() + band.rowLen[j]);
+      }
+      _weightSourceIndex.insert(_weightSourceIndex.end(),
+                                band.sourceIndex.begin(),
+                                band.sourceIndex.end());
+      _weights.insert(_weights.end(),
+                      band.weights.begin(), band.weights.end());
+    }
+  }
 
+  _sourceOffsets = (int *) _sourceOffsetBuf.getPtr();
+  _targetOffsets = (int *) _targetOffsetBuf.getPtr();
+  _offsetsComputed = true;
+
+  return;
+
+}
+
+///////////////////////////////////////////////////////////////
+// apply the weights to one plane of float data
+
+void MdvxRemapLut::applyWeights(const fl32 *source, fl32 missing, fl32 bad,
+				fl32 *target) const
+
+{
+
+  const Mdvx::coord_t &coord = _projTarget.getCoord();
+  if (_weightRowStart.size() != (size_t) (coord.nx * coord.ny + 1)) {
+    // weights not computed, all missing
+    for (int i = 0; i < coord.nx * coord.ny; i++) {
+      target[i] = missing;
+    }
+    return;
+  }
+
+  int nBands = _nThreads;
+  if (nBands > coord.ny) {
+    nBands = coord.ny;
+  }
+  if (nBands < 1) {
+    nBands = 1;
+  }
+  vector<Band> bands(nBands);
+  for (int i = 0; i < nBands; i++) {
+    bands[i].lut = this;
+    bands[i].apply = true;
+    bands[i].iy0 = (coord.ny * i) / nBands;
+    bands[i].iy1 = (coord.ny * (i + 1)) / nBands;
+    bands[i].source = source;
+    bands[i].missing = missing;
+    bands[i].bad = bad;
+    bands[i].target = target;
+  }
+  _runBands(bands);
+
+}
+
+///////////////////////////////////////////////////////////////
+// thread method
+
+void MdvxRemapLut::computeBand(void *ti)
+
+{
+  Band *band = (Band *) ti;
+  if (band->apply) {
+    band->lut->_applyWeights(*band);
+  } else if (band->lut->_method == REMAP_NEAREST) {
+    band->lut->_computeNearest(*band);
+  } else {
+    band->lut->_computeWeights(*band);
+  }
+}
+
+///////////////////////////////////////////////////////////////
+// run the bands, threaded if more than one
+
+void MdvxRemapLut::_runBands(vector<Band> &bands) const
+
+{
+  if (bands.size() == 1) {
+    computeBand(&bands[0]);
+    return;
+  }
+  MdvxRemapLutThreads threads;
+  threads.init((int) bands.size(), false);
+  for (size_t i = 0; i < bands.size(); i++) {
+    threads.thread((int) i, &bands[i]);
+  }
+  threads.waitForThreads();
+}
+
+///////////////////////////////////////////////////////////////
+// nearest neighbour offsets for a band of target rows
+
+void MdvxRemapLut::_computeNearest(Band &band) const
+
+{
+
+  const Mdvx::coord_t &coord = _projTarget.getCoord();
+  int targetIndex = band.iy0 * coord.nx;
+  for (int iy = band.iy0; iy < band.iy1; iy++) {
+
+    double yy = coord.miny + iy * coord.dy;
+    for (int ix = 0; ix < coord.nx; ix++, targetIndex++) {
+
+      double xx = coord.minx + ix * coord.dx;
+
+      // get lat/lon of target point
+      
       double lat, lon;
       _projTarget.xy2latlon(xx, yy, lat, lon);
 
@@ -161,20 +362,190 @@ void MdvxRemapLut::computeOffsets(const MdvxProj &proj_source,
       int sourceIndex;
       if (_projSource.latlon2arrayIndex(lat, lon, sourceIndex) == 0) {
         // add mapping
-	_sourceOffsetBuf.add(&sourceIndex, sizeof(int));
-	_targetOffsetBuf.add(&targetIndex, sizeof(int));
-	_nOffsets++;
+        band.sourceOffsets.push_back(sourceIndex);
+        band.targetOffsets.push_back(targetIndex);
       }
-      
+
     } // ix
 
   } // iy
 
-  _sourceOffsets = (int *) _sourceOffsetBuf.getPtr();
-  _targetOffsets = (int *) _targetOffsetBuf.getPtr();
-  _offsetsComputed = true;
+}
 
-  return;
+///////////////////////////////////////////////////////////////
+// weights for a band of target rows
+
+void MdvxRemapLut::_computeWeights(Band &band) const
+
+{
+
+  const Mdvx::coord_t &coord = _projTarget.getCoord();
+  vector<int> index;
+  vector<fl32> weight;
+  for (int iy = band.iy0; iy < band.iy1; iy++) {
+    double yy = coord.miny + iy * coord.dy;
+    for (int ix = 0; ix < coord.nx; ix++) {
+      index.clear();
+      weight.clear();
+      if (_method == REMAP_BILINEAR) {
+        double xx = coord.minx + ix * coord.dx;
+        double lat, lon;
+        _projTarget.xy2latlon(xx, yy, lat, lon);
+        _bilinear(lat, lon, index, weight);
+      } else {
+        _conservative(ix, iy, index, weight);
+      }
+      band.rowLen.push_back((int) index.size());
+      band.sourceIndex.insert(band.sourceIndex.end(),
+                              index.begin(), index.end());
+      band.weights.insert(band.weights.end(), weight.begin(), weight.end());
+    }
+  }
+
+}
+
+///////////////////////////////////////////////////////////////
+// sparse matrix times vector for a band of target rows
+
+void MdvxRemapLut::_applyWeights(Band &band) const
+
+{
+
+  const Mdvx::coord_t &coord = _projTarget.getCoord();
+  const int *rowStart = &_weightRowStart[0];
+  const int *sourceIndex = _weightSourceIndex.empty() ?
+    NULL : &_weightSourceIndex[0];
+  const fl32 *weights = _weights.empty() ? NULL : &_weights[0];
+  for (int i = band.iy0 * coord.nx; i < band.iy1 * coord.nx; i++) {
+    double sum = 0.0, wsum = 0.0;
+    for (int k = rowStart[i]; k < rowStart[i + 1]; k++) {
+      fl32 val = band.source[sourceIndex[k]];
+      if (val != band.missing && val != band.bad) {
+        sum += weights[k] * val;
+        wsum += weights[k];
+      }
+    }
+    if (wsum > 0.0) {
+      band.target[i] = (fl32) (sum / wsum);
+    } else {
+      band.target[i] = band.missing;
+    }
+  }
+
+}
+
+///////////////////////////////////////////////////////////////
+// bilinear weights for one target point.
+// Points within half a grid cell of the source edge use the
+// edge values, as nearest neighbour does.
+
+void MdvxRemapLut::_bilinear(double lat, double lon,
+			     vector<int> &index, vector<fl32> &weight) const
+
+{
+
+  // compute the grid indices here rather than via latlon2xyIndex(),
+  // which rejects y within half a cell below the grid, and wrap the
+  // longitude onto a global source as _conservative() does
+
+  const Mdvx::coord_t &coord = _projSource.getCoord();
+  double xx, yy;
+  _projSource.latlon2xy(lat, lon, xx, yy);
+  double xIndex = (xx - coord.minx) / coord.dx;
+  double yIndex = (yy - coord.miny) / coord.dy;
+  if (_sourceWrapsLon) {
+    xIndex -= floor((xIndex + 0.5) / coord.nx) * coord.nx;
+  }
+  if (xIndex < -0.5 || xIndex > coord.nx - 0.5 ||
+      yIndex < -0.5 || yIndex > coord.ny - 0.5) {
+    return;
+  }
+  
+  int ix0 = (int) floor(xIndex);
+  int iy0 = (int) floor(yIndex);
+  double tx = xIndex - ix0;
+  double ty = yIndex - iy0;
+  int ix1 = ix0 + 1;
+  int iy1 = iy0 + 1;
+  if (ix0 < 0) {
+    if (_sourceWrapsLon) {
+      ix0 = coord.nx - 1;
+    } else {
+      ix0 = 0;
+      tx = 1.0;
+    }
+  }
+  if (ix1 >= coord.nx) {
+    if (_sourceWrapsLon) {
+      ix1 = 0;
+    } else {
+      ix1 = coord.nx - 1;
+      tx = 0.0;
+    }
+  }
+  if (iy0 < 0) {
+    iy0 = 0;
+    ty = 1.0;
+  }
+  if (iy1 >= coord.ny) {
+    iy1 = coord.ny - 1;
+    ty = 0.0;
+  }
+
+  double w[4] = {(1.0 - tx) * (1.0 - ty), tx * (1.0 - ty),
+                 (1.0 - tx) * ty, tx * ty};
+  int k[4] = {iy0 * coord.nx + ix0, iy0 * coord.nx + ix1,
+              iy1 * coord.nx + ix0, iy1 * coord.nx + ix1};
+  for (int i = 0; i < 4; i++) {
+    if (w[i] <= 0.0) {
+      continue;
+    }
+    vector<int>::iterator it = find(index.begin(), index.end(), k[i]);
+    if (it == index.end()) {
+      index.push_back(k[i]);
+      weight.push_back((fl32) w[i]);
+    } else {
+      weight[it - index.begin()] += (fl32) w[i];
+    }
+  }
 
 }
 
+///////////////////////////////////////////////////////////////
+// conservative weights for one target cell: the fraction of an
+// n by n sampling of the cell that falls in each source cell.
+// Samples outside the source grid are left out, so weights for
+// cells on the edge of the source grid sum to less than 1.
+
+void MdvxRemapLut::_conservative(int ix, int iy,
+				 vector<int> &index,
+				 vector<fl32> &weight) const
+
+{
+
+  const Mdvx::coord_t &coord = _projTarget.getCoord();
+  int n = _nConservSamples;
+  double w = 1.0 / (n * n);
+  for (int jy = 0; jy < n; jy++) {
+    double yy = coord.miny + (iy + (jy + 0.5) / n - 0.5) * coord.dy;
+    for (int jx = 0; jx < n; jx++) {
+      double xx = coord.minx + (ix + (jx + 0.5) / n - 0.5) * coord.dx;
+      double lat, lon;
+      _projTarget.xy2latlon(xx, yy, lat, lon);
+      int sourceIndex;
+      if (_projSource.latlon2arrayIndex(lat, lon, sourceIndex,
+                                        _sourceWrapsLon)) {
+        continue;
+      }
+      vector<int>::iterator it =
+        find(index.begin(), index.end(), sourceIndex);
+      if (it == index.end()) {
+        index.push_back(sourceIndex);
+        weight.push_back((fl32) w);
+      } else {
+        weight[it - index.begin()] += (fl32) w;
+      }
+    }
+  }
+
+}
@@ -42,6 +42,7 @@
 #include <set>
 #include <string>
 #include <cstdio>
+#include <pthread.h>
 #include <dataport/port_types.h>
 #include <toolsa/DateTime.hh>
 #include <toolsa/TaFile.hh>
@@ -52,6 +53,7 @@ using namespace std;
 #include <Mdv/MdvxTimeList.hh>
 class MdvxField;
 class MdvxChunk;
+class MdvxMappedRead;
 class MdvxProj;
 class MdvxPjg;
 class DsMdvxMsg;
@@ -289,8 +291,13 @@ public:
   // get pointer to field object, by field num or name.
   // By name searches using both long and short names.
   // Returns NULL on failure.
+  //
+  // After a mapped read (see setReadMapped()), a field's data
+  // is decoded when the field is first got; getFields() decodes
+  // all fields.
   
-  const vector<MdvxField *> &getFields() const { return _fields; }
+  const vector<MdvxField *> &getFields() const
+  { _decodeMappedFields(); return _fields; }
   MdvxField *getField(int field_num) const
   { return( getFieldByNum( field_num )); }
   MdvxField *getFieldByNum(int field_num) const;
@@ -595,6 +602,10 @@ protected:
 
   bool _readAsSingleBuffer;
 
+  bool _readMapped;
+  mutable MdvxMappedRead *_mappedRead; // fields not yet decoded
+  mutable pthread_mutex_t _mappedMutex; // guards _mappedRead decoding
+
   // write request members
 
   bool _writeLdataInfo;
@@ -704,6 +715,17 @@ protected:
                    double vsection_min_lon = -360.0,
                    double vsection_max_lon = 360.0);
   
+  MdvxMappedRead *_mapForRead(TaFile &infile,
+                              bool fill_missing,
+                              bool do_decimate,
+                              bool do_final_convert);
+
+  int _decodeMappedField(MdvxField *field) const;
+  int _decodeMappedFields() const;
+  void _forgetMappedField(const MdvxField *field) const;
+  void _clearMappedRead() const;
+  void _initMappedMutex();
+
   int _read_vsection();
   
   int _read_rhi(bool respectUserDistance = false);
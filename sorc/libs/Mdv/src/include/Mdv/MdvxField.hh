@@ -512,6 +512,10 @@ public:
   // If the lookup table has not been initialized it is computed.
   // If the projection geometry has changed the lookup table is recomputed.
   //
+  // The method is the one set on the lookup table. For the weighted
+  // methods (bilinear, conservative) the data is converted to float for
+  // the remapping, and back to its original encoding afterwards.
+  //
   // Returns 0 on success, -1 on failure.
   
   int remap(MdvxRemapLut &lut,
@@ -833,6 +837,9 @@ protected:
   int _constrain_radar_horiz(const Mdvx &mdvx);
   int _decimate_radar_horiz(int max_nxy);
   int _decimate_rgba(int max_nxy);
+  int _remapWeighted(MdvxRemapLut &lut,
+                     MdvxProj &proj_target,
+                     int compression_type);
   void _check_lon_domain(double read_min_lon,
 			 double read_max_lon);
   
@@ -853,6 +860,23 @@ protected:
 		   double vsection_min_lon,
 		   double vsection_max_lon);
 
+  int _read_volume(const void *file_buf,
+		   size_t file_len,
+		   const Mdvx &mdvx,
+		   bool fill_missing,
+		   bool do_decimate,
+		   bool do_final_convert,
+		   MdvxRemapLut &remapLut);
+
+  int _convert_read_volume(const Mdvx &mdvx,
+			   bool fill_missing,
+			   bool do_decimate,
+			   bool do_final_convert,
+			   MdvxRemapLut &remapLut,
+			   bool is_vsection,
+			   double vsection_min_lon,
+			   double vsection_max_lon);
+
   int _apply_read_constraints(const Mdvx &mdvx,
                               bool fill_missing,
                               bool do_decimate,
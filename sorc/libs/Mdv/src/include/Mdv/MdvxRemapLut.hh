@@ -40,6 +40,7 @@
 #include <Mdv/Mdvx.hh>
 #include <Mdv/MdvxProj.hh>
 #include <toolsa/MemBuf.hh>
+#include <vector>
 using namespace std;
 
 class MdvxRemapLut
@@ -47,6 +48,14 @@ class MdvxRemapLut
 
 public:
 
+  // remapping method
+
+  typedef enum {
+    REMAP_NEAREST = 0,     // value of the nearest source point
+    REMAP_BILINEAR = 1,    // bilinear in the source grid indices
+    REMAP_CONSERVATIVE = 2 // first-order conservative, area weighted
+  } remap_method_t;
+
   ///////////////////////
   // default constructor
   //
@@ -72,6 +81,51 @@ public:
   void computeOffsets(const MdvxProj &proj_source,
 		      const MdvxProj &proj_target);
   
+  ///////////////////////////////////////////////////////////////
+  // set the remapping method, default REMAP_NEAREST.
+  //
+  // For REMAP_NEAREST computeOffsets() fills in the source and target
+  // offsets. For the other methods it fills in weights instead, as a
+  // compressed sparse matrix: target point i is the weighted mean of
+  // source points getWeightSourceIndex()[k], with weights getWeights()[k],
+  // for k from getWeightRowStart()[i] to getWeightRowStart()[i+1] - 1.
+  //
+  // REMAP_CONSERVATIVE estimates the overlap of each target cell with the
+  // source cells by sampling the target cell on an n by n subgrid,
+  // see setNConservSamples().
+  //
+  // Changing the method forces the table to be recomputed.
+
+  void setMethod(remap_method_t method);
+
+  // number of samples along each side of a target cell,
+  // for REMAP_CONSERVATIVE, default 4
+
+  void setNConservSamples(int n);
+
+  // number of threads used to compute the table and apply the weights,
+  // default 1
+
+  void setNThreads(int n) { _nThreads = (n < 1 ? 1 : n); }
+  
+  ///////////////////////////////////////////////////////////////
+  // apply the weights to one plane of float data.
+  // source has the source projection nx * ny points, target the
+  // target projection nx * ny points.
+  // Source points that are missing or bad are left out, and the
+  // remaining weights rescaled. Target points with no source data
+  // are set to missing.
+  // Only valid after computeOffsets() with a method other than
+  // REMAP_NEAREST.
+
+  void applyWeights(const fl32 *source, fl32 missing, fl32 bad,
+		    fl32 *target) const;
+
+  // access to members
+
+  remap_method_t getMethod() const { return (_method); }
+  bool isWeighted() const { return (_method != REMAP_NEAREST); }
+
   // access to members
 
   const MdvxProj &getProjSource() const { return (_projSource); }
@@ -81,6 +135,17 @@ public:
   const int *getSourceOffsets() const { return (_sourceOffsets); }
   const int *getTargetOffsets() const { return (_targetOffsets); }
   
+  int getNWeights() const { return ((int) _weights.size()); }
+  const vector<int> &getWeightRowStart() const { return (_weightRowStart); }
+  const vector<int> &getWeightSourceIndex() const {
+    return (_weightSourceIndex);
+  }
+  const vector<fl32> &getWeights() const { return (_weights); }
+
+  // thread method, one band of target rows
+
+  static void computeBand(void *ti);
+
 protected:
   
   MdvxProj _projSource;
@@ -94,6 +159,43 @@ protected:
 
   bool _offsetsComputed;
 
+  remap_method_t _method;
+  int _nConservSamples;
+  int _nThreads;
+  bool _sourceWrapsLon;
+
+  // weights, in compressed sparse row form, one row per target point
+
+  vector<int> _weightRowStart;
+  vector<int> _weightSourceIndex;
+  vector<fl32> _weights;
+
+  // what one thread does for a band of target rows
+
+  class Band {
+  public:
+    const MdvxRemapLut *lut;
+    bool apply;            // true to apply weights, false to compute
+    int iy0, iy1;          // target rows [iy0, iy1)
+    vector<int> sourceOffsets; // computing, nearest: the offsets
+    vector<int> targetOffsets;
+    vector<int> rowLen;        // computing, weighted: weights per point
+    vector<int> sourceIndex;
+    vector<fl32> weights;
+    const fl32 *source;    // applying
+    fl32 missing, bad;
+    fl32 *target;
+  };
+
+  void _runBands(vector<Band> &bands) const;
+  void _computeNearest(Band &band) const;
+  void _computeWeights(Band &band) const;
+  void _applyWeights(Band &band) const;
+  void _bilinear(double lat, double lon,
+		 vector<int> &index, vector<fl32> &weight) const;
+  void _conservative(int ix, int iy,
+		     vector<int> &index, vector<fl32> &weight) const;
+
 private:
 
 };
@@ -406,6 +406,33 @@ void clearCheckLatestValidModTime();
 void setReadAsSingleBuffer();
 void clearReadAsSingleBuffer();
 
+// set/clear readMapped option
+//
+// If this is set, readVolume() maps the file into memory rather
+// than reading it, and each field is decoded - copied from the
+// mapping, uncompressed, and converted according to the read
+// settings in force at the readVolume() call - only when it is
+// first got with getField(), getFieldByNum(), getFieldByName()
+// or getFields(). Fields which are never got are never decoded,
+// and the pages of the file are shared with other processes
+// reading it.
+//
+// Until all the fields are decoded, the master header reflects
+// the file headers of the fields not yet decoded.
+//
+// Decoding is guarded by a mutex, so the const get methods may be
+// called on a mapped object from several threads. However, each
+// decode updates the master header in place, so a thread must not
+// read getMasterHeader() while another may still be decoding -
+// call getFields() once before sharing the object in that case.
+//
+// Only applies to local reads of uncompressed MDV files by
+// readVolume(). Other reads, including vertical sections and
+// compressed files, are done as normal.
+
+void setReadMapped();
+void clearReadMapped();
+
 // deprecated
 
 void setReadAsSinglePart();
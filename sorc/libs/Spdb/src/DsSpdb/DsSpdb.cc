@@ -332,6 +332,94 @@ int DsSpdb::put(int prod_id,
 
 }
 
+//////////////////////////////////////////////////////////
+// putBatch - multiple chunks to single URL
+//
+// Chunks must already be in BE byte order, as appropriate.
+//
+// Returns 0 on success, -1 on error
+
+int DsSpdb::putBatch(const string &url_str,
+		     int prod_id,
+		     const string &prod_label)
+  
+{
+
+  _errStr = "ERROR - COMM - DsSpdb::putBatch\n";
+  TaStr::AddStr(_errStr, "  Time: ", DateTime::str());
+  TaStr::AddStr(_errStr, "  URL: ", url_str);
+
+  // decode URL
+
+  if (_setUrl(url_str)) {
+    return -1;
+  }
+
+  int iret;
+
+  if (_isLocal) {
+    iret = _localPut(prod_id, prod_label, true);
+  } else {
+    iret = _remotePut(prod_id, prod_label);
+  }
+
+  if (iret) {
+    return -1;
+  } else {
+    return 0;
+  }
+
+}
+
+//////////////////////////////////////////////////////////////
+// putBatch - multiple chunks to multiple URLs, as one
+// transaction per URL
+//
+// Chunks must already be in BE byte order, as appropriate.
+//
+// Returns 0 on success, -1 on error
+
+int DsSpdb::putBatch(int prod_id,
+		     const string &prod_label)
+
+{
+
+  _errStr = "ERROR - COMM - DsSpdb::putBatch\n";
+  TaStr::AddStr(_errStr, "  Time: ", DateTime::str());
+  
+  int iret = 0;
+  for (size_t i = 0; i < _urlStrings.size(); i++) {
+
+    // decode URL
+  
+    if (_setUrl(_urlStrings[i])) {
+      return -1;
+    }
+  
+    if (_isLocal) {
+
+      if (_localPut(prod_id, prod_label, true)) {
+	iret = -1;
+      }
+
+    } else {
+
+      if (_remotePut(prod_id, prod_label)) {
+	iret = -1;
+      }
+
+    }
+
+  } // i
+
+  if (iret) {
+    return -1;
+  } else {
+    return 0;
+  }
+
+}
+
 ///////////////////////////////////////////////////////////////////
 // erase()
 //
@@ -1446,7 +1534,8 @@ int DsSpdb::_reapChildren(bool cancel_uncompleted /* = false*/)
 // Returns 0 on success, -1 on failure
 
 int DsSpdb::_localPut(int prod_id,
-		      const string &prod_label)
+		      const string &prod_label,
+		      bool batch /* = false */)
 
 {
 
@@ -1454,7 +1543,11 @@ int DsSpdb::_localPut(int prod_id,
 
   int iret = 0;
 
-  if (Spdb::put(dir_str, prod_id, prod_label)) {
+  if (batch) {
+    if (Spdb::putBatch(dir_str, prod_id, prod_label)) {
+      iret = -1;
+    }
+  } else if (Spdb::put(dir_str, prod_id, prod_label)) {
     iret = -1;
   }
 
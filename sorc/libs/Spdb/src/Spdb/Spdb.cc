@@ -54,7 +54,10 @@
 #include <fcntl.h>
 #include <cerrno>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #include <set>
+#include <map>
 using namespace std;
 
 // initialize constants
@@ -63,6 +66,178 @@ int Spdb::_fileMajorVersion = 1;
 int Spdb::_fileMinorVersion = 1;
 const char *Spdb::_indxExt = "indx";
 const char *Spdb::_dataExt = "data";
+const double Spdb::DEFAULT_COMPACT_FRACTION = 0.5;
+
+// number of times a reader reopens a day whose index and data files
+// do not match, before waiting on the day lock instead
+
+static const int _nSnapshotTries = 5;
+
+///////////////////////////////////////////////////////////////
+// Day locks held in this process.
+//
+// fcntl() locks do not exclude threads of the same process, so
+// the day locks are also kept here, by path: the number of readers,
+// or -1 for a writer.
+
+static pthread_mutex_t _dayLockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _dayLockCond = PTHREAD_COND_INITIALIZER;
+static map<string, int> _dayLockHolders;
+
+static void _dayLockAcquire(const string &path, bool write)
+{
+  pthread_mutex_lock(&_dayLockMutex);
+  while (true) {
+    int &nHolders = _dayLockHolders[path];
+    if (write ? (nHolders == 0) : (nHolders >= 0)) {
+      nHolders = write ? -1 : nHolders + 1;
+      break;
+    }
+    pthread_cond_wait(&_dayLockCond, &_dayLockMutex);
+  }
+  pthread_mutex_unlock(&_dayLockMutex);
+}
+
+static void _dayLockRelease(const string &path)
+{
+  pthread_mutex_lock(&_dayLockMutex);
+  map<string, int>::iterator it = _dayLockHolders.find(path);
+  if (it != _dayLockHolders.end()) {
+    if (it->second < 0 || --it->second == 0) {
+      _dayLockHolders.erase(it);
+    }
+  }
+  pthread_cond_broadcast(&_dayLockCond);
+  pthread_mutex_unlock(&_dayLockMutex);
+}
+
+// id stored in the index header for a data file, never 0
+
+static si32 _dataFileId(const struct stat &fileStat)
+{
+  si32 id = (si32) (fileStat.st_ino & 0x7fffffff);
+  if (id == 0) {
+    id = 1;
+  }
+  return id;
+}
+
+///////////////////////////////////////////////////////////////
+// Day indexes cached in this process, for reads.
+//
+// An entry holds the decoded header and refs of a day, and the day's
+// data file mapped read-only. It is used while the stat of the files
+// matches the stat of the files it was read from: a writer using day
+// locking renames a new index into place, and any other write changes
+// the size or modification time. The data file is never truncated
+// below what an index refers to, so mapped chunks stay readable.
+// Entries are shared by the objects reading the day, and freed once
+// they are no longer current and no object uses them.
+
+class SpdbIndxCacheEntry {
+public:
+  SpdbIndxCacheEntry() :
+          dataMap(NULL), dataLen(0),
+          nUsers(0), current(true), lastUse(0) {}
+  ~SpdbIndxCacheEntry() {
+    if (dataMap != NULL) {
+      munmap(dataMap, dataLen);
+    }
+  }
+  struct stat indxStat;
+  struct stat dataStat;
+  Spdb::header_t hdr;
+  MemBuf refBuf;
+  MemBuf auxBuf;
+  void *dataMap;
+  size_t dataLen;
+  int nUsers;
+  bool current;
+  unsigned long lastUse;
+};
+
+static pthread_mutex_t _indxCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static map<string, SpdbIndxCacheEntry *> _indxCache;
+static unsigned long _indxCacheClock = 0;
+static int _indxCacheDays = -1; // not yet read from the environment
+
+// max days in the cache - called with the mutex held
+
+static int _indxCacheMaxDays()
+{
+  if (_indxCacheDays < 0) {
+    _indxCacheDays = 32;
+    char *days_str = getenv("SPDB_INDEX_CACHE_DAYS");
+    int days;
+    if (days_str && sscanf(days_str, "%d", &days) == 1) {
+      _indxCacheDays = MAX(days, 0);
+    }
+  }
+  return _indxCacheDays;
+}
+
+// do two stats refer to the same, unchanged file?
+
+static bool _sameFile(const struct stat &aa, const struct stat &bb)
+{
+  if (aa.st_dev != bb.st_dev || aa.st_ino != bb.st_ino ||
+      aa.st_size != bb.st_size || aa.st_mtime != bb.st_mtime) {
+    return false;
+  }
+#ifdef __linux__
+  if (aa.st_mtim.tv_nsec != bb.st_mtim.tv_nsec) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+// remove an entry - called with the mutex held
+
+static void _indxCacheDrop(map<string, SpdbIndxCacheEntry *>::iterator it)
+{
+  SpdbIndxCacheEntry *entry = it->second;
+  _indxCache.erase(it);
+  entry->current = false;
+  if (entry->nUsers == 0) {
+    delete entry;
+  }
+}
+
+// drop the least recently used entries not in use, down to
+// the max days - called with the mutex held
+
+static void _indxCacheTrim()
+{
+  int maxDays = _indxCacheMaxDays();
+  while ((int) _indxCache.size() > maxDays) {
+    map<string, SpdbIndxCacheEntry *>::iterator oldest = _indxCache.end();
+    for (map<string, SpdbIndxCacheEntry *>::iterator it = _indxCache.begin();
+         it != _indxCache.end(); it++) {
+      if (it->second->nUsers == 0 &&
+          (oldest == _indxCache.end() ||
+           it->second->lastUse < oldest->second->lastUse)) {
+        oldest = it;
+      }
+    }
+    if (oldest == _indxCache.end()) {
+      return;
+    }
+    _indxCacheDrop(oldest);
+  }
+}
+
+// drop a day, after it has been written
+
+static void _indxCacheForget(const string &indxPath)
+{
+  pthread_mutex_lock(&_indxCacheMutex);
+  map<string, SpdbIndxCacheEntry *>::iterator it = _indxCache.find(indxPath);
+  if (it != _indxCache.end()) {
+    _indxCacheDrop(it);
+  }
+  pthread_mutex_unlock(&_indxCacheMutex);
+}
 
 ////////////////////////////////////////////////////////////
 // Constructor
@@ -75,6 +250,10 @@ Spdb::Spdb() :
         _getRefsOnly(false),
         _respectZeroTypes(false),
         _enableDefrag(false),
+        _compactFraction(-1.0),
+        _compactDefault(true),
+        _nDaysCompacted(0),
+        _nBytesReclaimed(0.0),
         _getUnique(UniqueOff),
         _nGetChunks(0),
         _checkWriteTimeOnGet(false),
@@ -89,6 +268,9 @@ Spdb::Spdb() :
         _chunkUncompressOnGet(true),
 
         _locked(false),
+        _dayLocking(true),
+        _dayLocked(false),
+        _inBatch(false),
         _emptyDay(false),
         _openDay(0),
 
@@ -97,8 +279,10 @@ Spdb::Spdb() :
         _indxFile(NULL),
         _dataFile(NULL),
         _lockFile(NULL),
+        _dayLockFile(NULL),
         _openMode(ReadMode),
         _filesOpen(false),
+        _indxCacheEntry(NULL),
 
         _firstTime(0),
         _lastTime(0),
@@ -109,8 +293,35 @@ Spdb::Spdb() :
   MEM_zero(_indxPath);
   MEM_zero(_dataPath);
   MEM_zero(_lockPath);
+  MEM_zero(_dayLockPath);
   MEM_zero(_hdr);
 
+  setDayLocking(!_legacyLocking());
+
+  char *compact_str = getenv("SPDB_COMPACT_FRACTION");
+  double compact_fraction;
+  if (compact_str && sscanf(compact_str, "%lg", &compact_fraction) == 1) {
+    setCompactionThreshold(compact_fraction);
+  }
+
+}
+
+////////////////////////////////////////////////////////////
+// set day locking, with compaction by default since overwrites
+// then leave fragments
+
+void Spdb::setDayLocking(bool state /* = true */)
+
+{
+
+  _dayLocking = state;
+
+  // leave alone anything the caller has set
+  if (_compactDefault) {
+    _enableDefrag = state;
+    _compactFraction = state ? DEFAULT_COMPACT_FRACTION : -1.0;
+  }
+
 }
 
 ////////////////////////////////////////////////////////////
@@ -122,6 +333,18 @@ Spdb::~Spdb()
   _closeFiles();
 }
 
+///////////////////////////////////////
+// set the number of days in the index cache
+
+void Spdb::setIndexCacheDays(int n_days)
+
+{
+  pthread_mutex_lock(&_indxCacheMutex);
+  _indxCacheDays = MAX(n_days, 0);
+  _indxCacheTrim();
+  pthread_mutex_unlock(&_indxCacheMutex);
+}
+
 ///////////////////////////////////////
 // functions to set the put attributes
 
@@ -407,6 +630,35 @@ int Spdb::put(const string &dir,
 
 }
 
+//////////////////////////////////////////////////////////
+// put chunks which have been added with
+// addPutChunk() or addPutChunks(), with one open, lock
+// and index write per day file, each day committed atomically.
+// Returns 0 on success, -1 on error
+
+int Spdb::putBatch(const string &dir,
+                   int prod_id,
+                   const string &prod_label)
+  
+{
+
+  if (_nPutChunks < 1) {
+    return 0;
+  }
+
+  _clearErrStr();
+  _errStr += "Spdb::putBatch\n";
+
+  _dir = dir;
+  _setLock(WriteMode);
+  
+  int iret = _putBatch(prod_id, prod_label);
+
+  _clearLock();
+  return iret;
+
+}
+
 ///////////////////////////////////////////////////////////////////
 // erase()
 //
@@ -456,6 +708,35 @@ int Spdb::erase(const string &dir)
 
 }
 
+///////////////////////////////////////////////////////////////////
+// compact()
+//
+// Compact the data files for the days from start_time to end_time.
+// Days whose fragments are less than min_frag_fraction of the
+// data file are left alone.
+//
+// Returns 0 on success, -1 on failure
+
+int Spdb::compact(const string &dir,
+                  time_t start_time,
+                  time_t end_time,
+                  double min_frag_fraction /* = 0.0*/ )
+
+{
+  
+  _clearErrStr();
+  _errStr += "Spdb::compact\n";
+
+  _dir = dir;
+  _setLock(WriteMode);
+  
+  int iret = _compact(start_time, end_time, min_frag_fraction);
+
+  _clearLock();
+  return iret;
+
+}
+
 ///////////////////////////////////////////////////////////////////
 // getExact()
 //
@@ -1006,7 +1287,225 @@ int Spdb::_put(int prod_id,
   _latestValidTimePut = latestValidTime;
   _closeFiles();
   
-  // write latest data info
+  return _writeLdataInfo(latestValidTime, maxDataType, maxDataType2);
+
+}
+
+//////////////////////////////////////////////////////////
+// put as one transaction
+//
+// The chunks are grouped by day. Each day, in time order, gets
+// its own object, which opens and locks the day file, stores the
+// day's chunks and writes the new index to a temporary file.
+// Only when every day is ready are the indexes renamed into
+// place. On failure the temporary indexes are removed and the
+// data files truncated back to their size before the batch -
+// nothing has referred to the appended chunks, since in a batch
+// the data files are only appended to, and a new day gets no
+// index until it is committed.
+//
+// The earliest valid times the chunks set on later days are
+// gathered up front: days in the batch get them in their new
+// index, other days are updated once the batch is committed.
+//
+// Returns 0 on success, -1 on error
+
+int Spdb::_putBatch(int prod_id,
+                    const string &prod_label)
+  
+{
+
+  // group the chunks by day, keeping their order within each day
+
+  const chunk_ref_t *putRefs = (const chunk_ref_t *) _putRefBuf.getPtr();
+  const aux_ref_t *putAuxs = (const aux_ref_t *) _putAuxBuf.getPtr();
+  const char *chunkData = (const char *) _putDataBuf.getPtr();
+
+  time_t latestValidTime = putRefs[0].valid_time;
+  int maxDataType = putRefs[0].data_type;
+  int maxDataType2 = putRefs[0].data_type2;
+  map<int, vector<int> > days;
+  map<int, time_t> earliestValid;
+  
+  for (int i = 0; i < _nPutChunks; i++) {
+    const chunk_ref_t &ref = putRefs[i];
+    int validDay = ref.valid_time / SECS_IN_DAY;
+    days[validDay].push_back(i);
+    latestValidTime = MAX((time_t) ref.valid_time, latestValidTime);
+    maxDataType = MAX(maxDataType, ref.data_type);
+    maxDataType2 = MAX(maxDataType2, ref.data_type2);
+    // as in _setEarliestValid()
+    int expireDay = MIN((int) (ref.expire_time / SECS_IN_DAY), validDay + 3);
+    for (int iday = validDay + 1; iday <= expireDay; iday++) {
+      map<int, time_t>::iterator ev = earliestValid.find(iday);
+      if (ev == earliestValid.end() || ref.valid_time < ev->second) {
+        earliestValid[iday] = ref.valid_time;
+      }
+    }
+  }
+
+  // store each day's chunks and prepare its index
+
+  vector<Spdb *> dayObjs;
+  vector<off_t> dataSizes;
+  vector<bool> newDays;
+  vector<string> tmpPaths;
+  vector<FILE *> tmpFiles;
+  int iret = 0;
+
+  for (map<int, vector<int> >::iterator it = days.begin();
+       it != days.end(); it++) {
+
+    Spdb *day = new Spdb;
+    day->_dir = _dir;
+    day->_appName = _appName;
+    day->_putMode = _putMode;
+    day->_respectZeroTypes = _respectZeroTypes;
+    day->_leadTimeStorage = _leadTimeStorage;
+    day->_dayLocking = _dayLocking;
+    day->_inBatch = true;
+    dayObjs.push_back(day);
+    dataSizes.push_back(-1);
+    newDays.push_back(false);
+    tmpPaths.push_back("");
+    tmpFiles.push_back(NULL);
+
+    const vector<int> &chunks = it->second;
+    time_t validTime = putRefs[chunks[0]].valid_time;
+    if (day->_openFiles(prod_id, prod_label, validTime, WriteMode)) {
+      _errStr += day->_errStr;
+      _errStr += "ERROR - Spdb::putBatch\n";
+      _addStrErr("  Cannot open files for chunk in dir: ", _dir);
+      _addStrErr("  Valid Time: ", utimstr(validTime));
+      iret = -1;
+      break;
+    }
+
+    struct stat dataStat;
+    if (fstat(day->_dataFd, &dataStat) == 0) {
+      dataSizes.back() = dataStat.st_size;
+    }
+    struct stat indxStat;
+    newDays.back() = (stat(day->_indxPath, &indxStat) != 0 ||
+                      indxStat.st_size < (off_t) sizeof(header_t));
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+      const chunk_ref_t *ref = putRefs + chunks[i];
+      if (day->_storeChunk(ref, putAuxs + chunks[i],
+                           chunkData + ref->offset)) {
+        _errStr += day->_errStr;
+        _errStr += "ERROR - Spdb::putBatch\n";
+        _addStrErr("  Cannot store chunk in dir: ", _dir);
+        _addStrErr("  Valid Time: ", utimstr(ref->valid_time));
+        iret = -1;
+        break;
+      }
+    }
+    if (iret) {
+      break;
+    }
+
+    map<int, time_t>::iterator ev = earliestValid.find(it->first);
+    if (ev != earliestValid.end() &&
+        ev->second < (time_t) day->_hdr.earliest_valid) {
+      day->_hdr.earliest_valid = ev->second;
+    }
+
+    if (day->_prepareIndxFile(true, tmpPaths.back(), tmpFiles.back())) {
+      _errStr += day->_errStr;
+      _errStr += "ERROR - Spdb::putBatch\n";
+      iret = -1;
+      break;
+    }
+
+  } // it
+
+  // publish the indexes, or roll the days back. A rename is
+  // the only step that can fail here, and if it does the days
+  // already published stay stored - see putBatch().
+
+  for (size_t i = 0; i < dayObjs.size(); i++) {
+    Spdb *day = dayObjs[i];
+    if (iret == 0) {
+      if (day->_publishIndxFile(tmpPaths[i], tmpFiles[i]) == 0) {
+        day->_closeFiles(false);
+        delete day;
+        continue;
+      }
+      // _publishIndxFile() has removed the tmp file
+      tmpFiles[i] = NULL;
+      _errStr += day->_errStr;
+      _errStr += "ERROR - Spdb::putBatch\n";
+      if (i > 0) {
+        _addStrErr("  Earlier days were stored, failed on day: ",
+                   utimstr(day->_hdr.start_of_day));
+      }
+      iret = -1;
+    }
+    if (tmpFiles[i] != NULL) {
+      fclose(tmpFiles[i]);
+      unlink(tmpPaths[i].c_str());
+    }
+    if (newDays[i] && day->_dataFile != NULL) {
+      unlink(day->_dataPath);
+      if (day->_indxFile != NULL) {
+        unlink(day->_indxPath);
+      }
+    } else if (dataSizes[i] >= 0 && day->_dataFile != NULL) {
+      fflush(day->_dataFile);
+      if (ftruncate(day->_dataFd, dataSizes[i])) {
+        _errStr += "WARNING - Spdb::putBatch\n";
+        _addStrErr("  Cannot truncate data file: ", day->_dataPath);
+      }
+    }
+    day->_closeFiles(false);
+    delete day;
+  }
+
+  if (iret) {
+    return -1;
+  }
+
+  // earliest valid times on days after the batch
+
+  Spdb dayObj;
+  dayObj._dir = _dir;
+  dayObj._dayLocking = _dayLocking;
+  for (map<int, time_t>::iterator ev = earliestValid.begin();
+       ev != earliestValid.end(); ev++) {
+    if (days.find(ev->first) != days.end()) {
+      continue;
+    }
+    time_t middayTime = ev->first * SECS_IN_DAY + SECS_IN_DAY / 2;
+    if (dayObj._openFiles(prod_id, prod_label, middayTime, WriteMode, false)) {
+      _errStr += dayObj._errStr;
+      _errStr += "WARNING - Spdb::putBatch\n";
+      _addStrErr("  Cannot set earliest valid time for: ",
+                 utimstr(middayTime));
+      continue;
+    }
+    if (ev->second < (time_t) dayObj._hdr.earliest_valid) {
+      dayObj._hdr.earliest_valid = ev->second;
+      dayObj._writeIndxFile(false);
+    }
+    dayObj._closeFiles(false);
+  }
+
+  _latestValidTimePut = latestValidTime;
+  return _writeLdataInfo(latestValidTime, maxDataType, maxDataType2);
+
+}
+
+//////////////////////////////////////////////////////////
+// write the latest data info after a put
+//
+// Returns 0 on success, -1 on error
+
+int Spdb::_writeLdataInfo(time_t latestValidTime,
+                          int maxDataType,
+                          int maxDataType2)
+  
+{
 
   DsLdataInfo ldata;
   ldata.setDir(_path);
@@ -1031,7 +1530,7 @@ int Spdb::_put(int prod_id,
   }
 
   if (ldata.write(storeTime, "spdb")) {
-    _errStr += "ERROR - Spdb::put\n";
+    _errStr += "ERROR - Spdb::_writeLdataInfo\n";
     _errStr += "  Cannot write latest data info file.\n";
     _addStrErr("  Dir path: ", _path);
     return -1;
@@ -1078,6 +1577,89 @@ int Spdb::_erase()
   
 }
 
+///////////////////////////////////////////////////////////////////
+// compact the days from start_time to end_time
+//
+// Returns 0 on success, -1 on failure
+
+int Spdb::_compact(time_t start_time,
+                   time_t end_time,
+                   double min_frag_fraction)
+
+{
+
+  _nDaysCompacted = 0;
+  _nBytesReclaimed = 0.0;
+  RapDataDir.fillPath(_dir, _path);
+
+  int iret = 0;
+  int startDay = start_time / SECS_IN_DAY;
+  int endDay = end_time / SECS_IN_DAY;
+
+  for (int iday = startDay; iday <= endDay; iday++) {
+
+    time_t midday_time = iday * SECS_IN_DAY + SECS_IN_DAY / 2;
+
+    // only days which have files, so none are created
+
+    date_time_t vtime;
+    vtime.unix_time = midday_time;
+    uconvert_from_utime(&vtime);
+    char indxPath[MAX_PATH_LEN];
+    sprintf(indxPath, "%s%s%.4d%.2d%.2d.%s",
+	    _path.c_str(), PATH_DELIM,
+	    vtime.year, vtime.month, vtime.day, _indxExt);
+    char dataPath[MAX_PATH_LEN];
+    sprintf(dataPath, "%s%s%.4d%.2d%.2d.%s",
+	    _path.c_str(), PATH_DELIM,
+	    vtime.year, vtime.month, vtime.day, _dataExt);
+    if (!ta_stat_exists_compress(indxPath) ||
+        !ta_stat_exists_compress(dataPath)) {
+      continue;
+    }
+
+    if (_openFiles(0, "", midday_time, WriteMode)) {
+      _errStr += "ERROR - Spdb::_compact\n";
+      _addStrErr("  Cannot open files for day: ", utimstr(midday_time));
+      iret = -1;
+      continue;
+    }
+
+    double fragFraction = _fragFraction();
+    if (fragFraction <= 0.0 || fragFraction < min_frag_fraction) {
+      _closeFiles(false);
+      continue;
+    }
+
+    struct stat dataStat;
+    double sizeBefore = 0.0;
+    if (stat(_dataPath, &dataStat) == 0) {
+      sizeBefore = (double) dataStat.st_size;
+    }
+
+    if (_compactDataFile()) {
+      _errStr += "ERROR - Spdb::_compact\n";
+      _addStrErr("  Cannot compact data file: ", _dataPath);
+      _closeFiles(false);
+      iret = -1;
+      continue;
+    }
+
+    // the index is written as the files are closed
+
+    _closeFiles();
+
+    _nDaysCompacted++;
+    if (stat(_dataPath, &dataStat) == 0) {
+      _nBytesReclaimed += sizeBefore - (double) dataStat.st_size;
+    }
+
+  } // iday
+
+  return iret;
+
+}
+
 ////////////////////////////////////////////////////////////
 // get the first and last times in the data base
 //
@@ -2103,6 +2685,24 @@ int Spdb::_openFiles(int prod_id,
 	  vtime.year, vtime.month, vtime.day,
 	  _dataExt);
 
+  // a read of a day in the index cache needs no file access
+
+  if (mode == ReadMode && read_chunk_refs &&
+      _openFromCache(prod_id) == 0) {
+    _openMode = mode;
+    _openDay = valid_time / SECS_IN_DAY;
+    return 0;
+  }
+
+  // with day locking, writers hold the lock on this day until
+  // the files are closed
+
+  if (_dayLocking && mode == WriteMode) {
+    if (_setDayLock(valid_time, WriteMode)) {
+      return -1;
+    }
+  }
+
   // decide if files exist
   
   bool indx_file_exists = false;
@@ -2128,10 +2728,19 @@ int Spdb::_openFiles(int prod_id,
 
   if (indx_file_exists && data_file_exists) {
     
-    if (_openReadWrite(prod_id, mode, read_chunk_refs)) {
+    if (_dayLocking && mode == ReadMode) {
+      if (_openSnapshot(prod_id, valid_time, read_chunk_refs)) {
+        return -1;
+      }
+    } else if (_openReadWrite(prod_id, mode, read_chunk_refs)) {
+      _clearDayLock();
       return -1;
     }
 
+    if (mode == ReadMode && read_chunk_refs) {
+      _addToCache();
+    }
+
   } else {
 
     // no files
@@ -2155,6 +2764,7 @@ int Spdb::_openFiles(int prod_id,
     // create it in write mode
 
     if (_openCreate(prod_id, prod_label, valid_time, mode)) {
+      _clearDayLock();
       return -1;
     }
     
@@ -2294,6 +2904,252 @@ int Spdb::_openReadWrite(int prod_id,
 
 }
 
+/////////////////////////////////////////////////////
+// _openSnapshot()
+//
+// Open files for read, without a lock.
+//
+// Writers using day locking replace the index whole, so the index
+// read is always complete, but a writer can replace the data file
+// (defragmentation) between the two opens. The data file id in the
+// index header is checked against the data file opened, and the
+// files reopened if they do not match. If they keep not matching,
+// or the index has no data file id to check against, the day lock
+// is taken as for a legacy reader.
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_openSnapshot(int prod_id,
+                        time_t valid_time,
+                        bool read_chunk_refs)
+
+{
+
+  for (int i = 0; i < _nSnapshotTries; i++) {
+    if (_openReadWrite(prod_id, ReadMode, read_chunk_refs)) {
+      return -1;
+    }
+    if (_snapshotIsConsistent() && _indxHdrUnchanged()) {
+      return 0;
+    }
+    _closeFiles(false);
+    if (_hdr.data_file_id == 0) {
+      // reopening will not help
+      break;
+    }
+  }
+
+  // read as a legacy reader: the directory lock keeps out writers
+  // updating the index in place, the day lock keeps out the others.
+  // The directory lock is held until _clearLock().
+
+  if (!_locked && _setDirLock(ReadMode)) {
+    return -1;
+  }
+  if (_setDayLock(valid_time, ReadMode)) {
+    return -1;
+  }
+  return _openReadWrite(prod_id, ReadMode, read_chunk_refs);
+
+}
+
+/////////////////////////////////////////////////////
+// check that the open data file is the one the open
+// index refers to
+
+bool Spdb::_snapshotIsConsistent()
+
+{
+
+  if (_hdr.data_file_id == 0) {
+    // index written without day locking, or not yet rewritten
+    // since, so a compaction may have replaced the data file
+    // under it
+    return false;
+  }
+
+  struct stat dataStat;
+  if (fstat(_dataFd, &dataStat)) {
+    return false;
+  }
+
+  return (_dataFileId(dataStat) == _hdr.data_file_id);
+
+}
+
+/////////////////////////////////////////////////////
+// check that the header of the open index is still the one read
+// by _openReadWrite(), so that a writer updating the index in place
+// did not start while the refs were read
+
+bool Spdb::_indxHdrUnchanged()
+
+{
+
+  header_t hdr;
+  if (pread(_indxFd, &hdr, sizeof(header_t), 0) != (ssize_t) sizeof(header_t)) {
+    return false;
+  }
+  BE_to_array_32(((char *) &hdr + SPDB_LABEL_MAX),
+		 sizeof(header_t) - SPDB_LABEL_MAX);
+
+  // _openReadWrite() fills in a missing product id
+
+  if (hdr.prod_id == 0) {
+    hdr.prod_id = _hdr.prod_id;
+  }
+
+  return (memcmp(&hdr, &_hdr, sizeof(header_t)) == 0);
+
+}
+
+/////////////////////////////////////////////////////
+// _openFromCache()
+//
+// Open the day for read from the index cache, if it is
+// there and still current. The header and refs are copied
+// from the cache, and chunks are read from the mapped data
+// file, so no files are opened.
+//
+// Returns 0 on success, -1 if the day cannot be used from
+// the cache.
+
+int Spdb::_openFromCache(int prod_id)
+
+{
+
+  struct stat indxStat, dataStat;
+  if (stat(_indxPath, &indxStat) || stat(_dataPath, &dataStat)) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&_indxCacheMutex);
+  map<string, SpdbIndxCacheEntry *>::iterator it = _indxCache.find(_indxPath);
+  if (it == _indxCache.end()) {
+    pthread_mutex_unlock(&_indxCacheMutex);
+    return -1;
+  }
+  SpdbIndxCacheEntry *entry = it->second;
+  if (!_sameFile(entry->indxStat, indxStat) ||
+      !_sameFile(entry->dataStat, dataStat)) {
+    _indxCacheDrop(it);
+    pthread_mutex_unlock(&_indxCacheMutex);
+    return -1;
+  }
+  if (prod_id > 0 && entry->hdr.prod_id != 0 &&
+      entry->hdr.prod_id != prod_id) {
+    // let the files be opened, to report the error
+    pthread_mutex_unlock(&_indxCacheMutex);
+    return -1;
+  }
+  entry->nUsers++;
+  entry->lastUse = ++_indxCacheClock;
+  pthread_mutex_unlock(&_indxCacheMutex);
+
+  // the entry does not change while in use
+
+  _indxCacheEntry = entry;
+  _hdr = entry->hdr;
+  _hdrRefBuf = entry->refBuf;
+  _hdrAuxBuf = entry->auxBuf;
+  _filesOpen = true;
+
+  if (prod_id > 0 && _hdr.prod_id == 0) {
+    _hdr.prod_id = prod_id;
+  }
+  if (_hdr.prod_id != 0) {
+    _prodId = _hdr.prod_id;
+    _prodLabel = _hdr.prod_label;
+  }
+  if (_hdr.lead_time_storage != 0) {
+    _leadTimeStorage = (lead_time_storage_t) _hdr.lead_time_storage;
+  }
+
+  return 0;
+
+}
+
+/////////////////////////////////////////////////////
+// _addToCache()
+//
+// Add the day just opened for read to the index cache,
+// replacing any older entry for it. The files are only
+// cached if they are the ones at the paths, which rules
+// out compressed files and files replaced since the open.
+// This object then uses the entry, for its chunk reads.
+
+void Spdb::_addToCache()
+
+{
+
+  struct stat indxStat, dataStat, indxPathStat, dataPathStat;
+  if (fstat(_indxFd, &indxStat) || fstat(_dataFd, &dataStat) ||
+      stat(_indxPath, &indxPathStat) || stat(_dataPath, &dataPathStat) ||
+      !_sameFile(indxStat, indxPathStat) ||
+      !_sameFile(dataStat, dataPathStat)) {
+    return;
+  }
+
+  pthread_mutex_lock(&_indxCacheMutex);
+  bool enabled = (_indxCacheMaxDays() > 0);
+  pthread_mutex_unlock(&_indxCacheMutex);
+  if (!enabled) {
+    return;
+  }
+
+  SpdbIndxCacheEntry *entry = new SpdbIndxCacheEntry;
+  if (dataStat.st_size > 0) {
+    void *dataMap = mmap(NULL, dataStat.st_size, PROT_READ,
+                         MAP_SHARED, _dataFd, 0);
+    if (dataMap == MAP_FAILED) {
+      delete entry;
+      return;
+    }
+    entry->dataMap = dataMap;
+    entry->dataLen = dataStat.st_size;
+  }
+  entry->indxStat = indxStat;
+  entry->dataStat = dataStat;
+  entry->hdr = _hdr;
+  entry->refBuf = _hdrRefBuf;
+  entry->auxBuf = _hdrAuxBuf;
+  entry->nUsers = 1;
+
+  pthread_mutex_lock(&_indxCacheMutex);
+  map<string, SpdbIndxCacheEntry *>::iterator it = _indxCache.find(_indxPath);
+  if (it != _indxCache.end()) {
+    _indxCacheDrop(it);
+  }
+  entry->lastUse = ++_indxCacheClock;
+  _indxCache[_indxPath] = entry;
+  _indxCacheTrim();
+  pthread_mutex_unlock(&_indxCacheMutex);
+
+  _indxCacheEntry = entry;
+
+}
+
+/////////////////////////////////////////////////////
+// stop using the index cache entry, if any
+
+void Spdb::_releaseCache()
+
+{
+
+  if (_indxCacheEntry == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&_indxCacheMutex);
+  _indxCacheEntry->nUsers--;
+  if (!_indxCacheEntry->current && _indxCacheEntry->nUsers == 0) {
+    delete _indxCacheEntry;
+  }
+  pthread_mutex_unlock(&_indxCacheMutex);
+  _indxCacheEntry = NULL;
+
+}
+
 /////////////////////////////////////////////////////
 // _openCreate()
 //
@@ -2310,17 +3166,21 @@ int Spdb::_openCreate(int prod_id,
 {
 
   // open files for write/read
+  // with day locking, the index is created by _writeIndxFile(),
+  // so that it never exists part written
     
-  if ((_indxFile =
-       ta_fopen_uncompress(_indxPath, "wb+")) == NULL) {
-    int errNum = errno;
-    _errStr += "ERROR - Spdb::_openCreate\n";
-    _addStrErr("  Product: ", _hdr.prod_label);
-    _errStr += "  Cannot open data indx for write/read.\n";
-    _addStrErr("  _indxPath: ", strerror(errNum));
-    return -1;
+  if (!_dayLocking) {
+    if ((_indxFile =
+         ta_fopen_uncompress(_indxPath, "wb+")) == NULL) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_openCreate\n";
+      _addStrErr("  Product: ", _hdr.prod_label);
+      _errStr += "  Cannot open data indx for write/read.\n";
+      _addStrErr("  _indxPath: ", strerror(errNum));
+      return -1;
+    }
+    _indxFd = fileno(_indxFile);
   }
-  _indxFd = fileno(_indxFile);
   
   if ((_dataFile =
        ta_fopen_uncompress(_dataPath, "wb+")) == NULL) {
@@ -2329,7 +3189,10 @@ int Spdb::_openCreate(int prod_id,
     _addStrErr("  Product: ", _hdr.prod_label);
     _errStr += "  Cannot open data data for write/read.\n";
     _addStrErr("  _dataPath: ", strerror(errNum));
-    fclose(_indxFile);
+    if (_indxFile != NULL) {
+      fclose(_indxFile);
+      _indxFile = NULL;
+    }
     return -1;
   }
   _dataFd = fileno(_dataFile);
@@ -2339,7 +3202,9 @@ int Spdb::_openCreate(int prod_id,
   
   _initHdr(prod_id, prod_label, valid_time);
 
-  if (_writeIndxFile()) {
+  // in a batch put the index is written when the batch commits
+
+  if (!_inBatch && _writeIndxFile()) {
     _closeFiles(false);
     return -1;
   }
@@ -2435,6 +3300,7 @@ void Spdb::_closeFiles(bool sync /* = true*/ )
 {
 
   if (!_filesOpen) {
+    _clearDayLock();
     return;
   }
 
@@ -2468,9 +3334,16 @@ void Spdb::_closeFiles(bool sync /* = true*/ )
     _dataFile = NULL;
   }
 
+  _releaseCache();
+  if (_openMode == WriteMode) {
+    _indxCacheForget(_indxPath);
+  }
+
   _filesOpen = false;
   _openDay = 0;
 
+  _clearDayLock();
+
   return;
 
 
@@ -2483,6 +3356,16 @@ void Spdb::_closeFiles(bool sync /* = true*/ )
 int Spdb::_writeIndxFile(bool write_refs /* = true*/ )
 {
 
+  if (_dayLocking) {
+    return _replaceIndxFile(write_refs);
+  }
+
+  // the index is updated in place, so it no longer refers to
+  // a data file a reader can check
+
+  _hdr.index_version = 0;
+  _hdr.data_file_id = 0;
+
   // copy header and put into BE order
   
   header_t tmp_hdr = _hdr;
@@ -2540,6 +3423,167 @@ int Spdb::_writeIndxFile(bool write_refs /* = true*/ )
 
 }
 
+//////////////////////////////////////////////////////////
+// replace the indx file - used with day locking
+//
+// The index is written to a temporary file which is renamed
+// over the index path, so readers see either the old or the
+// new index, whole. The data file is flushed first, so that
+// every chunk in the new index is readable.
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_replaceIndxFile(bool write_refs)
+{
+
+  string tmpPath;
+  FILE *tmpFile;
+  if (_prepareIndxFile(write_refs, tmpPath, tmpFile)) {
+    return -1;
+  }
+  return _publishIndxFile(tmpPath, tmpFile);
+
+}
+
+//////////////////////////////////////////////////////////
+// write the new indx to a temporary file, ready for
+// _publishIndxFile(). The caller may instead close and
+// unlink the temporary file to abandon the change.
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_prepareIndxFile(bool write_refs,
+                           string &tmpPath,
+                           FILE *&tmpFile)
+{
+
+  tmpFile = NULL;
+
+  // the chunk and aux refs, in BE order, from memory or
+  // copied from the current index file
+
+  MemBuf workBuf;
+  
+  if (_hdr.n_chunks > 0 && write_refs) {
+
+    MemBuf refBuf;
+    refBuf.add(_hdrRefBuf.getPtr(), _hdr.n_chunks * sizeof(chunk_ref_t));
+    chunk_refs_to_BE((chunk_ref_t *) refBuf.getPtr(), _hdr.n_chunks);
+    
+    MemBuf auxBuf;
+    auxBuf.add(_hdrAuxBuf.getPtr(), _hdr.n_chunks * sizeof(aux_ref_t));
+    aux_refs_to_BE((aux_ref_t *) auxBuf.getPtr(), _hdr.n_chunks);
+    
+    workBuf.add(refBuf.getPtr(), refBuf.getLen());
+    workBuf.add(auxBuf.getPtr(), auxBuf.getLen());
+
+  } else if (_hdr.n_chunks > 0 && _indxFile != NULL) {
+
+    size_t nbytes =
+      _hdr.n_chunks * (sizeof(chunk_ref_t) + sizeof(aux_ref_t));
+    workBuf.reserve(nbytes);
+    fseek(_indxFile, sizeof(header_t), SEEK_SET);
+    if (ta_fread(workBuf.getPtr(), 1, nbytes, _indxFile) != (int) nbytes) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_prepareIndxFile\n";
+      _addStrErr("  Product: ", _hdr.prod_label);
+      _errStr += "  Cannot read indx file chunk refs.\n";
+      _addStrErr("  _indxPath: ", strerror(errNum));
+      return -1;
+    }
+
+  }
+
+  // make sure the chunks are readable before the index refers to them
+
+  if (_dataFile != NULL) {
+    fflush(_dataFile);
+  }
+
+  // stamp the header with a new version and the data file id
+
+  _hdr.index_version++;
+  _hdr.data_file_id = 0;
+  struct stat dataStat;
+  if (stat(_dataPath, &dataStat) == 0) {
+    _hdr.data_file_id = _dataFileId(dataStat);
+  }
+
+  header_t tmp_hdr = _hdr;
+  BE_from_array_32(((char *) &tmp_hdr + SPDB_LABEL_MAX),
+		   sizeof(header_t) - SPDB_LABEL_MAX);
+
+  // write the temporary file
+
+  tmpPath = _indxPath;
+  tmpPath += ".tmp";
+  if ((tmpFile = fopen(tmpPath.c_str(), "wb+")) == NULL) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_prepareIndxFile\n";
+    _addStrErr("  Product: ", _hdr.prod_label);
+    _addStrErr("  Cannot open tmp indx path: ", tmpPath);
+    _addStrErr("  ", strerror(errNum));
+    return -1;
+  }
+  
+  if (ta_fwrite(&tmp_hdr, sizeof(header_t), 1, tmpFile) != 1 ||
+      (workBuf.getLen() > 0 &&
+       ta_fwrite(workBuf.getPtr(), 1, workBuf.getLen(), tmpFile) !=
+       (int) workBuf.getLen()) ||
+      fflush(tmpFile) || fsync(fileno(tmpFile))) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_prepareIndxFile\n";
+    _addStrErr("  Product: ", _hdr.prod_label);
+    _errStr += "  Cannot write tmp indx file.\n";
+    _addStrErr("  Tmp path: ", tmpPath);
+    _addStrErr("  ", strerror(errNum));
+    fclose(tmpFile);
+    unlink(tmpPath.c_str());
+    tmpFile = NULL;
+    return -1;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////
+// rename the temporary indx file from _prepareIndxFile()
+// over the index path, and adopt it as the open index.
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_publishIndxFile(const string &tmpPath,
+                           FILE *tmpFile)
+{
+
+  // rename over the index path
+
+  if (rename(tmpPath.c_str(), _indxPath)) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_publishIndxFile\n";
+    _addStrErr("  Product: ", _hdr.prod_label);
+    _errStr += "  Cannot rename tmp indx file to indx file.\n";
+    _addStrErr("  Tmp path: ", tmpPath);
+    _addStrErr("  Indx path: ", _indxPath);
+    _addStrErr("  ", strerror(errNum));
+    fclose(tmpFile);
+    unlink(tmpPath.c_str());
+    return -1;
+  }
+
+  // the new file is now the open index
+
+  if (_indxFile != NULL) {
+    fclose(_indxFile);
+  }
+  _indxFile = tmpFile;
+  _indxFd = fileno(_indxFile);
+
+  return 0;
+
+}
+
 ////////////////////////////////////////////
 // _setLock()
 //
@@ -2549,6 +3593,28 @@ int Spdb::_writeIndxFile(bool write_refs /* = true*/ )
 
 int Spdb::_setLock(open_mode_t mode)
 
+{
+
+  // with day locking, readers take no lock, see _openSnapshot()
+
+  if (_dayLocking && mode == ReadMode) {
+    return 0;
+  }
+
+  return _setDirLock(mode);
+
+}
+
+////////////////////////////////////////////
+// _setDirLock()
+//
+// Lock the directory, exclusively for a WriteMode without
+// day locking, shared otherwise. Held until _clearLock().
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_setDirLock(open_mode_t mode)
+
 {
 
   // create the lock file
@@ -2562,8 +3628,12 @@ int Spdb::_setLock(open_mode_t mode)
     return -1;
   }
   
+  // with day locking, writers share the directory lock, which still
+  // keeps out writers using the single directory lock, and lock each
+  // day in _openFiles()
+
   const char *modeStr = "w";
-  if (mode == ReadMode) {
+  if (mode == ReadMode || _dayLocking) {
     modeStr = "r";
   }
   
@@ -2633,6 +3703,103 @@ bool Spdb::_ignoreLock()
   return false;
 }
 
+/////////////////////////////////////////////////
+// check whether to use the single directory lock
+
+bool Spdb::_legacyLocking()
+
+{
+  char *lock_str = getenv("SPDB_LEGACY_LOCKING");
+  
+  if (lock_str && STRequal(lock_str, "true")) {
+    return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////
+// _setDayLock()
+//
+// Lock the day containing valid_time, exclusively for WriteMode,
+// shared for ReadMode. Held until _clearDayLock().
+// A reader does not wait if no writer has locked the day yet.
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_setDayLock(time_t valid_time, open_mode_t mode)
+
+{
+
+  _clearDayLock();
+
+  date_time_t vtime;
+  vtime.unix_time = valid_time;
+  uconvert_from_utime(&vtime);
+  sprintf(_dayLockPath, "%s%s_lock_%.4d%.2d%.2d",
+	  _path.c_str(), PATH_DELIM,
+	  vtime.year, vtime.month, vtime.day);
+
+  bool write = (mode == WriteMode);
+  _dayLockAcquire(_dayLockPath, write);
+
+  if ((_dayLockFile = fopen(_dayLockPath, write ? "w+" : "r")) == NULL) {
+    _dayLockRelease(_dayLockPath);
+    if (!write) {
+      return 0;
+    }
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_setDayLock\n";
+    _addStrErr("  Cannot create lock file: ", _dayLockPath);
+    _addStrErr("  ", strerror(errNum));
+    return -1;
+  }
+
+  if (ta_lock_file(_dayLockPath, _dayLockFile, write ? "w" : "r")) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_setDayLock\n";
+    _addStrErr("  Cannot lock file: ", _dayLockPath);
+    _addStrErr("  ", strerror(errNum));
+    fclose(_dayLockFile);
+    _dayLockFile = NULL;
+    _dayLockRelease(_dayLockPath);
+    return -1;
+  }
+
+  _dayLocked = true;
+
+  return 0;
+
+}
+
+////////////////////////////////////////
+// clear the day lock, if held
+//
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_clearDayLock()
+
+{
+
+  int iret = 0;
+
+  if (_dayLocked) {
+    _dayLocked = false;
+    if (ta_unlock_file(_dayLockPath, _dayLockFile)) {
+      _errStr += "ERROR - Spdb::_clearDayLock\n";
+      _addStrErr("  File: ", _dayLockPath);
+      _addStrErr("  ", strerror(errno));
+      iret = -1;
+    }
+    fclose(_dayLockFile);
+    _dayLockFile = NULL;
+    _dayLockRelease(_dayLockPath);
+  }
+
+  return iret;
+
+}
+
 /////////////////////////////////////
 // add error string with int argument
 
@@ -2768,6 +3935,8 @@ void Spdb::_printIndxHeader(header_t &hdr,
   out << "end_valid: " << utimstr(hdr.end_valid) << endl;
   out << "latest_expire: " << utimstr(hdr.latest_expire) << endl;
   out << "earliest_valid: " << utimstr(hdr.earliest_valid) << endl;
+  out << "index_version: " << hdr.index_version << endl;
+  out << "data_file_id: " << hdr.data_file_id << endl;
 
   if (hdr.lead_time_storage == LEAD_TIME_IN_DATA_TYPE) {
     out << "Lead time: stored in data_type" << endl;
@@ -3525,27 +4694,45 @@ int Spdb::_readChunk(chunk_ref_t &ref,
   
   void *chunk = readBuf.reserve(ref.len);
   
-  // seek to offset
-  
-  if (fseek(_dataFile, ref.offset, SEEK_SET) < 0) {
-    int errNum = errno;
-    _errStr += "ERROR - Spdb::_readChunk\n";
-    _addStrErr(" Prod label: ", _hdr.prod_label);
-    _addIntErr(" Cannot seek to data offset: ", ref.offset);
-    _addStrErr(_dataPath, strerror(errNum));
-    return -1;
-  }
-  
-  // read data
-  
-  if ((ui32) ta_fread(chunk, 1, ref.len, _dataFile) != ref.len) {
-    int errNum = errno;
-    _errStr += "ERROR - Spdb::_readChunk\n";
-    _addStrErr(" Prod label: ", _hdr.prod_label);
-    _addIntErr(" Cannot read chunk of len: ", ref.len);
-    _addIntErr(" Data offset: ", ref.offset);
-    _addStrErr(_dataPath, strerror(errNum));
-    return -1;
+  if (_indxCacheEntry != NULL) {
+
+    // copy from the mapped data file
+
+    if ((size_t) ref.offset + ref.len > _indxCacheEntry->dataLen) {
+      _errStr += "ERROR - Spdb::_readChunk\n";
+      _addStrErr(" Prod label: ", _hdr.prod_label);
+      _addIntErr(" Chunk past end of data file, len: ", ref.len);
+      _addIntErr(" Data offset: ", ref.offset);
+      _addStrErr(" Data file: ", _dataPath);
+      return -1;
+    }
+    memcpy(chunk, (char *) _indxCacheEntry->dataMap + ref.offset, ref.len);
+
+  } else {
+
+    // seek to offset
+
+    if (fseek(_dataFile, ref.offset, SEEK_SET) < 0) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_readChunk\n";
+      _addStrErr(" Prod label: ", _hdr.prod_label);
+      _addIntErr(" Cannot seek to data offset: ", ref.offset);
+      _addStrErr(_dataPath, strerror(errNum));
+      return -1;
+    }
+
+    // read data
+
+    if ((ui32) ta_fread(chunk, 1, ref.len, _dataFile) != ref.len) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_readChunk\n";
+      _addStrErr(" Prod label: ", _hdr.prod_label);
+      _addIntErr(" Cannot read chunk of len: ", ref.len);
+      _addIntErr(" Data offset: ", ref.offset);
+      _addStrErr(_dataPath, strerror(errNum));
+      return -1;
+    }
+
   }
 
   // uncompress chunk if it is compressed
@@ -3597,6 +4784,7 @@ int Spdb::_setEarliestValid(time_t valid_time, time_t expire_time)
 
     Spdb dayObj;
     dayObj._dir = _dir;
+    dayObj._dayLocking = _dayLocking;
 
     for (int iday = valid_day + 1; iday <= expire_day; iday++) {
 
@@ -3706,7 +4894,11 @@ int Spdb::_storeChunk(const chunk_ref_t *input_ref,
     
     chunk_ref_t *existRef = (chunk_ref_t *) _hdrRefBuf.getPtr() + posn;
     
-    if (existRef->len >= inref.len) {
+    // with day locking, or in a batch put, the data file is only
+    // appended to, so that readers holding an older index still find
+    // the old chunk, and a failed batch can be truncated away
+
+    if (existRef->len >= inref.len && !_dayLocking && !_inBatch) {
 
       // chunk will fit in previous location. Fragment
       // is created at end of slot if they are not
@@ -3725,7 +4917,7 @@ int Spdb::_storeChunk(const chunk_ref_t *input_ref,
       // becomes a fragment.
       
       _hdr.nbytes_frag += existRef->len;
-      _hdr.nbytes_data -= existRef->len;
+      _hdr.nbytes_data += inref.len - existRef->len;
       append = true;
       
     } // if (existRef->len >= len)
@@ -3773,8 +4965,12 @@ int Spdb::_storeChunk(const chunk_ref_t *input_ref,
   _hdr.earliest_valid =
     MIN(((time_t) _hdr.earliest_valid), ((time_t) inref.valid_time));
 
-  _setEarliestValid(inref.valid_time,
-		    inref.expire_time);
+  // a batch put sets these itself, when it commits
+
+  if (!_inBatch) {
+    _setEarliestValid(inref.valid_time,
+		      inref.expire_time);
+  }
 
   return 0;
 
@@ -4105,16 +5301,26 @@ int Spdb::_writeChunk(chunk_ref_t &inref,
 }
 
 ////////////////////////////
-// defragment the data file
+// defragment the data file, if the fragments pass the threshold
+// (DEFAULT_COMPACT_FRACTION with day locking, or as set by
+// setCompactionThreshold()), or with no threshold set if:
+//   nbytesFrag > 10000 and fragFract > 0.05, or
+//   fragFract > 0.3
+// where fragFract is relative to the live data.
+//
+// Returns 0 on success, -1 on failure
 
 int Spdb::_defrag()
 
 {
 
-  // check if we need to defrag
-  // only defrag if:
-  //   nbytesFrag > 10000 and fragFract > 0.05, or
-  //   fragFract > 0.3
+  if (_compactFraction >= 0.0) {
+    double fragFraction = _fragFraction();
+    if (fragFraction <= 0.0 || fragFraction < _compactFraction) {
+      return 0;
+    }
+    return _compactDataFile();
+  }
 
   if (_hdr.nbytes_data == 0) return 0;
 
@@ -4126,6 +5332,50 @@ int Spdb::_defrag()
     return 0;
   }
 
+  return _compactDataFile();
+
+}
+
+////////////////////////////////////////////////////////
+// fraction of the data file not used by live chunks -
+// fragments, and anything written past the last chunk
+// the index knows about
+
+double Spdb::_fragFraction()
+
+{
+
+  struct stat dataStat;
+  if (_dataFile == NULL || fstat(fileno(_dataFile), &dataStat) ||
+      dataStat.st_size <= 0) {
+    return 0.0;
+  }
+
+  double nLive = 0.0;
+  const chunk_ref_t *ref = (const chunk_ref_t *) _hdrRefBuf.getPtr();
+  for (int i = 0; i < _hdr.n_chunks; i++, ref++) {
+    nLive += ref->len;
+  }
+
+  double fileSize = (double) dataStat.st_size;
+  return (fileSize - nLive) / fileSize;
+
+}
+
+////////////////////////////////////////////////////////
+// compact the data file
+//
+// The live chunks are copied to a temporary file, in the order
+// of the chunk refs, which is valid time order, and the file
+// renamed over the data file. The refs are updated in memory, the
+// index is written when the files are closed.
+//
+// Returns 0 on success, -1 on failure
+
+int Spdb::_compactDataFile()
+
+{
+
   // open a temporary file
 
   string defragPath = _dataPath;
@@ -4134,7 +5384,7 @@ int Spdb::_defrag()
   FILE *defragFile;
   if ((defragFile = fopen(defragPath.c_str(), "w")) == NULL) {
     int errNum = errno;
-    _errStr += "ERROR - Spdb::_defrag\n";
+    _errStr += "ERROR - Spdb::_compactDataFile\n";
     _addStrErr("  Prod label: ", _hdr.prod_label);
     _addStrErr("  Cannot open tmp data path: ", defragPath);
     _addStrErr("  ", strerror(errNum));
@@ -4147,6 +5397,7 @@ int Spdb::_defrag()
   MemBuf readBuf;
   MemBuf refBuf;
   MemBuf auxBuf;
+  si32 nbytesData = 0;
 
   chunk_ref_t *ref  = (chunk_ref_t *) _hdrRefBuf.getPtr();
   aux_ref_t *aux  = (aux_ref_t *) _hdrAuxBuf.getPtr();
@@ -4158,31 +5409,42 @@ int Spdb::_defrag()
     chunk_ref_t refCopy(*ref);
     aux_ref_t auxCopy(*aux);
    
-    // read the chunk, do not uncompress
-
-    if (_readChunk(refCopy, auxCopy, readBuf, false) == 0) {
-
-      // add to reference buffers, setting the offset first
-      
-      refCopy.offset = (ui32) ftell(defragFile);
-      refBuf.add(&refCopy, sizeof(chunk_ref_t));
-      auxBuf.add(&auxCopy, sizeof(aux_ref_t));
+    // read the chunk, do not uncompress. A chunk that cannot be
+    // read is an error, rather than dropped, since the header and
+    // minute positions count every ref
+
+    if (_readChunk(refCopy, auxCopy, readBuf, false)) {
+      _errStr += "ERROR - Spdb::_compactDataFile\n";
+      _addStrErr("  Prod label: ", _hdr.prod_label);
+      _addStrErr("  Cannot read chunk for time: ",
+                 utimstr(refCopy.valid_time));
+      fclose(defragFile);
+      unlink(defragPath.c_str());
+      return -1;
+    }
 
-      // write data to defrag file
-      
-      if (ta_fwrite(readBuf.getPtr(), readBuf.getLen(), 1, defragFile) != 1) {
-        int errNum = errno;
-        _errStr += "ERROR - Spdb::_defrag\n";
-        _addStrErr("  Prod label: ", _hdr.prod_label);
-        _errStr += "  Cannot write data to truncated data file.\n";
-        _addStrErr("  File path: ", defragPath);
-        _addIntErr("  Data len: ", readBuf.getLen());
-        _addStrErr("  ", strerror(errNum));
-        fclose(defragFile);
-        return -1;
-      }
+    // add to reference buffers, setting the offset first
+    
+    refCopy.offset = (ui32) ftell(defragFile);
+    refBuf.add(&refCopy, sizeof(chunk_ref_t));
+    auxBuf.add(&auxCopy, sizeof(aux_ref_t));
 
+    // write data to defrag file
+    
+    if (readBuf.getLen() > 0 &&
+        ta_fwrite(readBuf.getPtr(), readBuf.getLen(), 1, defragFile) != 1) {
+      int errNum = errno;
+      _errStr += "ERROR - Spdb::_compactDataFile\n";
+      _addStrErr("  Prod label: ", _hdr.prod_label);
+      _errStr += "  Cannot write data to truncated data file.\n";
+      _addStrErr("  File path: ", defragPath);
+      _addIntErr("  Data len: ", readBuf.getLen());
+      _addStrErr("  ", strerror(errNum));
+      fclose(defragFile);
+      unlink(defragPath.c_str());
+      return -1;
     }
+    nbytesData += readBuf.getLen();
     
   } // i
 
@@ -4196,7 +5458,7 @@ int Spdb::_defrag()
 
   if (rename(defragPath.c_str(), _dataPath)) {
     int errNum = errno;
-    _errStr += "ERROR - Spdb::_defrag\n";
+    _errStr += "ERROR - Spdb::_compactDataFile\n";
     _addStrErr("  Prod label: ", _hdr.prod_label);
     _errStr += "  Cannot rename defrag file to data file.\n";
     _addStrErr("  Defrag path: ", defragPath);
@@ -4208,9 +5470,21 @@ int Spdb::_defrag()
   // set the headers and ref and aux buffers
 
   _hdr.nbytes_frag = 0;
+  _hdr.nbytes_data = nbytesData;
   _hdrRefBuf = refBuf;
   _hdrAuxBuf = auxBuf;
 
+  // reopen, so that the object can go on using the files
+
+  if ((_dataFile = fopen(_dataPath, "rb+")) == NULL) {
+    int errNum = errno;
+    _errStr += "ERROR - Spdb::_compactDataFile\n";
+    _addStrErr("  Cannot reopen data file: ", _dataPath);
+    _addStrErr("  ", strerror(errNum));
+    return -1;
+  }
+  _dataFd = fileno(_dataFile);
+
   return 0;
 
 }
@@ -262,6 +262,34 @@ public:
   virtual int put(int prod_id,
 		  const string &prod_label);
   
+  //////////////////////////////////////////////////////////
+  // putBatch - multiple chunks to single URL
+  // Overrides Spdb function.
+  //
+  // For a local URL the chunks are stored with one open, lock
+  // and index write per day file, each day committed atomically,
+  // see Spdb::putBatch(). A remote put is already sent as a
+  // single message.
+  //
+  // Chunks must already be in BE byte order, as appropriate.
+  //
+  // Returns 0 on success, -1 on error
+
+  virtual int putBatch(const string &url_str,
+		       int prod_id,
+		       const string &prod_label);
+
+  //////////////////////////////////////////////////////////////
+  // putBatch - multiple chunks to multiple URLs, as one
+  // transaction per URL
+  //
+  // Chunks must already be in BE byte order, as appropriate.
+  //
+  // Returns 0 on success, -1 on error
+
+  virtual int putBatch(int prod_id,
+		       const string &prod_label);
+  
   ///////////////////////////////////////////////////////////////////
   // erase()
   //
@@ -621,7 +649,8 @@ protected:
 		 const string &prod_label);
 
   int _localPut(int prod_id,
-		const string &prod_label);
+		const string &prod_label,
+		bool batch = false);
 
   int _setUrl(const string &url_str);
 
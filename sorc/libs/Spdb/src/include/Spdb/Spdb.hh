@@ -64,6 +64,44 @@
 // chunk data is stored as it is passed to the library. The calling
 // program must make sure the chunks are in BE format.
 //
+// Locking:
+//
+// By default, writers hold a shared lock on the _lock file in the
+// directory, and an exclusive lock on the day they are writing
+// (_lock_yyyymmdd), so writers of different days do not wait for
+// each other. The data file is only appended to, and the index file
+// is replaced whole (written to a temporary file and renamed), with
+// the id of the data file it refers to in the header. Readers take
+// no lock: they open the index and data file of a day, and check the
+// id, reopening if a writer replaced the files in between. A day whose
+// index has no id is read as a legacy reader would, under the shared
+// directory lock and the day lock.
+//
+// Setting the environment variable SPDB_LEGACY_LOCKING to true, or
+// calling setDayLocking(false), restores the single directory lock,
+// held exclusively by writers and shared by readers. A writer in this
+// mode updates the index in place, and clears its data file id, so
+// readers using day locking fall back to the locks for that day.
+//
+// Programs built with the older library also update the files in
+// place, but keep the id. A reader using day locking checks that the
+// index header has not changed while the index was read, which
+// catches most of their updates, but not all: every program reading a
+// data base that such programs still write to must run with
+// SPDB_LEGACY_LOCKING set to true.
+//
+// Index cache:
+//
+// Reads keep the decoded index of each day, and the day's data file
+// mapped into memory, in a cache shared by all objects in the process.
+// A cached day is used while the index and data files have the same
+// inode, size and modification time as when it was read, so repeated
+// queries of the same days need two stat() calls rather than opening
+// and reading the files. Writes through this library drop the days
+// they change. The cache holds 32 days by default; setIndexCacheDays(),
+// or the environment variable SPDB_INDEX_CACHE_DAYS, changes that, and
+// 0 turns the cache off.
+//
 ////////////////////////////////////////////////////////////////
 
 #ifndef Spdb_HH
@@ -81,6 +119,8 @@
 
 using namespace std;
 
+class SpdbIndxCacheEntry;
+
 ///////////////////////////////////////////////////////////////
 // class definition
 
@@ -246,15 +286,62 @@ public:
 
   //////////////////////////////////////////////
   // Enable defragmentation in data files.
-  // Off by default.
+  // On by default with day locking, off otherwise.
   // If true, the defragmentation method will be called
-  // if a file has fragmented data because of many erase
-  // operations. This is rare.
+  // when the files for a day are closed after a put or
+  // erase, and compacts the data file if it has passed
+  // the compaction threshold (see setCompactionThreshold()).
 
   void setEnableDefragmentation(bool state = true) {
     _enableDefrag = state;
+    _compactDefault = false;
   }
 
+  //////////////////////////////////////////////
+  // Set day locking - see the notes on locking above.
+  // On by default, unless SPDB_LEGACY_LOCKING is true.
+  // With day locking, putModeOver appends the new chunk
+  // rather than overwriting the old one in place, so turning
+  // it on also turns on compaction at DEFAULT_COMPACT_FRACTION,
+  // unless a threshold has been set.
+
+  void setDayLocking(bool state = true);
+
+  //////////////////////////////////////////////
+  // Set automatic compaction.
+  // When the files for a day are closed after a put or erase,
+  // the data file is compacted if fragments (overwritten or
+  // erased chunks) are at least frag_fraction of the file.
+  // This enables defragmentation, and replaces its legacy
+  // rule. The environment variable SPDB_COMPACT_FRACTION sets
+  // the same thing for every object in a process.
+  //
+  // With day locking the threshold is DEFAULT_COMPACT_FRACTION
+  // unless set here or in the environment. Without it,
+  // defragmentation is off unless enabled, and then uses the
+  // legacy rule (see _defrag()) unless a threshold is set.
+  // setEnableDefragmentation(false) turns compaction off.
+
+  void setCompactionThreshold(double frag_fraction) {
+    _compactFraction = frag_fraction;
+    _compactDefault = false;
+    _enableDefrag = true;
+  }
+
+  // Compaction threshold with day locking, if not set otherwise.
+  // Compacting when half the data file is fragments keeps the
+  // file within twice the live data, and copies on average no
+  // more than was written since the last compaction.
+
+  static const double DEFAULT_COMPACT_FRACTION;
+
+  //////////////////////////////////////////////
+  // Set the number of days kept in the index cache, for
+  // all objects in the process - see the notes on the index
+  // cache above. 0 turns the cache off.
+
+  static void setIndexCacheDays(int n_days);
+
   ///////////////////////
   // number of put chunks
 
@@ -292,6 +379,33 @@ public:
 		  const int prod_id,
 		  const string &prod_label);
   
+  //////////////////////////////////////////////////////////
+  // put chunks which have been added with
+  // addPutChunk() or addPutChunks(), in one pass.
+  //
+  // The chunks are grouped by day file, and each day is opened,
+  // locked and has its index written once, however many chunks
+  // and valid times it gets. Nothing is visible to readers until
+  // every day is ready: if any chunk fails (for example
+  // putModeOnce with data already at that time), the data files
+  // are truncated back and the indexes left as they were.
+  //
+  // Each day is then committed atomically, in time order, by
+  // renaming its new index into place. The batch as a whole is
+  // not atomic: should a rename fail, the days before it stay
+  // stored and the rest are rolled back.
+  //
+  // The locks on all the days in the batch are held until they
+  // are committed together at the end. Days after the batch that
+  // its chunks overlap get their earliest valid time updated after
+  // the commit. Compaction is left to the next put or to compact().
+  //
+  // Returns 0 on success, -1 on error
+
+  virtual int putBatch(const string &dir,
+                       int prod_id,
+                       const string &prod_label);
+  
   ////////////////////////////////////////////////////////////////////
   // Erase data for a given valid time and data type.
   // If the data_type is 0, the data_type is not considered in the erase.
@@ -317,6 +431,29 @@ public:
   
   virtual int erase(const string &dir);
 
+  ///////////////////////////////////////////////////////////////////
+  // compact()
+  //
+  // Compact the data files for the days from start_time to end_time.
+  // Each data file is rewritten with the live chunks only, in valid
+  // time order, and its index updated. Days whose fragments are less
+  // than min_frag_fraction of the data file are left alone.
+  //
+  // Takes the same locks as a put.
+  //
+  // After the call, getNDaysCompacted() and getNBytesReclaimed()
+  // give the results.
+  //
+  // Returns 0 on success, -1 on failure
+  
+  int compact(const string &dir,
+              time_t start_time,
+              time_t end_time,
+              double min_frag_fraction = 0.0);
+
+  int getNDaysCompacted() const { return _nDaysCompacted; }
+  double getNBytesReclaimed() const { return _nBytesReclaimed; }
+
   ///////////////////////////////////////////////////////////////////
   //
   // get functions
@@ -753,6 +890,7 @@ public:
   char _indxPath[SPDB_PATH_MAX];
   char _dataPath[SPDB_PATH_MAX];
   char _lockPath[SPDB_PATH_MAX];
+  char _dayLockPath[SPDB_PATH_MAX];
   
   // file header and chunk refs
   
@@ -765,6 +903,10 @@ public:
   bool _getRefsOnly;
   bool _respectZeroTypes;
   bool _enableDefrag;
+  double _compactFraction; // < 0 for the legacy defrag rule
+  bool _compactDefault; // true until compaction is set by the caller
+  int _nDaysCompacted;
+  double _nBytesReclaimed;
   get_unique_t _getUnique;
   int _nGetChunks;
   MemBuf _getRefBuf;  // buffer for chunk refs for gets
@@ -805,6 +947,9 @@ public:
   // flags etc
   
   bool _locked;
+  bool _dayLocking;
+  bool _dayLocked;
+  bool _inBatch;
   bool _emptyDay;
   int _openDay;
   
@@ -815,8 +960,10 @@ public:
   FILE *_indxFile;
   FILE *_dataFile;
   FILE *_lockFile;
+  FILE *_dayLockFile;
   open_mode_t _openMode;
   bool _filesOpen;
+  SpdbIndxCacheEntry *_indxCacheEntry; // day read from the cache, or NULL
   
   // times from getTimes()
   
@@ -844,6 +991,12 @@ public:
   
   int _put(int prod_id, const string &prod_label);
   
+  int _putBatch(int prod_id, const string &prod_label);
+  
+  int _writeLdataInfo(time_t latest_valid_time,
+                      int max_data_type,
+                      int max_data_type2);
+  
   int _erase();
   
   int _getFirstAndLastTimes(time_t &first_time,
@@ -904,6 +1057,20 @@ public:
                      open_mode_t mode,
                      bool read_chunk_refs);
   
+  int _openSnapshot(int prod_id,
+                    time_t valid_time,
+                    bool read_chunk_refs);
+  
+  bool _snapshotIsConsistent();
+  
+  bool _indxHdrUnchanged();
+  
+  int _openFromCache(int prod_id);
+
+  void _addToCache();
+
+  void _releaseCache();
+
   int _openCreate(int prod_id,
                   const string &prod_label,
                   time_t valid_time,
@@ -923,10 +1090,18 @@ public:
 
   int _setLock(open_mode_t mode);
 
+  int _setDirLock(open_mode_t mode);
+
   bool _ignoreLock();
 
   int _clearLock();
 
+  bool _legacyLocking();
+
+  int _setDayLock(time_t valid_time, open_mode_t mode);
+
+  int _clearDayLock();
+
   void _addIntErr(const char *err_str, int iarg);
 
   void _addStrErr(const char *err_str, const string &sarg);
@@ -1001,12 +1176,29 @@ public:
 
   int _writeIndxFile(bool write_refs = true);
 
+  int _replaceIndxFile(bool write_refs);
+
+  int _prepareIndxFile(bool write_refs,
+                       string &tmp_path,
+                       FILE *&tmp_file);
+
+  int _publishIndxFile(const string &tmp_path,
+                       FILE *tmp_file);
+
   int _writeChunk(chunk_ref_t &inref,
                   const void *input_data,
                   bool append);
 
   int _defrag();
 
+  int _compact(time_t start_time,
+               time_t end_time,
+               double min_frag_fraction);
+
+  int _compactDataFile();
+
+  double _fragFraction();
+
   bool _acceptRef(int data_type,
                   int data_type2,
                   const chunk_ref_t &ref,
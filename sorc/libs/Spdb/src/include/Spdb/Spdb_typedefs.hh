@@ -114,7 +114,15 @@ typedef struct {
 
   si32 lead_time_storage; // see lead_time_storage_t above
 
-  si32 spares[66];
+  si32 index_version;  // incremented each time the index is replaced
+                       // by a writer using day locking, 0 otherwise
+
+  si32 data_file_id;   // id of the data file this index refers to,
+                       // 0 if not known. Lets a reader that takes no
+                       // lock check that the index and data file it
+                       // opened belong together.
+
+  si32 spares[64];
     
   // Minute_posn stores the first chunk position for each minute
   // of the day. If no chunk corresponds to this minute the value is -1
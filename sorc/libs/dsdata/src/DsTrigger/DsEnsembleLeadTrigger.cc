@@ -100,6 +100,7 @@ DsEnsembleLeadTrigger::DsEnsembleLeadTrigger(void) :
   _max_seconds_before_disable(ensembleLeadTrigger::disable_seconds),
   _max_seconds_before_timeout(ensembleLeadTrigger::timeout_seconds),
   _persistant_disable(ensembleLeadTrigger::persistant_disable),
+  _member_events(false),
   _gen_time(-1),
   _real_time_0(-1)
 {
@@ -115,6 +116,7 @@ DsEnsembleLeadTrigger(const vector<string> &url,
   _max_seconds_before_disable(ensembleLeadTrigger::disable_seconds),
   _max_seconds_before_timeout(ensembleLeadTrigger::timeout_seconds),
   _persistant_disable(ensembleLeadTrigger::persistant_disable),
+  _member_events(false),
   _gen_time(-1),
   _real_time_0(-1)
 {
@@ -140,6 +142,7 @@ DsEnsembleLeadTrigger::DsEnsembleLeadTrigger(const time_t &t0,
   _max_seconds_before_disable(ensembleLeadTrigger::disable_seconds),
   _max_seconds_before_timeout(ensembleLeadTrigger::timeout_seconds),
   _persistant_disable(ensembleLeadTrigger::persistant_disable),
+  _member_events(false),
   _gen_time(-1),
   _real_time_0(-1)
 {
@@ -171,29 +174,89 @@ DsEnsembleLeadTrigger::setPersistantDisable(const bool status)
   _persistant_disable = status;
 }
   
+//------------------------------------------------------------------
+void DsEnsembleLeadTrigger::setMemberEvents(const bool status)
+{
+  _member_events = status;
+}
+
 //----------------------------------------------------------------
 bool DsEnsembleLeadTrigger::nextTrigger(time_t &t, int &lt,
 					std::vector<std::string> &url,
 					bool &complete)
+{
+  bool member;
+  while (nextTrigger(t, lt, url, complete, member))
+  {
+    if (!member)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------
+bool DsEnsembleLeadTrigger::nextTrigger(time_t &t, int &lt,
+					std::vector<std::string> &url,
+					bool &complete, bool &member)
 {
   if (DsEnsembleAnyTrigger::isArchiveMode())
   {
-    return DsEnsembleAnyTrigger::archiveNextGenLeadTime(t, lt, url, complete);
+    return _archive_next(t, lt, url, complete, member);
   }
   else
   {
-    return _realtime_next(t, lt, url, complete);
+    return _realtime_next(t, lt, url, complete, member);
   }
 }
 
+//----------------------------------------------------------------
+bool DsEnsembleLeadTrigger::_archive_next(time_t &t, int &lt,
+					  std::vector<std::string> &url,
+					  bool &complete, bool &member)
+{
+  if (!_triggered_que.empty())
+  {
+    return _nextQuedTrigger(t, lt, url, complete, member);
+  }
+  member = false;
+  if (!DsEnsembleAnyTrigger::archiveNextGenLeadTime(t, lt, url, complete))
+  {
+    return false;
+  }
+  if (!_member_events)
+  {
+    return true;
+  }
+
+  // each member first, then the lead time
+  for (size_t i=0; i<url.size(); ++i)
+  {
+    Trigger_t ti;
+    ti.t = t;
+    ti.lt = lt;
+    ti.url.push_back(url[i]);
+    ti.member = true;
+    _triggered_que.push_back(ti);
+  }
+  Trigger_t ti;
+  ti.t = t;
+  ti.lt = lt;
+  ti.url = url;
+  ti.complete = complete;
+  _triggered_que.push_back(ti);
+  return _nextQuedTrigger(t, lt, url, complete, member);
+}
+
 //----------------------------------------------------------------
 bool DsEnsembleLeadTrigger::_realtime_next(time_t &t, int &lt,
 					   std::vector<std::string> &url,
-					   bool &complete)
+					   bool &complete, bool &member)
 {
   if (!_triggered_que.empty())
   {
-    if (_nextQuedTrigger(t, lt, url, complete))
+    if (_nextQuedTrigger(t, lt, url, complete, member))
     {
       return true;
     }
@@ -210,7 +273,7 @@ bool DsEnsembleLeadTrigger::_realtime_next(time_t &t, int &lt,
     _add_to_que();
     if (!_triggered_que.empty())
     {
-      return _nextQuedTrigger(t, lt, url, complete);
+      return _nextQuedTrigger(t, lt, url, complete, member);
     }
   }
   return false;
@@ -219,7 +282,7 @@ bool DsEnsembleLeadTrigger::_realtime_next(time_t &t, int &lt,
 //----------------------------------------------------------------
 bool DsEnsembleLeadTrigger::_nextQuedTrigger(time_t &t, int &lt,
 					     std::vector<std::string> &url,
-					     bool &complete)
+					     bool &complete, bool &member)
 {
   if (_triggered_que.empty())
   {
@@ -233,6 +296,7 @@ bool DsEnsembleLeadTrigger::_nextQuedTrigger(time_t &t, int &lt,
   lt = ti.lt;
   url = ti.url;
   complete = ti.complete;
+  member = ti.member;
   return true;
 }
 
@@ -301,6 +365,15 @@ void DsEnsembleLeadTrigger::_process_data(const time_t &t, const int lt,
     // here finally update state for this url at this lead time
     _last_trigger_time[url] = t0;
     _lead_time_state[ind].update(url);
+    if (_member_events)
+    {
+      Trigger_t ti;
+      ti.t = t;
+      ti.lt = lt;
+      ti.url.push_back(url);
+      ti.member = true;
+      _triggered_que.push_back(ti);
+    }
   }
 }
 
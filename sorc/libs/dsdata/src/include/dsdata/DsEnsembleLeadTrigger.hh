@@ -141,6 +141,18 @@ public:
    */
   void setPersistantDisable(const bool status);
 
+  /**
+   * Set whether each ensemble member arrival is also returned, by the
+   * nextTrigger() method that has a member argument. Default false.
+   *
+   * @param[in] status true or false
+   *
+   * When true, each member arriving at a wanted lead time is returned as
+   * its own event, before the event for the lead time it completes, so an
+   * app can process members as they arrive.
+   */
+  void setMemberEvents(const bool status);
+
   /**
    * Return with a triggering generation time/lead time/ set of URLs.
    * This is the main triggering method.
@@ -157,6 +169,24 @@ public:
   bool nextTrigger(time_t &gt, int &lt, std::vector<std::string> &url,
 		   bool &complete);
 
+  /**
+   * Return with a triggering generation time/lead time/ set of URLs, or
+   * with a single member arrival if setMemberEvents(true) was called.
+   *
+   * @param[out] gt  Returned generation time
+   * @param[out] lt  Returned lead time
+   * @param[out] url  List of available URLs at this gen time/lead time,
+   *                  or the one URL that arrived if member=true
+   * @param[out] complete  As with the other nextTrigger(), false if
+   *                       member=true
+   * @param[out] member  True for a single member arrival, false for a
+   *                     lead time that is ready to process
+   *
+   * @return true if values are set, false if there is no more data.
+   */
+  bool nextTrigger(time_t &gt, int &lt, std::vector<std::string> &url,
+		   bool &complete, bool &member);
+
 protected:
 private:
 
@@ -193,6 +223,11 @@ private:
    */
   bool _persistant_disable;
 
+  /**
+   * True to also return single member arrivals, see setMemberEvents()
+   */
+  bool _member_events;
+
   // bool _archive_mode;  /**< True for archive mode, false for real time */
   // time_t _archive_t0;  /**< Earliest time (archive mode) */
   // time_t _archive_t1;  /**< Latest time (archive mode) */
@@ -208,7 +243,8 @@ private:
     int lt;    /**< Lead seconds */
     std::vector<std::string> url;  /**< The URls that have triggered */
     bool complete;  /**< True if all URL's have triggered */
-    Trigger_t() : t(0), lt(0), url(), complete(false) {}
+    bool member;    /**< True for a single member arrival */
+    Trigger_t() : t(0), lt(0), url(), complete(false), member(false) {}
   };
 
   /**
@@ -259,11 +295,13 @@ private:
   //------------------------- methods  --------------------------------------
 
   bool _realtime_next(time_t &t, int &lt, std::vector<std::string> &url,
-  		      bool &complete);
+  		      bool &complete, bool &member);
   // bool _archive_next(time_t &t, int &lt, std::vector<std::string> &url,
   // 		     bool &complete);
+  bool _archive_next(time_t &t, int &lt, std::vector<std::string> &url,
+		     bool &complete, bool &member);
   bool _nextQuedTrigger(time_t &t, int &lt, std::vector<std::string> &url,
-			bool &complete);
+			bool &complete, bool &member);
   void _process(const time_t &t, const int lt, const std::string &url,
 	       const bool &hasData);
   void _process_data(const time_t &t, const int lt, const std::string &url);
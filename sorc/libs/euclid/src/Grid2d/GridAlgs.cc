@@ -36,6 +36,7 @@
 #include <rapmath/AngleCombiner.hh>
 #include <rapmath/FuzzyF.hh>
 #include <toolsa/LogStream.hh>
+#include <toolsa/TaBoxFilter.hh>
 #include <toolsa/TaThreadSimple.hh>
 #include <algorithm>
 #include <cmath>
@@ -1908,29 +1909,26 @@ double GridAlgs::localCenteredAverageNoMissing(int ix, int iy, int sx,
 //----------------------------------------------------------------
 void GridAlgs::smooth(int xw, int yw)
 {
-  // make an object to loop through the grid
-  Grid2dLoopA G(_nx, _ny, xw, yw);
-
-  // make a copy of the local object
-  GridAlgs tmp(*this);
-
-  Grid2dLoopAlgMean A;
+  smooth(xw, yw, false, 1);
+}
 
-  while (G.increment(tmp, A))
+//---------------------------------------------------------------------------
+void GridAlgs::smooth(int xw, int yw, bool xWrap, int numThread)
+{
+  if (_data.empty())
   {
-    int x, y;
-    double result;
-    if (G.getXyAndResult(A, xw*yw/2, x, y, result))
-    {
-      _data[y*_nx + x] = result;
-    }
-    else
-    {
-      _data[y*_nx + x] = _missing;
-    }
+    return;
   }
-}
 
+  // make a copy of the local data
+  vector<double> tmp(_data);
+
+  TaBoxFilter f(xw, yw);
+  f.setMinGood(xw*yw/2);
+  f.setWraparoundX(xWrap);
+  f.setNumThreads(numThread);
+  f.apply(&tmp[0], _nx, _ny, _missing, &_data[0]);
+}
 
 //---------------------------------------------------------------------------
 void GridAlgs::smoothSimple(int sx, int sy)
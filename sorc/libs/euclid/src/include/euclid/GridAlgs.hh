@@ -673,10 +673,11 @@ public:
 
   /**
    * Apply a sx by sy smoothing filter to the local grid.  At each point the
-   * output is set to the mean value within the box centered at the point.
+   * output is set to the mean value within the box centered at the point,
+   * or missing if there are sx*sy/2 or fewer non-missing points in the box.
    *
-   * This version is the fastest algorithm, traverses the grid using
-   * Grid2dLoopA and passing around a Grid2dLoopAlgMean object
+   * This version is the fastest algorithm, a separable running sum box
+   * filter (TaBoxFilter) that costs the same per point for any sx, sy.
    *
    * This is the recommended algorithm to use.
    *
@@ -685,6 +686,18 @@ public:
    */
   void smooth(int sx, int sy);
 
+  /**
+   * Apply a sx by sy smoothing filter to the local grid, as smooth(sx, sy),
+   * optionally with wraparound in x and with threads
+   *
+   * @param[in] sx
+   * @param[in] sy
+   * @param[in] xWrap  True if the grid wraps around in x, so the box at
+   *                   each edge takes in points from the other edge
+   * @param[in] numThread  Number of threads, 1 for none
+   */
+  void smooth(int sx, int sy, bool xWrap, int numThread=1);
+
   /**
    * Apply a sx by sy smoothing filter to the local grid
    *
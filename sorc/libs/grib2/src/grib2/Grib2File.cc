@@ -33,24 +33,49 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <set>
 
 #include <grib2/Grib2File.hh>
+#include <grib2/DS.hh>
 #include <toolsa/file_io.h>
 #include <toolsa/str.h>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/TaThreadSimple.hh>
 
 #define EDITION_LOCATION 7
+#define TOTAL_LENGTH_LOCATION 8
+#define INDICATOR_SECTION_SIZE 16
 #define GRIB2 2
 
 using namespace std;
 
 namespace Grib2 {
 
+/////////////////////////////////////////////
+// threads for unpacking the data of records
+
+class Grib2FileThreads : public TaThreadDoubleQue
+{
+public:
+  Grib2FileThreads() : TaThreadDoubleQue() {}
+  virtual ~Grib2FileThreads() {}
+  TaThread *clone(int index)
+  {
+    TaThreadSimple *t = new TaThreadSimple(index);
+    t->setThreadMethod(Grib2File::unpackDataThread);
+    t->setThreadContext(this);
+    return (TaThread *)t;
+  }
+};
+
 Grib2File::Grib2File()
 {
   _filePath = "";
   _filePtr = NULL;
   _fileContentsRead = false;
   _last_file_action = CONSTRUCT;
+  _nThreads = 1;
+  _threads = NULL;
 }
 
 Grib2File::~Grib2File() 
@@ -68,6 +93,7 @@ Grib2File::~Grib2File()
        ++inventory)
     delete inventory->record;
   
+  delete _threads;
 }
 
 void Grib2File::_setFilePath(const string &new_file_path)
@@ -150,25 +176,11 @@ int Grib2File::read(const string &file_path)
     return GRIB_FAILURE;
   }
 
-  char *uncompressPath = STRdup(_filePath.c_str());
-  char *ext = uncompressPath + strlen(uncompressPath) - 2;
-  if (!strncmp(ext, ".Z", 2)) {
-    *ext = '\0';
-  }
-
-  ext = uncompressPath + strlen(uncompressPath) - 3; 
-  if (!strncmp(ext, ".gz", 3)) {
-    *ext = '\0';
-  }
-
-  ext = uncompressPath + strlen(uncompressPath) - 4;
-  if (!strncmp(ext, ".bz2", 4)) {
-    *ext = '\0';
-  }
+  // Determine the input file size, from the open file since a
+  // compressed file is read from memory
 
-  // Determine the input file size
   struct stat file_stat;
-  if (stat(uncompressPath, &file_stat) != 0)
+  if (fstat(fileno(_filePtr), &file_stat) != 0)
   {
     cerr << "ERROR: " << method_name << endl;
     cerr << "Error stat'ing input GRIB file." << endl;
@@ -202,34 +214,25 @@ int Grib2File::read(const string &file_path)
   fclose(_filePtr);
   _filePtr = 0;
   
-  // Unpack the contents of the GRIB file
+  // Find the messages, then unpack each of them
 
-  ui08 *grib_ptr = grib_contents;
-  int rec_num = 0;
+  vector<ui64> offsets;
+  _scanMessages(grib_contents, file_size, offsets);
+  _inventory.reserve(offsets.size());
 
-  while (grib_ptr < grib_contents + file_size)
+  for (size_t rec_num = 0; rec_num < offsets.size(); rec_num++)
   {
-    bool record_found = false;
-    
-    // some non-standard grib2 records have WMO headers
-    while (grib_ptr < grib_contents + file_size && !record_found) {
-    if (grib_ptr[0] == 'G' &&
-          grib_ptr[1] == 'R' &&
-          grib_ptr[2] == 'I' &&
-          grib_ptr[3] == 'B')
-      {
-        record_found = true;
-        break;
-      }
-     
-      ++grib_ptr;
-    }
- 
-    if (!record_found)
-      break;
+    ui08 *grib_ptr = grib_contents + offsets[rec_num];
 
     file_inventory_t inventory;
 
+    if (file_size - offsets[rec_num] < INDICATOR_SECTION_SIZE) {
+      cerr << "ERROR: " << method_name << endl;
+      cerr << "Incomplete GRIB message at end of file" << endl;
+      delete[] grib_contents;
+      return GRIB_FAILURE;
+    }
+
     ui08 edition_num = grib_ptr[EDITION_LOCATION];
 
     if (edition_num != GRIB2) {
@@ -246,6 +249,7 @@ int Grib2File::read(const string &file_path)
     {
       cerr << "ERROR: " << method_name << endl;
       cerr << "Error unpacking record in grib file" << endl;
+      delete inventory.record;
       delete[] grib_contents;
       return GRIB_FAILURE;
     }
@@ -253,8 +257,6 @@ int Grib2File::read(const string &file_path)
     
     _inventory.push_back(inventory);
 
-    rec_num++;
-
   }
   
   delete [] grib_contents;
@@ -265,6 +267,40 @@ int Grib2File::read(const string &file_path)
   return GRIB_SUCCESS;
 }
 
+void Grib2File::_scanMessages(const ui08 *contents, ui64 size, vector<ui64> &offsets)
+{
+  ui64 pos = 0;
+
+  while (pos + 4 <= size)
+  {
+    // some non-standard grib2 records have WMO headers
+    if (contents[pos] != 'G' ||
+        contents[pos+1] != 'R' ||
+        contents[pos+2] != 'I' ||
+        contents[pos+3] != 'B')
+    {
+      ++pos;
+      continue;
+    }
+
+    offsets.push_back(pos);
+
+    if (size - pos < INDICATOR_SECTION_SIZE ||
+        contents[pos + EDITION_LOCATION] != GRIB2)
+      break;
+
+    // total length of the message, 8 bytes in the Indicator Section
+    ui64 total_len = 0;
+    for (int i = 0; i < 8; i++)
+      total_len = (total_len << 8) | contents[pos + TOTAL_LENGTH_LOCATION + i];
+
+    if (total_len < INDICATOR_SECTION_SIZE || total_len > size - pos)
+      break;
+
+    pos += total_len;
+  }
+}
+
 void Grib2File::printSummary(FILE *stream, int debug) const
 {
   vector< file_inventory_t >::const_iterator inventory;
@@ -356,6 +392,81 @@ vector <Grib2Record::Grib2Sections_t>  Grib2File::getRecords(const string &field
   return recordsFound;
 }
 
+void Grib2File::setNThreads(int nThreads)
+{
+  if (nThreads < 1)
+    nThreads = 1;
+
+  if (nThreads == _nThreads)
+    return;
+
+  delete _threads;
+  _threads = NULL;
+  _nThreads = nThreads;
+
+  if (_nThreads > 1) {
+    _threads = new Grib2FileThreads();
+    _threads->init(_nThreads, false);
+  }
+}
+
+int Grib2File::unpackData(const vector <Grib2Record::Grib2Sections_t> &records)
+{
+  static const string method_name = "Grib2File::unpackData()";
+
+  // One job per data section, all set up before any thread starts.
+  // Repeated sections are unpacked once.
+
+  vector<unpack_job_t> jobs;
+  jobs.reserve(records.size());
+  set<DS *> dataSections;
+
+  for (size_t i = 0; i < records.size(); i++) {
+    DS *ds = records[i].ds;
+    if (ds == NULL || !dataSections.insert(ds).second)
+      continue;
+    unpack_job_t job;
+    job.ds = ds;
+    job.recordNum = i;
+    job.failed = false;
+    jobs.push_back(job);
+  }
+
+  if (_threads == NULL || jobs.size() < 2) {
+    for (size_t i = 0; i < jobs.size(); i++)
+      unpackDataThread(&jobs[i]);
+  } else {
+    for (size_t i = 0; i < jobs.size(); i++)
+      _threads->thread((int) i, &jobs[i]);
+    _threads->waitForThreads();
+  }
+
+  // report in record order
+
+  int return_value = GRIB_SUCCESS;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    if (!jobs[i].failed)
+      continue;
+    const Grib2Record::Grib2Sections_t &record = records[jobs[i].recordNum];
+    cerr << "ERROR: " << method_name << endl;
+    cerr << "Cannot unpack data of record " << jobs[i].recordNum;
+    if (record.summary != NULL)
+      cerr << ", " << record.summary->name << " " << record.summary->levelType
+           << " " << record.summary->levelVal;
+    cerr << endl;
+    return_value = GRIB_FAILURE;
+  }
+
+  return return_value;
+}
+
+void Grib2File::unpackDataThread(void *ti)
+{
+  unpack_job_t *job = (unpack_job_t *) ti;
+  if (job->ds->getData() == NULL)
+    job->failed = true;
+}
+
 void Grib2File::printContents(FILE *stream, Grib2Record::print_sections_t printSec) const
 {
   vector< file_inventory_t >::const_iterator inventory;
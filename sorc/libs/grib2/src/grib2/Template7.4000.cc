@@ -41,12 +41,19 @@
 
 #ifndef NO_JASPER_LIB
 #include <jasper/jasper.h>
+#include <toolsa/TaThread.hh>
 #endif
 
 using namespace std;
 
 namespace Grib2 {
 
+#ifndef NO_JASPER_LIB
+// JasPer before version 3 is not thread safe, so code streams
+// unpacked on several threads are decoded one at a time
+static TaThread::SafeMutex _jasperMutex;
+#endif
+
 
 Template7_pt_4000::Template7_pt_4000(Grib2Record::Grib2Sections_t sectionsPtr)
   : DataTemp(sectionsPtr), jpcminlen(200)
@@ -351,6 +358,8 @@ int Template7_pt_4000::decode_jpeg2000 (char *input, si32 inputSize, si32 *outpu
 
     // jas_init();
 
+    TaThread::LockForScope lock(&_jasperMutex);
+
     //  Create jas_stream_t containing input JPEG200 codestream in memory.
     jpcstream = jas_stream_memopen (input, inputSize);
 
@@ -45,6 +45,7 @@ namespace Grib2 {
 class GribProj;
 class ProdDefTemp;
 class DataRepTemp;
+class Grib2FileThreads;
 
 /** 
  * @class Grib2File
@@ -103,6 +104,25 @@ public:
   vector <Grib2Record::Grib2Sections_t> getRecords (const string &fieldName, const string &level,
 						    const long int &leadTime = -99);
 
+  /** @brief Set the number of threads used by unpackData
+   *  @param[in] nThreads Number of threads, 1 (the default) to unpack on the calling thread */
+  void setNThreads (int nThreads);
+
+  /** @brief Unpack the data of a set of records ahead of use
+   *
+   * The data sections of the records, as returned by getRecords, are decoded
+   * on the threads set by setNThreads, after which ds->getData() returns each
+   * record's data without decoding it.  Use ds->freeData() as usual to
+   * reclaim memory.  Errors are reported in the order of the records once all
+   * of them are done.
+   *
+   * @param[in] records Records to unpack
+   * @return Either Grib2::GRIB_SUCCESS or Grib2::GRIB_FAILURE if any record failed */
+  int unpackData (const vector <Grib2Record::Grib2Sections_t> &records);
+
+  /** @brief Thread method for unpackData */
+  static void unpackDataThread (void *ti);
+
 
 
   /** @brief Begins a new Grib2Record
@@ -245,6 +265,26 @@ private:
 
   /** @brief Internally set the file we are reading */
   void _setFilePath (const string &new_file_path);
+
+  /** @brief Find the start of each message in the file contents
+   *
+   * Any WMO headers between messages are skipped.  The scan stops after
+   * a message that is not GRIB2 or whose length does not fit in the
+   * contents, leaving it for unpack to report. */
+  static void _scanMessages (const ui08 *contents, ui64 size, vector<ui64> &offsets);
+
+  /** @brief Data section of one record for unpackData */
+  typedef struct {
+    DS *ds;
+    size_t recordNum;
+    bool failed;
+  } unpack_job_t;
+
+  /** @brief Number of threads used by unpackData */
+  int _nThreads;
+
+  /** @brief Threads used by unpackData, NULL for none */
+  Grib2FileThreads *_threads;
   
   typedef struct {
 
@@ -0,0 +1,466 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file LogAsyncSink.cc
+ */
+
+#include <toolsa/LogAsyncSink.hh>
+#include <toolsa/LogStream.hh>
+#include <toolsa/LogFile.hh>
+#include <toolsa/Path.hh>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/time.h>
+
+/**
+ * The running sink, used by the signal and exit handlers
+ */
+static LogAsyncSink *sActive = NULL;
+
+/**
+ * Source of LogAsyncSink::_generation values
+ */
+static unsigned long sGeneration = 0;
+
+/**
+ * The calling thread's ring, and the generation of the sink it belongs to
+ */
+static __thread void *tRing = NULL;
+static __thread unsigned long tGeneration = 0;
+
+/**
+ * The fatal signals handled, and the handlers they replaced
+ */
+static const int sNumFatal = 5;
+static const int sFatal[sNumFatal] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+static struct sigaction sOldAction[sNumFatal];
+static bool sHandlersInstalled = false;
+
+/**
+ * Where the fatal signal handler writes, kept up to date with the log
+ * destination outside the handler, and the logfile it is open on if any
+ */
+static int sFatalFd = STDERR_FILENO;
+static std::string sFatalPath;
+
+//----------------------------------------------------------------
+static void sSetFatalFd(void)
+{
+  std::string path;
+  int fd = STDERR_FILENO;
+  if (LOG_STREAM_IS_COUT())
+  {
+    fd = STDOUT_FILENO;
+  }
+  else if (LOG_STREAM_IS_LOGFILE())
+  {
+    path = LogFile::getPointer()->currentPath();
+  }
+  if (path == sFatalPath)
+  {
+    if (path.empty())
+    {
+      __atomic_store_n(&sFatalFd, fd, __ATOMIC_RELEASE);
+    }
+    return;
+  }
+  if (!path.empty())
+  {
+    // as LogFile does when it opens the file
+    Path(path).makeDirRecurse();
+    int logFd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0664);
+    if (logFd < 0)
+    {
+      // try again on the next drain, stdout as in LogState::_log()
+      fd = STDOUT_FILENO;
+      path.clear();
+    }
+    else
+    {
+      fd = logFd;
+    }
+  }
+  int old = __atomic_exchange_n(&sFatalFd, fd, __ATOMIC_ACQ_REL);
+  if (!sFatalPath.empty())
+  {
+    close(old);
+  }
+  sFatalPath = path;
+}
+
+//----------------------------------------------------------------
+static void sSleepMs(int ms)
+{
+  struct timespec ts;
+  ts.tv_sec = ms/1000;
+  ts.tv_nsec = (long)(ms % 1000)*1000000L;
+  nanosleep(&ts, NULL);
+}
+
+//----------------------------------------------------------------
+LogAsyncSink::LogAsyncSink(void) :
+  _running(0),
+  _inFlight(0),
+  _capacity(DEFAULT_CAPACITY),
+  _blockOnFull(0),
+  _flushMs(DEFAULT_FLUSH_MS),
+  _seq(0)
+{
+  _generation = __atomic_add_fetch(&sGeneration, 1, __ATOMIC_RELAXED);
+  pthread_mutex_init(&_ringsMutex, NULL);
+  pthread_mutex_init(&_drainMutex, NULL);
+  pthread_mutex_init(&_wakeMutex, NULL);
+  pthread_cond_init(&_wake, NULL);
+  pthread_key_create(&_ownerKey, _ringOwnerExit);
+}
+
+//----------------------------------------------------------------
+LogAsyncSink::~LogAsyncSink(void)
+{
+  stop();
+  pthread_key_delete(_ownerKey);
+  for (size_t i=0; i<_rings.size(); ++i)
+  {
+    delete _rings[i];
+  }
+  pthread_cond_destroy(&_wake);
+  pthread_mutex_destroy(&_wakeMutex);
+  pthread_mutex_destroy(&_drainMutex);
+  pthread_mutex_destroy(&_ringsMutex);
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::start(int capacity, bool blockOnFull, int flushMs)
+{
+  _capacity = capacity > 0 ? capacity : DEFAULT_CAPACITY;
+  _blockOnFull = blockOnFull ? 1 : 0;
+  _flushMs = flushMs > 0 ? flushMs : DEFAULT_FLUSH_MS;
+  if (isRunning())
+  {
+    return;
+  }
+
+  if (!sHandlersInstalled)
+  {
+    for (int i=0; i<sNumFatal; ++i)
+    {
+      struct sigaction act;
+      memset(&act, 0, sizeof(act));
+      act.sa_handler = _fatalSignal;
+      sigemptyset(&act.sa_mask);
+      sigaction(sFatal[i], &act, &sOldAction[i]);
+    }
+    atexit(_atExit);
+    sHandlersInstalled = true;
+  }
+  sSetFatalFd();
+
+  __atomic_store_n(&_running, 1, __ATOMIC_RELEASE);
+  if (pthread_create(&_writer, NULL, _writerMain, this) != 0)
+  {
+    __atomic_store_n(&_running, 0, __ATOMIC_RELEASE);
+    return;
+  }
+  sActive = this;
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::stop(void)
+{
+  if (!isRunning())
+  {
+    return;
+  }
+  __atomic_store_n(&_running, 0, __ATOMIC_RELEASE);
+  _signal();
+  pthread_join(_writer, NULL);
+
+  // let any push() that saw the sink running finish queueing
+  while (__atomic_load_n(&_inFlight, __ATOMIC_ACQUIRE) > 0)
+  {
+    sSleepMs(1);
+  }
+  _drain();
+  if (sActive == this)
+  {
+    sActive = NULL;
+  }
+}
+
+//----------------------------------------------------------------
+bool LogAsyncSink::push(const std::string &msg, const bool droppable)
+{
+  __atomic_add_fetch(&_inFlight, 1, __ATOMIC_ACQ_REL);
+  if (!isRunning())
+  {
+    __atomic_sub_fetch(&_inFlight, 1, __ATOMIC_ACQ_REL);
+    return false;
+  }
+
+  Ring *r = _threadRing();
+  unsigned long capacity = r->_slots.size();
+  unsigned long tail = r->_tail;
+  unsigned long head = __atomic_load_n(&r->_head, __ATOMIC_ACQUIRE);
+  while (tail - head >= capacity)
+  {
+    if (droppable && !_blockOnFull)
+    {
+      __atomic_add_fetch(&r->_dropped, 1, __ATOMIC_RELAXED);
+      __atomic_sub_fetch(&_inFlight, 1, __ATOMIC_ACQ_REL);
+      return true;
+    }
+    _signal();
+    sSleepMs(1);
+    if (!isRunning())
+    {
+      // stopping, the caller writes it synchronously
+      __atomic_sub_fetch(&_inFlight, 1, __ATOMIC_ACQ_REL);
+      return false;
+    }
+    head = __atomic_load_n(&r->_head, __ATOMIC_ACQUIRE);
+  }
+
+  Entry &e = r->_slots[tail % capacity];
+  e._seq = __atomic_fetch_add(&_seq, 1, __ATOMIC_RELAXED);
+  e._msg = msg;
+  __atomic_store_n(&r->_tail, tail + 1, __ATOMIC_RELEASE);
+
+  if ((tail + 1 - head)*4 >= capacity*3)
+  {
+    // getting full, don't wait for the interval
+    _signal();
+  }
+  __atomic_sub_fetch(&_inFlight, 1, __ATOMIC_ACQ_REL);
+  return true;
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::flush(void)
+{
+  _drain();
+}
+
+//----------------------------------------------------------------
+LogAsyncSink::Ring *LogAsyncSink::_threadRing(void)
+{
+  if (tRing != NULL && tGeneration == _generation)
+  {
+    return static_cast<Ring *>(tRing);
+  }
+
+  Ring *r = NULL;
+  pthread_mutex_lock(&_ringsMutex);
+  for (size_t i=0; i<_rings.size(); ++i)
+  {
+    // reuse an empty ring left by a thread that has exited
+    Ring *ri = _rings[i];
+    if (__atomic_load_n(&ri->_owned, __ATOMIC_ACQUIRE) == 0 &&
+	__atomic_load_n(&ri->_head, __ATOMIC_ACQUIRE) == ri->_tail)
+    {
+      r = ri;
+      break;
+    }
+  }
+  if (r == NULL)
+  {
+    r = new Ring();
+    r->_slots.resize(_capacity);
+    r->_head = r->_tail = r->_dropped = 0;
+    _rings.push_back(r);
+  }
+  __atomic_store_n(&r->_owned, 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&_ringsMutex);
+
+  pthread_setspecific(_ownerKey, r);
+  tRing = r;
+  tGeneration = _generation;
+  return r;
+}
+
+//----------------------------------------------------------------
+static bool sLessSeq(const std::pair<unsigned long, std::string *> &a,
+		     const std::pair<unsigned long, std::string *> &b)
+{
+  return a.first < b.first;
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::_drain(void)
+{
+  pthread_mutex_lock(&_drainMutex);
+
+  pthread_mutex_lock(&_ringsMutex);
+  std::vector<Ring *> rings = _rings;
+  pthread_mutex_unlock(&_ringsMutex);
+
+  // take the messages out of the rings, then free the slots
+  std::vector<std::string> msgs;
+  std::vector<std::pair<unsigned long, std::string *> > order;
+  unsigned long dropped = 0;
+  for (size_t i=0; i<rings.size(); ++i)
+  {
+    Ring *r = rings[i];
+    unsigned long capacity = r->_slots.size();
+    unsigned long head = r->_head;
+    unsigned long tail = __atomic_load_n(&r->_tail, __ATOMIC_ACQUIRE);
+    for (unsigned long k=head; k<tail; ++k)
+    {
+      Entry &e = r->_slots[k % capacity];
+      order.push_back(std::pair<unsigned long, std::string *>(e._seq, NULL));
+      msgs.push_back(std::string());
+      msgs.back().swap(e._msg);
+    }
+    __atomic_store_n(&r->_head, tail, __ATOMIC_RELEASE);
+    dropped += __atomic_exchange_n(&r->_dropped, 0, __ATOMIC_ACQ_REL);
+  }
+  for (size_t i=0; i<msgs.size(); ++i)
+  {
+    order[i].second = &msgs[i];
+  }
+
+  if (!order.empty() || dropped > 0)
+  {
+    std::sort(order.begin(), order.end(), sLessSeq);
+    std::string batch;
+    for (size_t i=0; i<order.size(); ++i)
+    {
+      if (i > 0)
+      {
+	batch += "\n";
+      }
+      batch += *order[i].second;
+    }
+    if (dropped > 0)
+    {
+      char buf[100];
+      sprintf(buf, "WARNING LogAsyncSink dropped %lu messages, buffer full",
+	      dropped);
+      if (!batch.empty())
+      {
+	batch += "\n";
+      }
+      batch += buf;
+    }
+    LogState::getPointer()->_log(batch);
+  }
+
+  pthread_mutex_unlock(&_drainMutex);
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::_signal(void)
+{
+  pthread_mutex_lock(&_wakeMutex);
+  pthread_cond_signal(&_wake);
+  pthread_mutex_unlock(&_wakeMutex);
+}
+
+//----------------------------------------------------------------
+void *LogAsyncSink::_writerMain(void *sink)
+{
+  LogAsyncSink *s = static_cast<LogAsyncSink *>(sink);
+  while (s->isRunning())
+  {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    long nsec = now.tv_usec*1000L + (long)(s->_flushMs % 1000)*1000000L;
+    struct timespec until;
+    until.tv_sec = now.tv_sec + s->_flushMs/1000 + nsec/1000000000L;
+    until.tv_nsec = nsec % 1000000000L;
+
+    pthread_mutex_lock(&s->_wakeMutex);
+    if (s->isRunning())
+    {
+      pthread_cond_timedwait(&s->_wake, &s->_wakeMutex, &until);
+    }
+    pthread_mutex_unlock(&s->_wakeMutex);
+    s->_drain();
+
+    // follows setLogFile() and the daily logfile change
+    sSetFatalFd();
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::_ringOwnerExit(void *ring)
+{
+  Ring *r = static_cast<Ring *>(ring);
+  __atomic_store_n(&r->_owned, 0, __ATOMIC_RELEASE);
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::_fatalSignal(int sig)
+{
+  LogAsyncSink *s = sActive;
+  if (s != NULL)
+  {
+    sActive = NULL;
+    __atomic_store_n(&s->_running, 0, __ATOMIC_RELEASE);
+
+    // no locks or allocation here, write straight to the descriptor
+    // set up by sSetFatalFd()
+    int fd = __atomic_load_n(&sFatalFd, __ATOMIC_ACQUIRE);
+    for (size_t i=0; i<s->_rings.size(); ++i)
+    {
+      Ring *r = s->_rings[i];
+      unsigned long capacity = r->_slots.size();
+      unsigned long tail = __atomic_load_n(&r->_tail, __ATOMIC_ACQUIRE);
+      for (unsigned long k=r->_head; k<tail; ++k)
+      {
+	const std::string &msg = r->_slots[k % capacity]._msg;
+	if (write(fd, msg.data(), msg.size()) < 0 || write(fd, "\n", 1) < 0)
+	{
+	  break;
+	}
+      }
+      r->_head = tail;
+    }
+  }
+
+  for (int i=0; i<sNumFatal; ++i)
+  {
+    if (sFatal[i] == sig)
+    {
+      sigaction(sig, &sOldAction[i], NULL);
+      break;
+    }
+  }
+  raise(sig);
+}
+
+//----------------------------------------------------------------
+void LogAsyncSink::_atExit(void)
+{
+  if (sActive != NULL)
+  {
+    sActive->stop();
+  }
+}
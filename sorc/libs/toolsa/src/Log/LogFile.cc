@@ -157,6 +157,32 @@ void LogFile::finish(void)
   pthread_mutex_unlock(&_printMutex);
 }
 
+//----------------------------------------------------------------
+std::string LogFile::currentPath(void)
+{
+  string path, fullpath;
+  pthread_mutex_lock(&_printMutex);
+  if (!_logPath.empty())
+  {
+    DateTime dt(time(0));
+    _path(dt.getYear(), dt.getMonth(), dt.getDay(), path, fullpath);
+  }
+  pthread_mutex_unlock(&_printMutex);
+  return fullpath;
+}
+
+//----------------------------------------------------------------
+void LogFile::_path(int year, int month, int day, std::string &dir,
+		    std::string &fullpath) const
+{
+  char buf[1000];
+  sprintf(buf,"%s/%04d%02d%02d", _logPath.c_str(), year, month, day);
+  dir = buf;
+  sprintf(buf, "%s.%s.Log", _app.c_str(), _instance.c_str());
+  fullpath = dir + "/";
+  fullpath = fullpath + buf;
+}
+
 //----------------------------------------------------------------
 bool LogFile::logFileLog(const std::string &s)
 {
@@ -188,15 +214,10 @@ bool LogFile::logFileLog(const std::string &s)
 
   if (redo)
   {
-    char buf[1000];
-    sprintf(buf,"%s/%04d%02d%02d", _logPath.c_str(), year, month, day);
-    string path = buf;
-    sprintf(buf, "%s.%s.Log", _app.c_str(), _instance.c_str());
-    string fname = buf;
-    Path p(path, fname);
+    string path, fullpath;
+    _path(year, month, day, path, fullpath);
+    Path p(fullpath);
     p.makeDirRecurse();
-    string fullpath = path + "/";
-    fullpath = fullpath + fname;
     _logFileYear = year;
     _logFileMonth = month;
     _logFileDay = day;
@@ -42,11 +42,28 @@ using std::ofstream;
  */
 static LogState *_state = NULL;
 
+/**
+ * Defaults, in enum order, matching the LogState constructor
+ */
+int LogState::_fastEnabled[LogStream::TRIGGER+1] =
+{
+  1, // DEBUG
+  0, // DEBUG_VERBOSE
+  1, // ERROR
+  1, // FATAL
+  1, // FORCE
+  1, // PRINT
+  1, // SEVERE
+  1, // WARNING
+  0  // TRIGGER
+};
+
 //----------------------------------------------------------------
 LogStream::LogStream(const std::string &fname, const int line,
 		     const std::string &method, Log_t logT)
 {
   _active = LOG_STREAM_IS_ENABLED(logT);
+  _droppable = LogState::isDroppable(logT);
   if (_active)
   {
     string severityString = setSeverityString(logT);
@@ -61,6 +78,7 @@ LogStream::LogStream(const std::string &fname, const int line,
   // if the named type is not present, add it now and disable it
   LOG_STREAM_ADD_CUSTOM_TYPE_IF_NEW(name);
   _active = LOG_STREAM_IS_ENABLED(name);
+  _droppable = true;
   if (_active)
   {
     _setHeader(name, fname, line, method);
@@ -73,6 +91,7 @@ LogStream::LogStream(const std::string &fname, const int line,
 {
   // go with FORCE as the default
   _active = true;
+  _droppable = false;
   if (_active)
   {
     string severityString = setSeverityString(FORCE);
@@ -85,24 +104,7 @@ LogStream::~LogStream()
 {
   if (_active)
   {
-    LOG_STREAM_LOCK();
-    if (LOG_STREAM_IS_COUT())
-    {
-      std::cout << _buf.str() << std::endl;
-    }
-    else if (LOG_STREAM_IS_CERR())
-    {
-      std::cerr << _buf.str() << std::endl;
-    }
-    else
-    {
-      if (!LOG_STREAM_LOGFILE_LOG(_buf.str()))
-      {
-	// backup to stdout if the other fails
-	std::cout << _buf.str() << std::endl;
-      }
-    }
-    LOG_STREAM_UNLOCK();
+    LogState::getPointer()->write(_buf.str(), _droppable);
   }
 }
 
@@ -237,21 +239,23 @@ LogState::LogState() :
   _logOutputType(COUT),
   _accumBuf("")
 {
-  _enabled[LogStream::DEBUG] = true;
-  _enabled[LogStream::DEBUG_VERBOSE] = false;
-  _enabled[LogStream::ERROR] = true;
-  _enabled[LogStream::WARNING] = true;
-  _enabled[LogStream::FATAL] = true;
-  _enabled[LogStream::FORCE] = true;
-  _enabled[LogStream::SEVERE] = true;
-  _enabled[LogStream::PRINT] = true;
-  _enabled[LogStream::TRIGGER] = false;
+  _setEnabled(LogStream::DEBUG, true);
+  _setEnabled(LogStream::DEBUG_VERBOSE, false);
+  _setEnabled(LogStream::ERROR, true);
+  _setEnabled(LogStream::WARNING, true);
+  _setEnabled(LogStream::FATAL, true);
+  _setEnabled(LogStream::FORCE, true);
+  _setEnabled(LogStream::SEVERE, true);
+  _setEnabled(LogStream::PRINT, true);
+  _setEnabled(LogStream::TRIGGER, false);
   pthread_mutex_init(&_printMutex, NULL);
 }
 
 //----------------------------------------------------------------
 LogState::~LogState()
 {
+  // write anything still queued while the rest of the state is intact
+  _async.stop();
   pthread_mutex_destroy(&_printMutex);
   if (_logOutputType == LOGFILE)
   {
@@ -290,7 +294,7 @@ void LogState::logprint(LogStream::Log_t severity,
   }
   msg += buf;
 
-  _log(msg);
+  write(msg, isDroppable(severity));
 }
 
 
@@ -331,7 +335,51 @@ void LogState::logAccum(const std::string &fname, const int line,
   msg = _header(fname, line, method, severity);
   msg += _accumBuf;
   _accumBuf.clear();
-  _log(msg);
+  write(msg, isDroppable(severity));
+}
+
+//----------------------------------------------------------------
+void LogState::setAsync(const bool state, const int capacity,
+			const bool blockOnFull, const int flushMs)
+{
+  if (state)
+  {
+    _async.start(capacity, blockOnFull, flushMs);
+  }
+  else
+  {
+    _async.stop();
+  }
+}
+
+//----------------------------------------------------------------
+void LogState::flush(void)
+{
+  _async.flush();
+}
+
+//----------------------------------------------------------------
+void LogState::write(const std::string &msg, const bool droppable)
+{
+  if (!_async.push(msg, droppable))
+  {
+    _log(msg);
+  }
+}
+
+//----------------------------------------------------------------
+bool LogState::isDroppable(const LogStream::Log_t logT)
+{
+  switch (logT)
+  {
+  case LogStream::DEBUG:
+  case LogStream::DEBUG_VERBOSE:
+  case LogStream::PRINT:
+  case LogStream::TRIGGER:
+    return true;
+  default:
+    return false;
+  }
 }
 
 //----------------------------------------------------------------
@@ -357,6 +405,13 @@ void LogState::_log(const std::string &msg)
   LOG_STREAM_UNLOCK();
 }
 
+//----------------------------------------------------------------
+void LogState::_setEnabled(const LogStream::Log_t severity, const bool state)
+{
+  _enabled[severity] = state;
+  __atomic_store_n(&_fastEnabled[severity], state ? 1 : 0, __ATOMIC_RELAXED);
+}
+
 //----------------------------------------------------------------
 std::string LogState::_header(const std::string &fname, const int line,
 			      const std::string &method,
@@ -396,7 +451,7 @@ void LogState::setLogging(const LogStream::Log_t severity, const bool state)
     // take no action, these cannot be disabled
     return;  
   }
-  _enabled[severity] = state;
+  _setEnabled(severity, state);
 }
 
 //----------------------------------------------------------------
@@ -454,13 +509,13 @@ bool LogState::isEnabled(const std::string &name) const
 //----------------------------------------------------------------
 void LogState::setVerbose(void)
 {
-  _enabled[LogStream::DEBUG_VERBOSE] = true;
+  _setEnabled(LogStream::DEBUG_VERBOSE, true);
 }
 
 //----------------------------------------------------------------
 void LogState::clearVerbose(void)
 {
-  _enabled[LogStream::DEBUG_VERBOSE] = false;
+  _setEnabled(LogStream::DEBUG_VERBOSE, false);
 }
 
 //----------------------------------------------------------------
@@ -0,0 +1,953 @@
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/* ** Copyright UCAR (c) 1990 - 2016                                         */
+/* ** University Corporation for Atmospheric Research (UCAR)                 */
+/* ** National Center for Atmospheric Research (NCAR)                        */
+/* ** Boulder, Colorado, USA                                                 */
+/* ** BSD licence applies - redistribution and use in source and binary      */
+/* ** forms, with or without modification, are permitted provided that       */
+/* ** the following conditions are met:                                      */
+/* ** 1) If the software is modified to produce derivative works,            */
+/* ** such modified software should be clearly marked, so as not             */
+/* ** to confuse it with the version available from UCAR.                    */
+/* ** 2) Redistributions of source code must retain the above copyright      */
+/* ** notice, this list of conditions and the following disclaimer.          */
+/* ** 3) Redistributions in binary form must reproduce the above copyright   */
+/* ** notice, this list of conditions and the following disclaimer in the    */
+/* ** documentation and/or other materials provided with the distribution.   */
+/* ** 4) Neither the name of UCAR nor the names of its contributors,         */
+/* ** if any, may be used to endorse or promote products derived from        */
+/* ** this software without specific prior written permission.               */
+/* ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  */
+/* ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      */
+/* ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    */
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/**********************************************************************
+ * file_decompress.c
+ *
+ * Decompression of whole compressed files into memory, or into a
+ * stream as the data is decompressed, for reading them without
+ * uncompressing them on disk.
+ *
+ * The format is decided from the leading bytes of the file:
+ *
+ *   gzip       1f 8b          zlib
+ *   bzip2      'B' 'Z' 'h'    libbz2
+ *   compress   1f 9d          LZW, decoded here
+ *   LZ4        04 22 4d 18    LZ4 frame format, decoded here
+ *   zstd       28 b5 2f fd    libzstd, if built with -DHAVE_ZSTD
+ *
+ * Concatenated gzip members, bzip2 streams and LZ4 / zstd frames are
+ * all read, as the command line tools do.
+ *
+ **********************************************************************/
+
+#include <toolsa/compress.h>
+#include <toolsa/mem.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <bzlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define READ_CHUNK 65536
+
+/*
+ * writing to a stream, the output buffer is flushed once it holds
+ * this much, keeping the last LZ4_HISTORY bytes for LZ4 matches
+ */
+
+#define OUT_FLUSH_LEN (4 * READ_CHUNK)
+#define LZ4_HISTORY 65536
+
+/*
+ * output buffer, grown as data is decompressed, or flushed to fp
+ * if that is set
+ */
+
+typedef struct {
+  unsigned char *buf;
+  size_t len;
+  size_t alloc;
+  FILE *fp;
+  int write_errno;
+} out_buf_t;
+
+static int decompress_file(const char *path, out_buf_t *out);
+static int out_reserve(out_buf_t *out, size_t nbytes);
+static int out_append(out_buf_t *out, const void *data, size_t nbytes);
+static int out_flush(out_buf_t *out, size_t keep);
+static int map_whole_file(FILE *in, unsigned char **buf_p, size_t *len_p);
+static int gunzip_file(FILE *in, out_buf_t *out);
+static int bunzip2_file(FILE *in, out_buf_t *out);
+static int unlzw_buf(const unsigned char *in, size_t in_len, out_buf_t *out);
+static int unlz4_buf(const unsigned char *in, size_t in_len, out_buf_t *out);
+#ifdef HAVE_ZSTD
+static int unzstd_file(FILE *in, out_buf_t *out);
+#endif
+
+/**********************************************************************
+ * ta_file_compression_type()
+ *
+ * Returns the compression type of a file, from its leading bytes.
+ */
+
+ta_file_compression_t ta_file_compression_type(const char *path)
+
+{
+
+  unsigned char magic[4];
+  size_t nread;
+  FILE *in;
+
+  if ((in = fopen(path, "rb")) == NULL) {
+    return TA_FILE_NOT_COMPRESSED;
+  }
+  nread = fread(magic, 1, 4, in);
+  fclose(in);
+
+  if (nread >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+    return TA_FILE_GZIP;
+  }
+  if (nread >= 3 && magic[0] == 'B' && magic[1] == 'Z' && magic[2] == 'h') {
+    return TA_FILE_BZIP2;
+  }
+  if (nread >= 2 && magic[0] == 0x1f && magic[1] == 0x9d) {
+    return TA_FILE_COMPRESS;
+  }
+  if (nread == 4 && magic[0] == 0x04 && magic[1] == 0x22 &&
+      magic[2] == 0x4d && magic[3] == 0x18) {
+    return TA_FILE_LZ4;
+  }
+  if (nread == 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+      magic[2] == 0x2f && magic[3] == 0xfd) {
+    return TA_FILE_ZSTD;
+  }
+  return TA_FILE_NOT_COMPRESSED;
+
+}
+
+/**********************************************************************
+ * ta_decompress_file()
+ *
+ * Reads a compressed file and decompresses it into memory. The file
+ * itself is not changed.
+ *
+ * The memory for the uncompressed data is allocated by this routine,
+ * and should be freed by the calling routine using ta_compress_free().
+ *
+ * On success, returns pointer to the uncompressed data and sets
+ * *nbytes_uncompressed_p.
+ *
+ * On failure, returns NULL with errno set: ENOENT etc. if the file
+ * cannot be opened, EINVAL if it is not in a known compressed format,
+ * ENOTSUP for zstd files when built without zstd support, EIO if the
+ * compressed data is corrupt.
+ */
+
+void *ta_decompress_file(const char *path, size_t *nbytes_uncompressed_p)
+
+{
+
+  out_buf_t out;
+  int err;
+
+  out.buf = NULL;
+  out.len = 0;
+  out.alloc = 0;
+  out.fp = NULL;
+  out.write_errno = 0;
+
+  if ((err = decompress_file(path, &out)) != 0) {
+    if (out.buf != NULL) {
+      ufree(out.buf);
+    }
+    errno = err;
+    return NULL;
+  }
+
+  /* always return a valid pointer, even for empty files */
+
+  if (out.buf == NULL && out_reserve(&out, 1)) {
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  *nbytes_uncompressed_p = out.len;
+  return out.buf;
+
+}
+
+/**********************************************************************
+ * ta_decompress_file_to_stream()
+ *
+ * Reads a compressed file and writes the decompressed data to fp as
+ * it goes, so that only a few hundred kbytes are held in memory
+ * whatever the size of the file. The file itself is not changed.
+ *
+ * Returns 0 on success, -1 on failure with errno set as for
+ * ta_decompress_file(), or from the write to fp.
+ */
+
+int ta_decompress_file_to_stream(const char *path, FILE *fp)
+
+{
+
+  out_buf_t out;
+  int err;
+
+  out.buf = NULL;
+  out.len = 0;
+  out.alloc = 0;
+  out.fp = fp;
+  out.write_errno = 0;
+
+  if ((err = decompress_file(path, &out)) == 0 && out_flush(&out, 0)) {
+    err = out.write_errno;
+  }
+  if (out.buf != NULL) {
+    ufree(out.buf);
+  }
+  if (err) {
+    errno = err;
+    return -1;
+  }
+  return 0;
+
+}
+
+/*
+ * decompress path into out, returns 0 or an errno value
+ */
+
+static int decompress_file(const char *path, out_buf_t *out)
+
+{
+
+  ta_file_compression_t type;
+  unsigned char *in_buf = NULL;
+  size_t in_len = 0;
+  FILE *in;
+  int iret = -1;
+
+  type = ta_file_compression_type(path);
+  if (type == TA_FILE_NOT_COMPRESSED) {
+    return EINVAL;
+  }
+#ifndef HAVE_ZSTD
+  if (type == TA_FILE_ZSTD) {
+    return ENOTSUP;
+  }
+#endif
+
+  if ((in = fopen(path, "rb")) == NULL) {
+    return errno;
+  }
+
+  switch (type) {
+    case TA_FILE_GZIP:
+      iret = gunzip_file(in, out);
+      break;
+    case TA_FILE_BZIP2:
+      iret = bunzip2_file(in, out);
+      break;
+    case TA_FILE_COMPRESS:
+      if ((iret = map_whole_file(in, &in_buf, &in_len)) == 0) {
+        iret = unlzw_buf(in_buf, in_len, out);
+      }
+      break;
+    case TA_FILE_LZ4:
+      if ((iret = map_whole_file(in, &in_buf, &in_len)) == 0) {
+        iret = unlz4_buf(in_buf, in_len, out);
+      }
+      break;
+#ifdef HAVE_ZSTD
+    case TA_FILE_ZSTD:
+      iret = unzstd_file(in, out);
+      break;
+#endif
+    default:
+      break;
+  }
+
+  fclose(in);
+  if (in_buf != NULL) {
+    munmap(in_buf, in_len);
+  }
+
+  if (iret) {
+    /* a failed write to the output stream keeps its errno */
+    return out->write_errno ? out->write_errno : EIO;
+  }
+  return 0;
+
+}
+
+/*
+ * make room for nbytes more in the output buffer
+ */
+
+static int out_reserve(out_buf_t *out, size_t nbytes)
+
+{
+  size_t alloc;
+  unsigned char *buf;
+  if (out->fp != NULL && out->len + nbytes > OUT_FLUSH_LEN &&
+      out->len > LZ4_HISTORY) {
+    if (out_flush(out, LZ4_HISTORY)) {
+      return -1;
+    }
+  }
+  if (out->len + nbytes <= out->alloc) {
+    return 0;
+  }
+  alloc = out->alloc < READ_CHUNK ? READ_CHUNK : out->alloc;
+  while (alloc < out->len + nbytes) {
+    alloc *= 2;
+  }
+  if (out->buf == NULL) {
+    buf = (unsigned char *) umalloc(alloc);
+  } else {
+    buf = (unsigned char *) urealloc(out->buf, alloc);
+  }
+  if (buf == NULL) {
+    return -1;
+  }
+  out->buf = buf;
+  out->alloc = alloc;
+  return 0;
+}
+
+static int out_append(out_buf_t *out, const void *data, size_t nbytes)
+
+{
+  if (out_reserve(out, nbytes)) {
+    return -1;
+  }
+  memcpy(out->buf + out->len, data, nbytes);
+  out->len += nbytes;
+  return 0;
+}
+
+/*
+ * write all but the last keep bytes to the output stream
+ */
+
+static int out_flush(out_buf_t *out, size_t keep)
+
+{
+  size_t nbytes;
+  if (out->fp == NULL || out->len <= keep) {
+    return 0;
+  }
+  nbytes = out->len - keep;
+  if (fwrite(out->buf, 1, nbytes, out->fp) != nbytes) {
+    out->write_errno = errno ? errno : EIO;
+    return -1;
+  }
+  memmove(out->buf, out->buf + nbytes, keep);
+  out->len = keep;
+  return 0;
+}
+
+/*
+ * map the whole of an input file, for the formats decoded here
+ */
+
+static int map_whole_file(FILE *in, unsigned char **buf_p, size_t *len_p)
+
+{
+  struct stat in_stat;
+  void *buf;
+  *buf_p = NULL;
+  *len_p = 0;
+  if (fstat(fileno(in), &in_stat)) {
+    return -1;
+  }
+  if (in_stat.st_size == 0) {
+    return 0;
+  }
+  buf = mmap(NULL, (size_t) in_stat.st_size, PROT_READ, MAP_PRIVATE,
+             fileno(in), 0);
+  if (buf == MAP_FAILED) {
+    return -1;
+  }
+  *buf_p = (unsigned char *) buf;
+  *len_p = (size_t) in_stat.st_size;
+  return 0;
+}
+
+/*
+ * gzip, with zlib inflate, restarting for each member
+ */
+
+static int gunzip_file(FILE *in, out_buf_t *out)
+
+{
+
+  unsigned char in_buf[READ_CHUNK];
+  z_stream strm;
+  int ret = Z_OK;
+  int done = 0;
+
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, 15 + 16) != Z_OK) {
+    return -1;
+  }
+
+  while (!done) {
+
+    if (strm.avail_in == 0) {
+      strm.avail_in = (uInt) fread(in_buf, 1, READ_CHUNK, in);
+      strm.next_in = in_buf;
+      if (strm.avail_in == 0) {
+        /* end of file, must be at the end of a member */
+        if (ret != Z_STREAM_END) {
+          inflateEnd(&strm);
+          return -1;
+        }
+        break;
+      }
+    }
+
+    if (ret == Z_STREAM_END) {
+      /* another member follows */
+      if (inflateReset(&strm) != Z_OK) {
+        inflateEnd(&strm);
+        return -1;
+      }
+    }
+
+    do {
+      if (out_reserve(out, READ_CHUNK)) {
+        inflateEnd(&strm);
+        return -1;
+      }
+      strm.next_out = out->buf + out->len;
+      strm.avail_out = READ_CHUNK;
+      ret = inflate(&strm, Z_NO_FLUSH);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+        inflateEnd(&strm);
+        return -1;
+      }
+      out->len += READ_CHUNK - strm.avail_out;
+      if (ret == Z_BUF_ERROR && strm.avail_in > 0 && strm.avail_out > 0) {
+        inflateEnd(&strm);
+        return -1;
+      }
+    } while (strm.avail_out == 0 && ret != Z_STREAM_END);
+
+    /* trailing zero padding after the last member is allowed */
+
+    if (ret == Z_STREAM_END && strm.avail_in > 0 && strm.next_in[0] == 0) {
+      done = 1;
+    }
+
+  }
+
+  inflateEnd(&strm);
+  return 0;
+
+}
+
+/*
+ * bzip2, with libbz2, restarting for each stream
+ */
+
+static int bunzip2_file(FILE *in, out_buf_t *out)
+
+{
+
+  char unused[BZ_MAX_UNUSED];
+  int n_unused = 0;
+  int bzerror;
+  BZFILE *bz;
+
+  while (1) {
+
+    bz = BZ2_bzReadOpen(&bzerror, in, 0, 0, unused, n_unused);
+    if (bzerror != BZ_OK) {
+      BZ2_bzReadClose(&bzerror, bz);
+      return -1;
+    }
+
+    bzerror = BZ_OK;
+    while (bzerror == BZ_OK) {
+      int nread;
+      if (out_reserve(out, READ_CHUNK)) {
+        BZ2_bzReadClose(&bzerror, bz);
+        return -1;
+      }
+      nread = BZ2_bzRead(&bzerror, bz, out->buf + out->len, READ_CHUNK);
+      if (bzerror == BZ_OK || bzerror == BZ_STREAM_END) {
+        out->len += nread;
+      }
+    }
+    if (bzerror != BZ_STREAM_END) {
+      BZ2_bzReadClose(&bzerror, bz);
+      return -1;
+    }
+
+    /* keep the bytes read past the end of this stream */
+
+    {
+      void *unused_tmp;
+      BZ2_bzReadGetUnused(&bzerror, bz, &unused_tmp, &n_unused);
+      if (bzerror != BZ_OK) {
+        BZ2_bzReadClose(&bzerror, bz);
+        return -1;
+      }
+      memcpy(unused, unused_tmp, n_unused);
+    }
+    BZ2_bzReadClose(&bzerror, bz);
+
+    if (n_unused == 0) {
+      int c = getc(in);
+      if (c == EOF) {
+        break;
+      }
+      ungetc(c, in);
+    }
+
+  }
+
+  return 0;
+
+}
+
+/*
+ * compress(1) LZW format.
+ *
+ * Codes are 9 to maxbits bits long, written in groups of 8 codes; when
+ * the code length changes, or on a clear code, the rest of the current
+ * group is padding and is skipped.
+ */
+
+static int unlzw_buf(const unsigned char *in, size_t in_len, out_buf_t *out)
+
+{
+
+  static const int max_max_bits = 16;
+  unsigned short *prefix;
+  unsigned char *suffix;
+  unsigned char *stack;
+  size_t pos, mark;
+  unsigned long buf;
+  int left, bits, max_bits, block, iret = 0;
+  unsigned int mask, end, prev, code, temp;
+  unsigned char final;
+
+  if (in_len < 3 || in[0] != 0x1f || in[1] != 0x9d) {
+    return -1;
+  }
+  max_bits = in[2] & 0x1f;
+  block = in[2] & 0x80;
+  if (max_bits < 9 || max_bits > max_max_bits) {
+    return -1;
+  }
+  if (in_len == 3) {
+    return 0;
+  }
+
+  prefix = (unsigned short *) umalloc(65536 * sizeof(unsigned short));
+  suffix = (unsigned char *) umalloc(65536);
+  stack = (unsigned char *) umalloc(65536);
+
+  /* the first code is a literal, and makes no table entry */
+
+  bits = 9;
+  mask = 0x1ff;
+  end = block ? 256 : 255;
+  pos = 3;
+  mark = 3;
+  if (in_len < 5) {
+    iret = -1;
+    goto done;
+  }
+  buf = in[pos] | ((unsigned long) in[pos + 1] << 8);
+  pos += 2;
+  prev = buf & mask;
+  buf >>= bits;
+  left = 16 - bits;
+  if (prev > 255) {
+    iret = -1;
+    goto done;
+  }
+  final = (unsigned char) prev;
+  if (out_append(out, &final, 1)) {
+    iret = -1;
+    goto done;
+  }
+
+  while (1) {
+
+    /* code length goes up when the table fills, skipping to the end
+     * of the group of codes */
+
+    if (end >= mask && bits < max_bits) {
+      size_t rem = (pos - mark) % bits;
+      if (rem) {
+        pos += bits - rem;
+        if (pos >= in_len) {
+          break;
+        }
+      }
+      buf = 0;
+      left = 0;
+      mark = pos;
+      bits++;
+      mask = (mask << 1) | 1;
+    }
+
+    /* next code */
+
+    if (pos >= in_len) {
+      break;
+    }
+    buf |= (unsigned long) in[pos++] << left;
+    left += 8;
+    if (left < bits) {
+      if (pos >= in_len) {
+        iret = -1;
+        goto done;
+      }
+      buf |= (unsigned long) in[pos++] << left;
+      left += 8;
+    }
+    code = buf & mask;
+    buf >>= bits;
+    left -= bits;
+
+    /* clear code, back to 9 bits and an empty table */
+
+    if (code == 256 && block) {
+      size_t rem = (pos - mark) % bits;
+      if (rem) {
+        pos += bits - rem;
+        if (pos >= in_len) {
+          break;
+        }
+      }
+      buf = 0;
+      left = 0;
+      mark = pos;
+      bits = 9;
+      mask = 0x1ff;
+      end = 255;
+      continue;
+    }
+
+    /* a code one past the table is the previous string plus its
+     * own first byte */
+
+    {
+      unsigned int nstack = 0;
+      temp = code;
+      if (code > end) {
+        if (code != end + 1 || prev > end) {
+          iret = -1;
+          goto done;
+        }
+        stack[nstack++] = final;
+        code = prev;
+      }
+      while (code >= 256) {
+        stack[nstack++] = suffix[code];
+        code = prefix[code];
+      }
+      stack[nstack++] = (unsigned char) code;
+      final = (unsigned char) code;
+
+      if (end < mask) {
+        end++;
+        prefix[end] = (unsigned short) prev;
+        suffix[end] = final;
+      }
+      prev = temp;
+
+      if (out_reserve(out, nstack)) {
+        iret = -1;
+        goto done;
+      }
+      while (nstack > 0) {
+        out->buf[out->len++] = stack[--nstack];
+      }
+    }
+
+  }
+
+ done:
+  ufree(prefix);
+  ufree(suffix);
+  ufree(stack);
+  return iret;
+
+}
+
+/*
+ * LZ4 frame format. Checksums are not verified. Frames that need a
+ * dictionary are not supported.
+ */
+
+static unsigned int get_le32(const unsigned char *p)
+
+{
+  return ((unsigned int) p[0] | ((unsigned int) p[1] << 8) |
+          ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24));
+}
+
+static int unlz4_block(const unsigned char *in, size_t in_len,
+                       out_buf_t *out)
+
+{
+
+  size_t pos = 0;
+
+  while (pos < in_len) {
+
+    unsigned int token = in[pos++];
+    size_t lit_len = token >> 4;
+    size_t match_len, offset;
+
+    if (lit_len == 15) {
+      unsigned int b;
+      do {
+        if (pos >= in_len) {
+          return -1;
+        }
+        b = in[pos++];
+        lit_len += b;
+      } while (b == 255);
+    }
+    if (lit_len > in_len - pos) {
+      return -1;
+    }
+    if (out_append(out, in + pos, lit_len)) {
+      return -1;
+    }
+    pos += lit_len;
+
+    /* the last sequence has literals only */
+
+    if (pos == in_len) {
+      break;
+    }
+
+    if (in_len - pos < 2) {
+      return -1;
+    }
+    offset = in[pos] | ((size_t) in[pos + 1] << 8);
+    pos += 2;
+    if (offset == 0 || offset > out->len) {
+      return -1;
+    }
+
+    match_len = token & 15;
+    if (match_len == 15) {
+      unsigned int b;
+      do {
+        if (pos >= in_len) {
+          return -1;
+        }
+        b = in[pos++];
+        match_len += b;
+      } while (b == 255);
+    }
+    match_len += 4;
+
+    /* matches can overlap the bytes they produce */
+
+    if (out_reserve(out, match_len)) {
+      return -1;
+    }
+    {
+      unsigned char *dst = out->buf + out->len;
+      const unsigned char *src = dst - offset;
+      size_t i;
+      for (i = 0; i < match_len; i++) {
+        dst[i] = src[i];
+      }
+      out->len += match_len;
+    }
+
+  }
+
+  return 0;
+
+}
+
+static int unlz4_buf(const unsigned char *in, size_t in_len, out_buf_t *out)
+
+{
+
+  size_t pos = 0;
+
+  while (pos < in_len) {
+
+    unsigned int magic, flg, block_checksum, content_checksum;
+
+    if (in_len - pos < 4) {
+      return -1;
+    }
+    magic = get_le32(in + pos);
+    pos += 4;
+
+    /* skippable frames */
+
+    if ((magic & 0xfffffff0U) == 0x184d2a50U) {
+      unsigned int skip;
+      if (in_len - pos < 4) {
+        return -1;
+      }
+      skip = get_le32(in + pos);
+      pos += 4;
+      if (skip > in_len - pos) {
+        return -1;
+      }
+      pos += skip;
+      continue;
+    }
+
+    if (magic != 0x184d2204U || in_len - pos < 3) {
+      return -1;
+    }
+
+    /* frame descriptor */
+
+    flg = in[pos];
+    if ((flg >> 6) != 1 || (flg & 0x01)) {
+      return -1;
+    }
+    block_checksum = flg & 0x10;
+    content_checksum = flg & 0x04;
+    pos += 2;
+    if (flg & 0x08) {
+      pos += 8;
+    }
+    pos += 1;
+    if (pos > in_len) {
+      return -1;
+    }
+
+    /* blocks, up to the end mark */
+
+    while (1) {
+      unsigned int block_size;
+      int uncompressed;
+      if (in_len - pos < 4) {
+        return -1;
+      }
+      block_size = get_le32(in + pos);
+      pos += 4;
+      if (block_size == 0) {
+        break;
+      }
+      uncompressed = (block_size & 0x80000000U) != 0;
+      block_size &= 0x7fffffffU;
+      if (block_size > in_len - pos) {
+        return -1;
+      }
+      if (uncompressed) {
+        if (out_append(out, in + pos, block_size)) {
+          return -1;
+        }
+      } else if (unlz4_block(in + pos, block_size, out)) {
+        return -1;
+      }
+      pos += block_size;
+      if (block_checksum) {
+        if (in_len - pos < 4) {
+          return -1;
+        }
+        pos += 4;
+      }
+    }
+    if (content_checksum) {
+      if (in_len - pos < 4) {
+        return -1;
+      }
+      pos += 4;
+    }
+
+  }
+
+  return 0;
+
+}
+
+#ifdef HAVE_ZSTD
+
+/*
+ * zstd, with libzstd streaming decompression
+ */
+
+static int unzstd_file(FILE *in, out_buf_t *out)
+
+{
+
+  unsigned char in_buf[READ_CHUNK];
+  ZSTD_DStream *zds;
+  ZSTD_inBuffer input;
+  size_t ret = 0;
+  size_t nread;
+
+  if ((zds = ZSTD_createDStream()) == NULL) {
+    return -1;
+  }
+  ZSTD_initDStream(zds);
+
+  while ((nread = fread(in_buf, 1, READ_CHUNK, in)) > 0) {
+    input.src = in_buf;
+    input.size = nread;
+    input.pos = 0;
+    while (input.pos < input.size) {
+      ZSTD_outBuffer output;
+      if (out_reserve(out, READ_CHUNK)) {
+        ZSTD_freeDStream(zds);
+        return -1;
+      }
+      output.dst = out->buf + out->len;
+      output.size = READ_CHUNK;
+      output.pos = 0;
+      ret = ZSTD_decompressStream(zds, &output, &input);
+      if (ZSTD_isError(ret)) {
+        ZSTD_freeDStream(zds);
+        return -1;
+      }
+      out->len += output.pos;
+    }
+  }
+
+  /* flush what is left, a non-zero return means a truncated frame */
+
+  while (ret != 0) {
+    ZSTD_outBuffer output;
+    input.src = in_buf;
+    input.size = 0;
+    input.pos = 0;
+    if (out_reserve(out, READ_CHUNK)) {
+      ZSTD_freeDStream(zds);
+      return -1;
+    }
+    output.dst = out->buf + out->len;
+    output.size = READ_CHUNK;
+    output.pos = 0;
+    ret = ZSTD_decompressStream(zds, &output, &input);
+    if (ZSTD_isError(ret) || output.pos == 0) {
+      ZSTD_freeDStream(zds);
+      return -1;
+    }
+    out->len += output.pos;
+  }
+
+  ZSTD_freeDStream(zds);
+  return 0;
+
+}
+
+#endif
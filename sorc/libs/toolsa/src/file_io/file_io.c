@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -35,12 +36,14 @@
 
 #if defined(__linux)
 #include <sys/vfs.h>
+#include <sys/syscall.h>
 #endif
 
 #include <toolsa/umisc.h>
 #include <toolsa/file_io.h>
 #include <toolsa/pmu.h>
 #include <toolsa/str.h>
+#include <toolsa/compress.h>
 
 #ifndef MAX_PATH_LEN
 #define MAX_PATH_LEN 1024
@@ -55,6 +58,14 @@
  */
 
 static int file_uncompress(const char *path);
+static void remove_compress_ext(char *path);
+
+/*
+ * extensions searched for by ta_fopen_uncompress() when reading
+ */
+
+static const char *_compressExts[] = { ".gz", ".bz2", ".Z", ".lz4", ".zst" };
+#define N_COMPRESS_EXTS (sizeof(_compressExts) / sizeof(_compressExts[0]))
 
 /********************************************************
  * ta_fread()
@@ -322,10 +333,43 @@ static int file_uncompress(const char *path)
 
 }
 
+/*******************************************************
+ *
+ * remove_compress_ext()
+ *
+ * Removes any of the extensions ta_fopen_uncompress() looks
+ * for (.gz, .bz2, .Z, .lz4 or .zst) from the path.
+ */
+
+static void remove_compress_ext(char *path)
+
+{
+
+  size_t len = strlen(path);
+  size_t i;
+  
+  for (i = 0; i < N_COMPRESS_EXTS; i++) {
+    size_t extLen = strlen(_compressExts[i]);
+    if (len >= extLen && !strcmp(path + len - extLen, _compressExts[i])) {
+      path[len - extLen] = '\0';
+      return;
+    }
+  }
+
+}
+
 /*********************************************************
  * ta_fopen_uncompress()
  *
- * Uncompresses the file if necessary, then opens it
+ * Opens a file which may be compressed.
+ *
+ * For reading (type "r" or "rb"), if the plain file does not exist
+ * but a .gz, .bz2, .Z, .lz4 or .zst version does, that file is
+ * decompressed into memory with ta_fopen_decompress(). The
+ * compressed file is left as it is.
+ *
+ * For other types, the file is uncompressed on disk if necessary,
+ * then opened.
  *
  * Return is identical to fopen()
  */
@@ -335,15 +379,100 @@ FILE *ta_fopen_uncompress(const char *filename, const char *type)
 {
   FILE *local_file;
   char *filename_copy = STRdup(filename);
-  
-  ta_file_uncompress(filename_copy);
-  local_file = fopen(filename_copy, type);
+  struct stat file_stat;
+  size_t i;
+
+  if (type[0] != 'r' || strchr(type, '+') != NULL) {
+    ta_file_uncompress(filename_copy);
+    local_file = fopen(filename_copy, type);
+    ufree(filename_copy);
+    return local_file;
+  }
+
+  remove_compress_ext(filename_copy);
+  if (stat(filename_copy, &file_stat) == 0) {
+    local_file = fopen(filename_copy, type);
+    ufree(filename_copy);
+    return local_file;
+  }
+
+  for (i = 0; i < N_COMPRESS_EXTS; i++) {
+    char compressed_path[MAX_PATH_LEN];
+    STRncopy(compressed_path, filename_copy, MAX_PATH_LEN);
+    STRconcat(compressed_path, _compressExts[i], MAX_PATH_LEN);
+    if (stat(compressed_path, &file_stat) == 0) {
+      local_file = ta_fopen_decompress(compressed_path);
+      if (local_file == NULL) {
+        fprintf(stderr, "WARNING - could not decompress file: %s\n",
+                compressed_path);
+        fprintf(stderr, "  %s\n", strerror(errno));
+      }
+      ufree(filename_copy);
+      return local_file;
+    }
+  }
 
+  /*
+   * file does not exist, fopen() sets errno
+   */
+
+  local_file = fopen(filename_copy, type);
   ufree(filename_copy);
-  
   return local_file;
 }
 
+/*********************************************************
+ * ta_fopen_decompress()
+ *
+ * Decompresses a compressed file into memory, and opens the
+ * result for reading. The compressed file is not changed.
+ *
+ * The data is written a piece at a time, as it is decompressed,
+ * to an anonymous in-memory file where the system has them
+ * (memfd_create on linux), otherwise to tmpfile(), so fileno(),
+ * fstat(), fseek() etc. work on the returned stream.
+ *
+ * Returns stream positioned at the start, NULL on error with
+ * errno set.
+ */
+
+FILE *ta_fopen_decompress(const char *path)
+
+{
+
+  FILE *fp = NULL;
+  int fd = -1;
+  int err;
+
+#ifdef SYS_memfd_create
+  fd = (int) syscall(SYS_memfd_create, "ta_fopen_decompress", 0);
+  if (fd >= 0) {
+    if ((fp = fdopen(fd, "w+b")) == NULL) {
+      close(fd);
+    }
+  }
+#endif
+  if (fp == NULL) {
+    fp = tmpfile();
+  }
+  if (fp == NULL) {
+    return NULL;
+  }
+
+  /* decompressed a piece at a time straight into the file */
+
+  if (ta_decompress_file_to_stream(path, fp) ||
+      fflush(fp) || fseek(fp, 0L, SEEK_SET)) {
+    err = errno;
+    fclose(fp);
+    errno = err;
+    return NULL;
+  }
+
+  return fp;
+
+}
+
 /*********************************************
  * ta_lock_file()
  *
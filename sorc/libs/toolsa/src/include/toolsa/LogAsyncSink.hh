@@ -0,0 +1,209 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file LogAsyncSink.hh
+ * @brief Asynchronous, batched output of logged messages
+ *
+ * @class LogAsyncSink
+ * @brief Asynchronous, batched output of logged messages
+ *
+ * Each thread that logs gets its own single producer/single consumer ring
+ * buffer, so adding a message takes no lock. A background writer thread
+ * drains all the rings every flush interval (or sooner when a ring is
+ * filling up), merges the messages back into the order they were logged,
+ * and writes them through LogState with one lock and one flush per batch.
+ * The timestamp in each message is set when the message is logged, not
+ * when it is written.
+ *
+ * When a ring is full a droppable message (debug or informational) is
+ * either dropped (counted, and reported in the next batch) or the logging
+ * thread waits for the writer, depending on the overflow policy. For any
+ * other message the logging thread always waits, so warnings and errors
+ * are never lost.
+ *
+ * Everything still queued is written when the sink is stopped, at exit(),
+ * and on the fatal signals SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT
+ * (in that case with write(2) directly to the file descriptor of cout or
+ * cerr, or to a descriptor the sink keeps open on the current logfile,
+ * since the log file stream is not safe to use from a signal handler).
+ *
+ * Normally used through the LogStream macros LOG_STREAM_ASYNC(),
+ * LOG_STREAM_SYNC() and LOG_STREAM_FLUSH().
+ */
+#ifndef LogAsyncSink_HH
+#define LogAsyncSink_HH
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+class LogAsyncSink
+{
+public:
+
+  /**
+   * Default number of messages in each thread's ring buffer
+   */
+  static const int DEFAULT_CAPACITY = 4096;
+
+  /**
+   * Default interval between writes (milliseconds)
+   */
+  static const int DEFAULT_FLUSH_MS = 100;
+
+  /**
+   * Constructor, not running
+   */
+  LogAsyncSink(void);
+
+  /**
+   * Destructor, stops and writes anything queued
+   */
+  ~LogAsyncSink(void);
+
+  /**
+   * Start the writer thread. If already running, only the policy and
+   * flush interval change.
+   *
+   * @param[in] capacity  Messages per thread ring buffer, applies to rings
+   *                      created after the call
+   * @param[in] blockOnFull  True to wait for space when a ring is full,
+   *                         false to drop the message if droppable
+   * @param[in] flushMs  Milliseconds between writes
+   */
+  void start(int capacity, bool blockOnFull, int flushMs);
+
+  /**
+   * Stop the writer thread and write everything queued. Messages logged
+   * after this go out synchronously.
+   */
+  void stop(void);
+
+  /**
+   * @return true if running
+   */
+  inline bool isRunning(void) const
+  {
+    return __atomic_load_n(&_running, __ATOMIC_ACQUIRE) != 0;
+  }
+
+  /**
+   * Queue a message for the writer
+   * @param[in] msg  The fully formed message, no trailing newline
+   * @param[in] droppable  True if the message may be dropped when the ring
+   *                       is full and the policy is not to block
+   * @return false if not running, in which case the caller should write
+   *         the message itself
+   */
+  bool push(const std::string &msg, const bool droppable);
+
+  /**
+   * Write everything queued, from the calling thread
+   */
+  void flush(void);
+
+private:
+
+  /**
+   * @class Entry
+   * @brief One queued message
+   */
+  class Entry
+  {
+  public:
+    unsigned long _seq;  /**< Order in which it was logged, over all threads */
+    std::string _msg;    /**< The message */
+  };
+
+  /**
+   * @class Ring
+   * @brief One thread's ring buffer. The owning thread advances _tail,
+   *        the writer advances _head.
+   */
+  class Ring
+  {
+  public:
+    std::vector<Entry> _slots;  /**< Storage */
+    unsigned long _head;        /**< Next entry to write out */
+    unsigned long _tail;        /**< Next free slot */
+    unsigned long _dropped;     /**< Messages dropped since last batch */
+    int _owned;                 /**< 1 while a live thread owns the ring */
+  };
+
+  int _running;             /**< 1 while the writer thread is running */
+  int _inFlight;            /**< Number of push() calls under way */
+  int _capacity;            /**< Capacity for new rings */
+  int _blockOnFull;         /**< 1 to block, 0 to drop */
+  int _flushMs;             /**< Write interval */
+  unsigned long _seq;       /**< Next sequence number */
+  unsigned long _generation;  /**< Distinguishes sinks for thread locals */
+  std::vector<Ring *> _rings; /**< All rings, never shrinks */
+  pthread_mutex_t _ringsMutex;  /**< Protects _rings */
+  pthread_mutex_t _drainMutex;  /**< Only one drain at a time */
+  pthread_mutex_t _wakeMutex;   /**< Used with _wake */
+  pthread_cond_t _wake;         /**< Wakes the writer early */
+  pthread_t _writer;            /**< The writer thread */
+  pthread_key_t _ownerKey;      /**< Marks a ring unowned at thread exit */
+
+  /**
+   * @return the calling thread's ring, creating or reusing one as needed
+   */
+  Ring *_threadRing(void);
+
+  /**
+   * Move everything queued in all rings out in one batch
+   */
+  void _drain(void);
+
+  /**
+   * Wake the writer thread
+   */
+  void _signal(void);
+
+  /**
+   * Writer thread main loop
+   */
+  static void *_writerMain(void *sink);
+
+  /**
+   * Thread exit hook, marks the ring unowned
+   */
+  static void _ringOwnerExit(void *ring);
+
+  /**
+   * Write anything queued in the running sink, from a signal handler,
+   * then re-raise the signal with the previous handler
+   */
+  static void _fatalSignal(int sig);
+
+  /**
+   * Write anything queued in the running sink at exit()
+   */
+  static void _atExit(void);
+
+  LogAsyncSink(const LogAsyncSink &);
+  LogAsyncSink &operator=(const LogAsyncSink &);
+};
+
+#endif
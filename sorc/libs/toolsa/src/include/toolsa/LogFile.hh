@@ -110,6 +110,12 @@ public:
    */
   bool logFileLog(const std::string &s);
 
+  /**
+   * @return the path of the logfile written to today, empty if no
+   * logfile is set
+   */
+  std::string currentPath(void);
+
 protected:
 
 private:
@@ -130,6 +136,12 @@ private:
   int _logFileMonth;               /**< Current month */
   int _logFileDay;                 /**< Current day */
 
+  /**
+   * Build the logfile directory and full path for a day
+   */
+  void _path(int year, int month, int day, std::string &dir,
+	     std::string &fullpath) const;
+
   /**
    * Constructor
    * Initializes members
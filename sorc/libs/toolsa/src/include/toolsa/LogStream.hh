@@ -170,12 +170,52 @@
  * To free all internal memory and clean up
  *
  *  LOG_STREAM_FINISH()
+ *
+ * ---------------------- asynchronous output ------------------------------
+ *
+ * By default each message is written and flushed, under a lock, by the
+ * thread that logs it. To hand messages to a background writer instead:
+ *
+ *   LOG_STREAM_ASYNC(capacity, blockOnFull)
+ *
+ *       Each thread queues up to capacity messages without locking, the
+ *       writer outputs them in batches in the order logged. When a queue is
+ *       full a DEBUG, DEBUG_VERBOSE, PRINT, TRIGGER or custom type message
+ *       is dropped (blockOnFull=false, the count of dropped messages is
+ *       logged) or the thread waits (blockOnFull=true). For WARNING,
+ *       ERROR, SEVERE, FATAL and FORCE the thread always waits.
+ *       See LogAsyncSink.
+ *
+ *   LOG_STREAM_FLUSH()   write everything queued now
+ *   LOG_STREAM_SYNC()    write everything queued, back to synchronous output
+ *
+ * Queued messages are also written by LOG_STREAM_FINISH(), at exit(), and
+ * on fatal signals.
+ *
+ * ---------------------- cost of disabled messages ------------------------
+ *
+ * LOG(), LOGV() and LOGPRINT() test a cached per type flag before anything
+ * else, so a disabled message builds no LogStream object or header strings,
+ * and its streamed or formatted arguments are not evaluated.
+ *
+ * The fixed types can also be removed at compile time by defining
+ * LOG_STREAM_MIN_LEVEL, for example -DLOG_STREAM_MIN_LEVEL=LOG_STREAM_LEVEL_DEBUG
+ * in LOC_CPPC_CFLAGS strips all LOG(DEBUG_VERBOSE) statements. The levels,
+ * lowest first:
+ *   LOG_STREAM_LEVEL_VERBOSE   everything (the default)
+ *   LOG_STREAM_LEVEL_DEBUG     DEBUG, TRIGGER and above
+ *   LOG_STREAM_LEVEL_WARNING   WARNING and above
+ *   LOG_STREAM_LEVEL_ERROR     ERROR, SEVERE and above
+ *   LOG_STREAM_LEVEL_FATAL     FATAL, FORCE and PRINT only
+ * FORCE and PRINT are never stripped. LOGV(), LOGC() and LOG0 are not
+ * affected by LOG_STREAM_MIN_LEVEL.
  */
 
 #ifndef LOG_S_HH
 #define LOG_S_HH
 
 #include <toolsa/LogFile.hh>
+#include <toolsa/LogAsyncSink.hh>
 #include <map>
 #include <string>
 #include <sstream>
@@ -315,13 +355,63 @@
  */
 #define LOG_STREAM_TO_DEFAULT_LOGFILE(a,i) (LogState::getPointer()->setLogFile((a),(i)))
 
+/**
+ * Compile time levels for LOG_STREAM_MIN_LEVEL
+ */
+#define LOG_STREAM_LEVEL_VERBOSE 0
+#define LOG_STREAM_LEVEL_DEBUG 1
+#define LOG_STREAM_LEVEL_WARNING 2
+#define LOG_STREAM_LEVEL_ERROR 3
+#define LOG_STREAM_LEVEL_FATAL 4
+
+#ifndef LOG_STREAM_MIN_LEVEL
+#define LOG_STREAM_MIN_LEVEL LOG_STREAM_LEVEL_VERBOSE
+#endif
+
+/**
+ * Level of each fixed type, compared to LOG_STREAM_MIN_LEVEL
+ */
+#define LOG_STREAM_RANK_DEBUG_VERBOSE LOG_STREAM_LEVEL_VERBOSE
+#define LOG_STREAM_RANK_DEBUG LOG_STREAM_LEVEL_DEBUG
+#define LOG_STREAM_RANK_TRIGGER LOG_STREAM_LEVEL_DEBUG
+#define LOG_STREAM_RANK_WARNING LOG_STREAM_LEVEL_WARNING
+#define LOG_STREAM_RANK_ERROR LOG_STREAM_LEVEL_ERROR
+#define LOG_STREAM_RANK_SEVERE LOG_STREAM_LEVEL_ERROR
+#define LOG_STREAM_RANK_FATAL LOG_STREAM_LEVEL_FATAL
+#define LOG_STREAM_RANK_FORCE (LOG_STREAM_LEVEL_FATAL+1)
+#define LOG_STREAM_RANK_PRINT (LOG_STREAM_LEVEL_FATAL+1)
+
+/**
+ * True if a fixed type is compiled in and currently enabled
+ * @param[in] s  Logging type enum
+ */
+#define LOG_STREAM_ON(s) (LOG_STREAM_RANK_##s >= LOG_STREAM_MIN_LEVEL && LogState::isEnabledFast(LogStream::s))
+
+/**
+ * Switch to asynchronous output
+ * @param[in] capacity  Messages queued per thread
+ * @param[in] blockOnFull  True to wait when a queue is full, false to drop
+ *                         debug and informational messages
+ */
+#define LOG_STREAM_ASYNC(capacity,blockOnFull) (LogState::getPointer()->setAsync(true,(capacity),(blockOnFull)))
+
+/**
+ * Write everything queued and switch back to synchronous output
+ */
+#define LOG_STREAM_SYNC() (LogState::getPointer()->setAsync(false))
+
+/**
+ * Write everything queued for asynchronous output
+ */
+#define LOG_STREAM_FLUSH() (LogState::getPointer()->flush())
+
 /**
  * Do formatted logging, with inputs:
  * @param[in] s  Logging type enum
  * @param[in] format  a string
  * @param[in] ... optional additional args to go with the format
  */
-#define LOGPRINT(s, ...) (LogState::getPointer()->logprint(LogStream::s, PP_NARG(__VA_ARGS__), __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__))
+#define LOGPRINT(s, ...) (!LOG_STREAM_ON(s) ? (void)0 : LogState::getPointer()->logprint(LogStream::s, PP_NARG(__VA_ARGS__), __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__))
 
 /**
  * Do formatted logging, with inputs:
@@ -329,15 +419,18 @@
  * @param[in] format  a string
  * @param[in] ... optional additional args to go with the format
  */
-#define LOGPRINTV(s, ...) (LogState::getPointer()->logprint(s, PP_NARG(__VA_ARGS__), __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__))
+#define LOGPRINTV(s, ...) (!LogState::isEnabledFast((s)) ? (void)0 : LogState::getPointer()->logprint(s, PP_NARG(__VA_ARGS__), __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__))
 
 
 /**
  * Create a LogStream object to stream to when input is an enum. 
  *
  * @param[in] s  Logging type enum
+ *
+ * If the type is disabled, or below LOG_STREAM_MIN_LEVEL, no object is
+ * created and nothing streamed to it is evaluated.
  */
-#define LOG(s) LogStream(__FILE__, __LINE__, __FUNCTION__, LogStream::s)
+#define LOG(s) !LOG_STREAM_ON(s) ? (void)0 : LogStreamVoidify() & LogStream(__FILE__, __LINE__, __FUNCTION__, LogStream::s)
 
 /**
  * Create a LogStream object to stream to when input is a variable with
@@ -345,7 +438,7 @@
  *
  * @param[in] s  Logging type variable
  */
-#define LOGV(s) LogStream(__FILE__, __LINE__, __FUNCTION__, s)
+#define LOGV(s) !LogState::isEnabledFast((s)) ? (void)0 : LogStreamVoidify() & LogStream(__FILE__, __LINE__, __FUNCTION__, s)
 
 /**
  * Create a LogStream object to stream to for a custom type.
@@ -468,6 +561,7 @@ private:
 
   std::ostringstream _buf;  /**< String stream storage */
   bool _active;             /**< True if logging will actually happen */
+  bool _droppable;          /**< True if the message may be dropped */
 
   void _setHeader(const std::string &severityString, const std::string &fname, 
 		  const int line, const std::string &method,
@@ -476,6 +570,20 @@ private:
 		  const int line, const std::string &method);
 };
 
+/**
+ * @class LogStreamVoidify
+ *
+ * @brief Turns a streamed LogStream expression into void, so LOG() can be
+ *        the second branch of a ?: whose first branch is (void)0.
+ *        Uses &, which binds more loosely than << but more tightly than ?:
+ */
+class LogStreamVoidify
+{
+public:
+  inline LogStreamVoidify(void) {}
+  inline void operator&(const LogStream &) {}
+};
+
 /**
  * @class LogState
  *
@@ -569,6 +677,18 @@ public:
    */
   bool isEnabled(LogStream::Log_t logT) const;
 
+  /**
+   * @return true if input logging type is enabled, read from a cached flag
+   *         without creating the singleton or locking, for use by the LOG()
+   *         macros before any work is done
+   *
+   * @param[in] logT  The type
+   */
+  static inline bool isEnabledFast(LogStream::Log_t logT)
+  {
+    return __atomic_load_n(&_fastEnabled[logT], __ATOMIC_RELAXED) != 0;
+  }
+
   /**
    * @return true if input custom logging type is enabled
    * @return false if it is disabled, or not present
@@ -610,6 +730,46 @@ public:
    */
   void addCustomTypeIfNew(const std::string &s);
 
+  /**
+   * Switch between asynchronous and synchronous output
+   *
+   * @param[in] state  True for asynchronous
+   * @param[in] capacity  Messages queued per thread
+   * @param[in] blockOnFull  True to wait when a queue is full, false to drop
+   * @param[in] flushMs  Milliseconds between asynchronous writes
+   */
+  void setAsync(const bool state,
+		const int capacity=LogAsyncSink::DEFAULT_CAPACITY,
+		const bool blockOnFull=false,
+		const int flushMs=LogAsyncSink::DEFAULT_FLUSH_MS);
+
+  /**
+   * @return true if output is asynchronous
+   */
+  inline bool isAsync(void) const {return _async.isRunning();}
+
+  /**
+   * Write everything queued for asynchronous output
+   */
+  void flush(void);
+
+  /**
+   * Output a fully formed message, queued if asynchronous, otherwise
+   * written now
+   *
+   * @param[in] msg  The message, no trailing newline
+   * @param[in] droppable  True if the message may be dropped when an
+   *                       asynchronous queue is full
+   */
+  void write(const std::string &msg, const bool droppable=false);
+
+  /**
+   * @return true if messages of a logging type may be dropped when an
+   *         asynchronous queue is full, i.e. debug and informational types
+   * @param[in] logT  The logging type
+   */
+  static bool isDroppable(const LogStream::Log_t logT);
+
   /**
    * Lock the mutex member
    */
@@ -711,6 +871,12 @@ private:
    */
   std::map<LogStream::Log_t, bool>  _enabled;
 
+  /**
+   * Copy of _enabled indexed by the enum, read by isEnabledFast().
+   * Static so it holds the defaults before the singleton is created.
+   */
+  static int _fastEnabled[LogStream::TRIGGER+1];
+
   /**
    * State for enabling or disabling custom types, mapped from strings
    */
@@ -747,6 +913,13 @@ private:
    */
   std::string _accumBuf;
 
+  /**
+   * Background writer, used when output is asynchronous
+   */
+  LogAsyncSink _async;
+
+  friend class LogAsyncSink;
+
   /**
    * Constructor, members set to default values
    */
@@ -759,6 +932,13 @@ private:
 
   void _log(const std::string &msg);
 
+  /**
+   * Set the state of a fixed type in _enabled and _fastEnabled
+   * @param[in] severity  The type
+   * @param[in] state  The status to give this type
+   */
+  void _setEnabled(const LogStream::Log_t severity, const bool state);
+
   /**
    * Form the header string based on member settings from inputs
    *
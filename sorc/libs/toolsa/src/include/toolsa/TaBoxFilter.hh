@@ -0,0 +1,188 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file TaBoxFilter.hh
+ * @brief Box (mean) filter over a 2d array, cost independent of box size
+ *
+ * @class TaBoxFilter
+ * @brief Box (mean) filter over a 2d array, cost independent of box size
+ *
+ * The output at x,y is the mean of the non-missing data in the box
+ * [x-sx,x+sx] by [y-sy,y+sy], with points outside the array ignored, or in
+ * x optionally wrapped around (for global lat/lon grids).
+ *
+ * The filter is separable: a pass along each row keeps running sums and
+ * counts as the box slides, then a pass down the columns does the same
+ * with the row results, so each point costs a few adds however large the
+ * box. Both passes split the rows into bands that run in parallel when
+ * more than one thread is asked for.
+ *
+ * A value can be excluded from the means, with the same two modes as
+ * the ConvWx GridData::smooth() method:
+ * - rejectCenterExclude=true: output is the exclude value wherever the
+ *   input is the exclude value.
+ * - rejectCenterExclude=false: output is the exclude value where the box
+ *   has exclude values but no other data.
+ *
+ * Output is missing where the box has minGood or fewer good points.
+ *
+ * @code
+ *   TaBoxFilter f(5, 5);
+ *   f.setWraparoundX(true);
+ *   f.setNumThreads(4);
+ *   f.apply(in, nx, ny, missing, out);
+ * @endcode
+ */
+#ifndef TaBoxFilter_HH
+#define TaBoxFilter_HH
+
+#include <vector>
+
+class TaBoxFilter
+{
+public:
+
+  /**
+   * @param[in] sx  Box half width in x
+   * @param[in] sy  Box half width in y
+   */
+  TaBoxFilter(int sx, int sy);
+
+  /**
+   * Destructor
+   */
+  ~TaBoxFilter(void);
+
+  /**
+   * Exclude a value from the means
+   * @param[in] excludeValue
+   * @param[in] rejectCenterExclude  See the class description
+   */
+  void setExclude(double excludeValue, bool rejectCenterExclude);
+
+  /**
+   * Output is missing unless the box has more than this many good points
+   * @param[in] minGood  Default 0
+   */
+  inline void setMinGood(int minGood) {_minGood = minGood;}
+
+  /**
+   * @param[in] wrap  True if x wraps around, default false
+   */
+  inline void setWraparoundX(bool wrap) {_xWrap = wrap;}
+
+  /**
+   * @param[in] numThreads  Number of threads, default 1 (no threading)
+   */
+  inline void setNumThreads(int numThreads) {_numThreads = numThreads;}
+
+  /**
+   * Filter
+   * @param[in] in  Input, nx*ny values with x varying fastest
+   * @param[in] nx
+   * @param[in] ny
+   * @param[in] missing  Missing data value, for input and output
+   * @param[out] out  Output, nx*ny values, must not be the same as in
+   *
+   * Not to be called concurrently on one object.
+   */
+  void apply(const double *in, int nx, int ny, double missing,
+	     double *out);
+
+  /**
+   * Thread method, one band of rows for one pass
+   * @param[in] ti  Pointer to a TaBoxFilter::Band
+   */
+  static void compute(void *ti);
+
+private:
+
+  /**
+   * @class Band
+   * @brief What one thread does, rows [y0,y1) of one of the two passes
+   */
+  class Band
+  {
+  public:
+    TaBoxFilter *_filter;       /**< The filter */
+    bool _rowPass;              /**< True for the row pass, false columns */
+    int _y0;                    /**< First row */
+    int _y1;                    /**< One past the last row */
+  };
+
+  int _sx;                   /**< Box half width in x */
+  int _sy;                   /**< Box half width in y */
+  bool _isExclude;           /**< True to exclude _excludeValue */
+  double _excludeValue;      /**< The excluded value */
+  bool _rejectCenterExclude; /**< Exclude mode */
+  int _minGood;              /**< Output only where count > _minGood */
+  bool _xWrap;               /**< True if x wraps around */
+  int _numThreads;           /**< Threads to use */
+
+  // state for one apply(), shared by the threads
+  const double *_in; /**< Input */
+  double *_out;      /**< Output */
+  int _nx;           /**< Dimension */
+  int _ny;           /**< Dimension */
+  double _missing;   /**< Missing value */
+  std::vector<double> _rowSum;   /**< Row pass sums */
+  std::vector<int> _rowN;        /**< Row pass good counts */
+  std::vector<int> _rowNexclude; /**< Row pass exclude counts */
+
+  /**
+   * Row pass, sums and counts along x for rows [y0,y1)
+   */
+  void _rows(int y0, int y1);
+
+  /**
+   * Column pass, sums and counts of the row results along y, and the
+   * output, for rows [y0,y1)
+   */
+  void _columns(int y0, int y1);
+
+  /**
+   * Add or remove one input value to running row sums
+   */
+  inline void _add(double v, int sign, double &sum, int &n, int &nex) const
+  {
+    if (v == _missing)
+    {
+      return;
+    }
+    if (_isExclude && v == _excludeValue)
+    {
+      nex += sign;
+    }
+    else
+    {
+      sum += sign*v;
+      n += sign;
+    }
+  }
+
+  TaBoxFilter(const TaBoxFilter &);
+  TaBoxFilter &operator=(const TaBoxFilter &);
+};
+
+#endif
@@ -0,0 +1,195 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1990 - 2016
+// ** University Corporation for Atmospheric Research (UCAR)
+// ** National Center for Atmospheric Research (NCAR)
+// ** Boulder, Colorado, USA
+// ** BSD licence applies - redistribution and use in source and binary
+// ** forms, with or without modification, are permitted provided that
+// ** the following conditions are met:
+// ** 1) If the software is modified to produce derivative works,
+// ** such modified software should be clearly marked, so as not
+// ** to confuse it with the version available from UCAR.
+// ** 2) Redistributions of source code must retain the above copyright
+// ** notice, this list of conditions and the following disclaimer.
+// ** 3) Redistributions in binary form must reproduce the above copyright
+// ** notice, this list of conditions and the following disclaimer in the
+// ** documentation and/or other materials provided with the distribution.
+// ** 4) Neither the name of UCAR nor the names of its contributors,
+// ** if any, may be used to endorse or promote products derived from
+// ** this software without specific prior written permission.
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+/**
+ * @file TaEncodeKernels.hh
+ * @brief Vectorized loops for scale/bias encoding of gridded data
+ *
+ * @class TaEncodeKernels
+ * @brief Vectorized loops for scale/bias encoding of gridded data
+ *
+ * The per point loops behind MDV encoding conversion: float to 8 or 16 bit
+ * integers with a scale and bias, the reverse, min/max scans that skip the
+ * missing and bad values, and replacement of NaN and infinite values.
+ *
+ * Each loop has an AVX2 and an SSE2 version, picked at run time from what
+ * the CPU supports, and a scalar version used elsewhere. All versions give
+ * results bit for bit the same as the scalar one, which is the arithmetic
+ * MdvxField has always used:
+ * - encode: out = (int)((in - bias) / scale + 0.49999), in double,
+ *   then clamped to [minOut, maxOut]
+ * - decode: out = in * scale + bias, in float, set to 0 where its
+ *   magnitude is below a threshold
+ *
+ * The environment variable TA_ENCODE_KERNELS, set to "scalar", "sse2" or
+ * "avx2", caps the version used, for checking one against another.
+ *
+ * @code
+ *   size_t nClamped = TaEncodeKernels::encodeInt8(in, npts, miss, bad,
+ *                                                 scale, bias, 3, 255,
+ *                                                 0, 1, out);
+ * @endcode
+ */
+#ifndef TaEncodeKernels_HH
+#define TaEncodeKernels_HH
+
+#include <dataport/port_types.h>
+#include <cstddef>
+
+class TaEncodeKernels
+{
+public:
+
+  /**
+   * Instruction set levels, in increasing order
+   */
+  typedef enum {
+    SCALAR = 0,
+    SSE2 = 1,
+    AVX2 = 2
+  } level_t;
+
+  /**
+   * @return the level in use
+   */
+  static level_t getLevel(void);
+
+  /**
+   * Cap the level in use, for testing. Levels the CPU does not support
+   * are never used.
+   * @param[in] level
+   */
+  static void setLevel(level_t level);
+
+  /**
+   * Encode float data as 8 bit integers
+   *
+   * @param[in] in  Input, npoints values
+   * @param[in] npoints
+   * @param[in] inMissing  Input missing value, set to outMissing
+   * @param[in] inBad  Input bad value, set to outBad
+   * @param[in] scale
+   * @param[in] bias
+   * @param[in] minOut  Smallest encoded data value
+   * @param[in] maxOut  Largest encoded data value
+   * @param[in] outMissing
+   * @param[in] outBad
+   * @param[out] out  Output, npoints values
+   *
+   * @return number of points clamped to minOut or maxOut
+   */
+  static size_t encodeInt8(const fl32 *in, size_t npoints,
+                           fl32 inMissing, fl32 inBad,
+                           double scale, double bias,
+                           int minOut, int maxOut,
+                           ui08 outMissing, ui08 outBad, ui08 *out);
+
+  /**
+   * Encode float data as 16 bit integers, as encodeInt8()
+   */
+  static size_t encodeInt16(const fl32 *in, size_t npoints,
+                            fl32 inMissing, fl32 inBad,
+                            double scale, double bias,
+                            int minOut, int maxOut,
+                            ui16 outMissing, ui16 outBad, ui16 *out);
+
+  /**
+   * Decode 8 bit integers to floats
+   *
+   * @param[in] in  Input, npoints values
+   * @param[in] npoints
+   * @param[in] inMissing  Input missing value, set to outMissing
+   * @param[in] inBad  Input bad value, set to outBad
+   * @param[in] scale
+   * @param[in] bias
+   * @param[in] zeroThreshold  Decoded values with magnitude below this
+   *                           are set to 0
+   * @param[in] outMissing
+   * @param[in] outBad
+   * @param[out] out  Output, npoints values
+   */
+  static void decodeInt8(const ui08 *in, size_t npoints,
+                         ui08 inMissing, ui08 inBad,
+                         fl32 scale, fl32 bias, double zeroThreshold,
+                         fl32 outMissing, fl32 outBad, fl32 *out);
+
+  /**
+   * Decode 16 bit integers to floats, as decodeInt8()
+   */
+  static void decodeInt16(const ui16 *in, size_t npoints,
+                          ui16 inMissing, ui16 inBad,
+                          fl32 scale, fl32 bias, double zeroThreshold,
+                          fl32 outMissing, fl32 outBad, fl32 *out);
+
+  /**
+   * Minimum and maximum of the data that is not missing or bad
+   *
+   * @param[in] in  Input, npoints values
+   * @param[in] npoints
+   * @param[in] missing
+   * @param[in] bad
+   * @param[in,out] minVal  Initial value in, minimum out
+   * @param[in,out] maxVal  Initial value in, maximum out
+   *
+   * @return number of points that are not missing or bad
+   *
+   * The result is that of the loop
+   *   minVal = MIN(minVal, v); maxVal = MAX(maxVal, v);
+   * over the points in order, including its handling of NaN.
+   */
+  static size_t minMax(const fl32 *in, size_t npoints,
+                       fl32 missing, fl32 bad,
+                       fl32 &minVal, fl32 &maxVal);
+
+  /**
+   * Minimum and maximum, 8 bit data, as above
+   */
+  static size_t minMax(const ui08 *in, size_t npoints,
+                       ui08 missing, ui08 bad,
+                       ui08 &minVal, ui08 &maxVal);
+
+  /**
+   * Minimum and maximum, 16 bit data, as above
+   */
+  static size_t minMax(const ui16 *in, size_t npoints,
+                       ui16 missing, ui16 bad,
+                       ui16 &minVal, ui16 &maxVal);
+
+  /**
+   * Replace NaN and infinite values
+   *
+   * @param[in,out] data  npoints values
+   * @param[in] npoints
+   * @param[in] replacement  Value put in their place
+   *
+   * @return number replaced
+   */
+  static size_t replaceNonFinite(fl32 *data, size_t npoints,
+                                 fl32 replacement);
+
+private:
+
+  TaEncodeKernels(void);
+};
+
+#endif
@@ -72,6 +72,8 @@ public:
   FILE *fopen(const char *path, const char *mode);
 
   // Open and uncompress on the fly
+  // For reading, a compressed file is decompressed into memory
+  // and left as it is - see ta_fopen_uncompress().
   // Returns file pointer on success, NULL on failure.
   // File pointer mostly not needed when using this class.
 
@@ -36,6 +36,8 @@ extern "C" {
 #endif
 
 #include <dataport/port_types.h>
+#include <stddef.h>
+#include <stdio.h>
 
 /*
  * common header for most all compression types except RLE.
@@ -377,6 +379,69 @@ extern void *gunzip_known_len(const void *compressed_buffer,
                               unsigned int nbytes_compressed,
                               unsigned int nbytes_uncompressed);
      
+/******************************************************************
+ * Compressed file routines
+ *
+ * These read whole files written by the gzip, bzip2, compress, lz4
+ * and zstd command line tools, into memory. The files are not changed.
+ *******************************************************************/
+
+typedef enum {
+  TA_FILE_NOT_COMPRESSED = 0,
+  TA_FILE_GZIP =           1,  /* .gz */
+  TA_FILE_BZIP2 =          2,  /* .bz2 */
+  TA_FILE_COMPRESS =       3,  /* .Z */
+  TA_FILE_LZ4 =            4,  /* .lz4, frame format */
+  TA_FILE_ZSTD =           5   /* .zst, needs HAVE_ZSTD */
+} ta_file_compression_t;
+
+/**********************************************************************
+ * ta_file_compression_type()
+ *
+ * Returns the compression type of a file, from its leading bytes
+ * rather than its extension.
+ *
+ * Returns TA_FILE_NOT_COMPRESSED if the file is not compressed in a
+ * known format, or cannot be read.
+ *
+ **********************************************************************/
+
+extern ta_file_compression_t ta_file_compression_type(const char *path);
+
+/**********************************************************************
+ * ta_decompress_file()
+ *
+ * Reads a compressed file and decompresses it into memory.
+ * The format is found using ta_file_compression_type().
+ *
+ * The memory for the uncompressed data buffer is allocated by this routine.
+ * This should be freed by the calling routine using ta_compress_free().
+ *
+ * On success, returns pointer to the uncompressed data buffer.
+ * Also, *nbytes_uncompressed_p is set.
+ *
+ * On failure, returns NULL, with errno set to EINVAL if the file is
+ * not compressed, ENOTSUP for zstd files if the library was built
+ * without HAVE_ZSTD, EIO if the data is corrupt.
+ *
+ **********************************************************************/
+
+extern void *ta_decompress_file(const char *path,
+                                size_t *nbytes_uncompressed_p);
+     
+/**********************************************************************
+ * ta_decompress_file_to_stream()
+ *
+ * As ta_decompress_file(), but the uncompressed data is written to
+ * fp as it is decompressed, without holding the whole of it in memory.
+ *
+ * Returns 0 on success, -1 on failure with errno set as for
+ * ta_decompress_file(), or from the write to fp.
+ *
+ **********************************************************************/
+
+extern int ta_decompress_file_to_stream(const char *path, FILE *fp);
+     
 /******************************************************************
  * RLE routines
  *
@@ -144,13 +144,34 @@ extern int ta_file_uncompress(char *file_path);
 /*********************************************************
  * ta_fopen_uncompress()
  *
- * Uncompresses the file if necessary, then opens it
+ * Opens a file which may be compressed.
+ *
+ * For reading (type "r" or "rb"), if the plain file does not exist
+ * but a .gz, .bz2, .Z, .lz4 or .zst version does, it is decompressed
+ * into memory with ta_fopen_decompress(), leaving the file as it is.
+ * For other types, the file is uncompressed on disk if necessary,
+ * then opened.
  *
  * Return is identical to fopen()
  */
 
 extern FILE *ta_fopen_uncompress(const char *filename, const char *type);
 
+/*********************************************************
+ * ta_fopen_decompress()
+ *
+ * Decompresses a gzip, bzip2, compress, lz4 or zstd file
+ * into memory, and opens the result for reading.
+ * The format is found from the file contents.
+ * The compressed file is not changed.
+ *
+ * The returned stream supports fileno(), fstat() and fseek().
+ *
+ * Returns NULL on error, with errno set.
+ */
+
+extern FILE *ta_fopen_decompress(const char *path);
+
 /*********************************************
  * ta_lock_file()
  *
@@ -0,0 +1,275 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file TaBoxFilter.cc
+ */
+#include <toolsa/TaBoxFilter.hh>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/TaThreadSimple.hh>
+
+/**
+ * @class TaBoxFilterThreads
+ * @brief Instantiation to implement the clone() method
+ */
+class TaBoxFilterThreads : public TaThreadDoubleQue
+{
+public:
+  inline TaBoxFilterThreads(void) : TaThreadDoubleQue() {}
+  inline virtual ~TaBoxFilterThreads(void) {}
+  TaThread *clone(int index)
+  {
+    TaThreadSimple *t = new TaThreadSimple(index);
+    t->setThreadMethod(TaBoxFilter::compute);
+    t->setThreadContext(this);
+    return (TaThread *)t;
+  }
+};
+
+//----------------------------------------------------------------
+static inline int _wrap(int x, int nx)
+{
+  x = x % nx;
+  if (x < 0)
+  {
+    x += nx;
+  }
+  return x;
+}
+
+//----------------------------------------------------------------
+TaBoxFilter::TaBoxFilter(int sx, int sy) :
+  _sx(sx), _sy(sy), _isExclude(false), _excludeValue(0.0),
+  _rejectCenterExclude(true), _minGood(0), _xWrap(false), _numThreads(1),
+  _in(NULL), _out(NULL), _nx(0), _ny(0), _missing(0.0)
+{
+}
+
+//----------------------------------------------------------------
+TaBoxFilter::~TaBoxFilter()
+{
+}
+
+//----------------------------------------------------------------
+void TaBoxFilter::setExclude(double excludeValue, bool rejectCenterExclude)
+{
+  _isExclude = true;
+  _excludeValue = excludeValue;
+  _rejectCenterExclude = rejectCenterExclude;
+}
+
+//----------------------------------------------------------------
+void TaBoxFilter::apply(const double *in, int nx, int ny, double missing,
+			double *out)
+{
+  if (nx <= 0 || ny <= 0)
+  {
+    return;
+  }
+  _in = in;
+  _out = out;
+  _nx = nx;
+  _ny = ny;
+  _missing = missing;
+  _rowSum.resize(nx*ny);
+  _rowN.resize(nx*ny);
+  _rowNexclude.resize(nx*ny);
+
+  int nband = _numThreads;
+  if (nband > ny)
+  {
+    nband = ny;
+  }
+  if (nband <= 1)
+  {
+    _rows(0, ny);
+    _columns(0, ny);
+    return;
+  }
+
+  // each pass needs all of the previous one, so wait in between
+  TaBoxFilterThreads threads;
+  threads.init(nband, false);
+  std::vector<Band> bands(nband);
+  for (int pass=0; pass<2; ++pass)
+  {
+    for (int i=0; i<nband; ++i)
+    {
+      bands[i]._filter = this;
+      bands[i]._rowPass = (pass == 0);
+      bands[i]._y0 = (ny*i)/nband;
+      bands[i]._y1 = (ny*(i+1))/nband;
+      threads.thread(i, &bands[i]);
+    }
+    threads.waitForThreads();
+  }
+}
+
+//----------------------------------------------------------------
+void TaBoxFilter::compute(void *ti)
+{
+  Band *b = static_cast<Band *>(ti);
+  if (b->_rowPass)
+  {
+    b->_filter->_rows(b->_y0, b->_y1);
+  }
+  else
+  {
+    b->_filter->_columns(b->_y0, b->_y1);
+  }
+}
+
+//----------------------------------------------------------------
+void TaBoxFilter::_rows(int y0, int y1)
+{
+  for (int y=y0; y<y1; ++y)
+  {
+    const double *row = _in + y*_nx;
+    double sum = 0.0;
+    int n = 0, nex = 0;
+
+    // the box at x=0
+    if (_xWrap)
+    {
+      for (int x=-_sx; x<=_sx; ++x)
+      {
+	_add(row[_wrap(x, _nx)], 1, sum, n, nex);
+      }
+    }
+    else
+    {
+      for (int x=0; x<=_sx && x<_nx; ++x)
+      {
+	_add(row[x], 1, sum, n, nex);
+      }
+    }
+
+    // slide it along
+    int k = y*_nx;
+    for (int x=0; x<_nx; ++x, ++k)
+    {
+      _rowSum[k] = sum;
+      _rowN[k] = n;
+      _rowNexclude[k] = nex;
+
+      int xa = x + _sx + 1;
+      int xr = x - _sx;
+      if (_xWrap)
+      {
+	_add(row[_wrap(xa, _nx)], 1, sum, n, nex);
+	_add(row[_wrap(xr, _nx)], -1, sum, n, nex);
+      }
+      else
+      {
+	if (xa < _nx)
+	{
+	  _add(row[xa], 1, sum, n, nex);
+	}
+	if (xr >= 0)
+	{
+	  _add(row[xr], -1, sum, n, nex);
+	}
+      }
+      if (n == 0)
+      {
+	// no round off carried across gaps
+	sum = 0.0;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------
+void TaBoxFilter::_columns(int y0, int y1)
+{
+  std::vector<double> sum(_nx, 0.0);
+  std::vector<int> n(_nx, 0), nex(_nx, 0);
+
+  // the box at y0
+  for (int y=y0-_sy; y<=y0+_sy; ++y)
+  {
+    if (y < 0 || y >= _ny)
+    {
+      continue;
+    }
+    int k = y*_nx;
+    for (int x=0; x<_nx; ++x, ++k)
+    {
+      sum[x] += _rowSum[k];
+      n[x] += _rowN[k];
+      nex[x] += _rowNexclude[k];
+    }
+  }
+
+  for (int y=y0; y<y1; ++y)
+  {
+    int k = y*_nx;
+    for (int x=0; x<_nx; ++x, ++k)
+    {
+      if (_isExclude && _rejectCenterExclude && _in[k] == _excludeValue)
+      {
+	_out[k] = _excludeValue;
+      }
+      else if (n[x] > _minGood)
+      {
+	_out[k] = sum[x]/static_cast<double>(n[x]);
+      }
+      else if (n[x] == 0 && _isExclude && !_rejectCenterExclude && nex[x] > 0)
+      {
+	_out[k] = _excludeValue;
+      }
+      else
+      {
+	_out[k] = _missing;
+      }
+    }
+
+    // slide down
+    int ya = y + _sy + 1;
+    int yr = y - _sy;
+    if (ya < _ny)
+    {
+      k = ya*_nx;
+      for (int x=0; x<_nx; ++x, ++k)
+      {
+	sum[x] += _rowSum[k];
+	n[x] += _rowN[k];
+	nex[x] += _rowNexclude[k];
+      }
+    }
+    if (yr >= 0)
+    {
+      k = yr*_nx;
+      for (int x=0; x<_nx; ++x, ++k)
+      {
+	sum[x] -= _rowSum[k];
+	n[x] -= _rowN[k];
+	nex[x] -= _rowNexclude[k];
+	if (n[x] == 0)
+	{
+	  sum[x] = 0.0;
+	}
+      }
+    }
+  }
+}
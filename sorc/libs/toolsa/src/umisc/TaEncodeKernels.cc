@@ -0,0 +1,987 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1990 - 2016
+// ** University Corporation for Atmospheric Research (UCAR)
+// ** National Center for Atmospheric Research (NCAR)
+// ** Boulder, Colorado, USA
+// ** BSD licence applies - redistribution and use in source and binary
+// ** forms, with or without modification, are permitted provided that
+// ** the following conditions are met:
+// ** 1) If the software is modified to produce derivative works,
+// ** such modified software should be clearly marked, so as not
+// ** to confuse it with the version available from UCAR.
+// ** 2) Redistributions of source code must retain the above copyright
+// ** notice, this list of conditions and the following disclaimer.
+// ** 3) Redistributions in binary form must reproduce the above copyright
+// ** notice, this list of conditions and the following disclaimer in the
+// ** documentation and/or other materials provided with the distribution.
+// ** 4) Neither the name of UCAR nor the names of its contributors,
+// ** if any, may be used to endorse or promote products derived from
+// ** this software without specific prior written permission.
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+/**
+ * @file TaEncodeKernels.cc
+ *
+ * The scalar loops are the reference. The vector loops must not change
+ * the order or precision of any arithmetic: encoding converts to double
+ * before subtracting the bias, decoding multiplies and adds as two
+ * rounded float operations (never a fused multiply-add), and the float
+ * min/max falls back to the scalar loop for NaN data, where the result
+ * depends on the order of the points.
+ */
+#include <toolsa/TaEncodeKernels.hh>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+  (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define TA_ENCODE_X86
+#include <immintrin.h>
+#define TA_AVX2 __attribute__((target("avx2")))
+#endif
+
+// No fused multiply-add, even when the target flags allow it (-mfma,
+// -march=native), since the compiler would fuse the scalar and the
+// intrinsic multiply and add differently
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+//----------------------------------------------------------------
+// scalar reference loops
+//----------------------------------------------------------------
+
+template <class T>
+static size_t _encodeScalar(const fl32 *in, size_t npoints,
+                            fl32 inMissing, fl32 inBad,
+                            double scale, double bias,
+                            int minOut, int maxOut,
+                            T outMissing, T outBad, T *out)
+{
+  size_t nClamped = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    fl32 in_val = in[i];
+    if (in_val == inMissing) {
+      out[i] = outMissing;
+    } else if (in_val == inBad) {
+      out[i] = outBad;
+    } else {
+      int out_val = (int) ((in_val - bias) / scale + 0.49999);
+      if (out_val > maxOut) {
+        nClamped++;
+        out[i] = (T) maxOut;
+      } else if (out_val < minOut) {
+        nClamped++;
+        out[i] = (T) minOut;
+      } else {
+        out[i] = (T) out_val;
+      }
+    }
+  }
+  return nClamped;
+}
+
+template <class T>
+static void _decodeScalar(const T *in, size_t npoints,
+                          T inMissing, T inBad,
+                          fl32 scale, fl32 bias, double zeroThreshold,
+                          fl32 outMissing, fl32 outBad, fl32 *out)
+{
+  for (size_t i = 0; i < npoints; i++) {
+    if (in[i] == inMissing) {
+      out[i] = outMissing;
+    } else if (in[i] == inBad) {
+      out[i] = outBad;
+    } else {
+      fl32 outval = ((fl32) in[i] * scale + bias);
+      if (fabs(outval) < zeroThreshold) {
+        out[i] = 0.0;
+      } else {
+        out[i] = outval;
+      }
+    }
+  }
+}
+
+template <class T>
+static size_t _minMaxScalar(const T *in, size_t npoints,
+                            T missing, T bad, T &minVal, T &maxVal)
+{
+  size_t count = 0;
+  T min_val = minVal;
+  T max_val = maxVal;
+  for (size_t i = 0; i < npoints; i++) {
+    T this_val = in[i];
+    if (this_val != missing && this_val != bad) {
+      min_val = ((min_val < this_val) ? min_val : this_val);
+      max_val = ((max_val > this_val) ? max_val : this_val);
+      count++;
+    }
+  }
+  minVal = min_val;
+  maxVal = max_val;
+  return count;
+}
+
+static size_t _replaceNonFiniteScalar(fl32 *data, size_t npoints,
+                                      fl32 replacement)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    if (!std::isfinite(data[i])) {
+      data[i] = replacement;
+      count++;
+    }
+  }
+  return count;
+}
+
+// The smallest float at or above a double threshold, so that for any
+// float x, x < threshold exactly when x < the returned value
+
+static fl32 _floatThreshold(double threshold)
+{
+  fl32 t = (fl32) threshold;
+  if ((double) t < threshold) {
+    t = nextafterf(t, HUGE_VALF);
+  }
+  return t;
+}
+
+#ifdef TA_ENCODE_X86
+
+// Combine the lanes of a vector float min/max, and do the points after
+// the last whole vector. Returns false if the scalar loop has to be used.
+//
+// Lane order only shows in the sign of a zero result: the scalar loop
+// replaces the min or max with each value that ties it, so a zero result
+// takes the sign of the last zero in the data, or is the initial value
+// if there is no zero data.
+
+static bool _minMaxFloatFinish(const fl32 *in, size_t npoints, size_t i,
+                               fl32 missing, fl32 bad, int nlanes,
+                               const fl32 *lanesMin, const fl32 *lanesMax,
+                               const ui32 *lanesInvalid,
+                               fl32 &minVal, fl32 &maxVal, size_t &count)
+{
+  fl32 min_val = lanesMin[0];
+  fl32 max_val = lanesMax[0];
+  size_t nInvalid = 0;
+  for (int j = 0; j < nlanes; j++) {
+    min_val = ((min_val < lanesMin[j]) ? min_val : lanesMin[j]);
+    max_val = ((max_val > lanesMax[j]) ? max_val : lanesMax[j]);
+    nInvalid += lanesInvalid[j];
+  }
+  size_t nTail = _minMaxScalar(in + i, npoints - i, missing, bad,
+                               min_val, max_val);
+  if (std::isnan(min_val) || std::isnan(max_val)) {
+    return false;
+  }
+  if (min_val == 0.0 || max_val == 0.0) {
+    fl32 lastZero = 0.0;
+    bool found = false;
+    for (size_t k = npoints; k > 0 && !found; k--) {
+      fl32 v = in[k - 1];
+      if (v == 0.0 && v != missing && v != bad) {
+        lastZero = v;
+        found = true;
+      }
+    }
+    if (min_val == 0.0) {
+      min_val = found ? lastZero : minVal;
+    }
+    if (max_val == 0.0) {
+      max_val = found ? lastZero : maxVal;
+    }
+  }
+  count = i - nInvalid + nTail;
+  minVal = min_val;
+  maxVal = max_val;
+  return true;
+}
+
+//----------------------------------------------------------------
+// SSE2
+//----------------------------------------------------------------
+
+static inline __m128i _sel(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128 _sel(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// 4 floats to 4 clamped, substituted 32 bit integers
+
+static inline __m128i _encode4(const fl32 *in,
+                               __m128 inMissing, __m128 inBad,
+                               __m128d scale, __m128d bias, __m128d half,
+                               __m128i minOut, __m128i maxOut,
+                               __m128i outMissing, __m128i outBad,
+                               size_t &nClamped)
+{
+  __m128 f = _mm_loadu_ps(in);
+  __m128d lo = _mm_cvtps_pd(f);
+  __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(f, f));
+  lo = _mm_add_pd(_mm_div_pd(_mm_sub_pd(lo, bias), scale), half);
+  hi = _mm_add_pd(_mm_div_pd(_mm_sub_pd(hi, bias), scale), half);
+  __m128i v = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo),
+                                 _mm_cvttpd_epi32(hi));
+  __m128i above = _mm_cmpgt_epi32(v, maxOut);
+  __m128i below = _mm_cmplt_epi32(v, minOut);
+  v = _sel(above, maxOut, v);
+  v = _sel(below, minOut, v);
+  __m128i isMissing = _mm_castps_si128(_mm_cmpeq_ps(f, inMissing));
+  __m128i isBad = _mm_castps_si128(_mm_cmpeq_ps(f, inBad));
+  __m128i clamped = _mm_andnot_si128(_mm_or_si128(isMissing, isBad),
+                                     _mm_or_si128(above, below));
+  nClamped += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(clamped)));
+  v = _sel(isBad, outBad, v);
+  return _sel(isMissing, outMissing, v);
+}
+
+static size_t _encodeInt8Sse2(const fl32 *in, size_t npoints,
+                              fl32 inMissing, fl32 inBad,
+                              double scale, double bias,
+                              int minOut, int maxOut,
+                              ui08 outMissing, ui08 outBad, ui08 *out)
+{
+  __m128 vInMissing = _mm_set1_ps(inMissing);
+  __m128 vInBad = _mm_set1_ps(inBad);
+  __m128d vScale = _mm_set1_pd(scale);
+  __m128d vBias = _mm_set1_pd(bias);
+  __m128d vHalf = _mm_set1_pd(0.49999);
+  __m128i vMin = _mm_set1_epi32(minOut);
+  __m128i vMax = _mm_set1_epi32(maxOut);
+  __m128i vOutMissing = _mm_set1_epi32(outMissing);
+  __m128i vOutBad = _mm_set1_epi32(outBad);
+  size_t nClamped = 0;
+  size_t i = 0;
+  for (; i + 4 <= npoints; i += 4) {
+    __m128i v = _encode4(in + i, vInMissing, vInBad, vScale, vBias, vHalf,
+                         vMin, vMax, vOutMissing, vOutBad, nClamped);
+    __m128i w = _mm_packs_epi32(v, v);
+    int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+    memcpy(out + i, &bytes, 4);
+  }
+  return nClamped + _encodeScalar(in + i, npoints - i, inMissing, inBad,
+                                  scale, bias, minOut, maxOut,
+                                  outMissing, outBad, out + i);
+}
+
+static size_t _encodeInt16Sse2(const fl32 *in, size_t npoints,
+                               fl32 inMissing, fl32 inBad,
+                               double scale, double bias,
+                               int minOut, int maxOut,
+                               ui16 outMissing, ui16 outBad, ui16 *out)
+{
+  __m128 vInMissing = _mm_set1_ps(inMissing);
+  __m128 vInBad = _mm_set1_ps(inBad);
+  __m128d vScale = _mm_set1_pd(scale);
+  __m128d vBias = _mm_set1_pd(bias);
+  __m128d vHalf = _mm_set1_pd(0.49999);
+  __m128i vMin = _mm_set1_epi32(minOut);
+  __m128i vMax = _mm_set1_epi32(maxOut);
+  __m128i vOutMissing = _mm_set1_epi32(outMissing);
+  __m128i vOutBad = _mm_set1_epi32(outBad);
+  __m128i offset32 = _mm_set1_epi32(32768);
+  __m128i offset16 = _mm_set1_epi16((short) 0x8000);
+  size_t nClamped = 0;
+  size_t i = 0;
+  for (; i + 4 <= npoints; i += 4) {
+    __m128i v = _encode4(in + i, vInMissing, vInBad, vScale, vBias, vHalf,
+                         vMin, vMax, vOutMissing, vOutBad, nClamped);
+    // signed saturating pack, shifted to the signed range and back
+    v = _mm_sub_epi32(v, offset32);
+    __m128i w = _mm_xor_si128(_mm_packs_epi32(v, v), offset16);
+    _mm_storel_epi64((__m128i *) (out + i), w);
+  }
+  return nClamped + _encodeScalar(in + i, npoints - i, inMissing, inBad,
+                                  scale, bias, minOut, maxOut,
+                                  outMissing, outBad, out + i);
+}
+
+// 4 integers, zero extended to 32 bits, decoded to 4 floats
+
+static inline void _decode4(__m128i v, __m128i inMissing, __m128i inBad,
+                            __m128 scale, __m128 bias, __m128 threshold,
+                            __m128 absMask, __m128 outMissing,
+                            __m128 outBad, fl32 *out)
+{
+  __m128 f = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), scale), bias);
+  __m128 small = _mm_cmplt_ps(_mm_and_ps(f, absMask), threshold);
+  f = _mm_andnot_ps(small, f);
+  f = _sel(_mm_castsi128_ps(_mm_cmpeq_epi32(v, inBad)), outBad, f);
+  f = _sel(_mm_castsi128_ps(_mm_cmpeq_epi32(v, inMissing)), outMissing, f);
+  _mm_storeu_ps(out, f);
+}
+
+static void _decodeInt8Sse2(const ui08 *in, size_t npoints,
+                            ui08 inMissing, ui08 inBad,
+                            fl32 scale, fl32 bias, double zeroThreshold,
+                            fl32 outMissing, fl32 outBad, fl32 *out)
+{
+  __m128i vInMissing = _mm_set1_epi32(inMissing);
+  __m128i vInBad = _mm_set1_epi32(inBad);
+  __m128 vScale = _mm_set1_ps(scale);
+  __m128 vBias = _mm_set1_ps(bias);
+  __m128 vThreshold = _mm_set1_ps(_floatThreshold(zeroThreshold));
+  __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 vOutMissing = _mm_set1_ps(outMissing);
+  __m128 vOutBad = _mm_set1_ps(outBad);
+  __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= npoints; i += 16) {
+    __m128i b = _mm_loadu_si128((const __m128i *) (in + i));
+    __m128i wlo = _mm_unpacklo_epi8(b, zero);
+    __m128i whi = _mm_unpackhi_epi8(b, zero);
+    _decode4(_mm_unpacklo_epi16(wlo, zero), vInMissing, vInBad, vScale,
+             vBias, vThreshold, vAbs, vOutMissing, vOutBad, out + i);
+    _decode4(_mm_unpackhi_epi16(wlo, zero), vInMissing, vInBad, vScale,
+             vBias, vThreshold, vAbs, vOutMissing, vOutBad, out + i + 4);
+    _decode4(_mm_unpacklo_epi16(whi, zero), vInMissing, vInBad, vScale,
+             vBias, vThreshold, vAbs, vOutMissing, vOutBad, out + i + 8);
+    _decode4(_mm_unpackhi_epi16(whi, zero), vInMissing, vInBad, vScale,
+             vBias, vThreshold, vAbs, vOutMissing, vOutBad, out + i + 12);
+  }
+  _decodeScalar(in + i, npoints - i, inMissing, inBad, scale, bias,
+                zeroThreshold, outMissing, outBad, out + i);
+}
+
+static void _decodeInt16Sse2(const ui16 *in, size_t npoints,
+                             ui16 inMissing, ui16 inBad,
+                             fl32 scale, fl32 bias, double zeroThreshold,
+                             fl32 outMissing, fl32 outBad, fl32 *out)
+{
+  __m128i vInMissing = _mm_set1_epi32(inMissing);
+  __m128i vInBad = _mm_set1_epi32(inBad);
+  __m128 vScale = _mm_set1_ps(scale);
+  __m128 vBias = _mm_set1_ps(bias);
+  __m128 vThreshold = _mm_set1_ps(_floatThreshold(zeroThreshold));
+  __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 vOutMissing = _mm_set1_ps(outMissing);
+  __m128 vOutBad = _mm_set1_ps(outBad);
+  __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m128i w = _mm_loadu_si128((const __m128i *) (in + i));
+    _decode4(_mm_unpacklo_epi16(w, zero), vInMissing, vInBad, vScale,
+             vBias, vThreshold, vAbs, vOutMissing, vOutBad, out + i);
+    _decode4(_mm_unpackhi_epi16(w, zero), vInMissing, vInBad, vScale,
+             vBias, vThreshold, vAbs, vOutMissing, vOutBad, out + i + 4);
+  }
+  _decodeScalar(in + i, npoints - i, inMissing, inBad, scale, bias,
+                zeroThreshold, outMissing, outBad, out + i);
+}
+
+// Float min/max. Returns false, with the outputs untouched, if the
+// scalar loop has to be used.
+
+// Float min/max. Returns false, with the outputs untouched, if there is
+// NaN data and the scalar loop has to be used.
+
+static bool _minMaxFloatSse2(const fl32 *in, size_t npoints,
+                             fl32 missing, fl32 bad,
+                             fl32 &minVal, fl32 &maxVal, size_t &count)
+{
+  __m128 vMissing = _mm_set1_ps(missing);
+  __m128 vBad = _mm_set1_ps(bad);
+  __m128 vMin = _mm_set1_ps(minVal);
+  __m128 vMax = _mm_set1_ps(maxVal);
+  __m128 vNan = _mm_setzero_ps();
+  __m128i vInvalid = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= npoints; i += 4) {
+    __m128 v = _mm_loadu_ps(in + i);
+    __m128 invalid = _mm_or_ps(_mm_cmpeq_ps(v, vMissing),
+                               _mm_cmpeq_ps(v, vBad));
+    vNan = _mm_or_ps(vNan, _mm_andnot_ps(invalid, _mm_cmpunord_ps(v, v)));
+    vInvalid = _mm_sub_epi32(vInvalid, _mm_castps_si128(invalid));
+    vMin = _sel(invalid, vMin, _mm_min_ps(vMin, v));
+    vMax = _sel(invalid, vMax, _mm_max_ps(vMax, v));
+  }
+  if (_mm_movemask_ps(vNan)) {
+    return false;
+  }
+  fl32 lanesMin[4], lanesMax[4];
+  ui32 lanesInvalid[4];
+  _mm_storeu_ps(lanesMin, vMin);
+  _mm_storeu_ps(lanesMax, vMax);
+  _mm_storeu_si128((__m128i *) lanesInvalid, vInvalid);
+  return _minMaxFloatFinish(in, npoints, i, missing, bad, 4, lanesMin,
+                            lanesMax, lanesInvalid, minVal, maxVal, count);
+}
+
+static size_t _minMaxInt8Sse2(const ui08 *in, size_t npoints,
+                              ui08 missing, ui08 bad,
+                              ui08 &minVal, ui08 &maxVal)
+{
+  __m128i vMissing = _mm_set1_epi8((char) missing);
+  __m128i vBad = _mm_set1_epi8((char) bad);
+  __m128i vMin = _mm_set1_epi8((char) minVal);
+  __m128i vMax = _mm_set1_epi8((char) maxVal);
+  size_t nInvalid = 0;
+  size_t i = 0;
+  for (; i + 16 <= npoints; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (in + i));
+    __m128i invalid = _mm_or_si128(_mm_cmpeq_epi8(v, vMissing),
+                                   _mm_cmpeq_epi8(v, vBad));
+    nInvalid += __builtin_popcount(_mm_movemask_epi8(invalid));
+    // invalid points become 255 for the min, 0 for the max
+    vMin = _mm_min_epu8(vMin, _mm_or_si128(v, invalid));
+    vMax = _mm_max_epu8(vMax, _mm_andnot_si128(invalid, v));
+  }
+  ui08 lanesMin[16], lanesMax[16];
+  _mm_storeu_si128((__m128i *) lanesMin, vMin);
+  _mm_storeu_si128((__m128i *) lanesMax, vMax);
+  for (int j = 0; j < 16; j++) {
+    if (lanesMin[j] < minVal) minVal = lanesMin[j];
+    if (lanesMax[j] > maxVal) maxVal = lanesMax[j];
+  }
+  return (i - nInvalid) +
+    _minMaxScalar(in + i, npoints - i, missing, bad, minVal, maxVal);
+}
+
+static size_t _minMaxInt16Sse2(const ui16 *in, size_t npoints,
+                               ui16 missing, ui16 bad,
+                               ui16 &minVal, ui16 &maxVal)
+{
+  // SSE2 only has signed 16 bit min/max, so work offset by 0x8000
+  __m128i offset = _mm_set1_epi16((short) 0x8000);
+  __m128i vMissing = _mm_set1_epi16((short) missing);
+  __m128i vBad = _mm_set1_epi16((short) bad);
+  __m128i vMin = _mm_xor_si128(_mm_set1_epi16((short) minVal), offset);
+  __m128i vMax = _mm_xor_si128(_mm_set1_epi16((short) maxVal), offset);
+  size_t nInvalid = 0;
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (in + i));
+    __m128i invalid = _mm_or_si128(_mm_cmpeq_epi16(v, vMissing),
+                                   _mm_cmpeq_epi16(v, vBad));
+    nInvalid += __builtin_popcount(_mm_movemask_epi8(invalid)) / 2;
+    vMin = _mm_min_epi16(vMin,
+                         _mm_xor_si128(_mm_or_si128(v, invalid), offset));
+    vMax = _mm_max_epi16(vMax,
+                         _mm_xor_si128(_mm_andnot_si128(invalid, v), offset));
+  }
+  ui16 lanesMin[8], lanesMax[8];
+  _mm_storeu_si128((__m128i *) lanesMin, _mm_xor_si128(vMin, offset));
+  _mm_storeu_si128((__m128i *) lanesMax, _mm_xor_si128(vMax, offset));
+  for (int j = 0; j < 8; j++) {
+    if (lanesMin[j] < minVal) minVal = lanesMin[j];
+    if (lanesMax[j] > maxVal) maxVal = lanesMax[j];
+  }
+  return (i - nInvalid) +
+    _minMaxScalar(in + i, npoints - i, missing, bad, minVal, maxVal);
+}
+
+static size_t _replaceNonFiniteSse2(fl32 *data, size_t npoints,
+                                    fl32 replacement)
+{
+  __m128i expMask = _mm_set1_epi32(0x7f800000);
+  __m128 vReplacement = _mm_set1_ps(replacement);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 4 <= npoints; i += 4) {
+    __m128 v = _mm_loadu_ps(data + i);
+    __m128i e = _mm_and_si128(_mm_castps_si128(v), expMask);
+    __m128 nonFinite = _mm_castsi128_ps(_mm_cmpeq_epi32(e, expMask));
+    int mask = _mm_movemask_ps(nonFinite);
+    if (mask) {
+      count += __builtin_popcount(mask);
+      _mm_storeu_ps(data + i, _sel(nonFinite, vReplacement, v));
+    }
+  }
+  return count + _replaceNonFiniteScalar(data + i, npoints - i, replacement);
+}
+
+//----------------------------------------------------------------
+// AVX2
+//----------------------------------------------------------------
+
+// 8 floats to 8 clamped, substituted 32 bit integers
+
+static inline TA_AVX2
+__m256i _encode8(const fl32 *in, __m256 inMissing, __m256 inBad,
+                 __m256d scale, __m256d bias, __m256d half,
+                 __m256i minOut, __m256i maxOut,
+                 __m256i outMissing, __m256i outBad, size_t &nClamped)
+{
+  __m256 f = _mm256_loadu_ps(in);
+  __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(f));
+  __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1));
+  lo = _mm256_add_pd(_mm256_div_pd(_mm256_sub_pd(lo, bias), scale), half);
+  hi = _mm256_add_pd(_mm256_div_pd(_mm256_sub_pd(hi, bias), scale), half);
+  __m256i v =
+    _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(lo)),
+                            _mm256_cvttpd_epi32(hi), 1);
+  __m256i above = _mm256_cmpgt_epi32(v, maxOut);
+  __m256i below = _mm256_cmpgt_epi32(minOut, v);
+  v = _mm256_min_epi32(_mm256_max_epi32(v, minOut), maxOut);
+  __m256i isMissing =
+    _mm256_castps_si256(_mm256_cmp_ps(f, inMissing, _CMP_EQ_OQ));
+  __m256i isBad = _mm256_castps_si256(_mm256_cmp_ps(f, inBad, _CMP_EQ_OQ));
+  __m256i clamped =
+    _mm256_andnot_si256(_mm256_or_si256(isMissing, isBad),
+                        _mm256_or_si256(above, below));
+  nClamped +=
+    __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(clamped)));
+  v = _mm256_blendv_epi8(v, outBad, isBad);
+  return _mm256_blendv_epi8(v, outMissing, isMissing);
+}
+
+static TA_AVX2
+size_t _encodeInt8Avx2(const fl32 *in, size_t npoints,
+                       fl32 inMissing, fl32 inBad,
+                       double scale, double bias,
+                       int minOut, int maxOut,
+                       ui08 outMissing, ui08 outBad, ui08 *out)
+{
+  __m256 vInMissing = _mm256_set1_ps(inMissing);
+  __m256 vInBad = _mm256_set1_ps(inBad);
+  __m256d vScale = _mm256_set1_pd(scale);
+  __m256d vBias = _mm256_set1_pd(bias);
+  __m256d vHalf = _mm256_set1_pd(0.49999);
+  __m256i vMin = _mm256_set1_epi32(minOut);
+  __m256i vMax = _mm256_set1_epi32(maxOut);
+  __m256i vOutMissing = _mm256_set1_epi32(outMissing);
+  __m256i vOutBad = _mm256_set1_epi32(outBad);
+  size_t nClamped = 0;
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m256i v = _encode8(in + i, vInMissing, vInBad, vScale, vBias, vHalf,
+                         vMin, vMax, vOutMissing, vOutBad, nClamped);
+    __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(v),
+                                _mm256_extracti128_si256(v, 1));
+    _mm_storel_epi64((__m128i *) (out + i), _mm_packus_epi16(w, w));
+  }
+  return nClamped + _encodeScalar(in + i, npoints - i, inMissing, inBad,
+                                  scale, bias, minOut, maxOut,
+                                  outMissing, outBad, out + i);
+}
+
+static TA_AVX2
+size_t _encodeInt16Avx2(const fl32 *in, size_t npoints,
+                        fl32 inMissing, fl32 inBad,
+                        double scale, double bias,
+                        int minOut, int maxOut,
+                        ui16 outMissing, ui16 outBad, ui16 *out)
+{
+  __m256 vInMissing = _mm256_set1_ps(inMissing);
+  __m256 vInBad = _mm256_set1_ps(inBad);
+  __m256d vScale = _mm256_set1_pd(scale);
+  __m256d vBias = _mm256_set1_pd(bias);
+  __m256d vHalf = _mm256_set1_pd(0.49999);
+  __m256i vMin = _mm256_set1_epi32(minOut);
+  __m256i vMax = _mm256_set1_epi32(maxOut);
+  __m256i vOutMissing = _mm256_set1_epi32(outMissing);
+  __m256i vOutBad = _mm256_set1_epi32(outBad);
+  size_t nClamped = 0;
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m256i v = _encode8(in + i, vInMissing, vInBad, vScale, vBias, vHalf,
+                         vMin, vMax, vOutMissing, vOutBad, nClamped);
+    _mm_storeu_si128((__m128i *) (out + i),
+                     _mm_packus_epi32(_mm256_castsi256_si128(v),
+                                      _mm256_extracti128_si256(v, 1)));
+  }
+  return nClamped + _encodeScalar(in + i, npoints - i, inMissing, inBad,
+                                  scale, bias, minOut, maxOut,
+                                  outMissing, outBad, out + i);
+}
+
+// 8 integers, zero extended to 32 bits, decoded to 8 floats
+
+static inline TA_AVX2
+void _decode8(__m256i v, __m256i inMissing, __m256i inBad,
+              __m256 scale, __m256 bias, __m256 threshold, __m256 absMask,
+              __m256 outMissing, __m256 outBad, fl32 *out)
+{
+  __m256 f = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(v), scale),
+                           bias);
+  __m256 small = _mm256_cmp_ps(_mm256_and_ps(f, absMask), threshold,
+                               _CMP_LT_OQ);
+  f = _mm256_andnot_ps(small, f);
+  f = _mm256_blendv_ps(f, outBad,
+                       _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, inBad)));
+  f = _mm256_blendv_ps(f, outMissing,
+                       _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, inMissing)));
+  _mm256_storeu_ps(out, f);
+}
+
+static TA_AVX2
+void _decodeInt8Avx2(const ui08 *in, size_t npoints,
+                     ui08 inMissing, ui08 inBad,
+                     fl32 scale, fl32 bias, double zeroThreshold,
+                     fl32 outMissing, fl32 outBad, fl32 *out)
+{
+  __m256i vInMissing = _mm256_set1_epi32(inMissing);
+  __m256i vInBad = _mm256_set1_epi32(inBad);
+  __m256 vScale = _mm256_set1_ps(scale);
+  __m256 vBias = _mm256_set1_ps(bias);
+  __m256 vThreshold = _mm256_set1_ps(_floatThreshold(zeroThreshold));
+  __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 vOutMissing = _mm256_set1_ps(outMissing);
+  __m256 vOutBad = _mm256_set1_ps(outBad);
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m128i b = _mm_loadl_epi64((const __m128i *) (in + i));
+    _decode8(_mm256_cvtepu8_epi32(b), vInMissing, vInBad, vScale, vBias,
+             vThreshold, vAbs, vOutMissing, vOutBad, out + i);
+  }
+  _decodeScalar(in + i, npoints - i, inMissing, inBad, scale, bias,
+                zeroThreshold, outMissing, outBad, out + i);
+}
+
+static TA_AVX2
+void _decodeInt16Avx2(const ui16 *in, size_t npoints,
+                      ui16 inMissing, ui16 inBad,
+                      fl32 scale, fl32 bias, double zeroThreshold,
+                      fl32 outMissing, fl32 outBad, fl32 *out)
+{
+  __m256i vInMissing = _mm256_set1_epi32(inMissing);
+  __m256i vInBad = _mm256_set1_epi32(inBad);
+  __m256 vScale = _mm256_set1_ps(scale);
+  __m256 vBias = _mm256_set1_ps(bias);
+  __m256 vThreshold = _mm256_set1_ps(_floatThreshold(zeroThreshold));
+  __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 vOutMissing = _mm256_set1_ps(outMissing);
+  __m256 vOutBad = _mm256_set1_ps(outBad);
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m128i w = _mm_loadu_si128((const __m128i *) (in + i));
+    _decode8(_mm256_cvtepu16_epi32(w), vInMissing, vInBad, vScale, vBias,
+             vThreshold, vAbs, vOutMissing, vOutBad, out + i);
+  }
+  _decodeScalar(in + i, npoints - i, inMissing, inBad, scale, bias,
+                zeroThreshold, outMissing, outBad, out + i);
+}
+
+static TA_AVX2
+bool _minMaxFloatAvx2(const fl32 *in, size_t npoints,
+                      fl32 missing, fl32 bad,
+                      fl32 &minVal, fl32 &maxVal, size_t &count)
+{
+  __m256 vMissing = _mm256_set1_ps(missing);
+  __m256 vBad = _mm256_set1_ps(bad);
+  __m256 vMin = _mm256_set1_ps(minVal);
+  __m256 vMax = _mm256_set1_ps(maxVal);
+  __m256 vNan = _mm256_setzero_ps();
+  __m256i vInvalid = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m256 v = _mm256_loadu_ps(in + i);
+    __m256 invalid = _mm256_or_ps(_mm256_cmp_ps(v, vMissing, _CMP_EQ_OQ),
+                                  _mm256_cmp_ps(v, vBad, _CMP_EQ_OQ));
+    vNan = _mm256_or_ps(vNan,
+                        _mm256_andnot_ps(invalid,
+                                         _mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+    vInvalid = _mm256_sub_epi32(vInvalid, _mm256_castps_si256(invalid));
+    vMin = _mm256_blendv_ps(_mm256_min_ps(vMin, v), vMin, invalid);
+    vMax = _mm256_blendv_ps(_mm256_max_ps(vMax, v), vMax, invalid);
+  }
+  if (_mm256_movemask_ps(vNan)) {
+    return false;
+  }
+  fl32 lanesMin[8], lanesMax[8];
+  ui32 lanesInvalid[8];
+  _mm256_storeu_ps(lanesMin, vMin);
+  _mm256_storeu_ps(lanesMax, vMax);
+  _mm256_storeu_si256((__m256i *) lanesInvalid, vInvalid);
+  return _minMaxFloatFinish(in, npoints, i, missing, bad, 8, lanesMin,
+                            lanesMax, lanesInvalid, minVal, maxVal, count);
+}
+
+static TA_AVX2
+size_t _minMaxInt8Avx2(const ui08 *in, size_t npoints,
+                       ui08 missing, ui08 bad,
+                       ui08 &minVal, ui08 &maxVal)
+{
+  __m256i vMissing = _mm256_set1_epi8((char) missing);
+  __m256i vBad = _mm256_set1_epi8((char) bad);
+  __m256i vMin = _mm256_set1_epi8((char) minVal);
+  __m256i vMax = _mm256_set1_epi8((char) maxVal);
+  size_t nInvalid = 0;
+  size_t i = 0;
+  for (; i + 32 <= npoints; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) (in + i));
+    __m256i invalid = _mm256_or_si256(_mm256_cmpeq_epi8(v, vMissing),
+                                      _mm256_cmpeq_epi8(v, vBad));
+    nInvalid += __builtin_popcount((unsigned int) _mm256_movemask_epi8(invalid));
+    vMin = _mm256_min_epu8(vMin, _mm256_or_si256(v, invalid));
+    vMax = _mm256_max_epu8(vMax, _mm256_andnot_si256(invalid, v));
+  }
+  ui08 lanesMin[32], lanesMax[32];
+  _mm256_storeu_si256((__m256i *) lanesMin, vMin);
+  _mm256_storeu_si256((__m256i *) lanesMax, vMax);
+  for (int j = 0; j < 32; j++) {
+    if (lanesMin[j] < minVal) minVal = lanesMin[j];
+    if (lanesMax[j] > maxVal) maxVal = lanesMax[j];
+  }
+  return (i - nInvalid) +
+    _minMaxScalar(in + i, npoints - i, missing, bad, minVal, maxVal);
+}
+
+static TA_AVX2
+size_t _minMaxInt16Avx2(const ui16 *in, size_t npoints,
+                        ui16 missing, ui16 bad,
+                        ui16 &minVal, ui16 &maxVal)
+{
+  __m256i vMissing = _mm256_set1_epi16((short) missing);
+  __m256i vBad = _mm256_set1_epi16((short) bad);
+  __m256i vMin = _mm256_set1_epi16((short) minVal);
+  __m256i vMax = _mm256_set1_epi16((short) maxVal);
+  size_t nInvalid = 0;
+  size_t i = 0;
+  for (; i + 16 <= npoints; i += 16) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) (in + i));
+    __m256i invalid = _mm256_or_si256(_mm256_cmpeq_epi16(v, vMissing),
+                                      _mm256_cmpeq_epi16(v, vBad));
+    nInvalid +=
+      __builtin_popcount((unsigned int) _mm256_movemask_epi8(invalid)) / 2;
+    vMin = _mm256_min_epu16(vMin, _mm256_or_si256(v, invalid));
+    vMax = _mm256_max_epu16(vMax, _mm256_andnot_si256(invalid, v));
+  }
+  ui16 lanesMin[16], lanesMax[16];
+  _mm256_storeu_si256((__m256i *) lanesMin, vMin);
+  _mm256_storeu_si256((__m256i *) lanesMax, vMax);
+  for (int j = 0; j < 16; j++) {
+    if (lanesMin[j] < minVal) minVal = lanesMin[j];
+    if (lanesMax[j] > maxVal) maxVal = lanesMax[j];
+  }
+  return (i - nInvalid) +
+    _minMaxScalar(in + i, npoints - i, missing, bad, minVal, maxVal);
+}
+
+static TA_AVX2
+size_t _replaceNonFiniteAvx2(fl32 *data, size_t npoints, fl32 replacement)
+{
+  __m256i expMask = _mm256_set1_epi32(0x7f800000);
+  __m256 vReplacement = _mm256_set1_ps(replacement);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= npoints; i += 8) {
+    __m256 v = _mm256_loadu_ps(data + i);
+    __m256i e = _mm256_and_si256(_mm256_castps_si256(v), expMask);
+    __m256 nonFinite = _mm256_castsi256_ps(_mm256_cmpeq_epi32(e, expMask));
+    int mask = _mm256_movemask_ps(nonFinite);
+    if (mask) {
+      count += __builtin_popcount(mask);
+      _mm256_storeu_ps(data + i, _mm256_blendv_ps(v, vReplacement, nonFinite));
+    }
+  }
+  return count + _replaceNonFiniteScalar(data + i, npoints - i, replacement);
+}
+
+#endif
+
+//----------------------------------------------------------------
+// dispatch
+//----------------------------------------------------------------
+
+static TaEncodeKernels::level_t _supportedLevel(void)
+{
+#ifdef TA_ENCODE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return TaEncodeKernels::AVX2;
+  }
+  return TaEncodeKernels::SSE2;
+#else
+  return TaEncodeKernels::SCALAR;
+#endif
+}
+
+static TaEncodeKernels::level_t _initialLevel(void)
+{
+  TaEncodeKernels::level_t level = _supportedLevel();
+  const char *env = getenv("TA_ENCODE_KERNELS");
+  if (env != NULL) {
+    if (strcmp(env, "scalar") == 0) {
+      level = TaEncodeKernels::SCALAR;
+    } else if (strcmp(env, "sse2") == 0 && level > TaEncodeKernels::SSE2) {
+      level = TaEncodeKernels::SSE2;
+    }
+  }
+  return level;
+}
+
+static TaEncodeKernels::level_t _level = _initialLevel();
+
+//----------------------------------------------------------------
+TaEncodeKernels::level_t TaEncodeKernels::getLevel(void)
+{
+  return _level;
+}
+
+//----------------------------------------------------------------
+void TaEncodeKernels::setLevel(level_t level)
+{
+  level_t supported = _supportedLevel();
+  _level = (level < supported) ? level : supported;
+}
+
+//----------------------------------------------------------------
+size_t TaEncodeKernels::encodeInt8(const fl32 *in, size_t npoints,
+                                   fl32 inMissing, fl32 inBad,
+                                   double scale, double bias,
+                                   int minOut, int maxOut,
+                                   ui08 outMissing, ui08 outBad, ui08 *out)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    return _encodeInt8Avx2(in, npoints, inMissing, inBad, scale, bias,
+                           minOut, maxOut, outMissing, outBad, out);
+  }
+  if (_level == SSE2) {
+    return _encodeInt8Sse2(in, npoints, inMissing, inBad, scale, bias,
+                           minOut, maxOut, outMissing, outBad, out);
+  }
+#endif
+  return _encodeScalar(in, npoints, inMissing, inBad, scale, bias,
+                       minOut, maxOut, outMissing, outBad, out);
+}
+
+//----------------------------------------------------------------
+size_t TaEncodeKernels::encodeInt16(const fl32 *in, size_t npoints,
+                                    fl32 inMissing, fl32 inBad,
+                                    double scale, double bias,
+                                    int minOut, int maxOut,
+                                    ui16 outMissing, ui16 outBad, ui16 *out)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    return _encodeInt16Avx2(in, npoints, inMissing, inBad, scale, bias,
+                            minOut, maxOut, outMissing, outBad, out);
+  }
+  if (_level == SSE2) {
+    return _encodeInt16Sse2(in, npoints, inMissing, inBad, scale, bias,
+                            minOut, maxOut, outMissing, outBad, out);
+  }
+#endif
+  return _encodeScalar(in, npoints, inMissing, inBad, scale, bias,
+                       minOut, maxOut, outMissing, outBad, out);
+}
+
+//----------------------------------------------------------------
+void TaEncodeKernels::decodeInt8(const ui08 *in, size_t npoints,
+                                 ui08 inMissing, ui08 inBad,
+                                 fl32 scale, fl32 bias, double zeroThreshold,
+                                 fl32 outMissing, fl32 outBad, fl32 *out)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    _decodeInt8Avx2(in, npoints, inMissing, inBad, scale, bias,
+                    zeroThreshold, outMissing, outBad, out);
+    return;
+  }
+  if (_level == SSE2) {
+    _decodeInt8Sse2(in, npoints, inMissing, inBad, scale, bias,
+                    zeroThreshold, outMissing, outBad, out);
+    return;
+  }
+#endif
+  _decodeScalar(in, npoints, inMissing, inBad, scale, bias,
+                zeroThreshold, outMissing, outBad, out);
+}
+
+//----------------------------------------------------------------
+void TaEncodeKernels::decodeInt16(const ui16 *in, size_t npoints,
+                                  ui16 inMissing, ui16 inBad,
+                                  fl32 scale, fl32 bias, double zeroThreshold,
+                                  fl32 outMissing, fl32 outBad, fl32 *out)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    _decodeInt16Avx2(in, npoints, inMissing, inBad, scale, bias,
+                     zeroThreshold, outMissing, outBad, out);
+    return;
+  }
+  if (_level == SSE2) {
+    _decodeInt16Sse2(in, npoints, inMissing, inBad, scale, bias,
+                     zeroThreshold, outMissing, outBad, out);
+    return;
+  }
+#endif
+  _decodeScalar(in, npoints, inMissing, inBad, scale, bias,
+                zeroThreshold, outMissing, outBad, out);
+}
+
+//----------------------------------------------------------------
+size_t TaEncodeKernels::minMax(const fl32 *in, size_t npoints,
+                               fl32 missing, fl32 bad,
+                               fl32 &minVal, fl32 &maxVal)
+{
+#ifdef TA_ENCODE_X86
+  // lanes that see no data keep the initial values, so a NaN there
+  // would mix into the lane reduction
+  size_t count;
+  if (std::isnan(minVal) || std::isnan(maxVal)) {
+    return _minMaxScalar(in, npoints, missing, bad, minVal, maxVal);
+  }
+  if (_level == AVX2 &&
+      _minMaxFloatAvx2(in, npoints, missing, bad, minVal, maxVal, count)) {
+    return count;
+  }
+  if (_level == SSE2 &&
+      _minMaxFloatSse2(in, npoints, missing, bad, minVal, maxVal, count)) {
+    return count;
+  }
+#endif
+  return _minMaxScalar(in, npoints, missing, bad, minVal, maxVal);
+}
+
+//----------------------------------------------------------------
+size_t TaEncodeKernels::minMax(const ui08 *in, size_t npoints,
+                               ui08 missing, ui08 bad,
+                               ui08 &minVal, ui08 &maxVal)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    return _minMaxInt8Avx2(in, npoints, missing, bad, minVal, maxVal);
+  }
+  if (_level == SSE2) {
+    return _minMaxInt8Sse2(in, npoints, missing, bad, minVal, maxVal);
+  }
+#endif
+  return _minMaxScalar(in, npoints, missing, bad, minVal, maxVal);
+}
+
+//----------------------------------------------------------------
+size_t TaEncodeKernels::minMax(const ui16 *in, size_t npoints,
+                               ui16 missing, ui16 bad,
+                               ui16 &minVal, ui16 &maxVal)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    return _minMaxInt16Avx2(in, npoints, missing, bad, minVal, maxVal);
+  }
+  if (_level == SSE2) {
+    return _minMaxInt16Sse2(in, npoints, missing, bad, minVal, maxVal);
+  }
+#endif
+  return _minMaxScalar(in, npoints, missing, bad, minVal, maxVal);
+}
+
+//----------------------------------------------------------------
+size_t TaEncodeKernels::replaceNonFinite(fl32 *data, size_t npoints,
+                                         fl32 replacement)
+{
+#ifdef TA_ENCODE_X86
+  if (_level == AVX2) {
+    return _replaceNonFiniteAvx2(data, npoints, replacement);
+  }
+  if (_level == SSE2) {
+    return _replaceNonFiniteSse2(data, npoints, replacement);
+  }
+#endif
+  return _replaceNonFiniteScalar(data, npoints, replacement);
+}
@@ -0,0 +1,236 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1990 - 2016
+// ** University Corporation for Atmospheric Research (UCAR)
+// ** National Center for Atmospheric Research (NCAR)
+// ** Boulder, Colorado, USA
+// ** BSD licence applies - redistribution and use in source and binary
+// ** forms, with or without modification, are permitted provided that
+// ** the following conditions are met:
+// ** 1) If the software is modified to produce derivative works,
+// ** such modified software should be clearly marked, so as not
+// ** to confuse it with the version available from UCAR.
+// ** 2) Redistributions of source code must retain the above copyright
+// ** notice, this list of conditions and the following disclaimer.
+// ** 3) Redistributions in binary form must reproduce the above copyright
+// ** notice, this list of conditions and the following disclaimer in the
+// ** documentation and/or other materials provided with the distribution.
+// ** 4) Neither the name of UCAR nor the names of its contributors,
+// ** if any, may be used to endorse or promote products derived from
+// ** this software without specific prior written permission.
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+/**
+ * @file TaBoxFilterTest.cc
+ *
+ * Runs TaBoxFilter on random grids and compares each output point with a
+ * brute force average over its box, which is what the ConvWx
+ * GridData::smooth() loops did before they used the filter.
+ *
+ * The grids have missing and exclude values, including rows and columns
+ * that are all one or the other, and the boxes go from a single point to
+ * wider than the grid, with and without x wraparound, both exclude modes,
+ * a minimum good count, and one or several threads.
+ *
+ * The filter keeps running sums, so means may differ from the brute force
+ * ones in the last few bits; missing and exclude outputs must match
+ * exactly.
+ *
+ * Exits 0 if everything matches, 1 otherwise.
+ */
+#include <toolsa/TaBoxFilter.hh>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using std::vector;
+
+static const double MISSING = -9999.0;
+static const double EXCLUDE = 0.0;
+
+// Allowed difference in a mean, data are in [1, 100]
+static const double TOLERANCE = 1.0e-9;
+
+static int _nFail = 0;
+static int _nCheck = 0;
+
+// Small deterministic generator, so a failure can be repeated
+static unsigned int _seed = 12345;
+
+static unsigned int _rand(void)
+{
+  _seed = _seed * 1103515245 + 12345;
+  return (_seed >> 8) & 0xffffff;
+}
+
+//----------------------------------------------------------------
+// brute force reference
+//----------------------------------------------------------------
+
+static void _boxRef(const vector<double> &in, int nx, int ny,
+                    int sx, int sy, bool isExclude, bool rejectCenter,
+                    int minGood, bool wrap, vector<double> &out)
+{
+  out.assign(nx * ny, MISSING);
+  for (int y = 0; y < ny; y++) {
+    for (int x = 0; x < nx; x++) {
+      double center = in[y * nx + x];
+      if (isExclude && rejectCenter && center == EXCLUDE) {
+        out[y * nx + x] = EXCLUDE;
+        continue;
+      }
+      double sum = 0.0;
+      int n = 0, nex = 0;
+      for (int iy = y - sy; iy <= y + sy; iy++) {
+        if (iy < 0 || iy >= ny) {
+          continue;
+        }
+        for (int ix = x - sx; ix <= x + sx; ix++) {
+          int jx = ix;
+          if (wrap) {
+            jx = ((ix % nx) + nx) % nx;
+          } else if (ix < 0 || ix >= nx) {
+            continue;
+          }
+          double v = in[iy * nx + jx];
+          if (v == MISSING) {
+            continue;
+          }
+          if (isExclude && v == EXCLUDE) {
+            nex++;
+          } else {
+            sum += v;
+            n++;
+          }
+        }
+      }
+      if (n > minGood) {
+        out[y * nx + x] = sum / n;
+      } else if (n == 0 && isExclude && !rejectCenter && nex > 0) {
+        out[y * nx + x] = EXCLUDE;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------
+// test data and checks
+//----------------------------------------------------------------
+
+// Mostly data, some missing and exclude points, and now and then a whole
+// row or column of missing or exclude values
+
+static vector<double> _grid(int nx, int ny)
+{
+  vector<double> v(nx * ny);
+  for (int i = 0; i < nx * ny; i++) {
+    unsigned int r = _rand();
+    if ((r & 7) == 0) {
+      v[i] = MISSING;
+    } else if ((r & 7) == 1) {
+      v[i] = EXCLUDE;
+    } else {
+      v[i] = 1.0 + 99.0 * (double) (r >> 3) / (double) (1 << 21);
+    }
+  }
+  if (_rand() % 3 == 0) {
+    int y = _rand() % ny;
+    double fill = (_rand() & 1) ? MISSING : EXCLUDE;
+    for (int x = 0; x < nx; x++) {
+      v[y * nx + x] = fill;
+    }
+  }
+  if (_rand() % 3 == 0) {
+    int x = _rand() % nx;
+    double fill = (_rand() & 1) ? MISSING : EXCLUDE;
+    for (int y = 0; y < ny; y++) {
+      v[y * nx + x] = fill;
+    }
+  }
+  return v;
+}
+
+static bool _match(double got, double want)
+{
+  if (want == MISSING || want == EXCLUDE || got == MISSING ||
+      got == EXCLUDE) {
+    return got == want;
+  }
+  return fabs(got - want) <= TOLERANCE;
+}
+
+// excludeMode 0 is no exclude, 1 rejectCenterExclude true, 2 false
+
+static void _check(const vector<double> &in, int nx, int ny,
+                   int sx, int sy, int excludeMode, int minGood,
+                   bool wrap)
+{
+  static const int threads[] = {1, 3, 8};
+
+  bool isExclude = excludeMode > 0;
+  bool rejectCenter = excludeMode == 1;
+
+  vector<double> want;
+  _boxRef(in, nx, ny, sx, sy, isExclude, rejectCenter, minGood, wrap, want);
+
+  for (int it = 0; it < 3; it++) {
+    TaBoxFilter f(sx, sy);
+    if (isExclude) {
+      f.setExclude(EXCLUDE, rejectCenter);
+    }
+    f.setMinGood(minGood);
+    f.setWraparoundX(wrap);
+    f.setNumThreads(threads[it]);
+    vector<double> got(nx * ny, -1.0);
+    f.apply(&in[0], nx, ny, MISSING, &got[0]);
+
+    _nCheck++;
+    for (int i = 0; i < nx * ny; i++) {
+      if (!_match(got[i], want[i])) {
+        _nFail++;
+        fprintf(stderr, "FAIL: nx %d ny %d sx %d sy %d exclude %d "
+                "minGood %d wrap %d threads %d, at x %d y %d "
+                "got %.17g want %.17g\n",
+                nx, ny, sx, sy, excludeMode, minGood, (int) wrap,
+                threads[it], i % nx, i / nx, got[i], want[i]);
+        break;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------
+// main
+//----------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  static const int sizes[] = {1, 2, 3, 7, 20, 61};
+  static const int halfWidths[] = {0, 1, 2, 5, 40};
+  static const int minGoods[] = {0, 3};
+  int nsize = sizeof(sizes) / sizeof(sizes[0]);
+  int nhalf = sizeof(halfWidths) / sizeof(halfWidths[0]);
+
+  for (int iy = 0; iy < nsize; iy++) {
+    for (int ix = 0; ix < nsize; ix++) {
+      int nx = sizes[ix], ny = sizes[iy];
+      vector<double> in = _grid(nx, ny);
+      for (int isx = 0; isx < nhalf; isx++) {
+        for (int isy = 0; isy < nhalf; isy++) {
+          for (int excludeMode = 0; excludeMode < 3; excludeMode++) {
+            for (int ig = 0; ig < 2; ig++) {
+              for (int wrap = 0; wrap < 2; wrap++) {
+                _check(in, nx, ny, halfWidths[isx], halfWidths[isy],
+                       excludeMode, minGoods[ig], wrap == 1);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  fprintf(stderr, "%d checks, %d failed\n", _nCheck, _nFail);
+  return _nFail == 0 ? 0 : 1;
+}
@@ -0,0 +1,375 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+// ** Copyright UCAR (c) 1990 - 2016
+// ** University Corporation for Atmospheric Research (UCAR)
+// ** National Center for Atmospheric Research (NCAR)
+// ** Boulder, Colorado, USA
+// ** BSD licence applies - redistribution and use in source and binary
+// ** forms, with or without modification, are permitted provided that
+// ** the following conditions are met:
+// ** 1) If the software is modified to produce derivative works,
+// ** such modified software should be clearly marked, so as not
+// ** to confuse it with the version available from UCAR.
+// ** 2) Redistributions of source code must retain the above copyright
+// ** notice, this list of conditions and the following disclaimer.
+// ** 3) Redistributions in binary form must reproduce the above copyright
+// ** notice, this list of conditions and the following disclaimer in the
+// ** documentation and/or other materials provided with the distribution.
+// ** 4) Neither the name of UCAR nor the names of its contributors,
+// ** if any, may be used to endorse or promote products derived from
+// ** this software without specific prior written permission.
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*
+/**
+ * @file TaEncodeKernelsTest.cc
+ *
+ * Runs every TaEncodeKernels loop at each level the CPU supports, and
+ * compares the results bit for bit with the scalar loops below, which are
+ * those of TaEncodeKernels.cc (_encodeScalar, _decodeScalar,
+ * _minMaxScalar, _replaceNonFiniteScalar).
+ *
+ * The data has missing and bad values, NaN, both infinities, +0 and -0,
+ * values either side of each rounding and clamping edge, and every length
+ * up to a few vectors, starting at every alignment, so the vector tails
+ * and the NaN fallback are all used.
+ *
+ * Exits 0 if everything matches, 1 otherwise.
+ */
+#include <toolsa/TaEncodeKernels.hh>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using std::vector;
+
+//----------------------------------------------------------------
+// scalar reference loops
+//----------------------------------------------------------------
+
+template <class T>
+static size_t _encodeRef(const fl32 *in, size_t npoints,
+                         fl32 inMissing, fl32 inBad,
+                         double scale, double bias,
+                         int minOut, int maxOut,
+                         T outMissing, T outBad, T *out)
+{
+  size_t nClamped = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    fl32 in_val = in[i];
+    if (in_val == inMissing) {
+      out[i] = outMissing;
+    } else if (in_val == inBad) {
+      out[i] = outBad;
+    } else {
+      int out_val = (int) ((in_val - bias) / scale + 0.49999);
+      if (out_val > maxOut) {
+        nClamped++;
+        out[i] = (T) maxOut;
+      } else if (out_val < minOut) {
+        nClamped++;
+        out[i] = (T) minOut;
+      } else {
+        out[i] = (T) out_val;
+      }
+    }
+  }
+  return nClamped;
+}
+
+template <class T>
+static void _decodeRef(const T *in, size_t npoints,
+                       T inMissing, T inBad,
+                       fl32 scale, fl32 bias, double zeroThreshold,
+                       fl32 outMissing, fl32 outBad, fl32 *out)
+{
+  for (size_t i = 0; i < npoints; i++) {
+    if (in[i] == inMissing) {
+      out[i] = outMissing;
+    } else if (in[i] == inBad) {
+      out[i] = outBad;
+    } else {
+      // two rounded float operations, never a fused multiply-add
+      volatile fl32 product = (fl32) in[i] * scale;
+      fl32 outval = product + bias;
+      if (fabs(outval) < zeroThreshold) {
+        out[i] = 0.0;
+      } else {
+        out[i] = outval;
+      }
+    }
+  }
+}
+
+template <class T>
+static size_t _minMaxRef(const T *in, size_t npoints,
+                         T missing, T bad, T &minVal, T &maxVal)
+{
+  size_t count = 0;
+  T min_val = minVal;
+  T max_val = maxVal;
+  for (size_t i = 0; i < npoints; i++) {
+    T this_val = in[i];
+    if (this_val != missing && this_val != bad) {
+      min_val = ((min_val < this_val) ? min_val : this_val);
+      max_val = ((max_val > this_val) ? max_val : this_val);
+      count++;
+    }
+  }
+  minVal = min_val;
+  maxVal = max_val;
+  return count;
+}
+
+static size_t _replaceNonFiniteRef(fl32 *data, size_t npoints,
+                                   fl32 replacement)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    if (!std::isfinite(data[i])) {
+      data[i] = replacement;
+      count++;
+    }
+  }
+  return count;
+}
+
+//----------------------------------------------------------------
+// test data
+//----------------------------------------------------------------
+
+// Longest run tested, a few AVX2 vectors plus a tail
+static const size_t MAX_LEN = 83;
+
+// Largest start offset, so every alignment is used
+static const size_t MAX_OFFSET = 8;
+
+static const fl32 IN_MISSING = -9999.0;
+static const fl32 IN_BAD = -8888.0;
+
+static int _nFail = 0;
+static int _nCheck = 0;
+
+// Small deterministic generator, so a failure can be repeated
+static unsigned int _seed = 12345;
+
+static unsigned int _rand(void)
+{
+  _seed = _seed * 1103515245 + 12345;
+  return (_seed >> 8) & 0xffffff;
+}
+
+// Float data for encoding with scale 0.5 and bias -10, so encoded values
+// fall on 0 to 255 inside [-10, 117.5]. Includes each special value.
+
+static vector<fl32> _floatData(size_t n, bool special)
+{
+  static const fl32 specials[] = {
+    IN_MISSING, IN_BAD, 0.0f, -0.0f, NAN, -NAN, INFINITY, -INFINITY,
+    -10.0f, 117.5f, 117.75f, 118.0f, -10.25f, -11.0f, 1.0e30f, -1.0e30f,
+    // 0.49999 rounding edges: (v + 10) / 0.5 = k + 0.50001 and neighbours
+    -9.749995f, -9.74999f, -9.75f, 2.250005f, 2.25f, 2.249995f
+  };
+  size_t nspecial = sizeof(specials) / sizeof(specials[0]);
+  vector<fl32> v(n);
+  for (size_t i = 0; i < n; i++) {
+    unsigned int r = _rand();
+    if (special && (r & 3) == 0) {
+      v[i] = specials[(r >> 2) % nspecial];
+    } else {
+      v[i] = -20.0f + 150.0f * (fl32) (r % 100000) / 100000.0f;
+    }
+  }
+  return v;
+}
+
+template <class T>
+static vector<T> _intData(size_t n, T maxVal)
+{
+  vector<T> v(n);
+  for (size_t i = 0; i < n; i++) {
+    v[i] = (T) (_rand() % ((unsigned int) maxVal + 1));
+  }
+  return v;
+}
+
+static bool _same(const void *a, const void *b, size_t nbytes)
+{
+  return nbytes == 0 || memcmp(a, b, nbytes) == 0;
+}
+
+static void _check(bool ok, const char *what, const char *level,
+                   size_t len, size_t offset)
+{
+  _nCheck++;
+  if (!ok) {
+    _nFail++;
+    fprintf(stderr, "FAIL: %s, level %s, length %d, offset %d\n",
+            what, level, (int) len, (int) offset);
+  }
+}
+
+//----------------------------------------------------------------
+// one check of each loop
+//----------------------------------------------------------------
+
+template <class T>
+static void _testEncode(const char *level, const fl32 *in, size_t len,
+                        size_t offset, int maxOut, const char *what)
+{
+  vector<T> ref(len + 1), out(len + 1);
+  T outMissing = (T) 0, outBad = (T) 1;
+  size_t nRef = _encodeRef(in, len, IN_MISSING, IN_BAD, 0.5, -10.0,
+                           2, maxOut, outMissing, outBad, &ref[0]);
+  size_t nOut;
+  if (sizeof(T) == 1) {
+    nOut = TaEncodeKernels::encodeInt8(in, len, IN_MISSING, IN_BAD,
+                                       0.5, -10.0, 2, maxOut,
+                                       (ui08) outMissing, (ui08) outBad,
+                                       (ui08 *) &out[0]);
+  } else {
+    nOut = TaEncodeKernels::encodeInt16(in, len, IN_MISSING, IN_BAD,
+                                        0.5, -10.0, 2, maxOut,
+                                        (ui16) outMissing, (ui16) outBad,
+                                        (ui16 *) &out[0]);
+  }
+  _check(nRef == nOut && _same(&ref[0], &out[0], len * sizeof(T)),
+         what, level, len, offset);
+}
+
+template <class T>
+static void _testDecode(const char *level, const T *in, size_t len,
+                        size_t offset, fl32 scale, fl32 bias,
+                        double zeroThreshold, const char *what)
+{
+  vector<fl32> ref(len + 1), out(len + 1);
+  T inMissing = (T) 0, inBad = (T) 1;
+  _decodeRef(in, len, inMissing, inBad, scale, bias, zeroThreshold,
+             IN_MISSING, NAN, &ref[0]);
+  if (sizeof(T) == 1) {
+    TaEncodeKernels::decodeInt8((const ui08 *) in, len, (ui08) inMissing,
+                                (ui08) inBad, scale, bias, zeroThreshold,
+                                IN_MISSING, NAN, &out[0]);
+  } else {
+    TaEncodeKernels::decodeInt16((const ui16 *) in, len, (ui16) inMissing,
+                                 (ui16) inBad, scale, bias, zeroThreshold,
+                                 IN_MISSING, NAN, &out[0]);
+  }
+  _check(_same(&ref[0], &out[0], len * sizeof(fl32)), what, level, len,
+         offset);
+}
+
+template <class T>
+static void _testMinMax(const char *level, const T *in, size_t len,
+                        size_t offset, T missing, T bad, T min0, T max0,
+                        const char *what)
+{
+  T minRef = min0, maxRef = max0, minOut = min0, maxOut = max0;
+  size_t nRef = _minMaxRef(in, len, missing, bad, minRef, maxRef);
+  size_t nOut = TaEncodeKernels::minMax(in, len, missing, bad,
+                                        minOut, maxOut);
+  _check(nRef == nOut && _same(&minRef, &minOut, sizeof(T)) &&
+         _same(&maxRef, &maxOut, sizeof(T)), what, level, len, offset);
+}
+
+static void _testReplace(const char *level, const fl32 *in, size_t len,
+                         size_t offset)
+{
+  vector<fl32> ref(in, in + len), out(in, in + len);
+  ref.push_back(0.0f);
+  out.push_back(0.0f);
+  size_t nRef = _replaceNonFiniteRef(&ref[0], len, IN_MISSING);
+  size_t nOut = TaEncodeKernels::replaceNonFinite(&out[0], len, IN_MISSING);
+  _check(nRef == nOut && _same(&ref[0], &out[0], len * sizeof(fl32)),
+         "replaceNonFinite", level, len, offset);
+}
+
+//----------------------------------------------------------------
+// all checks at one level
+//----------------------------------------------------------------
+
+static void _testLevel(const char *level)
+{
+  for (size_t offset = 0; offset <= MAX_OFFSET; offset++) {
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+
+      // float data, with and without special values, so that both the
+      // vector min/max and its NaN fallback are used
+
+      for (int special = 0; special <= 1; special++) {
+        vector<fl32> f = _floatData(len + offset + 1, special == 1);
+        const fl32 *in = &f[offset];
+        _testEncode<ui08>(level, in, len, offset, 255, "encodeInt8");
+        _testEncode<ui08>(level, in, len, offset, 200,
+                          "encodeInt8 clamped");
+        _testEncode<ui16>(level, in, len, offset, 65535, "encodeInt16");
+        _testEncode<ui16>(level, in, len, offset, 100,
+                          "encodeInt16 clamped");
+        _testMinMax<fl32>(level, in, len, offset, IN_MISSING, IN_BAD,
+                          1.0e30f, -1.0e30f, "minMax fl32");
+        _testMinMax<fl32>(level, in, len, offset, IN_MISSING, IN_BAD,
+                          0.0f, -0.0f, "minMax fl32 signed zero init");
+        _testMinMax<fl32>(level, in, len, offset, IN_MISSING, IN_BAD,
+                          NAN, NAN, "minMax fl32 NaN init");
+        _testReplace(level, in, len, offset);
+      }
+
+      // all zeros of both signs, where only the order sets the sign
+
+      vector<fl32> z(len + offset + 1);
+      for (size_t i = 0; i < z.size(); i++) {
+        z[i] = (_rand() & 1) ? 0.0f : -0.0f;
+      }
+      _testMinMax<fl32>(level, &z[offset], len, offset, IN_MISSING, IN_BAD,
+                        1.0e30f, -1.0e30f, "minMax fl32 signed zeros");
+      _testMinMax<fl32>(level, &z[offset], len, offset, IN_MISSING, IN_BAD,
+                        -0.0f, 0.0f, "minMax fl32 signed zeros init");
+
+      // integer data
+
+      vector<ui08> b = _intData<ui08>(len + offset + 1, 255);
+      vector<ui16> s = _intData<ui16>(len + offset + 1, 65535);
+      _testDecode<ui08>(level, &b[offset], len, offset, 0.5f, -10.0f, 0.0,
+                        "decodeInt8");
+      _testDecode<ui08>(level, &b[offset], len, offset, 0.1f, -12.7f, 0.05,
+                        "decodeInt8 zero threshold");
+      _testDecode<ui16>(level, &s[offset], len, offset, 0.01f, -300.0f,
+                        0.0, "decodeInt16");
+      _testDecode<ui16>(level, &s[offset], len, offset, 0.003f, -98.3f,
+                        0.0015, "decodeInt16 zero threshold");
+      _testMinMax<ui08>(level, &b[offset], len, offset, 0, 1, 255, 0,
+                        "minMax ui08");
+      _testMinMax<ui08>(level, &b[offset], len, offset, 0, 255, 100, 100,
+                        "minMax ui08 bad 255");
+      _testMinMax<ui16>(level, &s[offset], len, offset, 0, 1, 65535, 0,
+                        "minMax ui16");
+      _testMinMax<ui16>(level, &s[offset], len, offset, 65535, 65534,
+                        30000, 30000, "minMax ui16 bad 65534");
+    }
+  }
+}
+
+//----------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  static const TaEncodeKernels::level_t levels[] = {
+    TaEncodeKernels::SCALAR, TaEncodeKernels::SSE2, TaEncodeKernels::AVX2
+  };
+  static const char *names[] = {"scalar", "sse2", "avx2"};
+
+  for (int i = 0; i < 3; i++) {
+    TaEncodeKernels::setLevel(levels[i]);
+    if (TaEncodeKernels::getLevel() != levels[i]) {
+      fprintf(stderr, "Level %s not supported, skipped\n", names[i]);
+      continue;
+    }
+    int nFail = _nFail;
+    _testLevel(names[i]);
+    fprintf(stderr, "Level %s: %s\n", names[i],
+            _nFail == nFail ? "ok" : "FAILED");
+  }
+
+  fprintf(stderr, "%d checks, %d failed\n", _nCheck, _nFail);
+  return _nFail == 0 ? 0 : 1;
+}
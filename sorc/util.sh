@@ -5,6 +5,7 @@ rm CloudHt.cd/CloudHt
 rm CmorphAverager.cd/CmorphAverager
 rm EnsFcstComb.cd/EnsFcstComb
 rm EnsLookupGen.cd/EnsLookupGen
+rm EpochBench.cd/EpochBench
 rm GmgsiNcf2Mdv.cd/GmgsiNcf2Mdv
 rm Grib2toMdv.cd/Grib2toMdv
 rm MdvMerge2.cd/MdvMerge2